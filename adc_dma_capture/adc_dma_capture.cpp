@@ -2,6 +2,9 @@
  * Modified from Raspberry Pi example for continuous ECG capture
  * Uses 12-bit ADC resolution and outputs actual voltage values
  * Samples ADC at 500Hz for 5 seconds (2500 samples) in a loop
+ * Driven by the event-loop scheduler: the DMA interrupt starts the dump,
+ * the dump runs in batches, and a timer restarts the capture one second
+ * after the dump is done. The CPU sleeps in between.
  */
 
 #include <pico/time.h>
@@ -10,6 +13,8 @@
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 #include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "ecg_scheduler.hpp"
 
 #define CAPTURE_CHANNEL 0      // Channel 0 is ADC0/GPIO26
 constexpr int16_t CAPTURE_DEPTH = 5000;     // 5 seconds of data at 500Hz
@@ -21,6 +26,15 @@ constexpr float CLOCK_DIV = 47999.0f;
 uint16_t capture_buf[CAPTURE_DEPTH];  // Using uint16_t for 12-bit values
 uint dma_chan;  // Make DMA channel global so we can reuse it
 
+#define EVENT_CAPTURE_DONE  (1u << 0)   // DMA finished the capture buffer
+#define PRINT_BATCH         100         // Lines per run of the print task
+#define PRINT_GAP_US        2000        // Pause between batches, keeps the USB output from overflowing
+#define CAPTURE_GAP_US      1000000     // Wait between captures
+
+static EcgScheduler sched;
+static int capture_task_id, print_task_id;
+static int print_next = -1;             // Next sample to print, -1 when no dump is in progress
+
 void init_adc_and_dma() {
     // Init GPIO for analogue use: hi-Z, no pulls, disable digital input buffer.
     adc_gpio_init(26 + CAPTURE_CHANNEL);
@@ -42,7 +56,13 @@ void init_adc_and_dma() {
     dma_chan = dma_claim_unused_channel(true);
 }
 
-void adc_capture_loop() {
+void capture_dma_irq() {
+    dma_channel_acknowledge_irq0(dma_chan);
+    adc_run(false);
+    ecg_sched_post(sched, EVENT_CAPTURE_DONE);
+}
+
+void capture_task(void *) {
     // Configure DMA for this capture
     dma_channel_config cfg = dma_channel_get_default_config(dma_chan);
     channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);  // 16-bit transfers for 12-bit ADC
@@ -65,26 +85,34 @@ void adc_capture_loop() {
     );
 
     adc_run(true);
+}
 
-    // Wait for capture to complete
-    dma_channel_wait_for_finish_blocking(dma_chan);
-    
-    // Stop the ADC
-    adc_run(false);
-    adc_fifo_drain();
-
-    // Print header
-    printf("Time(ms),Voltage(V)\n");
+// Runs when the capture completes, then once per batch until every sample is printed
+void print_task(void *) {
+    if (print_next < 0) {
+        adc_fifo_drain();
+        // Print header
+        printf("Time(ms),Voltage(V)\n");
+        print_next = 0;
+    }
 
     // Print samples to stdout with actual voltage values
-    for (int i = 0; i < CAPTURE_DEPTH; ++i) {
+    int end = print_next + PRINT_BATCH < CAPTURE_DEPTH ? print_next + PRINT_BATCH : CAPTURE_DEPTH;
+    for (int i = print_next; i < end; ++i) {
         float time_ms = (float)i * (1000.0f / SAMPLE_RATE);
         float voltage = capture_buf[i] * ADC_CONVERSION_FACTOR;
         printf("%.1f,%.3f\n", time_ms, voltage);
-        sleep_us(20);  // Small delay to prevent overwhelming the serial output
     }
-
-    printf("Capture complete\n\n");
+    print_next = end;
+
+    uint64_t now = time_us_64();
+    if (print_next < CAPTURE_DEPTH) {
+        ecg_sched_wake_at(sched, print_task_id, now + PRINT_GAP_US);
+    } else {
+        printf("Capture complete\n\n");
+        print_next = -1;
+        ecg_sched_wake_at(sched, capture_task_id, now + CAPTURE_GAP_US);
+    }
 }
 
 void cleanup_dma() {
@@ -103,11 +131,17 @@ int main() {
     printf("Capture duration: %d samples (%d seconds)\n\n", 
            CAPTURE_DEPTH, CAPTURE_DEPTH/SAMPLE_RATE);
 
-    // Capture loop
-    while(1) {
-        adc_capture_loop();
-        sleep_ms(1000);  // Wait between captures
-    }
+    ecg_sched_init(sched, ecg_sched_clock_pico, ecg_sched_idle_pico);
+    capture_task_id = ecg_sched_add(sched, "capture", capture_task, NULL, 0, 0, 0);
+    print_task_id = ecg_sched_add(sched, "print", print_task, NULL, EVENT_CAPTURE_DONE, 0, 0);
+
+    dma_channel_set_irq0_enabled(dma_chan, true);
+    irq_set_exclusive_handler(DMA_IRQ_0, capture_dma_irq);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    // Capture loop: start now, the tasks take it from there
+    ecg_sched_wake_at(sched, capture_task_id, time_us_64());
+    ecg_sched_run(sched);
 
     // This won't be reached in an infinite loop, but good practice
     cleanup_dma();
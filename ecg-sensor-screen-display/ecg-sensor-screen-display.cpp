@@ -1,249 +1,501 @@
 /**
  * ECG Display and Heart Rate Monitor
- * Combines ADC capture with LCD display and heart rate detection
+ * Combines ADC capture with LCD display and heart rate detection.
+ * Core 0 captures, core 1 filters and draws; sample blocks pass between
+ * them through lock-free queues without being copied.
  */
 
 #include <pico/stdlib.h>
 #include <pico/time.h>
+#include <pico/multicore.h>
 #include <hardware/adc.h>
 #include <hardware/dma.h>
+#include <hardware/irq.h>
 #include <hardware/clocks.h>
 #include <stdio.h>
-#include <cmath>
-#include "lcd_wrapper.hpp"  // 使用新的包装头文件
+#include "ecg_display.hpp"
+#include "ecg_block_queue.hpp"
+#include "ecg_block_pool.hpp"
+#include "ecg_scheduler.hpp"
+#include "ecg_coro.hpp"
+#include "ecg_governor.hpp"
+#include "ecg_stream.hpp"
 
+// 导联 i 接在 ADC 通道 CAPTURE_CHANNEL + i (GP26 + i)，多导联时 ADC 轮流采样各通道
 #define CAPTURE_CHANNEL 0
-#define CAPTURE_DEPTH 2500  // 2.5 seconds of data at 1000Hz
-#define DISPLAY_WIDTH 240
-#define DISPLAY_HEIGHT 135
-#define ECG_AMPLITUDE 50    // Vertical scaling for ECG display
-#define ECG_OFFSET 90       // Vertical center position for ECG trace
-#define R_PEAK_THRESHOLD 2.3 // Voltage threshold for R peak detection (adjust as needed)
+#define CAPTURE_LEADS   1
+#define CAPTURE_MASK    (((1u << CAPTURE_LEADS) - 1) << CAPTURE_CHANNEL)
+
+// ADC 连续采样，两个 DMA 通道互相链接，轮流把 ECG_CHUNK_SAMPLES 组写进块池里的一块
+// 写满一块，核 0 的 DMA 中断盖上序号、时间戳和 CRC，给每个消费者一个引用发布出去，再从池里换一块空的；
+// 消费者用完放掉引用，最后一个放掉时块回到池里。采样从 DMA 写入到进入历史记录都不拷贝
+#define CAPTURE_BLOCKS        16    // 2 的幂；两块在 DMA 手里，核 1 落后 14 块 (140 ms) 才丢数据
+#define CAPTURE_CONSUMERS     1     // 每块的消费者：核 1 的显示
+#define CAPTURE_BLOCK_SAMPLES (ECG_CHUNK_SAMPLES * CAPTURE_LEADS)
+#define CAPTURE_DMA_IRQ       DMA_IRQ_1   // DMA_IRQ_0 归 DEV_Config 的传输队列
+#define LATENCY_REPORT_MS     5000
+#define REPORT_LINE_BYTES     128   // 报告每次等 USB 发送缓冲空出一行的量
+#define LOG_DRAIN_US          20000 // 二进制日志搬到 USB 的间隔
+#define LOG_DRAIN_BYTES       128   // 一次搬的量，不超过 USB 发送缓冲
+#define TRACE_DRAIN_US        10000 // 追踪打开时搬事件的间隔；两个核每 10 ms 合计几十个事件
+#define TRACE_DRAIN_BYTES     (DEV_TRACE_HEADER + 7 * sizeof(DEV_TRACE_REC))  // 一段 120 字节
+#define STREAM_MAX_QUEUED     4     // 采样帧最多积压的块，USB 跟不上时多出的块不发，主机按序号算丢块
+
+// 事件位；核 0 的调度器管报告和串口，核 1 的管绘制
+#define EVENT_BLOCK           (1u << 0)   // 核 0 发布了采样块 (核 1)
+#define EVENT_USB_RX          (1u << 1)   // USB 串口收到数据 (核 0)
+#define EVENT_CORO            (1u << 2)   // 协程等的条件到了 (核 0)
+#define RENDER_DEADLINE_US    ((uint32_t)(ECG_CHUNK_SAMPLES * 1000000 / SAMPLE_RATE))  // 下一块到来之前画完
 
 // Global variables
-uint16_t capture_buf[CAPTURE_DEPTH];
-uint dma_chan;
-UWORD *display_buf;
-uint32_t last_heartbeat_time = 0;
-float heart_rate = 0.0f;
-
-// Constants from adc_dma_capture.cpp
-constexpr float ADC_VREF = 3.3f;
-constexpr float ADC_CONVERSION_FACTOR = (ADC_VREF / (1 << 12));
-constexpr float SAMPLE_RATE = 1000.0f;
-constexpr float CLOCK_DIV = 47999.0f;
-
-// 在全局变量区添加滤波器系数和状态
-struct BandpassFilter {
-    // 二阶IIR滤波器的状态变量
-    float x1 = 0, x2 = 0;  // 输入历史
-    float y1 = 0, y2 = 0;  // 输出历史
-    
-    // 滤波器系数 (0.5-35Hz @ 1000Hz采样率)
-    // 使用二阶Butterworth滤波器设计
-    static constexpr float b0 = 0.0675f;
-    static constexpr float b1 = 0.0f;
-    static constexpr float b2 = -0.0675f;
-    static constexpr float a1 = -1.8650f;
-    static constexpr float a2 = 0.8651f;
-    
-    float process(float input) {
-        // 实现IIR滤波器
-        float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-        
-        // 更新状态
-        x2 = x1;
-        x1 = input;
-        y2 = y1;
-        y1 = output;
-        
-        return output;
-    }
-    
-    void reset() {
-        x1 = x2 = y1 = y2 = 0.0f;
-    }
+static uint16_t capture_payload[CAPTURE_BLOCKS][CAPTURE_BLOCK_SAMPLES] DEV_RAM_DMA;
+static EcgSampleBlock capture_blocks[CAPTURE_BLOCKS];
+static EcgBlockPool capture_pool;           // 池空时原地重写，计入 exhausted
+static EcgBlockQueue<EcgSampleBlock *, CAPTURE_BLOCKS> capture_filled;  // 核 0 -> 核 1
+static uint dma_chan[2];
+static EcgSampleBlock *dma_block[2];        // 各通道正在写的块
+static uint32_t capture_seq;                // 下一块的序号，丢掉的块也占一个
+static bool capture_gap;                    // 上一块被丢了
+static EcgScheduler main_sched;             // 核 0
+static EcgScheduler render_sched;           // 核 1
+static EcgSignal report_now;   // 串口命令叫核 0 立即报告
+// 核 1 的统计，核 1 拷好后置 ready，核 0 打印后清掉
+struct RenderStats {
+    EcgLatency latency;
+    EcgSchedStats sched;
 };
+static RenderStats render_stats;
+static std::atomic<bool> render_stats_ready;
+static EcgSignal hist_now;     // 串口命令叫核 0 打印各段的直方图
+static EcgGovernor governor;   // 核 0 的 gov_loop 调，串口命令固定档
+static std::atomic<bool> stream_on;     // 串口命令 s 开关采样帧
+static EcgBlockQueue<EcgSampleBlock *, CAPTURE_BLOCKS> capture_stream;  // DMA 中断 -> stream_loop
+static EcgSignal stream_ready;
+
+// 48 MHz ADC 时钟 (PLL_USB，调速改 clk_sys 时不变)，每个导联 SAMPLE_RATE 次/秒
+constexpr float CLOCK_DIV = 48000000.0f / (SAMPLE_RATE * CAPTURE_LEADS) - 1.0f;
 
 void init_adc_and_dma() {
-    adc_gpio_init(26 + CAPTURE_CHANNEL);
+    for (int i = 0; i < CAPTURE_LEADS; i++) {
+        adc_gpio_init(26 + CAPTURE_CHANNEL + i);
+    }
     adc_init();
     adc_select_input(CAPTURE_CHANNEL);
+    adc_set_round_robin(CAPTURE_LEADS > 1 ? ((1u << CAPTURE_LEADS) - 1) << CAPTURE_CHANNEL : 0);
     adc_fifo_setup(true, true, 1, false, false);
     adc_set_clkdiv(CLOCK_DIV);
-    dma_chan = dma_claim_unused_channel(true);
+    for (int i = 0; i < 2; i++) {
+        dma_chan[i] = dma_claim_unused_channel(true);
+    }
 }
 
-void init_display() {
-    if(DEV_Module_Init() != 0) {
-        printf("Display init failed!\n");
-        return;
+// 一块写满：发布出去，换一块空闲的给这个通道，下次链接触发时生效
+static void capture_dma_irq() {
+    DEV_TRACE_BEGIN("capture irq");
+    uint64_t now = time_us_64();
+    for (int i = 0; i < 2; i++) {
+        if (!dma_irqn_get_channel_status(1, dma_chan[i])) {
+            continue;
+        }
+        dma_irqn_acknowledge_channel(1, dma_chan[i]);
+        EcgSampleBlock *next = ecg_block_alloc(capture_pool);
+        if (next != nullptr) {
+            EcgSampleBlock *block = dma_block[i];
+            block->sets = ECG_CHUNK_SAMPLES;
+            block->seq = capture_seq++;
+            // 最早一组已经在块里等了一整块的时间
+            block->oldest_us = now - (uint64_t)ECG_CHUNK_SAMPLES * (uint64_t)(1000000 / SAMPLE_RATE);
+            block->channel_mask = CAPTURE_MASK;
+            block->flags = capture_gap ? ECG_BLOCK_AFTER_GAP : 0;
+            ecg_block_seal(block);
+            // 采样帧打开时 USB 也是一个消费者
+            bool stream = stream_on.load(std::memory_order_relaxed) && capture_stream.size() < STREAM_MAX_QUEUED;
+            ecg_block_ref(block, CAPTURE_CONSUMERS - 1 + stream);
+            capture_gap = false;
+            capture_filled.push(block);   // 块总数等于队列容量，不会满
+            if (stream) {
+                capture_stream.push(block);
+                ecg_signal_raise(stream_ready);
+            }
+            dma_block[i] = next;
+            ecg_sched_post(render_sched, EVENT_BLOCK);
+            // FIFO 只当门铃，把核 1 从 __wfi 叫醒；满了说明核 1 还没醒，不用再按
+            if (multicore_fifo_wready()) {
+                multicore_fifo_push_blocking(0);
+            }
+        } else {
+            capture_seq++;
+            capture_gap = true;
+        }
+        dma_channel_set_write_addr(dma_chan[i], dma_block[i]->samples, false);
     }
-    
-    DEV_SET_PWM(50);  // Set backlight
-    LCD_1IN14_Init(HORIZONTAL);
-    LCD_1IN14_Clear(BLACK);
-    
-    // Allocate display buffer
-    display_buf = (UWORD *)malloc(DISPLAY_WIDTH * DISPLAY_HEIGHT * 2);
-    if(display_buf == NULL) {
-        printf("Failed to allocate display buffer\n");
+    DEV_TRACE_COUNTER("blocks free", (int32_t)ecg_block_pool_free(capture_pool));
+    DEV_TRACE_END("capture irq");
+}
+
+void start_capture() {
+    ecg_block_pool_init(capture_pool, capture_blocks, CAPTURE_BLOCKS, capture_payload[0], CAPTURE_BLOCK_SAMPLES);
+    // 与协程的 DMA 等待共享，各自只确认自己的通道
+    irq_add_shared_handler(CAPTURE_DMA_IRQ, capture_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(CAPTURE_DMA_IRQ, true);
+
+    adc_fifo_drain();
+    adc_run(false);
+    // 轮询从第一个导联开始，块中的采样按导联交错；每块正好是整组
+    adc_select_input(CAPTURE_CHANNEL);
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config cfg = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_dreq(&cfg, DREQ_ADC);
+        channel_config_set_chain_to(&cfg, dma_chan[i ^ 1]);
+        dma_block[i] = ecg_block_alloc(capture_pool);
+        dma_channel_configure(dma_chan[i], &cfg,
+            dma_block[i]->samples,          // dst
+            &adc_hw->fifo,                  // src
+            CAPTURE_BLOCK_SAMPLES,
+            i == 0                          // 第一个通道立即开始，第二个由链接触发
+        );
+        dma_irqn_set_channel_enabled(1, dma_chan[i], true);
+    }
+
+    adc_run(true);
+}
+
+// 核 1 的门铃中断：事件已经置位，只需清空 FIFO
+static void doorbell_irq() {
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+}
+
+// 取走所有已发布的块，滤波后放掉引用，再画一次
+static void render_task(void *) {
+    EcgSampleBlock *block;
+    bool any = false;
+    while (capture_filled.pop(block)) {
+        // DMA 写满这块的时刻就是最早一组加上一块的时长
+        uint64_t filled_us = block->oldest_us + (uint64_t)block->sets * (uint64_t)(1000000 / SAMPLE_RATE);
+        ecg_hist_record(display_stages[ECG_STAGE_CAPTURE], (uint32_t)(time_us_64() - filled_us));
+        ecg_display_push(block->samples, block->sets, block->oldest_us);
+        ecg_block_release(block);
+        any = true;
+    }
+    // Only the columns the new samples touched are drawn and sent
+    if (any) {
+        ecg_display_update();
+    }
+}
+
+// 核 1 不打印，USB 发不出去时 printf 会卡住绘制；统计拷一份留给核 0 的报告
+// 核 0 打印完才清 ready，在那之前核 1 不覆盖，接着累计
+static void render_stats_task(void *) {
+    if (render_stats_ready.load(std::memory_order_acquire)) {
         return;
     }
-    
-    // Initialize Paint
-    Paint_NewImage((UBYTE *)display_buf, LCD_1IN14.WIDTH, LCD_1IN14.HEIGHT, 0, WHITE);
-    Paint_SetScale(65);
-    Paint_Clear(BLACK);
-    Paint_SetRotate(ROTATE_0);
+    render_stats.latency = display_latency;
+    ecg_sched_take_stats(render_sched, render_stats.sched);
+    render_stats_ready.store(true, std::memory_order_release);
 }
 
-void calculate_heart_rate(float voltage) {
-    static uint32_t r_peak_count = 0;
-    static uint32_t last_peak_time = 0;
-    static const uint32_t MIN_RR_INTERVAL_MS = 200; // Minimum time between peaks (300bpm max)
-    
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    
-    // Check for R peak
-    if (voltage > R_PEAK_THRESHOLD && 
-        (current_time - last_peak_time) > MIN_RR_INTERVAL_MS) {
-        
-        if (last_peak_time > 0) {
-            // Calculate instantaneous heart rate
-            float rr_interval = (current_time - last_peak_time) / 1000.0f; // Convert to seconds
-            float instant_hr = 60.0f / rr_interval;
-            
-            // Update heart rate with moving average
-            heart_rate = heart_rate * 0.7f + instant_hr * 0.3f;
+// 核 1：初始化显示，之后由调度器按事件运行
+static void render_core() {
+    EcgLeadSetup leads = ECG_LEADS_DEFAULT;
+    leads.count = CAPTURE_LEADS;
+    bool ok = init_display(ecg_panel_find(ECG_PANEL_DEFAULT), ECG_PANEL_RGB444, ECG_RENDER_DEFAULT, &leads);
+
+    ecg_sched_init(render_sched, ecg_sched_clock_pico, ecg_sched_idle_pico);
+    ecg_sched_add(render_sched, "render", render_task, NULL, EVENT_BLOCK, 0, RENDER_DEADLINE_US);
+    ecg_sched_add(render_sched, "stats", render_stats_task, NULL, 0, LATENCY_REPORT_MS * 1000, 0);
+    multicore_fifo_push_blocking(ok);   // 告诉核 0 可以开始采样
+
+    multicore_fifo_drain();
+    irq_set_exclusive_handler(SIO_FIFO_IRQ_NUM(1), doorbell_irq);
+    irq_set_enabled(SIO_FIFO_IRQ_NUM(1), true);
+    ecg_sched_run(render_sched);
+}
+
+static void report_bus(char *line, size_t len) {
+    UDOUBLE contested[DEV_BUS_COUNTERS];
+    DEV_Bus_Perf_Read(contested);
+    snprintf(line, len, "bus contested: sram0-3 %lu, sram4-7 %lu, scratch x %lu, scratch y %lu\n",
+             (unsigned long)contested[DEV_BUS_SRAM0_3], (unsigned long)contested[DEV_BUS_SRAM4_7],
+             (unsigned long)contested[DEV_BUS_SCRATCH_X], (unsigned long)contested[DEV_BUS_SCRATCH_Y]);
+}
+
+static void report_xip(char *line, size_t len) {
+    UDOUBLE xip_hit, xip_access;
+    DEV_XIP_Perf_Read(&xip_hit, &xip_access);
+    snprintf(line, len, "xip cache: %lu misses of %lu accesses (%lu.%02lu%% hit)\n",
+             (unsigned long)(xip_access - xip_hit), (unsigned long)xip_access,
+             (unsigned long)(xip_access ? (uint64_t)xip_hit * 10000 / xip_access / 100 : 0),
+             (unsigned long)(xip_access ? (uint64_t)xip_hit * 10000 / xip_access % 100 : 0));
+}
+
+static void report_p99(char *line, size_t len) {
+    int n = snprintf(line, len, "p99 us:");
+    for (int i = 0; i < ECG_STAGE_COUNT && n < (int)len; i++) {
+        n += snprintf(line + n, len - n, " %s %lu", display_stages[i].name,
+                      (unsigned long)ecg_hist_value_at(display_stages[i], 990));
+    }
+    // 截断时也以换行结尾
+    n = n < (int)len - 1 ? n : (int)len - 2;
+    line[n++] = '\n';
+    line[n] = '\0';
+}
+
+static void report_blocks(char *line, size_t len) {
+    snprintf(line, len, "blocks: %lu of %d free, %lu at least, %lu dropped with the pool empty\n",
+             (unsigned long)ecg_block_pool_free(capture_pool), CAPTURE_BLOCKS,
+             (unsigned long)capture_pool.low_water.load(std::memory_order_relaxed),
+             (unsigned long)capture_pool.exhausted.load(std::memory_order_relaxed));
+}
+
+static void report_latency(const EcgLatency &latency, char *line, size_t len) {
+    snprintf(line, len, "latency: %lu us last, %lu us avg, %lu us worst (target %d us)\n",
+             (unsigned long)latency.last_us, (unsigned long)(latency.sum_us / latency.count),
+             (unsigned long)latency.max_us, ECG_LATENCY_TARGET_US);
+}
+
+// 核 0 的报告：到时或收到 r 时打印，一次格式化一行，每行之前等 USB 发送缓冲有一行的空间，
+// 主机没在读时不卡在 printf 里。核 1 的统计在它拷好以后才打印
+static EcgCoro report_loop() {
+    static char line[REPORT_LINE_BYTES];
+    static EcgSchedStats main_stats;
+    uint64_t next = time_us_64() + LATENCY_REPORT_MS * 1000;
+    for (;;) {
+        if (!co_await ecg_wait(report_now, next)) {
+            next += LATENCY_REPORT_MS * 1000;
+        }
+        co_await ecg_usb_writable(REPORT_LINE_BYTES);
+        report_bus(line, sizeof(line));
+        printf("%s", line);
+        co_await ecg_usb_writable(REPORT_LINE_BYTES);
+        report_xip(line, sizeof(line));
+        printf("%s", line);
+        co_await ecg_usb_writable(REPORT_LINE_BYTES);
+        report_p99(line, sizeof(line));
+        printf("%s", line);
+        co_await ecg_usb_writable(REPORT_LINE_BYTES);
+        report_blocks(line, sizeof(line));
+        printf("%s", line);
+        uint32_t row = 0;
+        while (ecg_gov_report_line(governor, &row, line, sizeof(line))) {
+            co_await ecg_usb_writable(REPORT_LINE_BYTES);
+            printf("%s", line);
+        }
+        ecg_sched_take_stats(main_sched, main_stats);
+        row = 0;
+        while (ecg_sched_report_line(main_stats, &row, line, sizeof(line) - 7)) {   // 留出 "core 0 "
+            co_await ecg_usb_writable(REPORT_LINE_BYTES);
+            printf("%s%s", row == 1 ? "core 0 " : "", line);
+        }
+        if (!render_stats_ready.load(std::memory_order_acquire)) {
+            continue;
+        }
+        if (render_stats.latency.count > 0) {
+            co_await ecg_usb_writable(REPORT_LINE_BYTES);
+            report_latency(render_stats.latency, line, sizeof(line));
+            printf("%s", line);
+        }
+        row = 0;
+        while (ecg_sched_report_line(render_stats.sched, &row, line, sizeof(line) - 7)) {
+            co_await ecg_usb_writable(REPORT_LINE_BYTES);
+            printf("%s%s", row == 1 ? "core 1 " : "", line);
         }
-        
-        last_peak_time = current_time;
-        r_peak_count++;
+        render_stats_ready.store(false, std::memory_order_release);
     }
 }
 
-void display_ecg_data() {
-    static float filtered_buf[CAPTURE_DEPTH];
-    static const int DISPLAY_SAMPLES = DISPLAY_WIDTH;
-    static float display_samples[DISPLAY_WIDTH];
-    static BandpassFilter filter;  // 滤波器实例
-    
-    // 首先应用带通滤波器
-    for(int i = 0; i < CAPTURE_DEPTH; i++) {
-        float voltage = capture_buf[i] * ADC_CONVERSION_FACTOR;
-        filtered_buf[i] = filter.process(voltage);
+// 两个核的二进制日志 (Debug() 等) 原样送到 USB，不在设备上格式化；主机用 log_decode.py 还原
+static EcgCoro log_loop() {
+    static uint8_t buf[LOG_DRAIN_BYTES];
+    for (;;) {
+        co_await ecg_delay_us(LOG_DRAIN_US);
+        for (uint8_t core = 0; core < DEV_LOG_CORES; core++) {
+            uint32_t n;
+            while ((n = DEV_Log_Read(core, buf, sizeof(buf))) > 0) {
+                uint64_t taken_us = time_us_64();
+                co_await ecg_usb_writable(n);
+                DEV_TRACE_BEGIN("usb write");
+                stdio_put_string((const char *)buf, (int)n, false, false);
+                DEV_TRACE_END("usb write");
+                ecg_hist_record(display_stages[ECG_STAGE_USB], (uint32_t)(time_us_64() - taken_us));
+            }
+        }
     }
-    
-    // 智能降采样使用局部最大最小值方法
-    const int DOWNSAMPLE_FACTOR = CAPTURE_DEPTH / DISPLAY_WIDTH;
-    for(int i = 0; i < DISPLAY_WIDTH; i++) {
-        float min_val = 99999.0f;
-        float max_val = -99999.0f;
-        int start_idx = i * DOWNSAMPLE_FACTOR;
-        int end_idx = start_idx + DOWNSAMPLE_FACTOR;
-        
-        // 在此窗口中找到局部最大和最小值
-        for(int j = start_idx; j < end_idx && j < CAPTURE_DEPTH; j++) {
-            min_val = min_val > filtered_buf[j] ? filtered_buf[j] : min_val;
-            max_val = max_val < filtered_buf[j] ? filtered_buf[j] : max_val;
+}
+
+// 追踪打开时把两个核的事件段送到 USB，主机用 trace_export.py 转成 Chrome trace
+static EcgCoro trace_loop() {
+    static uint8_t buf[TRACE_DRAIN_BYTES];
+    for (;;) {
+        co_await ecg_delay_us(TRACE_DRAIN_US);
+        for (uint8_t core = 0; core < DEV_TRACE_CORES; core++) {
+            uint32_t n;
+            while ((n = DEV_Trace_Read(core, buf, sizeof(buf))) > 0) {
+                uint64_t taken_us = time_us_64();
+                co_await ecg_usb_writable(n);
+                stdio_put_string((const char *)buf, (int)n, false, false);
+                ecg_hist_record(display_stages[ECG_STAGE_USB], (uint32_t)(time_us_64() - taken_us));
+            }
         }
-        
-        // 使用与均值偏差较大的值作为代表点
-        float mean = (min_val + max_val) / 2.0f;
-        float dist_to_min = fabs(mean - min_val);
-        float dist_to_max = fabs(mean - max_val);
-        
-        display_samples[i] = (dist_to_max > dist_to_min) ? max_val : min_val;
     }
-    
-    // 清除显示缓冲区
-    Paint_Clear(BLACK);
-    
-    // 绘制网格
-    for (int x = 0; x < DISPLAY_WIDTH; x += 20) {
-        Paint_DrawLine(x, 0, x, DISPLAY_HEIGHT, GRAY, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+}
+
+// 采样帧：每块编成一帧送到 USB，原始 ADC 值，主机用 host/ecg_capture 解码存盘
+// 编好就放掉块，等 USB 的时候不占池
+static EcgCoro stream_loop() {
+    static uint8_t frame[ecg_stream_frame_bytes(CAPTURE_BLOCK_SAMPLES)];
+    static_assert(sizeof(frame) <= REPORT_LINE_BYTES, "a frame must fit the USB send buffer");
+    for (;;) {
+        co_await stream_ready;
+        EcgSampleBlock *block;
+        while (capture_stream.pop(block)) {
+            uint64_t taken_us = time_us_64();
+            size_t n = ecg_stream_encode(block, frame, sizeof(frame));
+            ecg_block_release(block);
+            co_await ecg_usb_writable((uint32_t)n);
+            stdio_put_string((const char *)frame, (int)n, false, false);
+            ecg_hist_record(display_stages[ECG_STAGE_USB], (uint32_t)(time_us_64() - taken_us));
+        }
     }
-    for (int y = 0; y < DISPLAY_HEIGHT; y += 20) {
-        Paint_DrawLine(0, y, DISPLAY_WIDTH, y, GRAY, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+}
+
+// 收到 h 时打印各段直方图：每段一行分位数摘要，再是非空的桶 (下界 us:次数)，一行一行等 USB 有空
+static EcgCoro hist_loop() {
+    static char line[REPORT_LINE_BYTES];
+    for (;;) {
+        co_await hist_now;
+        for (int i = 0; i < ECG_STAGE_COUNT; i++) {
+            const EcgHistogram &hist = display_stages[i];
+            co_await ecg_usb_writable(REPORT_LINE_BYTES);
+            ecg_hist_summary(hist, line, sizeof(line));
+            printf("%s", line);
+            uint32_t next = 0;
+            while (ecg_hist_buckets(hist, &next, line, sizeof(line))) {
+                co_await ecg_usb_writable(REPORT_LINE_BYTES);
+                printf("%s", line);
+            }
+        }
     }
-    
-    // 绘制ECG数据
-    for (int i = 1; i < DISPLAY_WIDTH; i++) {
-        // 缩放电压值到显示坐标
-        int y1 = ECG_OFFSET - (int)(display_samples[i-1] * ECG_AMPLITUDE);
-        int y2 = ECG_OFFSET - (int)(display_samples[i] * ECG_AMPLITUDE);
-        
-        // 确保坐标在显示范围内
-        y1 = (y1 < 0) ? 0 : (y1 >= DISPLAY_HEIGHT ? DISPLAY_HEIGHT - 1 : y1);
-        y2 = (y2 < 0) ? 0 : (y2 >= DISPLAY_HEIGHT ? DISPLAY_HEIGHT - 1 : y2);
-        
-        Paint_DrawLine(i-1, y1, i, y2, BLUE, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-        
-        // 使用滤波后的数据进行心率计算
-        calculate_heart_rate(display_samples[i]);
+}
+
+// 调速：每个窗口量两个核的负载和窗口内告警路径 (R 波检测) 与刷新的 p99，需要时换档
+// 窗口首尾相接，换档时等电压稳定的时间算在下一个窗口里
+static EcgCoro gov_loop() {
+    static EcgHistSnapshot detect, render, push;
+    EcgScheduler *const scheds[ECG_GOV_CORES] = {&main_sched, &render_sched};
+    uint32_t idle[ECG_GOV_CORES];
+    for (int i = 0; i < ECG_GOV_CORES; i++) {
+        idle[i] = scheds[i]->idle_clock_us.load(std::memory_order_relaxed);
+    }
+    ecg_hist_snapshot(display_stages[ECG_STAGE_DETECT], detect);
+    ecg_hist_snapshot(display_stages[ECG_STAGE_RENDER], render);
+    ecg_hist_snapshot(display_stages[ECG_STAGE_PUSH], push);
+    uint64_t start = time_us_64();
+    for (;;) {
+        co_await ecg_delay_us(ECG_GOV_WINDOW_US);
+        uint64_t now = time_us_64();
+        EcgGovSample sample;
+        sample.window_us = (uint32_t)(now - start);
+        start = now;
+        for (int i = 0; i < ECG_GOV_CORES; i++) {
+            uint32_t total = scheds[i]->idle_clock_us.load(std::memory_order_relaxed);
+            uint32_t idled = total - idle[i];
+            sample.busy_us[i] = idled < sample.window_us ? sample.window_us - idled : 0;
+            idle[i] = total;
+        }
+        sample.detect_p99_us = ecg_hist_value_since(display_stages[ECG_STAGE_DETECT], detect, 990);
+        sample.frame_p99_us = ecg_hist_value_since(display_stages[ECG_STAGE_RENDER], render, 990) +
+                              ecg_hist_value_since(display_stages[ECG_STAGE_PUSH], push, 990);
+        ecg_hist_snapshot(display_stages[ECG_STAGE_DETECT], detect);
+        ecg_hist_snapshot(display_stages[ECG_STAGE_RENDER], render);
+        ecg_hist_snapshot(display_stages[ECG_STAGE_PUSH], push);
+
+        uint8_t next = ecg_gov_update(governor, sample);
+        if (next != governor.level) {
+            const EcgGovLevel &to = ecg_gov_levels[next];
+            bool faster = next > governor.level;
+            if (faster) {
+                ecg_gov_set_voltage_pico(to);
+                co_await ecg_delay_us(ECG_GOV_VREG_SETTLE_US);
+            }
+            // 没换成时电压可能已经升了，高电压跑低频只是费电，下个窗口再试
+            if (ecg_gov_set_clock_pico(to)) {
+                if (!faster) {
+                    ecg_gov_set_voltage_pico(to);
+                }
+                ecg_gov_set_level(governor, next);
+                DEV_TRACE_COUNTER("sys mhz", (int32_t)(to.sys_khz / 1000));
+            }
+        }
     }
-    
-    // 显示心率
-    char hr_str[32];
-    snprintf(hr_str, sizeof(hr_str), "HR: %.0f BPM", heart_rate);
-    Paint_DrawString_EN(5, 5, hr_str, &Font16, BLACK, GREEN);
-    
-    // 更新显示
-    LCD_1IN14_Display(display_buf);
 }
 
-void capture_and_display() {
-    // Configure DMA
-    dma_channel_config cfg = dma_channel_get_default_config(dma_chan);
-    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
-    channel_config_set_read_increment(&cfg, false);
-    channel_config_set_write_increment(&cfg, true);
-    channel_config_set_dreq(&cfg, DREQ_ADC);
-    
-    // Start new capture
-    adc_fifo_drain();
-    adc_run(false);
-    
-    dma_channel_configure(dma_chan, &cfg,
-        capture_buf,    // dst
-        &adc_hw->fifo,  // src
-        CAPTURE_DEPTH,  // transfer count
-        true           // start immediately
-    );
-    
-    adc_run(true);
-    
-    // Wait for capture to complete
-    dma_channel_wait_for_finish_blocking(dma_chan);
-    
-    // Stop ADC
-    adc_run(false);
-    adc_fifo_drain();
-    
-    // Display the captured data
-    display_ecg_data();
+// 串口命令：r 立即打印核 0 的报告，t 开关事件追踪，h 打印各段延迟直方图，c 清零直方图和调速统计，
+// g 依次把调速固定在最慢、…、最快一档，再恢复按负载调，s 开关采样帧
+static void serial_task(void *) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == 'r') {
+            ecg_signal_raise(report_now);
+        } else if (c == 't') {
+            DEV_Trace_Enable(!DEV_Trace_On);
+        } else if (c == 'h') {
+            ecg_signal_raise(hist_now);
+        } else if (c == 'c') {
+            for (int i = 0; i < ECG_STAGE_COUNT; i++) {
+                ecg_hist_reset(display_stages[i]);
+            }
+            ecg_gov_clear_stats(governor);
+        } else if (c == 'g') {
+            ecg_gov_pin(governor, (int8_t)(governor.pinned + 1));
+        } else if (c == 's') {
+            stream_on = !stream_on;
+        }
+    }
+}
+
+static void usb_rx_callback(void *) {
+    ecg_sched_post(main_sched, EVENT_USB_RX);
 }
 
 int main() {
     stdio_init_all();
     
-    // Initialize ADC, DMA, and Display
+    // Initialize ADC and DMA here, the display on core 1
     init_adc_and_dma();
-    init_display();
+    multicore_launch_core1(render_core);
+    if (!multicore_fifo_pop_blocking()) {
+        printf("Display init failed\n");
+    }
     
     printf("Starting ECG monitoring...\n");
-    
-    // Main loop
-    while(1) {
-        capture_and_display();
-        sleep_ms(100);  // Small delay between captures
+    ecg_sched_init(main_sched, ecg_sched_clock_pico, ecg_sched_idle_pico);
+    ecg_sched_add(main_sched, "serial", serial_task, NULL, EVENT_USB_RX, 0, 0);
+    ecg_coro_attach(main_sched, EVENT_CORO);
+    printf("coroutine switch: %lu cycles\n", (unsigned long)ecg_coro_bench(DEV_Cycle_Count, 1000));
+    ecg_gov_init(governor);
+    if (!report_loop() || !log_loop() || !trace_loop() || !hist_loop() || !gov_loop() || !stream_loop()) {
+        printf("Report coroutine failed\n");
     }
+    stdio_set_chars_available_callback(usb_rx_callback, NULL);
+    start_capture();
+    
+    // Main loop: core 0 only takes DMA interrupts, reports and reads commands
+    DEV_Bus_Perf_Start();
+    UDOUBLE xip_hit, xip_access;
+    DEV_XIP_Perf_Read(&xip_hit, &xip_access);  // 清零，从这里开始计
+    ecg_sched_run(main_sched);
     
     // Cleanup (never reached in infinite loop)
-    free(display_buf);
-    dma_channel_unclaim(dma_chan);
+    for (int i = 0; i < 2; i++) {
+        dma_channel_abort(dma_chan[i]);
+        dma_channel_unclaim(dma_chan[i]);
+    }
     DEV_Module_Exit();
     
     return 0;
-}
\ No newline at end of file
+}
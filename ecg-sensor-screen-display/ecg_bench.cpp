@@ -0,0 +1,89 @@
+// ecg_bench.cpp
+// 微基准的运行和输出，与内核和平台无关
+
+#include "ecg_bench.hpp"
+
+#include <string.h>
+extern "C" {
+#include "DEV_Config.h"
+}
+
+// 两次连续读计数器之间的最小差，从每次测量里减掉
+static uint32_t bench_overhead(const EcgBenchEnv &env) {
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 16; i++) {
+        uint32_t saved = env.quiet_begin();
+        uint32_t t0 = env.counter();
+        uint32_t t1 = env.counter();
+        env.quiet_end(saved);
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+        }
+    }
+    return best;
+}
+
+static uint32_t bench_once(const EcgBenchEnv &env, const EcgBenchKernel &kernel) {
+    if (kernel.setup != NULL) {
+        kernel.setup();
+    }
+    uint32_t saved = kernel.needs_irq ? 0 : env.quiet_begin();
+    uint32_t t0 = env.counter();
+    kernel.run();
+    uint32_t t1 = env.counter();
+    if (!kernel.needs_irq) {
+        env.quiet_end(saved);
+    }
+    return t1 - t0;
+}
+
+void ecg_bench_run(const EcgBenchEnv &env, const EcgBenchKernel &kernel, uint32_t runs, EcgBenchResult &result) {
+    uint32_t samples[ECG_BENCH_MAX_RUNS];
+    runs = runs < 1 ? 1 : (runs > ECG_BENCH_MAX_RUNS ? ECG_BENCH_MAX_RUNS : runs);
+    uint32_t overhead = bench_overhead(env);
+
+    bench_once(env, kernel);    // 预热：代码和数据进缓存，延迟初始化做完
+    for (uint32_t i = 0; i < runs; i++) {
+        uint32_t t = bench_once(env, kernel);
+        t = t > overhead ? t - overhead : 0;
+        // 插入排序，runs 很小
+        uint32_t j = i;
+        for (; j > 0 && samples[j - 1] > t; j--) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = t;
+    }
+    result.runs = runs;
+    result.min = samples[0];
+    result.median = samples[runs / 2];
+    result.max = samples[runs - 1];
+}
+
+void ecg_bench_print_meta(FILE *out, const char *counter, uint32_t hz, uint32_t runs) {
+    fprintf(out, "bench-meta counter=%s hz=%lu runs=%lu ram_code=%d memory_plan=%d\n",
+            counter, (unsigned long)hz, (unsigned long)runs, DEV_RAM_CODE, DEV_MEMORY_PLAN);
+}
+
+void ecg_bench_print(FILE *out, const EcgBenchKernel &kernel, const EcgBenchResult &result) {
+    // 每单位的计数保留两位小数，用整数算，固件和主机输出一致
+    uint64_t per_unit = (uint64_t)result.median * 100 / kernel.items;
+    fprintf(out, "bench,%s,%s,%lu,%lu,%lu,%lu,%lu.%02lu\n", kernel.name, kernel.unit,
+            (unsigned long)kernel.items, (unsigned long)result.min, (unsigned long)result.median,
+            (unsigned long)result.max, (unsigned long)(per_unit / 100), (unsigned long)(per_unit % 100));
+}
+
+int ecg_bench_all(FILE *out, const EcgBenchEnv &env, uint32_t runs, const char *filter) {
+    int ran = 0;
+    for (int i = 0; i < ecg_bench_kernel_count; i++) {
+        const EcgBenchKernel &kernel = ecg_bench_kernels[i];
+        if (filter != NULL && strstr(kernel.name, filter) == NULL) {
+            continue;
+        }
+        EcgBenchResult result;
+        ecg_bench_run(env, kernel, runs, result);
+        ecg_bench_print(out, kernel, result);
+        fflush(out);
+        ran++;
+    }
+    return ran;
+}
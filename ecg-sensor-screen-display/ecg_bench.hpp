@@ -0,0 +1,51 @@
+// ecg_bench.hpp
+// 微基准：登记好的内核 (滤波、抽取、QRS 检测、写像素、画线/竖线段/文字、SPI 推送) 逐个运行 runs 次，
+// 每次之前 setup 放好输入 (不计时)，计时时关中断 (需要中断的内核除外)，先空跑一次预热缓存；
+// 减去读计数器本身的开销后报告最小、中位、最大计数和每个单位 (采样、像素、字节) 的计数
+// 计数器在固件上是 DWT 周期 (DEV_Cycle_Count)，在主机上是纳秒
+// 输出是 CSV 行，和其他文本混在 USB 上也能挑出来，lib/Config/bench_compare.py 对比两次结果：
+//   bench-meta counter=cycles hz=150000000 runs=31 ram_code=1 memory_plan=1
+//   bench,<kernel>,<unit>,<items>,<min>,<median>,<max>,<per unit>
+// 固件 (ecg-bench) 和主机 (ecg_bench_host) 共用
+#ifndef ECG_BENCH_HPP
+#define ECG_BENCH_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ECG_BENCH_MAX_RUNS  64
+
+struct EcgBenchKernel {
+    const char *name;
+    const char *unit;           // "sample"、"pixel" 或 "byte"
+    uint32_t items;             // 一次运行处理的单位数
+    void (*setup)();            // 每次运行前，不计时；可以为 NULL
+    void (*run)();
+    bool needs_irq;             // 运行时要开中断 (等 DMA 中断)
+};
+
+struct EcgBenchResult {
+    uint32_t runs;
+    uint32_t min, median, max;  // 已减去读计数器的开销
+};
+
+// 运行环境：计数器，以及计时期间关中断和恢复
+struct EcgBenchEnv {
+    uint32_t (*counter)();
+    uint32_t (*quiet_begin)();
+    void (*quiet_end)(uint32_t saved);
+};
+
+extern const EcgBenchKernel ecg_bench_kernels[];
+extern const int ecg_bench_kernel_count;
+
+void ecg_bench_run(const EcgBenchEnv &env, const EcgBenchKernel &kernel, uint32_t runs, EcgBenchResult &result);
+
+// 打印 bench-meta 行；counter 是计数单位 ("cycles" 或 "ns")，hz 是 CPU 时钟，主机上为 0
+void ecg_bench_print_meta(FILE *out, const char *counter, uint32_t hz, uint32_t runs);
+void ecg_bench_print(FILE *out, const EcgBenchKernel &kernel, const EcgBenchResult &result);
+
+// 名字包含 filter 的内核逐个运行并打印 (filter 为 NULL 时全部)，返回运行的个数
+int ecg_bench_all(FILE *out, const EcgBenchEnv &env, uint32_t runs, const char *filter);
+
+#endif // ECG_BENCH_HPP
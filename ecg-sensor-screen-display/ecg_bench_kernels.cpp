@@ -0,0 +1,142 @@
+// ecg_bench_kernels.cpp
+// 登记的微基准内核：显示流水线每一段各一个，输入固定，每次运行的工作量相同
+// 加一个内核就是在 ecg_bench_kernels 表里加一行；items 要与 run 实际处理的量一致
+
+#include "ecg_bench.hpp"
+#include "ecg_display.hpp"
+
+#define BENCH_SAMPLES   1000        // 一秒的采样
+#define BENCH_WIDTH     240         // 图像与 1.14 寸面板相同
+#define BENCH_HEIGHT    135
+#define BENCH_LINES     15          // 从左上角到右边缘的线，每条 BENCH_WIDTH 个像素
+#define BENCH_SPAN_ROWS 16          // 每列竖线段的长度
+#define BENCH_TEXT      "HR: 72 BPM"
+#define BENCH_SPI_BYTES 4096
+
+static uint16_t bench_adc[BENCH_SAMPLES];
+static float bench_volts[BENCH_SAMPLES];
+static int16_t bench_mv[BENCH_SAMPLES];
+static volatile float bench_sink;   // 让编译器保留结果
+static BandpassFilter bench_filter DEV_RAM_DSP;
+static EcgHistory bench_history DEV_RAM_FRAME;
+static UBYTE bench_image[BENCH_WIDTH * BENCH_HEIGHT * 2] DEV_RAM_FRAME;
+static UWORD bench_top[BENCH_WIDTH], bench_bottom[BENCH_WIDTH];
+static PAINT_TRACE bench_trace;
+static uint8_t bench_spi[BENCH_SPI_BYTES];
+static uint32_t bench_ms;           // QRS 检测的时间跨次运行递增
+
+// 合成的心电：基线 1.4 V，每 800 个采样一个 R 波 (20 个采样的三角形)，叠加一点锯齿噪声
+static void bench_make_input() {
+    static bool made;
+    if (made) {
+        return;
+    }
+    BandpassFilter filter;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        int phase = i % 800;
+        int peak = phase < 10 ? phase * 150 : (phase < 20 ? (20 - phase) * 150 : 0);
+        bench_adc[i] = (uint16_t)(1740 + peak + (i * 37) % 23);
+        bench_volts[i] = filter.process(bench_adc[i] * ADC_CONVERSION_FACTOR);
+        bench_mv[i] = (int16_t)(bench_volts[i] * 1000.0f);
+    }
+    for (int i = 0; i < BENCH_WIDTH; i++) {
+        bench_top[i] = (UWORD)(10 + (i * 7) % 100);
+        bench_bottom[i] = bench_top[i] + BENCH_SPAN_ROWS - 1;
+    }
+    for (int i = 0; i < BENCH_SPI_BYTES; i++) {
+        bench_spi[i] = (uint8_t)i;
+    }
+    made = true;
+}
+
+static void setup_filter() {
+    bench_make_input();
+    bench_filter.reset();
+}
+
+static void run_filter() {
+    float last = 0.0f;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        last = bench_filter.process(bench_adc[i] * ADC_CONVERSION_FACTOR);
+    }
+    bench_sink = last;
+}
+
+static void setup_decimate() {
+    bench_make_input();
+    ecg_history_reset(bench_history);
+}
+
+static void run_decimate() {
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        ecg_history_push(bench_history, bench_mv[i]);
+    }
+}
+
+static void run_qrs() {
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        calculate_heart_rate(bench_volts[i], bench_ms++);
+    }
+    bench_sink = heart_rate;
+}
+
+static void setup_paint() {
+    bench_make_input();
+    Paint_NewImage(bench_image, BENCH_WIDTH, BENCH_HEIGHT, ROTATE_0, WHITE);
+    Paint_SetScale(65);
+    Paint_SetRotate(ROTATE_0);
+}
+
+static void run_pixel() {
+    for (UWORD y = 0; y < BENCH_HEIGHT; y++) {
+        for (UWORD x = 0; x < BENCH_WIDTH; x++) {
+            Paint_SetPixel(x, y, (UWORD)(x ^ y));
+        }
+    }
+}
+
+static void run_line() {
+    for (int i = 0; i < BENCH_LINES; i++) {
+        Paint_DrawLine(0, 0, BENCH_WIDTH - 1, (UWORD)(i * (BENCH_HEIGHT - 1) / (BENCH_LINES - 1)),
+                       GREEN, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+    }
+}
+
+static void setup_span() {
+    setup_paint();
+    Paint_TraceInit(&bench_trace, 0, BENCH_WIDTH, 0, BENCH_HEIGHT - 1, GREEN);
+    Paint_TraceSetData(&bench_trace, bench_top, bench_bottom);
+    bench_trace.Connect = 0;
+}
+
+static void run_span() {
+    Paint_DrawTraces(&bench_trace, 1);
+}
+
+static void run_text() {
+    Paint_DrawString_EN(0, 0, BENCH_TEXT, &Font24, BLACK, WHITE);
+}
+
+static void run_spi() {
+    DEV_SPI_Write_nByte(bench_spi, BENCH_SPI_BYTES);
+}
+
+static void run_spi_dma() {
+    DEV_SPI_Write_nByte_DMA(bench_spi, BENCH_SPI_BYTES);
+    DEV_SPI_DMA_Wait();
+}
+
+const EcgBenchKernel ecg_bench_kernels[] = {
+    {"bandpass", "sample", BENCH_SAMPLES, setup_filter, run_filter, false},
+    {"decimate", "sample", BENCH_SAMPLES, setup_decimate, run_decimate, false},
+    {"qrs", "sample", BENCH_SAMPLES, bench_make_input, run_qrs, false},
+    {"pixel", "pixel", BENCH_WIDTH * BENCH_HEIGHT, setup_paint, run_pixel, false},
+    {"line", "pixel", BENCH_LINES * BENCH_WIDTH, setup_paint, run_line, false},
+    // 竖线段不连接相邻列，每列正好 BENCH_SPAN_ROWS 个像素
+    {"span", "pixel", BENCH_WIDTH * BENCH_SPAN_ROWS, setup_span, run_span, false},
+    {"text", "pixel", (uint32_t)(sizeof(BENCH_TEXT) - 1) * Font24.Width * Font24.Height, setup_paint, run_text, false},
+    {"spi push", "byte", BENCH_SPI_BYTES, bench_make_input, run_spi, false},
+    // 等 DMA 完成中断，计时期间开着中断
+    {"spi dma", "byte", BENCH_SPI_BYTES, bench_make_input, run_spi_dma, true},
+};
+const int ecg_bench_kernel_count = sizeof(ecg_bench_kernels) / sizeof(ecg_bench_kernels[0]);
@@ -0,0 +1,49 @@
+/**
+ * ECG micro-benchmark firmware (ecg-bench)
+ * Runs the kernels registered in ecg_bench_kernels.cpp and prints their
+ * cycle counts over USB, one CSV line per kernel (see ecg_bench.hpp).
+ * Conditions are kept the same from run to run: core 1 stays in reset,
+ * nothing else is scheduled, the clock is the SDK default, and each timed
+ * run has interrupts off unless the kernel waits for one. Output waits
+ * for the host to open the port, and b runs everything again:
+ *
+ *   cat /dev/ttyACM0 > after.txt    # send b to repeat
+ *   python3 lib/Config/bench_compare.py before.txt after.txt
+ */
+
+#include <pico/stdlib.h>
+#include <hardware/clocks.h>
+#include <hardware/sync.h>
+#include <stdio.h>
+#include "ecg_bench.hpp"
+extern "C" {
+#include "DEV_Config.h"
+}
+
+#define BENCH_RUNS  31
+
+static uint32_t bench_quiet_begin() {
+    return save_and_disable_interrupts();
+}
+
+static void bench_quiet_end(uint32_t saved) {
+    restore_interrupts(saved);
+}
+
+int main() {
+    stdio_init_all();
+    while (!stdio_usb_connected()) {
+        sleep_ms(100);
+    }
+    // SPI 和 DMA 中断，与显示固件的配置相同
+    DEV_Module_Init();
+
+    EcgBenchEnv env = {DEV_Cycle_Count, bench_quiet_begin, bench_quiet_end};
+    for (;;) {
+        ecg_bench_print_meta(stdout, "cycles", clock_get_hz(clk_sys), BENCH_RUNS);
+        ecg_bench_all(stdout, env, BENCH_RUNS, NULL);
+        printf("bench done, b to run again\n");
+        while (getchar() != 'b') {
+        }
+    }
+}
@@ -0,0 +1,89 @@
+// ecg_block_pool.cpp
+// 采样块池：位图分配、引用计数归还、载荷 CRC
+
+#include "ecg_block_pool.hpp"
+
+extern "C" {
+#include "DEV_Config.h"
+}
+
+void ecg_block_pool_init(EcgBlockPool &pool, EcgSampleBlock *blocks, uint8_t count,
+                         uint16_t *storage, uint16_t capacity) {
+    if (count > ECG_BLOCK_POOL_MAX) {
+        count = ECG_BLOCK_POOL_MAX;
+    }
+    pool.blocks = blocks;
+    pool.count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        EcgSampleBlock &block = blocks[i];
+        block.samples = storage + (uint32_t)i * capacity;
+        block.capacity = capacity;
+        block.refs.store(0, std::memory_order_relaxed);
+        block.index = i;
+        block.pool = &pool;
+    }
+    pool.free_mask.store(count == 32 ? 0xFFFFFFFFu : (1u << count) - 1, std::memory_order_release);
+    pool.exhausted.store(0, std::memory_order_relaxed);
+    pool.low_water.store(count, std::memory_order_relaxed);
+}
+
+EcgSampleBlock *DEV_RAM_FUNC(ecg_block_alloc)(EcgBlockPool &pool) {
+    uint32_t mask = pool.free_mask.load(std::memory_order_relaxed);
+    uint32_t taken;
+    do {
+        if (mask == 0) {
+            pool.exhausted.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        taken = mask & (0u - mask);     // 最低的空闲位
+    } while (!pool.free_mask.compare_exchange_weak(mask, mask & ~taken, std::memory_order_acquire,
+                                                   std::memory_order_relaxed));
+
+    // 统计用，两个核同时分配时偶尔少记一次最低值无妨
+    uint32_t left = (uint32_t)__builtin_popcount(mask & ~taken);
+    if (left < pool.low_water.load(std::memory_order_relaxed)) {
+        pool.low_water.store(left, std::memory_order_relaxed);
+    }
+
+    EcgSampleBlock *block = &pool.blocks[__builtin_ctz(taken)];
+    block->sets = 0;
+    block->seq = 0;
+    block->oldest_us = 0;
+    block->channel_mask = 0;
+    block->flags = 0;
+    block->crc = 0;
+    block->refs.store(1, std::memory_order_relaxed);
+    return block;
+}
+
+// 最后一个引用：消费者对载荷的读取都在归还之前完成，下一个生产者看到空闲位时才能写
+void DEV_RAM_FUNC(ecg_block_release)(EcgSampleBlock *block) {
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block->pool->free_mask.fetch_or(1u << block->index, std::memory_order_release);
+    }
+}
+
+uint32_t ecg_block_pool_free(const EcgBlockPool &pool) {
+    return (uint32_t)__builtin_popcount(pool.free_mask.load(std::memory_order_relaxed));
+}
+
+// CRC-32 (IEEE, 反射)，按半字节查表，表只有 64 字节；采样按小端字节计算
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t DEV_RAM_FUNC(ecg_crc32_update)(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    }
+    return crc;
+}
+
+// 两个平台都是小端，内存里的字节就是采样的小端字节
+uint32_t DEV_RAM_FUNC(ecg_block_crc)(const EcgSampleBlock *block) {
+    return ~ecg_crc32_update(0xFFFFFFFFu, block->samples, ecg_block_samples(block) * sizeof(uint16_t));
+}
@@ -0,0 +1,75 @@
+// ecg_block_pool.hpp
+// 固定容量的采样块池，块带侵入式引用计数
+// 一块采样可以同时交给几个消费者 (显示、记录、USB、检测)，不拷贝；最后一个引用放掉时块回到池里
+// 空闲块记在一个位图里，分配是一次 CAS、归还是一次原子或，中断里和两个核上都可以调用，不用 malloc
+// 载荷缓冲由调用者提供 (固件上在 DEV_RAM_DMA)，块本身只放元数据
+// 固件和主机测试共用
+#ifndef ECG_BLOCK_POOL_HPP
+#define ECG_BLOCK_POOL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define ECG_BLOCK_POOL_MAX   32         // 位图一个字
+
+#define ECG_BLOCK_AFTER_GAP  (1u << 0)  // 这块之前有块因为池用完被丢掉
+
+struct EcgBlockPool;
+
+// 一块采样：sets 组，每组按导联交错，导联就是 channel_mask 里置位的 ADC 输入
+struct EcgSampleBlock {
+    uint16_t *samples;              // 载荷，建池时指定，之后不变
+    uint16_t capacity;              // 载荷能放的采样数
+    uint16_t sets;
+    uint32_t seq;                   // 生产者的块序号，跳号说明丢了块
+    uint64_t oldest_us;             // 最早一组的采样时刻
+    uint16_t channel_mask;          // 每个 ADC 输入一位
+    uint16_t flags;                 // ECG_BLOCK_*
+    uint32_t crc;                   // 有效采样的 CRC-32，ecg_block_seal 写入
+
+    std::atomic<uint16_t> refs;
+    uint8_t index;                  // 在池里的位置
+    EcgBlockPool *pool;
+};
+
+struct EcgBlockPool {
+    EcgSampleBlock *blocks;
+    uint8_t count;
+    std::atomic<uint32_t> free_mask;    // 置位的是空闲块
+    std::atomic<uint32_t> exhausted;    // 池空、分配失败的次数
+    std::atomic<uint32_t> low_water;    // 建池以来最少的空闲块数
+};
+
+// 用 count 个块和 count * capacity 个采样的载荷建池，count 不超过 ECG_BLOCK_POOL_MAX
+void ecg_block_pool_init(EcgBlockPool &pool, EcgSampleBlock *blocks, uint8_t count,
+                         uint16_t *storage, uint16_t capacity);
+
+// 取一块，引用计数为 1，元数据清零；池空时返回 nullptr 并计入 exhausted
+EcgSampleBlock *ecg_block_alloc(EcgBlockPool &pool);
+
+// 交给更多消费者之前加引用，每个消费者用完调用一次 ecg_block_release
+inline void ecg_block_ref(EcgSampleBlock *block, uint16_t n = 1) {
+    block->refs.fetch_add(n, std::memory_order_relaxed);
+}
+void ecg_block_release(EcgSampleBlock *block);
+
+uint32_t ecg_block_pool_free(const EcgBlockPool &pool);
+
+// 有效采样数：sets 乘以导联数
+inline uint32_t ecg_block_samples(const EcgSampleBlock *block) {
+    return (uint32_t)block->sets * (uint32_t)__builtin_popcount(block->channel_mask);
+}
+// CRC-32 (IEEE)：从 crc 接着算 len 字节；一段数据的 CRC 是 ~ecg_crc32_update(0xFFFFFFFF, data, len)
+uint32_t ecg_crc32_update(uint32_t crc, const void *data, size_t len);
+
+// 生产者写完采样和元数据后调用；消费者可以用 ecg_block_intact 检查载荷有没有被改写
+uint32_t ecg_block_crc(const EcgSampleBlock *block);
+inline void ecg_block_seal(EcgSampleBlock *block) {
+    block->crc = ecg_block_crc(block);
+}
+inline bool ecg_block_intact(const EcgSampleBlock *block) {
+    return ecg_block_crc(block) == block->crc;
+}
+
+#endif // ECG_BLOCK_POOL_HPP
@@ -0,0 +1,52 @@
+// ecg_block_queue.hpp
+// 单生产者/单消费者的有界无锁队列，用于两个核之间交接采样块
+// 队列里只放块指针或小的描述符，采样本身留在 DMA 写入的缓冲区里，不拷贝
+// 生产者只写 tail，消费者只写 head；写 tail 用 release、读 tail 用 acquire，
+// 所以消费者看到一个描述符时，生产者在发布前写入的缓冲区内容也都可见
+// 只有头文件，固件和主机测试共用
+#ifndef ECG_BLOCK_QUEUE_HPP
+#define ECG_BLOCK_QUEUE_HPP
+
+#include <stdint.h>
+#include <atomic>
+
+// 容量 N 必须是 2 的幂；head/tail 自由递增，差值就是队列长度
+template <typename T, uint32_t N>
+struct EcgBlockQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    T slots[N];
+    std::atomic<uint32_t> head{0};  // 下一个要取的位置，只有消费者写
+    std::atomic<uint32_t> tail{0};  // 下一个要放的位置，只有生产者写
+
+    // 生产者调用；队列满时返回 false
+    bool push(const T &item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        slots[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者调用；队列空时返回 false
+    bool pop(T &item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h) {
+            return false;
+        }
+        item = slots[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 两端都可以调用，结果只是某一时刻的近似值
+    uint32_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+};
+
+#endif // ECG_BLOCK_QUEUE_HPP
@@ -0,0 +1,189 @@
+// ecg_coro.cpp
+// 协程运行时：帧池、调度器任务、不依赖硬件的等待；DMA、USB 和周期计数器在 ecg_coro_pico.cpp
+
+#include "ecg_coro.hpp"
+
+#include <stdio.h>
+
+// 帧池：按槽分配，used 只在运行时所在的核上改
+alignas(8) static unsigned char coro_frames[ECG_CORO_MAX][ECG_CORO_FRAME_BYTES];
+static bool coro_used[ECG_CORO_MAX];
+static EcgCoro::promise_type *coro_live[ECG_CORO_MAX];
+
+static EcgScheduler *coro_sched;
+static uint32_t coro_event;
+static int coro_task = -1;
+
+void *EcgCoro::promise_type::operator new(size_t size) noexcept {
+    if (size > ECG_CORO_FRAME_BYTES) {
+        printf("coro: frame of %u bytes exceeds %u\n", (unsigned)size, (unsigned)ECG_CORO_FRAME_BYTES);
+        return nullptr;
+    }
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        if (!coro_used[i]) {
+            coro_used[i] = true;
+            return coro_frames[i];
+        }
+    }
+    printf("coro: frame pool exhausted\n");
+    return nullptr;
+}
+
+void EcgCoro::promise_type::operator delete(void *frame) noexcept {
+    int i = (int)(((unsigned char *)frame - coro_frames[0]) / ECG_CORO_FRAME_BYTES);
+    coro_used[i] = false;
+}
+
+// 帧分配成功后构造 promise：登记为活着的协程，并叫运行时扫描一次让它开始运行
+EcgCoro::promise_type::promise_type() {
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        if (coro_live[i] == nullptr) {
+            coro_live[i] = this;
+            break;
+        }
+    }
+    if (coro_sched != nullptr) {
+        ecg_sched_post(*coro_sched, coro_event);
+    }
+}
+
+EcgCoro::promise_type::~promise_type() {
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        if (coro_live[i] == this) {
+            coro_live[i] = nullptr;
+            break;
+        }
+    }
+}
+
+int ecg_coro_live() {
+    int live = 0;
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        live += coro_live[i] != nullptr;
+    }
+    return live;
+}
+
+void ecg_signal_raise(EcgSignal &signal) {
+    signal.set.store(true, std::memory_order_release);
+    if (coro_sched != nullptr) {
+        ecg_sched_post(*coro_sched, coro_event);
+    }
+}
+
+// 条件满足就清掉等待状态；信号在这里取走，置位时没人等的信号留给下一次 co_await
+static bool coro_due(EcgCoro::promise_type &p, uint64_t now) {
+    bool signaled = p.signal != nullptr && p.signal->set.exchange(false, std::memory_order_acquire);
+    if (!signaled && p.wake_us > now && (p.poll == nullptr || !p.poll(p.poll_arg))) {
+        return false;
+    }
+    p.signaled = signaled;
+    p.signal = nullptr;
+    p.wake_us = ECG_SCHED_NEVER;
+    p.poll = nullptr;
+    return true;
+}
+
+// 扫描一遍，恢复条件满足的协程；恢复中新建的协程排在空槽里，本次或下次扫描运行
+static void coro_scan(uint64_t now) {
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        EcgCoro::promise_type *p = coro_live[i];
+        if (p != nullptr && coro_due(*p, now)) {
+            EcgCoro::Handle::from_promise(*p).resume();
+        }
+    }
+}
+
+// 调度器任务：事件或定时器触发，扫描后把定时器设到最早的唤醒时刻
+static void coro_run(void *arg) {
+    (void)arg;
+    coro_scan(coro_sched->now());
+
+    uint64_t wake = ECG_SCHED_NEVER;
+    uint64_t now = coro_sched->now();
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        EcgCoro::promise_type *p = coro_live[i];
+        if (p == nullptr) {
+            continue;
+        }
+        uint64_t at = p->wake_us;
+        if (p->poll != nullptr && now + ECG_CORO_POLL_US < at) {
+            at = now + ECG_CORO_POLL_US;
+        }
+        wake = at < wake ? at : wake;
+    }
+    ecg_sched_wake_at(*coro_sched, coro_task, wake);
+}
+
+int ecg_coro_attach(EcgScheduler &sched, uint32_t event) {
+    coro_sched = &sched;
+    coro_event = event;
+    coro_task = ecg_sched_add(sched, "coro", coro_run, nullptr, event, 0, 0);
+    return coro_task;
+}
+
+bool EcgDelay::await_ready() const {
+    return coro_sched->now() >= wake_us;
+}
+
+EcgDelay ecg_delay_us(uint32_t us) {
+    return {coro_sched->now() + us};
+}
+
+static void coro_xfer_done(DEV_XFER *Xfer) {
+    ecg_signal_raise(*(EcgSignal *)Xfer->Arg);
+}
+
+// 先登记等待再提交：完成回调可能在 DEV_Xfer_Submit 返回前就在中断里 (主机上是同步) 运行
+bool EcgXferWait::await_suspend(EcgCoro::Handle h) {
+    xfer.Callback = coro_xfer_done;
+    xfer.Arg = &done;
+    h.promise().signal = &done;
+    if (DEV_Xfer_Submit(&xfer) != 0) {
+        // 提交失败不会有回调，不挂起
+        h.promise().signal = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 切换测量：a 置位 ping 后等 pong，b 等 ping 后置位 pong；每轮两次切换
+static EcgSignal bench_ping, bench_pong;
+
+static EcgCoro bench_a(uint32_t rounds) {
+    for (uint32_t i = 0; i < rounds; i++) {
+        ecg_signal_raise(bench_ping);
+        co_await bench_pong;
+    }
+}
+
+static EcgCoro bench_b(uint32_t rounds) {
+    for (uint32_t i = 0; i < rounds; i++) {
+        co_await bench_ping;
+        ecg_signal_raise(bench_pong);
+    }
+}
+
+uint32_t ecg_coro_bench(uint32_t (*counter)(), uint32_t rounds) {
+    int live = ecg_coro_live();
+    if (rounds == 0) {
+        return 0;
+    }
+    EcgCoro b = bench_b(rounds);
+    if (!b) {
+        return 0;
+    }
+    if (!bench_a(rounds)) {
+        b.handle.destroy();     // 还停在开头，直接销毁
+        return 0;
+    }
+    // 直接扫描，不经过调度器的取事件和挑任务，测的是挂起、扫描、恢复本身
+    uint64_t now = coro_sched->now();
+    uint32_t start = counter();
+    while (ecg_coro_live() > live) {
+        coro_scan(now);
+    }
+    uint32_t elapsed = counter() - start;
+    coro_sched->pending.fetch_and(~coro_event, std::memory_order_relaxed);
+    return elapsed / (rounds * 2);
+}
@@ -0,0 +1,149 @@
+// ecg_coro.hpp
+// C++20 协程：流水线的一个阶段可以写成顺序代码，在等 DMA、SPI、定时或 USB 时挂起
+// 协程帧来自静态池 (ECG_CORO_MAX 个，每个 ECG_CORO_FRAME_BYTES)，不用堆；
+// 帧太大或池用完时协程函数返回空的 EcgCoro，不会运行
+// 运行时挂在一个 EcgScheduler 上，作为其中的一个任务：中断 (或 ecg_signal_raise) 置位事件，
+// 任务扫描所有挂起的协程，条件满足的依次恢复；协程只在这个任务里运行，从不在中断里运行
+// 只能挂在一个核的调度器上
+//
+//   EcgCoro stage() {
+//       for (;;) {
+//           co_await ecg_delay_us(5000);
+//           int status = co_await ecg_xfer(xfer);
+//       }
+//   }
+#ifndef ECG_CORO_HPP
+#define ECG_CORO_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <coroutine>
+#include "ecg_scheduler.hpp"
+extern "C" {
+#include "DEV_Config.h"
+}
+
+#define ECG_CORO_MAX         8      // 同时存在的协程数
+#define ECG_CORO_FRAME_BYTES 512    // 每个协程帧的上限
+#define ECG_CORO_POLL_US     1000   // 轮询条件 (ecg_poll) 的检查间隔
+
+// 二值信号：中断或其他代码置位，co_await 等到置位后清掉；置位时没人等就留到下次
+struct EcgSignal {
+    std::atomic<bool> set{false};
+};
+
+struct EcgCoro {
+    struct promise_type {
+        // 挂起时等待的条件，任意一个满足就恢复
+        EcgSignal *signal = nullptr;
+        uint64_t wake_us = 0;                   // 创建时为 0，第一次扫描就开始运行
+        bool (*poll)(void *arg) = nullptr;
+        void *poll_arg = nullptr;
+        bool signaled = false;                  // 上次恢复是因为信号
+
+        promise_type();
+        ~promise_type();
+        static void *operator new(size_t size) noexcept;
+        static void operator delete(void *frame) noexcept;
+        static EcgCoro get_return_object_on_allocation_failure() noexcept { return EcgCoro(); }
+        EcgCoro get_return_object() noexcept {
+            return EcgCoro(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }  // 结束时帧直接还给池
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    EcgCoro() = default;
+    explicit EcgCoro(Handle h) : handle(h) {}
+    // 协程已创建并排队运行
+    explicit operator bool() const { return (bool)handle; }
+
+    Handle handle;
+};
+
+// 把运行时挂到调度器上，event 是留给协程的事件位；在创建任何协程之前调用
+int ecg_coro_attach(EcgScheduler &sched, uint32_t event);
+// 还活着的协程数
+int ecg_coro_live();
+// 置位信号并唤醒运行时，中断里可以调用
+void ecg_signal_raise(EcgSignal &signal);
+
+// co_await ecg_delay_us(us) / ecg_delay_until(t)
+struct EcgDelay {
+    uint64_t wake_us;
+    bool await_ready() const;
+    void await_suspend(EcgCoro::Handle h) const { h.promise().wake_us = wake_us; }
+    void await_resume() const {}
+};
+EcgDelay ecg_delay_us(uint32_t us);
+inline EcgDelay ecg_delay_until(uint64_t at_us) { return {at_us}; }
+
+// co_await signal，或 co_await ecg_wait(signal, until_us)：信号到来返回 true，超时返回 false
+struct EcgSignalWait {
+    EcgSignal &signal;
+    uint64_t until_us;
+    bool await_ready() const { return signal.set.exchange(false, std::memory_order_acquire); }
+    void await_suspend(EcgCoro::Handle h) const {
+        h.promise().signal = &signal;
+        h.promise().wake_us = until_us;
+    }
+    bool await_resume() const { return true; }
+};
+struct EcgSignalTimed : EcgSignalWait {
+    EcgCoro::promise_type *promise = nullptr;
+    void await_suspend(EcgCoro::Handle h) {
+        promise = &h.promise();
+        EcgSignalWait::await_suspend(h);
+    }
+    bool await_resume() const { return promise == nullptr || promise->signaled; }
+};
+inline EcgSignalWait operator co_await(EcgSignal &signal) { return {signal, ECG_SCHED_NEVER}; }
+inline EcgSignalTimed ecg_wait(EcgSignal &signal, uint64_t until_us) { return {{signal, until_us}}; }
+
+// co_await ecg_poll(fn, arg)：每 ECG_CORO_POLL_US 检查一次 fn(arg)，为 true 时恢复
+// 给没有中断可用的条件，例如 USB 发送缓冲有空
+struct EcgPoll {
+    bool (*fn)(void *arg);
+    void *arg;
+    bool await_ready() const { return fn(arg); }
+    void await_suspend(EcgCoro::Handle h) const {
+        h.promise().poll = fn;
+        h.promise().poll_arg = arg;
+    }
+    void await_resume() const {}
+};
+inline EcgPoll ecg_poll(bool (*fn)(void *arg), void *arg) { return {fn, arg}; }
+
+// co_await ecg_xfer(xfer)：提交 DEV_XFER，传输结束 (完成回调) 时恢复，返回 DEV_XFER_DONE 或 DEV_XFER_ERROR
+// 占用 xfer 的 Callback 和 Arg；只用于单个传输，不用于链
+struct EcgXferWait {
+    DEV_XFER &xfer;
+    EcgSignal done;
+    bool await_ready() const { return false; }
+    bool await_suspend(EcgCoro::Handle h);
+    UBYTE await_resume() const { return xfer.Status; }
+};
+inline EcgXferWait ecg_xfer(DEV_XFER &xfer) { return {xfer, {}}; }
+
+// 以下在 ecg_coro_pico.cpp，只有固件上有
+// co_await ecg_dma_done(chan)：DMA 通道传输结束时恢复，用 DMA_IRQ_1 (与其他处理函数共享)
+struct EcgDmaWait {
+    uint chan;
+    EcgSignal done;
+    bool await_ready() const;
+    bool await_suspend(EcgCoro::Handle h);
+    void await_resume() const {}
+};
+inline EcgDmaWait ecg_dma_done(uint chan) { return {chan, {}}; }
+// co_await ecg_usb_writable(bytes)：USB 串口连着，且发送缓冲能放下 bytes 字节
+EcgPoll ecg_usb_writable(uint32_t bytes);
+
+// 两个协程用信号来回切换 rounds 次，返回每次切换 (一个挂起、另一个恢复) 的平均计数
+// counter 是周期计数器 (固件) 或纳秒 (主机)；在挂上调度器之后、调度器运行之前调用
+uint32_t ecg_coro_bench(uint32_t (*counter)(), uint32_t rounds);
+
+#endif // ECG_CORO_HPP
@@ -0,0 +1,71 @@
+// ecg_coro_pico.cpp
+// 固件上的协程等待：DMA 完成 (DMA_IRQ_1 共享处理函数)、USB 串口可写
+
+#include "ecg_coro.hpp"
+
+#include <pico/stdlib.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
+
+#define CORO_DMA_IRQ DMA_IRQ_1  // DMA_IRQ_0 归 DEV_Config 的传输队列
+
+static EcgSignal *volatile coro_dma_wait[NUM_DMA_CHANNELS];
+static bool coro_dma_installed;
+
+// 只处理有协程在等的通道，其他通道 (采集) 留给共享这个中断的处理函数
+static void coro_dma_irq() {
+    for (uint chan = 0; chan < NUM_DMA_CHANNELS; chan++) {
+        EcgSignal *signal = coro_dma_wait[chan];
+        if (signal == nullptr || !dma_irqn_get_channel_status(1, chan)) {
+            continue;
+        }
+        dma_irqn_acknowledge_channel(1, chan);
+        dma_irqn_set_channel_enabled(1, chan, false);
+        coro_dma_wait[chan] = nullptr;
+        ecg_signal_raise(*signal);
+    }
+}
+
+bool EcgDmaWait::await_ready() const {
+    return !dma_channel_is_busy(chan);
+}
+
+// 先打开通道中断再检查一次：检查之前结束的传输不会再来中断，不挂起
+bool EcgDmaWait::await_suspend(EcgCoro::Handle h) {
+    if (!coro_dma_installed) {
+        irq_add_shared_handler(CORO_DMA_IRQ, coro_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(CORO_DMA_IRQ, true);
+        coro_dma_installed = true;
+    }
+    h.promise().signal = &done;
+    coro_dma_wait[chan] = &done;
+    dma_irqn_acknowledge_channel(1, chan);
+    dma_irqn_set_channel_enabled(1, chan, true);
+    if (dma_channel_is_busy(chan)) {
+        return true;
+    }
+    uint32_t save = save_and_disable_interrupts();
+    dma_irqn_set_channel_enabled(1, chan, false);
+    coro_dma_wait[chan] = nullptr;
+    restore_interrupts(save);
+    h.promise().signal = nullptr;
+    done.set.store(false, std::memory_order_relaxed);
+    return false;
+}
+
+static bool coro_usb_writable(void *arg) {
+#if LIB_PICO_STDIO_USB
+    return tud_cdc_connected() && tud_cdc_write_available() >= (uint32_t)(uintptr_t)arg;
+#else
+    (void)arg;
+    return true;
+#endif
+}
+
+EcgPoll ecg_usb_writable(uint32_t bytes) {
+    return ecg_poll(coro_usb_writable, (void *)(uintptr_t)bytes);
+}
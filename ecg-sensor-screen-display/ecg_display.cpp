@@ -0,0 +1,403 @@
+/**
+ * ECG render path
+ * Filters incoming samples into the history and draws the trace, grid and
+ * heart rate. Shared by the firmware and the host build.
+ *
+ * Up to ECG_MAX_LEADS leads are shown stacked or overlaid, each with its own
+ * filter, history, band, gain and colour; lead 0 drives the heart rate.
+ *
+ * The live view is a sweep: columns stay where they were drawn and a cursor
+ * moves across the trace, so a chunk of new samples only changes the few
+ * columns at the cursor. In layers mode only those columns are composed and
+ * sent, which keeps the time from a sample to the panel short.
+ */
+
+#include "ecg_display.hpp"
+
+#include <pico/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+
+UWORD *display_buf;
+const EcgPanel *display_panel;
+EcgLayout display_layout;
+PAINT_LIST display_list DEV_RAM_FRAME;
+PAINT_COMPOSITOR display_compositor DEV_RAM_FRAME;
+EcgHistory display_history[ECG_MAX_LEADS];
+EcgView display_view;
+static PAINT_CMD display_cmds[ECG_DISPLAY_COMMANDS];
+static EcgRenderMode display_mode;
+uint32_t last_heartbeat_time = 0;
+float heart_rate = 0.0f;
+EcgLatency display_latency;
+EcgHistogram display_stages[ECG_STAGE_COUNT];
+static const char *const stage_names[ECG_STAGE_COUNT] = {"capture", "filter", "detect", "render", "push", "usb"};
+
+// 帧缓冲和图层画布共用一块静态内存，按最大面板分配，放在 SRAM4-7
+static UBYTE frame_ram[ECG_MAX_COLUMNS * ECG_MAX_ROWS * 2] DEV_RAM_FRAME;
+
+static BandpassFilter filters[ECG_MAX_LEADS] DEV_RAM_DSP;  // 每个导联一个滤波器实例
+static uint8_t display_leads;
+static UWORD trace_top[ECG_MAX_LEADS][ECG_MAX_COLUMNS], trace_bottom[ECG_MAX_LEADS][ECG_MAX_COLUMNS];
+
+// 扫描状态：下一次从绝对列 sweep_next 开始重画，它可能还没凑满
+static bool sweep_valid;
+static int8_t sweep_zoom;
+static int64_t sweep_next;
+// 上次渲染改动的列：从 changed_first 起 changed_count 列，可能绕过右边界
+static int changed_first, changed_count;
+
+static void render_sweep(bool full);
+
+// 尚未显示的采样中最早一个的到达时间
+static bool pending;
+static uint64_t pending_since_us;
+
+// 图层模式：每层一个 2 位 (scale 4) 画布，索引 0 在上层透明
+// 虚线间隙画成索引 0，与整帧模式的 BLACK 间隙一致的前提是背景为 BLACK
+enum { ECG_LAYER_GRID, ECG_LAYER_TRACE, ECG_LAYER_HUD, ECG_LAYER_COUNT };
+static PAINT layer_surfaces[ECG_LAYER_COUNT];
+static PAINT_LAYER display_layers[ECG_LAYER_COUNT];
+static char hud_text[32];
+static PAINT_TRACE display_traces[ECG_MAX_LEADS];
+static UWORD trace_prev[ECG_MAX_LEADS][2 * ECG_MAX_COLUMNS];
+static const UWORD grid_palette[4] = {ECG_COLOR_BACKGROUND, ECG_COLOR_GRID, ECG_COLOR_BACKGROUND, ECG_COLOR_BACKGROUND};
+static UWORD trace_palette[4] = {ECG_COLOR_BACKGROUND, ECG_COLOR_BACKGROUND, ECG_COLOR_BACKGROUND, ECG_COLOR_BACKGROUND};
+static const UWORD hud_palette[4] = {ECG_COLOR_BACKGROUND, ECG_COLOR_BACKGROUND, ECG_COLOR_TEXT, ECG_COLOR_BACKGROUND};
+
+static const EcgLeadSetup single_lead = ECG_LEADS_DEFAULT;
+
+// 各导联的波形数据
+static void set_trace_data() {
+    for (uint8_t i = 0; i < display_leads; i++) {
+        Paint_TraceSetData(&display_traces[i], trace_top[i], trace_bottom[i]);
+    }
+}
+
+static void draw_grid(PAINT *surface, UWORD color) {
+    const EcgLayout &layout = display_layout;
+    const EcgRect &trace = layout.trace;
+    UWORD right = trace.x + trace.w - 1;
+    UWORD bottom = trace.y + trace.h - 1;
+    for (UWORD x = trace.x; x <= right; x += layout.grid_pitch) {
+        Surface_DrawLine(surface, x, trace.y, x, bottom, color, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    }
+    for (UWORD y = trace.y; y <= bottom; y += layout.grid_pitch) {
+        Surface_DrawLine(surface, trace.x, y, right, y, color, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    }
+}
+
+static void flush_layers() {
+    if (display_panel->display_rect != NULL) {
+        Paint_CompositorFlushRect(&display_compositor, display_panel->display_rect);
+    } else {
+        Paint_CompositorFlush(&display_compositor, display_panel->display_band);
+    }
+}
+
+static bool init_layers(UWORD width, UWORD height) {
+    static const UWORD *palettes[ECG_LAYER_COUNT] = {grid_palette, trace_palette, hud_palette};
+    UDOUBLE size = (UDOUBLE)((width + 3) / 4) * height;
+    for (int i = 0; i < ECG_LAYER_COUNT; i++) {
+        PAINT *surface = &layer_surfaces[i];
+        Surface_NewImage(surface, frame_ram + size * i, width, height, 0, 0);
+        Surface_SetScale(surface, 4);
+        Surface_SetRotate(surface, ROTATE_0);
+        Surface_Clear(surface, 0);
+        display_layers[i].Surface = surface;
+        display_layers[i].Palette = palettes[i];
+        display_layers[i].Key = 0;
+        display_layers[i].Visible = 1;
+    }
+    if (Paint_CompositorInit(&display_compositor, display_layers, ECG_LAYER_COUNT, width, height) != 0) {
+        printf("Layers not supported\n");
+        return false;
+    }
+    // 网格只画一次，之后不再产生脏行
+    draw_grid(&layer_surfaces[ECG_LAYER_GRID], 1);
+    // 波形层的索引 1..3 依次是各导联的颜色
+    for (uint8_t i = 0; i < display_leads; i++) {
+        trace_palette[i + 1] = display_traces[i].Color;
+        display_traces[i].Color = i + 1;
+        Paint_TraceSetErase(&display_traces[i], trace_prev[i], 0);
+    }
+    hud_text[0] = '\0';
+    // 网格和空的波形在采样到达之前发送，之后每次只发送光标附近的几列
+    render_sweep(true);
+    set_trace_data();
+    Surface_DrawTraces(&layer_surfaces[ECG_LAYER_TRACE], display_traces, display_leads);
+    flush_layers();
+    return true;
+}
+
+bool init_display(const EcgPanel *panel, bool rgb444, EcgRenderMode mode, const EcgLeadSetup *leads) {
+    if(DEV_Module_Init() != 0) {
+        printf("Display init failed!\n");
+        return false;
+    }
+
+    DEV_SET_PWM(50);  // Set backlight
+    display_panel = panel;
+    panel->init(HORIZONTAL);
+    if (panel->set_rgb444 != NULL) {
+        panel->set_rgb444(rgb444);
+    }
+    panel->clear(ECG_COLOR_BACKGROUND);
+
+    UWORD width = *panel->width;
+    UWORD height = *panel->height;
+    if ((UDOUBLE)width * height * 2 > sizeof(frame_ram)) {
+        printf("Panel %ux%u exceeds the frame buffer\n", width, height);
+        return false;
+    }
+    if (leads == NULL) {
+        leads = &single_lead;
+    }
+    ecg_layout_init(display_layout, width, height, CAPTURE_DEPTH, leads->count, leads->arrangement, leads->gain);
+    display_leads = display_layout.leads;
+    const EcgRect &trace = display_layout.trace;
+    for (uint8_t i = 0; i < display_leads; i++) {
+        const EcgLeadBand &band = display_layout.lead[i];
+        Paint_TraceInit(&display_traces[i], trace.x, trace.w, band.top, band.bottom, leads->color[i]);
+        ecg_history_reset(display_history[i]);
+        filters[i].reset();
+    }
+    ecg_view_init(display_view, display_layout.column_step_q16, trace.w);
+    ecg_view_keys_init();
+    sweep_valid = false;
+    pending = false;
+    display_latency = {};
+    for (int i = 0; i < ECG_STAGE_COUNT; i++) {
+        ecg_hist_init(display_stages[i], stage_names[i]);
+    }
+
+    // 显示列表和图层模式都按条带发送，不需要整帧缓冲
+    if (panel->display_band == NULL) {
+        mode = ECG_RENDER_FRAMEBUFFER;
+    }
+    display_mode = mode;
+    display_buf = NULL;
+    if (mode == ECG_RENDER_FRAMEBUFFER) {
+        display_buf = (UWORD *)frame_ram;
+    }
+    if (mode == ECG_RENDER_LAYERS) {
+        return init_layers(width, height);
+    }
+
+    // Initialize Paint
+    Paint_NewImage((UBYTE *)display_buf, width, height, 0, WHITE);
+    Paint_SetScale(65);
+    Paint_SetRotate(ROTATE_0);
+    if (mode == ECG_RENDER_LIST) {
+        Paint_ListInit(&display_list, display_cmds, ECG_DISPLAY_COMMANDS, ECG_COLOR_BACKGROUND);
+        if (Paint_SetList(&display_list) != 0) {
+            printf("Display list not supported\n");
+            return false;
+        }
+    }
+    Paint_Clear(ECG_COLOR_BACKGROUND);
+    return true;
+}
+
+bool calculate_heart_rate(float voltage, uint32_t current_time) {
+    static uint32_t r_peak_count = 0;
+    static uint32_t last_peak_time = 0;
+    static const uint32_t MIN_RR_INTERVAL_MS = 200; // Minimum time between peaks (300bpm max)
+
+    // Check for R peak
+    if (voltage > R_PEAK_THRESHOLD &&
+        (current_time - last_peak_time) > MIN_RR_INTERVAL_MS) {
+
+        if (last_peak_time > 0) {
+            // Calculate instantaneous heart rate
+            float rr_interval = (current_time - last_peak_time) / 1000.0f; // Convert to seconds
+            float instant_hr = 60.0f / rr_interval;
+
+            // Update heart rate with moving average
+            heart_rate = heart_rate * 0.7f + instant_hr * 0.3f;
+        }
+
+        last_peak_time = current_time;
+        r_peak_count++;
+        DEV_TRACE_INSTANT("r peak");
+        DEV_TRACE_COUNTER("heart rate", (int32_t)heart_rate);
+        return true;
+    }
+    return false;
+}
+
+void DEV_RAM_FUNC(ecg_display_push)(const uint16_t *samples, int count, uint64_t oldest_us) {
+    if (count <= 0) {
+        return;
+    }
+    DEV_TRACE_BEGIN("filter");
+    uint64_t start_us = time_us_64();
+    if (!pending) {
+        pending = true;
+        pending_since_us = oldest_us;
+    }
+
+    // 带通滤波，结果以 mV 存入历史；心率检测用导联 0，按采样序号计时，与处理时刻无关
+    for (int i = 0; i < count; i++) {
+        uint32_t n = display_history[0].count;
+        for (uint8_t lead = 0; lead < display_leads; lead++) {
+            float voltage = *samples++ * ADC_CONVERSION_FACTOR;
+            float filtered = filters[lead].process(voltage);
+            float mv = filtered * 1000.0f;
+            mv = mv > INT16_MAX ? INT16_MAX : (mv < INT16_MIN ? INT16_MIN : mv);
+            ecg_history_push(display_history[lead], (int16_t)lrintf(mv));
+            if (lead == 0 && calculate_heart_rate(filtered, (uint32_t)((uint64_t)n * 1000u / (uint32_t)SAMPLE_RATE))) {
+                uint64_t arrived_us = oldest_us + (uint64_t)i * (uint64_t)(1000000 / SAMPLE_RATE);
+                ecg_hist_record(display_stages[ECG_STAGE_DETECT], (uint32_t)(time_us_64() - arrived_us));
+            }
+        }
+    }
+    ecg_hist_record(display_stages[ECG_STAGE_FILTER], (uint32_t)(time_us_64() - start_us));
+    DEV_TRACE_END("filter");
+}
+
+// 电压越高行号越小；没有数据的列画在 0 V
+static void set_column(uint8_t lead, int column, const EcgBucket &b) {
+    bool empty = b.min > b.max;
+    trace_top[lead][column] = ecg_layout_row(display_layout, lead, empty ? 0.0f : b.max / 1000.0f);
+    trace_bottom[lead][column] = ecg_layout_row(display_layout, lead, empty ? 0.0f : b.min / 1000.0f);
+}
+
+// 暂停回看：窗口结束于 view.end，整段重画（没有变化的列不会被重绘）
+static void render_window() {
+    static EcgBucket buckets[ECG_MAX_COLUMNS];
+    const int columns = display_layout.trace.w;
+    uint32_t view_end = ecg_view_end(display_view, display_history[0]);
+    for (uint8_t lead = 0; lead < display_leads; lead++) {
+        ecg_history_render(display_history[lead], view_end, ecg_view_step(display_view), columns, buckets);
+        for (int i = 0; i < columns; i++) {
+            set_column(lead, i, buckets[i]);
+        }
+    }
+    changed_first = 0;
+    changed_count = columns;
+    sweep_valid = false;
+}
+
+// 实时扫描：绝对列 k 画在第 k % columns 列，光标前留 ECG_SWEEP_GAP 列空白
+// 只重画上次未凑满的列到最新采样所在的列；full 时重画一整屏
+static void render_sweep(bool full) {
+    static EcgBucket buckets[ECG_MAX_COLUMNS];
+    const int columns = display_layout.trace.w;
+    uint32_t step = ecg_view_step(display_view);
+    uint32_t count = display_history[0].count;
+    int64_t last = count > 0 ? (int64_t)(((uint64_t)(count - 1) << 16) / step) : -1;
+    int64_t first = last + ECG_SWEEP_GAP + 1 - columns;
+    if (!full && sweep_valid && sweep_next > first) {
+        first = sweep_next;
+    }
+    // 空白区后第一列不再与前一列相连，也要重画
+    int64_t changed = last + ECG_SWEEP_GAP + 2 - first;
+    changed_first = changed < columns ? (int)((first % columns + columns) % columns) : 0;
+    changed_count = changed < columns ? (int)changed : columns;
+
+    // 各导联采样数相同，选到的级别也相同
+    int level = 0;
+    for (int64_t k = first; k <= last; ) {
+        int n = last - k + 1 < columns ? (int)(last - k + 1) : columns;
+        for (uint8_t lead = 0; lead < display_leads; lead++) {
+            level = ecg_history_render_at(display_history[lead], k * (int64_t)step, step, n, buckets);
+            for (int i = 0; i < n; i++) {
+                set_column(lead, (int)(((k + i) % columns + columns) % columns), buckets[i]);
+            }
+        }
+        k += n;
+    }
+    for (uint8_t lead = 0; lead < display_leads; lead++) {
+        for (int g = 1; g <= ECG_SWEEP_GAP; g++) {
+            trace_top[lead][(last + g) % columns] = PAINT_TRACE_GAP;
+        }
+    }
+    // 列按所用级别的整桶取值，从还没凑满的桶所在的列起下次重画
+    int64_t settled = (int64_t)((((uint64_t)(count >> level) << level) << 16) / step);
+    sweep_next = settled < last ? settled : last;
+    sweep_zoom = display_view.zoom;
+    sweep_valid = true;
+}
+
+void ecg_display_update() {
+    const EcgLayout &layout = display_layout;
+    const int columns = layout.trace.w;
+    DEV_TRACE_BEGIN("render");
+    uint64_t start_us = time_us_64();
+    uint64_t push_us = 0;   // 其中花在发送上的时间
+
+    bool view_changed = ecg_view_poll_keys(display_view, display_history[0]);
+    if (display_view.live) {
+        render_sweep(view_changed || !sweep_valid || sweep_zoom != display_view.zoom);
+    } else {
+        render_window();
+    }
+
+    char hr_str[32];
+    int len = snprintf(hr_str, sizeof(hr_str), "HR: %.0f BPM", heart_rate);
+    if (display_view.zoom != 0 || !display_view.live) {
+        // 非默认视图时显示窗口长度，回看历史时再显示距现在的秒数
+        float window_s = ((uint64_t)columns * ecg_view_step(display_view) >> 16) / SAMPLE_RATE;
+        len += snprintf(hr_str + len, sizeof(hr_str) - len, " %.1fs", window_s);
+        if (!display_view.live) {
+            snprintf(hr_str + len, sizeof(hr_str) - len, " -%.0fs",
+                     (display_history[0].count - ecg_view_end(display_view, display_history[0])) / SAMPLE_RATE);
+        }
+    }
+
+    // 绘制ECG数据：每列一段竖线，所有导联按列一遍画完；图层模式下原地擦除上一帧的竖线，不清屏
+    set_trace_data();
+    if (display_mode == ECG_RENDER_LAYERS) {
+        PAINT *trace_layer = &layer_surfaces[ECG_LAYER_TRACE];
+        if (strcmp(hr_str, hud_text) != 0) {
+            PAINT *hud = &layer_surfaces[ECG_LAYER_HUD];
+            Surface_Clear(hud, 0);
+            Surface_DrawString_EN(hud, layout.hr_text.x, layout.hr_text.y, hr_str, layout.hr_font, 1, 2);
+            strcpy(hud_text, hr_str);
+        }
+        if (changed_first + changed_count > columns) {
+            // 改动绕过右边界时两侧分别发送，否则脏区会合并成整行宽
+            Surface_DrawTracesRange(trace_layer, display_traces, display_leads, changed_first, columns - changed_first);
+            uint64_t push_start = time_us_64();
+            flush_layers();
+            push_us += time_us_64() - push_start;
+            Surface_DrawTracesRange(trace_layer, display_traces, display_leads, 0, changed_first + changed_count - columns);
+        } else {
+            Surface_DrawTracesRange(trace_layer, display_traces, display_leads, changed_first, changed_count);
+        }
+        uint64_t push_start = time_us_64();
+        flush_layers();
+        push_us += time_us_64() - push_start;
+    } else {
+        // 清除显示缓冲区并绘制网格
+        Paint_Clear(ECG_COLOR_BACKGROUND);
+        draw_grid(&Paint, ECG_COLOR_GRID);
+        Paint_DrawTraces(display_traces, display_leads);
+        Paint_DrawString_EN(layout.hr_text.x, layout.hr_text.y, hr_str, layout.hr_font, ECG_COLOR_BACKGROUND, ECG_COLOR_TEXT);
+        // 显示列表逐条带栅格化再发送，两者都算在发送里
+        uint64_t push_start = time_us_64();
+        if (display_buf != NULL) {
+            display_panel->display(display_buf);
+        } else {
+            Paint_ListFlush(&display_list, display_panel->display_band);
+        }
+        push_us = time_us_64() - push_start;
+    }
+    uint64_t end_us = time_us_64();
+    ecg_hist_record(display_stages[ECG_STAGE_RENDER], (uint32_t)(end_us - start_us - push_us));
+    ecg_hist_record(display_stages[ECG_STAGE_PUSH], (uint32_t)push_us);
+
+    // 传输结束时像素已在面板 GRAM 中，再加上面板扫描到该行的最长等待
+    if (pending) {
+        uint32_t latency = (uint32_t)(time_us_64() - pending_since_us) + ECG_PANEL_REFRESH_US;
+        display_latency.count++;
+        display_latency.last_us = latency;
+        display_latency.max_us = latency > display_latency.max_us ? latency : display_latency.max_us;
+        display_latency.sum_us += latency;
+        pending = false;
+    }
+    DEV_TRACE_END("render");
+}
@@ -0,0 +1,131 @@
+// ecg_display.hpp
+// ECG 波形渲染路径：滤波、历史记录、绘制和心率检测
+// 与采集硬件无关，固件和主机模拟器 (host/) 共用同一份代码
+#ifndef ECG_DISPLAY_HPP
+#define ECG_DISPLAY_HPP
+
+#include <stdint.h>
+#include "lcd_wrapper.hpp"
+#include "ecg_layout.hpp"
+#include "ecg_panel.hpp"
+#include "ecg_history.hpp"
+#include "ecg_view.hpp"
+#include "ecg_histogram.hpp"
+
+#define CAPTURE_DEPTH 2500  // 2.5 seconds of data at 1000Hz
+#define ECG_PANEL_RGB444 1   // 面板支持时使用 12 位传输
+#define ECG_DISPLAY_COMMANDS 1024 // 网格 + 每个导联每列一段波形 + 心率文字
+#define ECG_CHUNK_SAMPLES 10     // 每凑够这么多采样刷新一次，1 kHz 下 10 ms
+#define ECG_SWEEP_GAP 4          // 扫描光标前留空的列数
+
+// 采样到像素可见的延迟：最早的采样到达到传输结束，再加面板从 GRAM 扫描到玻璃的最长等待
+#define ECG_PANEL_REFRESH_US  16667   // ST7789 帧率控制 0x0F，60 Hz
+#define ECG_LATENCY_TARGET_US 50000
+
+// 渲染方式，面板不支持按条带刷新时总是使用整帧缓冲
+enum EcgRenderMode {
+    ECG_RENDER_FRAMEBUFFER,  // 整帧 RGB565 缓冲，每帧全屏发送
+    ECG_RENDER_LIST,         // 显示列表，按条带光栅化，不分配整帧缓冲
+    ECG_RENDER_LAYERS,       // 网格 / 波形 / 心率三个 2 位图层，只合成并发送变化的行
+};
+#define ECG_RENDER_DEFAULT ECG_RENDER_LAYERS
+
+// 界面配色：RGB565 低位重复高位，RGB444 传输时无损
+#define ECG_COLOR_BACKGROUND BLACK
+#define ECG_COLOR_GRID       0x8C51  // 最接近 GRAY (0x8430) 的 RGB444 颜色
+#define ECG_COLOR_TRACE      BLUE
+#define ECG_COLOR_TRACE2     YELLOW
+#define ECG_COLOR_TRACE3     MAGENTA
+#define ECG_COLOR_TEXT       GREEN
+
+#define R_PEAK_THRESHOLD 2.3 // Voltage threshold for R peak detection (adjust as needed)
+
+// Constants from adc_dma_capture.cpp
+constexpr float ADC_VREF = 3.3f;
+constexpr float ADC_CONVERSION_FACTOR = (ADC_VREF / (1 << 12));
+constexpr float SAMPLE_RATE = 1000.0f;
+
+extern UWORD *display_buf;
+extern const EcgPanel *display_panel;
+extern EcgLayout display_layout;
+extern PAINT_LIST display_list;
+extern PAINT_COMPOSITOR display_compositor;
+extern EcgHistory display_history[ECG_MAX_LEADS];
+extern EcgView display_view;
+extern float heart_rate;
+
+struct EcgLatency {
+    uint32_t count;     // 测量次数，每次刷新一次
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+};
+extern EcgLatency display_latency;
+
+// 流水线各段的延迟直方图 (us)，init_display 建好；采集和 USB 两段由固件记录
+enum EcgStage {
+    ECG_STAGE_CAPTURE,      // DMA 写满一块到开始滤波
+    ECG_STAGE_FILTER,       // 滤波一批块，含检测
+    ECG_STAGE_DETECT,       // R 波采样到达到检测出来
+    ECG_STAGE_RENDER,       // 一次刷新，不含发送
+    ECG_STAGE_PUSH,         // 一次刷新中发送到面板
+    ECG_STAGE_USB,          // 数据取出到交给 USB
+    ECG_STAGE_COUNT
+};
+extern EcgHistogram display_stages[ECG_STAGE_COUNT];
+
+// 在全局变量区添加滤波器系数和状态
+struct BandpassFilter {
+    // 二阶IIR滤波器的状态变量
+    float x1 = 0, x2 = 0;  // 输入历史
+    float y1 = 0, y2 = 0;  // 输出历史
+
+    // 滤波器系数 (0.5-35Hz @ 1000Hz采样率)
+    // 使用二阶Butterworth滤波器设计
+    static constexpr float b0 = 0.0675f;
+    static constexpr float b1 = 0.0f;
+    static constexpr float b2 = -0.0675f;
+    static constexpr float a1 = -1.8650f;
+    static constexpr float a2 = 0.8651f;
+
+    float DEV_RAM_FUNC(process)(float input) {
+        // 实现IIR滤波器
+        float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+        // 更新状态
+        x2 = x1;
+        x1 = input;
+        y2 = y1;
+        y1 = output;
+
+        return output;
+    }
+
+    void reset() {
+        x1 = x2 = y1 = y2 = 0.0f;
+    }
+};
+
+// 导联数、排列方式以及每个导联的增益和颜色
+struct EcgLeadSetup {
+    uint8_t count;                      // 1..ECG_MAX_LEADS
+    EcgLeadArrangement arrangement;
+    float gain[ECG_MAX_LEADS];          // 纵向增益，1 为参考幅度
+    UWORD color[ECG_MAX_LEADS];
+};
+#define ECG_LEADS_DEFAULT {1, ECG_LEADS_STACKED, {1.0f, 1.0f, 1.0f}, \
+                           {ECG_COLOR_TRACE, ECG_COLOR_TRACE2, ECG_COLOR_TRACE3}}
+
+// leads 为 NULL 时只有一个导联
+bool init_display(const EcgPanel *panel, bool rgb444 = ECG_PANEL_RGB444,
+                  EcgRenderMode mode = ECG_RENDER_DEFAULT, const EcgLeadSetup *leads = NULL);
+// 检测到 R 波时返回 true
+bool calculate_heart_rate(float voltage, uint32_t current_time);
+
+// 写入刚到达的 count 组采样，每组按导联顺序交错排列；oldest_us 为其中最早一组的到达时间
+// 可以连续调用多次再刷新
+void ecg_display_push(const uint16_t *samples, int count, uint64_t oldest_us);
+// 只重画并发送受新采样影响的列，记录延迟
+void ecg_display_update();
+
+#endif // ECG_DISPLAY_HPP
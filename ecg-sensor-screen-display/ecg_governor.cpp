@@ -0,0 +1,145 @@
+// ecg_governor.cpp
+// 调速策略和能耗统计
+
+#include "ecg_governor.hpp"
+
+#include <string.h>
+
+// 电压取得保守：RP2350 在 150 MHz 的默认是 1.10 V，频率降下来以后每档降 50 mV
+const EcgGovLevel ecg_gov_levels[] = {
+    {48000, 1000},
+    {96000, 1050},
+    {150000, 1100},
+};
+const uint8_t ecg_gov_level_count = sizeof(ecg_gov_levels) / sizeof(ecg_gov_levels[0]);
+
+static_assert(sizeof(ecg_gov_levels) / sizeof(ecg_gov_levels[0]) <= ECG_GOV_MAX_LEVELS, "too many levels");
+
+void ecg_gov_init(EcgGovernor &gov) {
+    memset(&gov, 0, sizeof(gov));
+    gov.level = ecg_gov_level_count - 1;
+    gov.pinned = -1;
+}
+
+// 动态功耗正比于 V²·f；单位是 (mV²/1000)·MHz，乘上毫秒不会溢出
+static uint64_t level_power(const EcgGovLevel &level) {
+    return (uint64_t)level.vreg_mv * level.vreg_mv / 1000 * level.sys_khz / 1000;
+}
+
+static void record_window(EcgGovernor &gov, const EcgGovSample &sample) {
+    EcgGovLevelStats &stats = gov.stats[gov.level];
+    stats.time_us += sample.window_us;
+    stats.windows++;
+    stats.detect_p99_us = sample.detect_p99_us > stats.detect_p99_us ? sample.detect_p99_us : stats.detect_p99_us;
+    stats.frame_p99_us = sample.frame_p99_us > stats.frame_p99_us ? sample.frame_p99_us : stats.frame_p99_us;
+}
+
+uint8_t ecg_gov_update(EcgGovernor &gov, const EcgGovSample &sample) {
+    const uint8_t top = ecg_gov_level_count - 1;
+    record_window(gov, sample);
+
+    uint32_t busiest = 0;
+    for (int i = 0; i < ECG_GOV_CORES; i++) {
+        uint32_t util = sample.window_us ? (uint32_t)((uint64_t)sample.busy_us[i] * 1000 / sample.window_us) : 0;
+        util = util > 1000 ? 1000 : util;
+        gov.util[i] = (uint16_t)util;
+        busiest = util > busiest ? util : busiest;
+    }
+
+    // 告警路径的延迟优先：超过保护线直接到最快一档，负载再低也停留一段时间
+    if (sample.detect_p99_us > ECG_GOV_DETECT_GUARD_US || sample.frame_p99_us > ECG_GOV_FRAME_GUARD_US) {
+        gov.guard_trips++;
+        gov.hold = ECG_GOV_HOLD_WINDOWS;
+        gov.low_windows = 0;
+        return top;
+    }
+    if (gov.hold > 0) {
+        gov.hold--;
+        return top;
+    }
+    if (gov.pinned >= 0) {
+        return (uint8_t)gov.pinned;
+    }
+
+    // 忙的时间按频率反比换算到各档 (等 DMA 的时间也算进去，所以偏保守)，取放得下的最慢一档
+    uint8_t want = top;
+    for (uint8_t i = 0; i < ecg_gov_level_count; i++) {
+        uint64_t projected = (uint64_t)busiest * ecg_gov_levels[gov.level].sys_khz / ecg_gov_levels[i].sys_khz;
+        if (projected <= ECG_GOV_UTIL_HIGH) {
+            want = i;
+            break;
+        }
+    }
+    if (want > gov.level) {
+        gov.low_windows = 0;
+        return want;
+    }
+    if (want < gov.level && ++gov.low_windows >= ECG_GOV_DOWN_WINDOWS) {
+        // 一次只降一档，下一档再量过几个窗口才继续
+        gov.low_windows = 0;
+        return gov.level - 1;
+    }
+    if (want == gov.level) {
+        gov.low_windows = 0;
+    }
+    return gov.level;
+}
+
+void ecg_gov_set_level(EcgGovernor &gov, uint8_t level) {
+    if (level != gov.level && level < ecg_gov_level_count) {
+        gov.level = level;
+        gov.changes++;
+        gov.low_windows = 0;
+    }
+}
+
+void ecg_gov_pin(EcgGovernor &gov, int8_t level) {
+    gov.pinned = level >= 0 && level < ecg_gov_level_count ? level : -1;
+    gov.low_windows = 0;
+}
+
+void ecg_gov_clear_stats(EcgGovernor &gov) {
+    memset(gov.stats, 0, sizeof(gov.stats));
+    gov.changes = 0;
+    gov.guard_trips = 0;
+}
+
+uint32_t ecg_gov_energy_permille(const EcgGovernor &gov) {
+    const uint64_t full = level_power(ecg_gov_levels[ecg_gov_level_count - 1]);
+    uint64_t used = 0, flat = 0;
+    for (uint8_t i = 0; i < ecg_gov_level_count; i++) {
+        uint64_t ms = gov.stats[i].time_us / 1000;
+        used += ms * level_power(ecg_gov_levels[i]);
+        flat += ms * full;
+    }
+    return flat ? (uint32_t)(used * 1000 / flat) : 1000;
+}
+
+bool ecg_gov_report_line(const EcgGovernor &gov, uint32_t *next, char *buf, size_t len) {
+    uint32_t i = *next;
+    if (i > ecg_gov_level_count) {
+        return false;
+    }
+    *next = i + 1;
+    if (i == 0) {
+        const EcgGovLevel &now = ecg_gov_levels[gov.level];
+        const EcgGovLevel &full = ecg_gov_levels[ecg_gov_level_count - 1];
+        // held：延迟保护触发后停在最快一档
+        const char *mode = gov.hold > 0 ? "held" : (gov.pinned >= 0 ? "pinned" : "auto");
+        snprintf(buf, len, "gov: %s at %lu MHz %u mV, util %u%% %u%%, %lu changes, %lu guard trips, energy %lu%% of %lu MHz\n",
+                 mode, (unsigned long)(now.sys_khz / 1000), now.vreg_mv, gov.util[0] / 10, gov.util[1] / 10,
+                 (unsigned long)gov.changes, (unsigned long)gov.guard_trips,
+                 (unsigned long)(ecg_gov_energy_permille(gov) / 10), (unsigned long)(full.sys_khz / 1000));
+        return true;
+    }
+    uint64_t total_us = 0;
+    for (uint8_t l = 0; l < ecg_gov_level_count; l++) {
+        total_us += gov.stats[l].time_us;
+    }
+    const EcgGovLevelStats &stats = gov.stats[i - 1];
+    snprintf(buf, len, "gov-level %lu MHz %u mV time=%lu%% detect_p99=%lu frame_p99=%lu\n",
+             (unsigned long)(ecg_gov_levels[i - 1].sys_khz / 1000), ecg_gov_levels[i - 1].vreg_mv,
+             (unsigned long)(total_us ? stats.time_us * 100 / total_us : 0),
+             (unsigned long)stats.detect_p99_us, (unsigned long)stats.frame_p99_us);
+    return true;
+}
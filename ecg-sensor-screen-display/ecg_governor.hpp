@@ -0,0 +1,85 @@
+// ecg_governor.hpp
+// 按负载调 clk_sys 和内核电压：心电的计算量很小，大部分时间两个核都在 idle 里，没必要一直跑满 150 MHz
+// 每个窗口 (ECG_GOV_WINDOW_US) 量一次两个核不在 idle 的时间，换算到各档的频率，
+// 选预计负载不超过 ECG_GOV_UTIL_HIGH 的最慢一档；升档立即生效，降档要连续 ECG_GOV_DOWN_WINDOWS 个窗口都允许
+// 延迟保护优先于负载：窗口内 R 波检测 (告警依据) 或一次刷新的 p99 超过保护线，直接升到最快一档并保持一段时间
+// 每档累计停留时间和各窗口里最差的 p99，按 V²·f 估计内核动态功耗，报告能耗和延迟的取舍
+// 这里只做决定和统计，与硬件无关，固件和主机测试共用；切换电压和时钟在 ecg_governor_pico.cpp
+#ifndef ECG_GOVERNOR_HPP
+#define ECG_GOVERNOR_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ECG_GOV_CORES           2
+#define ECG_GOV_MAX_LEVELS      4
+#define ECG_GOV_WINDOW_US       250000
+#define ECG_GOV_UTIL_HIGH       700     // 千分比：预计负载超过 70% 的档不用，留余量给突发
+#define ECG_GOV_DOWN_WINDOWS    4       // 降档前要连续满足的窗口数 (1 s)
+#define ECG_GOV_HOLD_WINDOWS    20      // 延迟保护触发后在最快一档至少停留的窗口数 (5 s)
+// 检测延迟里固有一块的时长 (10 ms)，保护线给处理留 5 ms；一次刷新 (绘制加发送) 要在下一块到来前的 80% 内完成
+#define ECG_GOV_DETECT_GUARD_US 15000
+#define ECG_GOV_FRAME_GUARD_US  8000
+
+struct EcgGovLevel {
+    uint32_t sys_khz;
+    uint16_t vreg_mv;
+};
+
+// 从慢到快；最后一档是启动时的默认时钟和电压
+extern const EcgGovLevel ecg_gov_levels[];
+extern const uint8_t ecg_gov_level_count;
+
+// 一个窗口的测量
+struct EcgGovSample {
+    uint32_t window_us;
+    uint32_t busy_us[ECG_GOV_CORES];    // 各核不在 idle 的时间 (idle 里响应的中断算 idle)
+    uint32_t detect_p99_us;             // 窗口内 R 波检测延迟的 p99，没有检测为 0
+    uint32_t frame_p99_us;              // 窗口内一次刷新 (绘制加发送) 的 p99，没有刷新为 0
+};
+
+struct EcgGovLevelStats {
+    uint64_t time_us;
+    uint32_t windows;
+    uint32_t detect_p99_us;             // 在这一档的各窗口里最差的
+    uint32_t frame_p99_us;
+};
+
+struct EcgGovernor {
+    uint8_t level;                      // 当前档，0 最慢
+    int8_t pinned;                      // 固定的档，-1 按负载调
+    uint8_t low_windows;                // 连续允许降档的窗口数
+    uint8_t hold;                       // 延迟保护后还要停在最快一档的窗口数
+    uint32_t changes;
+    uint32_t guard_trips;
+    uint16_t util[ECG_GOV_CORES];       // 上一个窗口各核的负载，千分比
+    EcgGovLevelStats stats[ECG_GOV_MAX_LEVELS];
+};
+
+void ecg_gov_init(EcgGovernor &gov);
+
+// 记一个窗口 (算在当前档)，返回下一档；与当前档不同时，调用者切换成功后调用 ecg_gov_set_level，失败则下个窗口再决定
+uint8_t ecg_gov_update(EcgGovernor &gov, const EcgGovSample &sample);
+void ecg_gov_set_level(EcgGovernor &gov, uint8_t level);
+
+// 固定在某一档 (延迟保护仍然生效)，-1 恢复按负载调
+void ecg_gov_pin(EcgGovernor &gov, int8_t level);
+void ecg_gov_clear_stats(EcgGovernor &gov);
+
+// 统计期间的内核动态能耗，相对于一直停在最快一档，千分比
+uint32_t ecg_gov_energy_permille(const EcgGovernor &gov);
+
+// 报告的第 *next 行写进 buf：先是一行总况 (auto、pinned 或延迟保护后的 held)，再每档一行：
+//   gov: auto at 48 MHz 1000 mV, util 3% 24%, 5 changes, 0 guard trips, energy 27% of 150 MHz
+//   gov-level 48 MHz 1000 mV time=91% detect_p99=10800 frame_p99=2900
+// 返回 false 表示已经写完，buf 里没有内容
+bool ecg_gov_report_line(const EcgGovernor &gov, uint32_t *next, char *buf, size_t len);
+
+// 以下在 ecg_governor_pico.cpp，只有固件上有
+// 换档的顺序：升档先设电压，等 ECG_GOV_VREG_SETTLE_US 再设时钟；降档先设时钟再设电压
+#define ECG_GOV_VREG_SETTLE_US  1000
+void ecg_gov_set_voltage_pico(const EcgGovLevel &level);
+// 时钟做不出来或 I2C 正在传输时返回 false，什么也没改
+bool ecg_gov_set_clock_pico(const EcgGovLevel &level);
+
+#endif // ECG_GOVERNOR_HPP
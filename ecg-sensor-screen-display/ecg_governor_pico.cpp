@@ -0,0 +1,31 @@
+// ecg_governor_pico.cpp
+// 固件上换档：内核电压用片上稳压器，时钟和跟着 clk_sys 走的分频由 DEV_Set_Sys_Clock 一起改
+
+#include "ecg_governor.hpp"
+
+#include <hardware/vreg.h>
+
+extern "C" {
+#include "DEV_Config.h"
+}
+
+static enum vreg_voltage gov_voltage(uint16_t mv) {
+    switch (mv) {
+    case 1000:
+        return VREG_VOLTAGE_1_00;
+    case 1050:
+        return VREG_VOLTAGE_1_05;
+    case 1100:
+        return VREG_VOLTAGE_1_10;
+    default:
+        return VREG_VOLTAGE_DEFAULT;
+    }
+}
+
+void ecg_gov_set_voltage_pico(const EcgGovLevel &level) {
+    vreg_set_voltage(gov_voltage(level.vreg_mv));
+}
+
+bool ecg_gov_set_clock_pico(const EcgGovLevel &level) {
+    return DEV_Set_Sys_Clock(level.sys_khz) == 0;
+}
@@ -0,0 +1,153 @@
+// ecg_histogram.cpp
+// 对数-线性延迟直方图
+
+#include "ecg_histogram.hpp"
+
+#include <stdio.h>
+#include <string.h>
+extern "C" {
+#include "DEV_Config.h"
+}
+
+uint32_t ecg_hist_bucket_low(uint32_t bucket) {
+    const uint32_t sub = 1u << ECG_HIST_SUB_BITS;
+    if (bucket < 2 * sub) {
+        return bucket;
+    }
+    uint32_t shift = (bucket >> ECG_HIST_SUB_BITS) - 1;
+    return (sub + (bucket & (sub - 1))) << shift;
+}
+
+uint32_t ecg_hist_bucket_high(uint32_t bucket) {
+    if (bucket + 1 >= ECG_HIST_BUCKETS) {
+        return ECG_HIST_MAX_VALUE;
+    }
+    return ecg_hist_bucket_low(bucket + 1) - 1;
+}
+
+static void hist_clear(EcgHistogram &hist) {
+    memset(hist.counts, 0, sizeof(hist.counts));
+    hist.total = 0;
+    hist.max = 0;
+    hist.sum = 0;
+}
+
+void ecg_hist_init(EcgHistogram &hist, const char *name) {
+    hist.name = name;
+    hist_clear(hist);
+    hist.reset_pending.store(false, std::memory_order_relaxed);
+}
+
+void DEV_RAM_FUNC(ecg_hist_record)(EcgHistogram &hist, uint32_t value) {
+    if (hist.reset_pending.load(std::memory_order_relaxed)) {
+        hist_clear(hist);
+        hist.reset_pending.store(false, std::memory_order_release);
+    }
+    hist.counts[ecg_hist_bucket(value)]++;
+    hist.total++;
+    hist.sum += value;
+    if (value > hist.max) {
+        hist.max = value;
+    }
+}
+
+void ecg_hist_reset(EcgHistogram &hist) {
+    hist.reset_pending.store(true, std::memory_order_release);
+}
+
+uint32_t ecg_hist_count(const EcgHistogram &hist) {
+    return hist.reset_pending.load(std::memory_order_acquire) ? 0 : hist.total;
+}
+
+uint32_t ecg_hist_value_at(const EcgHistogram &hist, uint32_t permille) {
+    uint32_t total = ecg_hist_count(hist);
+    if (total == 0) {
+        return 0;
+    }
+    // 第 rank 个记录 (从 1 数) 所在的桶；最高的桶用实际最大值，不报告比最大值还大的上界
+    uint64_t rank = ((uint64_t)total * permille + 999) / 1000;
+    rank = rank < 1 ? 1 : rank;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < ECG_HIST_BUCKETS; i++) {
+        seen += hist.counts[i];
+        if (seen >= rank) {
+            uint32_t high = ecg_hist_bucket_high(i);
+            return high < hist.max ? high : hist.max;
+        }
+    }
+    return hist.max;
+}
+
+void ecg_hist_snapshot(const EcgHistogram &hist, EcgHistSnapshot &snap) {
+    if (ecg_hist_count(hist) == 0) {
+        memset(&snap, 0, sizeof(snap));
+        return;
+    }
+    memcpy(snap.counts, hist.counts, sizeof(snap.counts));
+    snap.total = hist.total;
+}
+
+uint32_t ecg_hist_value_since(const EcgHistogram &hist, const EcgHistSnapshot &snap, uint32_t permille) {
+    uint32_t total = ecg_hist_count(hist);
+    // 总数变少说明中间清零过，快照作废
+    bool whole = total < snap.total;
+    uint32_t fresh = whole ? total : total - snap.total;
+    if (fresh == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)fresh * permille + 999) / 1000;
+    rank = rank < 1 ? 1 : rank;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < ECG_HIST_BUCKETS; i++) {
+        uint32_t count = hist.counts[i];
+        // 另一个核正在记录时某个桶可能比快照还旧，当作没有新记录
+        seen += whole ? count : (count > snap.counts[i] ? count - snap.counts[i] : 0);
+        if (seen >= rank) {
+            uint32_t high = ecg_hist_bucket_high(i);
+            return high < hist.max ? high : hist.max;
+        }
+    }
+    return hist.max;
+}
+
+int ecg_hist_summary(const EcgHistogram &hist, char *buf, size_t len) {
+    uint32_t total = ecg_hist_count(hist);
+    return snprintf(buf, len, "hist %s count=%lu mean=%lu p50=%lu p90=%lu p99=%lu p999=%lu max=%lu\n", hist.name,
+                    (unsigned long)total, (unsigned long)(total ? hist.sum / total : 0),
+                    (unsigned long)ecg_hist_value_at(hist, 500), (unsigned long)ecg_hist_value_at(hist, 900),
+                    (unsigned long)ecg_hist_value_at(hist, 990), (unsigned long)ecg_hist_value_at(hist, 999),
+                    (unsigned long)(total ? hist.max : 0));
+}
+
+bool ecg_hist_buckets(const EcgHistogram &hist, uint32_t *next, char *buf, size_t len) {
+    if (ecg_hist_count(hist) == 0) {
+        return false;
+    }
+    uint32_t i = *next;
+    while (i < ECG_HIST_BUCKETS && hist.counts[i] == 0) {
+        i++;
+    }
+    if (i >= ECG_HIST_BUCKETS) {
+        *next = i;
+        return false;
+    }
+    int n = snprintf(buf, len, "hist-buckets %s", hist.name);
+    for (; i < ECG_HIST_BUCKETS; i++) {
+        if (hist.counts[i] == 0) {
+            continue;
+        }
+        char item[24];
+        int m = snprintf(item, sizeof(item), " %lu:%lu", (unsigned long)ecg_hist_bucket_low(i),
+                         (unsigned long)hist.counts[i]);
+        // 留一个字节给换行
+        if (n + m + 2 > (int)len) {
+            break;
+        }
+        memcpy(buf + n, item, m);
+        n += m;
+    }
+    buf[n++] = '\n';
+    buf[n] = '\0';
+    *next = i;
+    return true;
+}
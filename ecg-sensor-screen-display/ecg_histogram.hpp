@@ -0,0 +1,72 @@
+// ecg_histogram.hpp
+// 固定桶的延迟直方图 (HDR 式对数-线性)：每个 2 的幂区间分成 2^ECG_HIST_SUB_BITS 个等宽的桶，
+// 小于 2^ECG_HIST_SUB_BITS 的值每个一桶。桶宽不超过值的 1/16，所以 p99、p99.9 这些分位数的
+// 相对误差不超过 6.25%，而整个 0..16 s 的范围只要 336 个计数
+// 记录是一次 clz 加一次自增，不分配内存，中断里也可以调用
+// 只有记录方所在的核写直方图；清零由任意一方请求，记录方下一次记录时执行
+// 读取方 (报告) 在另一个核上读，可能读到正在更新的一个桶，对统计无影响
+// 固件和主机共用
+#ifndef ECG_HISTOGRAM_HPP
+#define ECG_HISTOGRAM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define ECG_HIST_SUB_BITS   4       // 每个 2 的幂区间 16 个桶
+#define ECG_HIST_MAX_BITS   24      // 超过 2^24-1 us (16.7 s) 的值记在最后一个桶
+#define ECG_HIST_BUCKETS    ((ECG_HIST_MAX_BITS - ECG_HIST_SUB_BITS + 1) << ECG_HIST_SUB_BITS)
+#define ECG_HIST_MAX_VALUE  ((1u << ECG_HIST_MAX_BITS) - 1)
+
+struct EcgHistogram {
+    const char *name;
+    uint32_t counts[ECG_HIST_BUCKETS];
+    uint32_t total;
+    uint32_t max;                   // 截断之前的值
+    uint64_t sum;
+    std::atomic<bool> reset_pending;
+};
+
+// 某一时刻的计数，之后用 ecg_hist_value_since 求这以后新记录的分位数 (按窗口看延迟，不必清零)
+struct EcgHistSnapshot {
+    uint32_t counts[ECG_HIST_BUCKETS];
+    uint32_t total;
+};
+
+// 值所在的桶
+inline uint32_t ecg_hist_bucket(uint32_t value) {
+    const uint32_t sub = 1u << ECG_HIST_SUB_BITS;
+    if (value > ECG_HIST_MAX_VALUE) {
+        value = ECG_HIST_MAX_VALUE;
+    }
+    if (value < sub) {
+        return value;
+    }
+    uint32_t shift = 31 - __builtin_clz(value) - ECG_HIST_SUB_BITS;
+    return ((shift + 1) << ECG_HIST_SUB_BITS) + (value >> shift) - sub;
+}
+
+// 桶里最小和最大的值
+uint32_t ecg_hist_bucket_low(uint32_t bucket);
+uint32_t ecg_hist_bucket_high(uint32_t bucket);
+
+void ecg_hist_init(EcgHistogram &hist, const char *name);
+void ecg_hist_record(EcgHistogram &hist, uint32_t value);
+// 请求清零，任何核都可以调用；清零之前读到的计数都是 0
+void ecg_hist_reset(EcgHistogram &hist);
+
+uint32_t ecg_hist_count(const EcgHistogram &hist);
+// 至少 permille/1000 的记录不超过的值，取所在桶的上界；没有记录时为 0
+uint32_t ecg_hist_value_at(const EcgHistogram &hist, uint32_t permille);
+
+void ecg_hist_snapshot(const EcgHistogram &hist, EcgHistSnapshot &snap);
+// 快照以后的记录里的分位数，取桶的上界；快照以后清零过则按清零以后的全部记录算
+uint32_t ecg_hist_value_since(const EcgHistogram &hist, const EcgHistSnapshot &snap, uint32_t permille);
+
+// 一行摘要：hist <name> count=.. mean=.. p50=.. p90=.. p99=.. p999=.. max=..
+int ecg_hist_summary(const EcgHistogram &hist, char *buf, size_t len);
+// 从第 *next 个桶起，把非空的桶写成一行 hist-buckets <name> <下界>:<计数> ...，写满 len 为止
+// 返回 false 表示已经没有非空的桶，buf 里没有内容
+bool ecg_hist_buckets(const EcgHistogram &hist, uint32_t *next, char *buf, size_t len);
+
+#endif // ECG_HISTOGRAM_HPP
@@ -0,0 +1,104 @@
+/**
+ * ECG history
+ * Ring buffers of min/max buckets, one per decimation level. Level k keeps
+ * the last ECG_HISTORY_BUCKETS buckets of 2^k samples, so coarse levels
+ * reach much further back than the raw samples.
+ */
+
+#include "ecg_history.hpp"
+
+#include <string.h>
+
+#define HISTORY_MASK (ECG_HISTORY_BUCKETS - 1)
+
+static const EcgBucket EMPTY_BUCKET = {INT16_MAX, INT16_MIN};
+
+static inline EcgBucket merge(EcgBucket a, EcgBucket b) {
+    EcgBucket r;
+    r.min = a.min < b.min ? a.min : b.min;
+    r.max = a.max > b.max ? a.max : b.max;
+    return r;
+}
+
+void ecg_history_reset(EcgHistory &history) {
+    memset(&history, 0, sizeof(history));
+}
+
+void ecg_history_push(EcgHistory &history, int16_t value) {
+    uint32_t index = history.count++;
+    history.levels[0][index & HISTORY_MASK] = {value, value};
+
+    // 奇数序号的桶凑满了上一级的一个桶
+    for (int level = 1; level < ECG_HISTORY_LEVELS && (index & 1); level++) {
+        const EcgBucket *lower = history.levels[level - 1];
+        history.levels[level][(index >> 1) & HISTORY_MASK] =
+            merge(lower[(index - 1) & HISTORY_MASK], lower[index & HISTORY_MASK]);
+        index >>= 1;
+    }
+}
+
+uint32_t ecg_history_oldest(const EcgHistory &history, int level) {
+    uint32_t complete = history.count >> level;
+    uint32_t first = complete > ECG_HISTORY_BUCKETS ? complete - ECG_HISTORY_BUCKETS : 0;
+    return first << level;
+}
+
+// 第 level 级的第 index 个桶；最新的桶可能还没凑满，由下一级补齐
+static EcgBucket bucket(const EcgHistory &history, int level, uint32_t index) {
+    uint32_t complete = history.count >> level;
+    if (index < complete) {
+        if (complete - index > ECG_HISTORY_BUCKETS) {
+            return EMPTY_BUCKET;
+        }
+        return history.levels[level][index & HISTORY_MASK];
+    }
+    if (level == 0 || index > complete) {
+        return EMPTY_BUCKET;
+    }
+    return merge(bucket(history, level - 1, 2 * index), bucket(history, level - 1, 2 * index + 1));
+}
+
+int ecg_history_render(const EcgHistory &history, uint32_t end, uint32_t step_q16,
+                       uint16_t columns, EcgBucket *out) {
+    if (step_q16 == 0) {
+        step_q16 = 1;
+    }
+    int64_t start_q16 = ((int64_t)end << 16) - (int64_t)columns * step_q16;
+    return ecg_history_render_at(history, start_q16, step_q16, columns, out);
+}
+
+int ecg_history_render_at(const EcgHistory &history, int64_t start_q16, uint32_t step_q16,
+                          uint16_t columns, EcgBucket *out) {
+    if (step_q16 == 0) {
+        step_q16 = 1;
+    }
+
+    // 每列至少一个桶的最粗级别，窗口起点已经滚出该级时再往上找
+    int level = 0;
+    while (level + 1 < ECG_HISTORY_LEVELS && ((uint64_t)1 << (level + 1 + 16)) <= step_q16) {
+        level++;
+    }
+    uint32_t start = start_q16 > 0 ? (uint32_t)(start_q16 >> 16) : 0;
+    while (level + 1 < ECG_HISTORY_LEVELS && start < ecg_history_oldest(history, level)) {
+        level++;
+    }
+
+    for (uint16_t i = 0; i < columns; i++) {
+        int64_t s = start_q16 + (int64_t)i * step_q16;
+        int64_t e = s + step_q16;
+        if (e <= 0) {
+            out[i] = EMPTY_BUCKET;
+            continue;
+        }
+        uint32_t first = s > 0 ? (uint32_t)(s >> 16) : 0;
+        uint32_t last = (uint32_t)(e >> 16);
+        last = last > first ? last - 1 : first;
+
+        EcgBucket acc = EMPTY_BUCKET;
+        for (uint32_t b = first >> level; b <= last >> level; b++) {
+            acc = merge(acc, bucket(history, level, b));
+        }
+        out[i] = acc;
+    }
+    return level;
+}
@@ -0,0 +1,39 @@
+// ecg_history.hpp
+// ECG 历史记录：最近的原始采样加上 2x/4x/8x... 各级 min/max 金字塔
+// 每级保留相同数量的桶，级别越高覆盖的时间越长：第 0 级约 1 秒，第 11 级超过 30 分钟
+// 任意时间窗口、任意缩放都从合适的级别按列读取，耗时与屏幕宽度成正比
+#ifndef ECG_HISTORY_HPP
+#define ECG_HISTORY_HPP
+
+#include <stdint.h>
+
+#define ECG_HISTORY_BUCKETS 1024   // 每级保留的桶数，必须是 2 的幂
+#define ECG_HISTORY_LEVELS  12     // 第 0 级为原始采样，第 k 级每桶 2^k 个采样
+
+struct EcgBucket {
+    int16_t min, max;   // min > max 表示该处没有数据
+};
+
+struct EcgHistory {
+    EcgBucket levels[ECG_HISTORY_LEVELS][ECG_HISTORY_BUCKETS];
+    uint32_t count;     // 已写入的采样总数，同时是下一个采样的绝对序号
+};
+
+void ecg_history_reset(EcgHistory &history);
+
+// 写入一个采样，逐级合并已凑满的桶，均摊 O(1)
+void ecg_history_push(EcgHistory &history, int16_t value);
+
+// 第 level 级仍保留的最早采样的绝对序号
+uint32_t ecg_history_oldest(const EcgHistory &history, int level);
+
+// 渲染结束于 end（不含）的窗口，每列 step_q16 (Q16.16) 个采样，结果写入 out[columns]
+// 返回使用的级别
+int ecg_history_render(const EcgHistory &history, uint32_t end, uint32_t step_q16,
+                       uint16_t columns, EcgBucket *out);
+// 同上，窗口从 start_q16 (Q16.16，可为负) 开始；列边界只取决于 start_q16 和步长，
+// 在 step_q16 的整数倍处分段渲染，只要选到同一级别，结果与一次渲染整段相同
+int ecg_history_render_at(const EcgHistory &history, int64_t start_q16, uint32_t step_q16,
+                          uint16_t columns, EcgBucket *out);
+
+#endif // ECG_HISTORY_HPP
@@ -0,0 +1,44 @@
+/**
+ * ECG view layout
+ * All divisions happen here, once per panel.
+ */
+
+#include "ecg_layout.hpp"
+
+void ecg_layout_init(EcgLayout &layout, uint16_t width, uint16_t height, uint32_t samples,
+                     uint8_t leads, EcgLeadArrangement arrangement, const float *gains) {
+    layout.width = width;
+    layout.height = height;
+
+    // 波形占满整个面板，心率文本叠加在左上角
+    layout.trace = {0, 0, width, height};
+
+    layout.hr_font = height >= 120 ? &Font16 : &Font12;
+    uint16_t margin = height >= 120 ? 5 : 2;
+    layout.hr_text = {margin, margin, (uint16_t)(layout.hr_font->Width * 12), layout.hr_font->Height};
+
+    layout.grid_pitch = (uint16_t)(ECG_REF_GRID_PITCH * width / ECG_REF_WIDTH);
+    if (layout.grid_pitch < 8) {
+        layout.grid_pitch = 8;
+    }
+
+    // 每个导联的区域按参考布局等比缩放：基线在区域内的相对位置和幅度与单导联时相同
+    leads = leads < 1 ? 1 : (leads > ECG_MAX_LEADS ? ECG_MAX_LEADS : leads);
+    layout.leads = leads;
+    for (uint8_t i = 0; i < leads; i++) {
+        EcgLeadBand &band = layout.lead[i];
+        uint16_t h = layout.trace.h;
+        band.top = layout.trace.y;
+        if (arrangement == ECG_LEADS_STACKED) {
+            band.top += (uint16_t)(h * i / leads);
+            h = (uint16_t)(h * (i + 1) / leads - h * i / leads);
+        }
+        band.bottom = band.top + h - 1;
+        band.baseline = (int16_t)(band.top + ECG_REF_OFFSET * h / ECG_REF_HEIGHT);
+        band.amplitude = (float)ECG_REF_AMPLITUDE * h / ECG_REF_HEIGHT * (gains != NULL ? gains[i] : 1.0f);
+    }
+
+    uint16_t columns = layout.trace.w > ECG_MAX_COLUMNS ? ECG_MAX_COLUMNS : layout.trace.w;
+    layout.trace.w = columns;
+    layout.column_step_q16 = (uint32_t)(((uint64_t)samples << 16) / columns);
+}
@@ -0,0 +1,65 @@
+// ecg_layout.hpp
+// ECG 视图布局：初始化时根据面板尺寸计算一次，之后每帧只做加法和移位
+#ifndef ECG_LAYOUT_HPP
+#define ECG_LAYOUT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lcd_wrapper.hpp"
+
+// 参考布局：1.14" 横屏 240x135 上调好的数值，其他面板按高度/宽度等比缩放
+#define ECG_REF_WIDTH      240
+#define ECG_REF_HEIGHT     135
+#define ECG_REF_AMPLITUDE  50    // Vertical scaling for ECG display (px/V)
+#define ECG_REF_OFFSET     90    // Vertical center position for ECG trace
+#define ECG_REF_GRID_PITCH 20
+
+#define ECG_MAX_COLUMNS    320   // 最宽的面板 (2" 横屏)
+#define ECG_MAX_ROWS       240   // 最高的面板
+#define ECG_MAX_LEADS      3
+
+// 多导联排列：上下堆叠各占一条，或叠加在同一区域
+enum EcgLeadArrangement {
+    ECG_LEADS_STACKED,
+    ECG_LEADS_OVERLAID,
+};
+
+struct EcgRect {
+    uint16_t x, y, w, h;
+};
+
+// 一个导联的纵向区域，波形限制在 top..bottom 之内
+struct EcgLeadBand {
+    uint16_t top, bottom;
+    int16_t baseline;           // 0 V 对应的行
+    float amplitude;            // px/V，已乘导联增益
+};
+
+struct EcgLayout {
+    uint16_t width, height;     // 面板尺寸
+    EcgRect trace;              // 波形区域
+    EcgRect hr_text;            // 心率文本区域
+    sFONT *hr_font;
+    uint16_t grid_pitch;        // 网格间距 (px)
+    uint32_t column_step_q16;   // 每列对应的采样数 (Q16.16)
+    uint8_t leads;
+    EcgLeadBand lead[ECG_MAX_LEADS];
+};
+
+// gains 为各导联的增益，NULL 时均为 1
+void ecg_layout_init(EcgLayout &layout, uint16_t width, uint16_t height, uint32_t samples,
+                     uint8_t leads = 1, EcgLeadArrangement arrangement = ECG_LEADS_STACKED,
+                     const float *gains = NULL);
+
+// 第 column 列覆盖的采样从这里开始，到 column + 1 的起点结束
+static inline uint32_t ecg_layout_column_start(const EcgLayout &layout, uint16_t column) {
+    return (uint32_t)(((uint64_t)column * layout.column_step_q16) >> 16);
+}
+
+static inline int ecg_layout_row(const EcgLayout &layout, uint8_t lead, float value) {
+    const EcgLeadBand &band = layout.lead[lead];
+    int y = band.baseline - (int)(value * band.amplitude);
+    return y < band.top ? band.top : (y > band.bottom ? band.bottom : y);
+}
+
+#endif // ECG_LAYOUT_HPP
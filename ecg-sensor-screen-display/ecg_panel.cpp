@@ -0,0 +1,37 @@
+/**
+ * Panel table
+ * One entry per driver in lib/LCD, all used in HORIZONTAL scan direction.
+ */
+
+#include "ecg_panel.hpp"
+
+#include <string.h>
+
+static void lcd_2in_display(UWORD *image) {
+    LCD_2IN_Display((UBYTE *)image);
+}
+
+static void lcd_1in14_set_rgb444(bool enable) {
+    LCD_1IN14_SetColorMode(enable ? LCD_1IN14_COLOR_RGB444 : LCD_1IN14_COLOR_RGB565);
+}
+
+const EcgPanel ecg_panels[] = {
+    {"0in96", LCD_0IN96_Init, LCD_0IN96_Clear, LCD_0IN96_Display, NULL, NULL, NULL, &LCD_0IN96.WIDTH, &LCD_0IN96.HEIGHT, 1, 26},
+    {"1in14", LCD_1IN14_Init, LCD_1IN14_Clear, LCD_1IN14_Display, lcd_1in14_set_rgb444, LCD_1IN14_DisplayBand, LCD_1IN14_DisplayRect, &LCD_1IN14.WIDTH, &LCD_1IN14.HEIGHT, 40, 53},
+    {"1in3",  LCD_1IN3_Init,  LCD_1IN3_Clear,  LCD_1IN3_Display,  NULL, NULL, NULL, &LCD_1IN3.WIDTH,  &LCD_1IN3.HEIGHT,  0, 0},
+    {"1in44", LCD_1IN44_Init, LCD_1IN44_Clear, LCD_1IN44_Display, NULL, NULL, NULL, &LCD_1IN44.WIDTH, &LCD_1IN44.HEIGHT, 1, 2},
+    {"1in54", LCD_1IN54_Init, LCD_1IN54_Clear, LCD_1IN54_Display, NULL, NULL, NULL, &LCD_1IN54.WIDTH, &LCD_1IN54.HEIGHT, 0, 0},
+    {"1in8",  LCD_1IN8_Init,  LCD_1IN8_Clear,  LCD_1IN8_Display,  NULL, NULL, NULL, &LCD_1IN8.WIDTH,  &LCD_1IN8.HEIGHT,  1, 1},
+    {"2in",   LCD_2IN_Init,   LCD_2IN_Clear,   lcd_2in_display,   NULL, NULL, NULL, &LCD_2IN.WIDTH,   &LCD_2IN.HEIGHT,   0, 0},
+};
+
+const int ecg_panel_count = sizeof(ecg_panels) / sizeof(ecg_panels[0]);
+
+const EcgPanel *ecg_panel_find(const char *name) {
+    for (int i = 0; i < ecg_panel_count; i++) {
+        if (strcmp(ecg_panels[i].name, name) == 0) {
+            return &ecg_panels[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,30 @@
+// ecg_panel.hpp
+// lib/LCD 中各尺寸面板的统一描述，运行时选择面板而无需重新编译
+#ifndef ECG_PANEL_HPP
+#define ECG_PANEL_HPP
+
+#include <stdint.h>
+#include "lcd_wrapper.hpp"
+
+struct EcgPanel {
+    const char *name;
+    void (*init)(UBYTE scan_dir);
+    void (*clear)(UWORD color);
+    void (*display)(UWORD *image);
+    void (*set_rgb444)(bool enable);   // 12 位传输，不支持的面板为 NULL
+    void (*display_band)(UWORD ystart, UWORD yend, UWORD *band);  // 按条带刷新，不支持的面板为 NULL
+    void (*display_rect)(UWORD xstart, UWORD ystart, UWORD xend, UWORD yend, UWORD *rect);  // 按任意窗口刷新，不支持的面板为 NULL
+    const UWORD *width;     // 指向驱动的 LCD_xxx.WIDTH，init 之后有效
+    const UWORD *height;    // 指向驱动的 LCD_xxx.HEIGHT，init 之后有效
+    uint16_t gram_x;        // 横屏时面板玻璃原点在控制器中的列/行偏移
+    uint16_t gram_y;
+};
+
+#define ECG_PANEL_DEFAULT "1in14"
+
+extern const EcgPanel ecg_panels[];
+extern const int ecg_panel_count;
+
+const EcgPanel *ecg_panel_find(const char *name);
+
+#endif // ECG_PANEL_HPP
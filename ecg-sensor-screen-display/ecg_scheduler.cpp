@@ -0,0 +1,168 @@
+// ecg_scheduler.cpp
+// 事件循环本体，不依赖硬件；固件上的时钟和 idle 在 ecg_scheduler_pico.cpp
+
+#include "ecg_scheduler.hpp"
+
+#include <stdio.h>
+
+void ecg_sched_init(EcgScheduler &sched, EcgClockFn now, EcgIdleFn idle) {
+    sched.count = 0;
+    sched.pending.store(0, std::memory_order_relaxed);
+    sched.now = now;
+    sched.idle = idle;
+    sched.start_us = now();
+    sched.idle_us = 0;
+    sched.idle_clock_us.store(0, std::memory_order_relaxed);
+}
+
+int ecg_sched_add(EcgScheduler &sched, const char *name, EcgTaskFn fn, void *arg,
+                  uint32_t events, uint32_t period_us, uint32_t deadline_us) {
+    if (sched.count >= ECG_SCHED_MAX_TASKS) {
+        return -1;
+    }
+    EcgTask &task = sched.tasks[sched.count];
+    task = {};
+    task.name = name;
+    task.fn = fn;
+    task.arg = arg;
+    task.events = events;
+    task.period_us = period_us;
+    task.deadline_us = deadline_us;
+    task.next_us = period_us != 0 ? sched.now() + period_us : ECG_SCHED_NEVER;
+    return sched.count++;
+}
+
+void ecg_sched_wake_at(EcgScheduler &sched, int task, uint64_t at_us) {
+    sched.tasks[task].next_us = at_us;
+}
+
+// 取走挂起的事件和到期的定时器，标记就绪；已经就绪的任务合并为一次运行
+static void collect(EcgScheduler &sched, uint64_t now) {
+    uint32_t events = sched.pending.exchange(0, std::memory_order_acquire);
+    for (uint8_t i = 0; i < sched.count; i++) {
+        EcgTask &task = sched.tasks[i];
+        if ((events & task.events) != 0 && !task.ready) {
+            task.ready = true;
+            task.release_us = now;
+        }
+        if (task.next_us <= now) {
+            if (!task.ready) {
+                task.ready = true;
+                task.release_us = task.next_us;
+            }
+            if (task.period_us != 0) {
+                // 按周期递推不累积漂移；落后超过一个周期时跳过错过的几次
+                task.next_us += task.period_us;
+                if (task.next_us <= now) {
+                    task.next_us = now + task.period_us;
+                }
+            } else {
+                task.next_us = ECG_SCHED_NEVER;
+            }
+        }
+    }
+}
+
+// 截止时间最早的就绪任务，没有截止时间的排在最后，相同时按添加顺序
+static EcgTask *pick(EcgScheduler &sched) {
+    EcgTask *best = nullptr;
+    uint64_t best_deadline = 0;
+    for (uint8_t i = 0; i < sched.count; i++) {
+        EcgTask &task = sched.tasks[i];
+        if (!task.ready) {
+            continue;
+        }
+        uint64_t deadline = task.deadline_us != 0 ? task.release_us + task.deadline_us : ECG_SCHED_NEVER;
+        if (best == nullptr || deadline < best_deadline) {
+            best = &task;
+            best_deadline = deadline;
+        }
+    }
+    return best;
+}
+
+static void run_task(EcgScheduler &sched, EcgTask &task) {
+    // 先清就绪，运行期间到来的事件会让任务再运行一次
+    task.ready = false;
+    uint64_t start = sched.now();
+    task.fn(task.arg);
+    uint64_t end = sched.now();
+
+    uint32_t run_us = (uint32_t)(end - start);
+    uint32_t wait_us = (uint32_t)(start - task.release_us);
+    task.runs++;
+    task.busy_us += run_us;
+    task.max_us = run_us > task.max_us ? run_us : task.max_us;
+    task.max_wait_us = wait_us > task.max_wait_us ? wait_us : task.max_wait_us;
+    if (task.deadline_us != 0 && end - task.release_us > task.deadline_us) {
+        task.misses++;
+    }
+}
+
+void ecg_sched_run_until(EcgScheduler &sched, uint64_t until_us) {
+    for (;;) {
+        uint64_t now = sched.now();
+        if (now >= until_us) {
+            return;
+        }
+        collect(sched, now);
+        EcgTask *task = pick(sched);
+        if (task != nullptr) {
+            run_task(sched, *task);
+            continue;
+        }
+
+        uint64_t wake = until_us;
+        for (uint8_t i = 0; i < sched.count; i++) {
+            wake = sched.tasks[i].next_us < wake ? sched.tasks[i].next_us : wake;
+        }
+        sched.idle(sched, wake);
+        uint64_t idle = sched.now() - now;
+        sched.idle_us += idle;
+        sched.idle_clock_us.fetch_add((uint32_t)idle, std::memory_order_relaxed);
+    }
+}
+
+void ecg_sched_run(EcgScheduler &sched) {
+    ecg_sched_run_until(sched, ECG_SCHED_NEVER);
+}
+
+void ecg_sched_take_stats(EcgScheduler &sched, EcgSchedStats &stats) {
+    uint64_t now = sched.now();
+    stats.elapsed_us = now - sched.start_us;
+    stats.idle_us = sched.idle_us;
+    stats.count = sched.count;
+    for (uint8_t i = 0; i < sched.count; i++) {
+        EcgTask &task = sched.tasks[i];
+        stats.tasks[i] = task;
+        task.runs = 0;
+        task.misses = 0;
+        task.max_us = 0;
+        task.max_wait_us = 0;
+        task.busy_us = 0;
+    }
+    sched.start_us = now;
+    sched.idle_us = 0;
+}
+
+bool ecg_sched_report_line(const EcgSchedStats &stats, uint32_t *next, char *buf, size_t len) {
+    uint64_t elapsed = stats.elapsed_us;
+    uint32_t i = *next;
+    if (elapsed == 0 || i > stats.count) {
+        return false;
+    }
+    *next = i + 1;
+    if (i == 0) {
+        snprintf(buf, len, "sched: %lu ms, idle %lu%%\n", (unsigned long)(elapsed / 1000),
+                 (unsigned long)(stats.idle_us * 100 / elapsed));
+        return true;
+    }
+    const EcgTask &task = stats.tasks[i - 1];
+    snprintf(buf, len, "  %-8s %6lu runs, busy %lu.%lu%%, max %lu us, max wait %lu us, %lu missed\n",
+             task.name, (unsigned long)task.runs,
+             (unsigned long)(task.busy_us * 100 / elapsed),
+             (unsigned long)(task.busy_us * 1000 / elapsed % 10),
+             (unsigned long)task.max_us, (unsigned long)task.max_wait_us,
+             (unsigned long)task.misses);
+    return true;
+}
@@ -0,0 +1,95 @@
+// ecg_scheduler.hpp
+// 协作式事件循环：任务运行到结束，不抢占
+// 任务由事件位 (中断里 ecg_sched_post 置位：DMA 块就绪、SPI 完成、USB 收到数据等) 或定时器触发，
+// 就绪的任务按截止时间从早到晚依次运行；没有任务就绪时调用 idle，固件上是 __wfi 睡到下一个定时器或中断
+// 每个任务记录运行次数、累计和最长运行时间、超过截止时间的次数
+// 时钟和 idle 都由调用者提供，主机测试用虚拟时钟，结果完全确定
+#ifndef ECG_SCHEDULER_HPP
+#define ECG_SCHEDULER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define ECG_SCHED_MAX_TASKS 8
+#define ECG_SCHED_NEVER     UINT64_MAX
+
+typedef void (*EcgTaskFn)(void *arg);
+
+struct EcgTask {
+    const char *name;
+    EcgTaskFn fn;
+    void *arg;
+    uint32_t events;        // 触发任务的事件位，0 表示只由定时器触发
+    uint32_t period_us;     // 周期，0 表示不周期运行
+    uint32_t deadline_us;   // 从触发到运行结束的期限，0 表示不检查
+
+    bool ready;
+    uint64_t release_us;    // 本次触发的时刻：定时器的到期时刻，或事件循环取走事件的时刻
+    uint64_t next_us;       // 下一次定时触发，ECG_SCHED_NEVER 表示没有
+
+    uint32_t runs;
+    uint32_t misses;        // 超过截止时间结束的次数
+    uint32_t max_us;        // 最长一次运行
+    uint32_t max_wait_us;   // 从触发到开始运行的最长等待
+    uint64_t busy_us;       // 累计运行时间
+};
+
+struct EcgScheduler;
+typedef uint64_t (*EcgClockFn)();
+// 没有任务就绪时调用，最晚在 until_us 返回；有事件挂起时必须立即返回
+typedef void (*EcgIdleFn)(EcgScheduler &sched, uint64_t until_us);
+
+struct EcgScheduler {
+    EcgTask tasks[ECG_SCHED_MAX_TASKS];
+    uint8_t count;
+    std::atomic<uint32_t> pending;  // 中断置位、事件循环取走的事件
+    EcgClockFn now;
+    EcgIdleFn idle;
+    uint64_t start_us;
+    uint64_t idle_us;               // 累计在 idle 里的时间
+    // 同上但报告不清零，32 位回绕；别的核 (调速器) 隔一段时间读一次，两次之差就是这段时间的 idle
+    std::atomic<uint32_t> idle_clock_us;
+};
+
+void ecg_sched_init(EcgScheduler &sched, EcgClockFn now, EcgIdleFn idle);
+
+// 添加任务，返回任务号；任务表满时返回 -1
+// 周期任务第一次在添加后 period_us 运行
+int ecg_sched_add(EcgScheduler &sched, const char *name, EcgTaskFn fn, void *arg,
+                  uint32_t events, uint32_t period_us, uint32_t deadline_us);
+
+// 置位事件，可以在中断里或另一个核上调用；另一个核需要自己唤醒本核 (例如 FIFO 门铃)
+inline void ecg_sched_post(EcgScheduler &sched, uint32_t events) {
+    sched.pending.fetch_or(events, std::memory_order_release);
+}
+
+// 在 at_us 时刻触发一次任务 (替换原来的下一次定时)
+void ecg_sched_wake_at(EcgScheduler &sched, int task, uint64_t at_us);
+
+// 运行事件循环直到时钟到达 until_us；ecg_sched_run 永不返回
+void ecg_sched_run_until(EcgScheduler &sched, uint64_t until_us);
+void ecg_sched_run(EcgScheduler &sched);
+
+// 上次取出以来的统计：总时长、idle 和每个任务的副本
+struct EcgSchedStats {
+    uint64_t elapsed_us;
+    uint64_t idle_us;
+    uint8_t count;
+    EcgTask tasks[ECG_SCHED_MAX_TASKS];
+};
+
+// 取出每个任务的统计并清零 (不含周期和截止时间等配置)；只在运行这个事件循环的核上调用，
+// 副本可以交给别的核打印
+void ecg_sched_take_stats(EcgScheduler &sched, EcgSchedStats &stats);
+
+// 把取出的统计的第 *next 行写进 buf：先是一行 sched: <毫秒> ms, idle <百分比>%，再每个任务一行
+// 返回 false 表示已经写完 (或这段时长为 0)，buf 里没有内容
+bool ecg_sched_report_line(const EcgSchedStats &stats, uint32_t *next, char *buf, size_t len);
+
+// 固件上的 idle：关中断检查事件，用一个硬件定时器在 until_us 唤醒，__wfi
+// 在 ecg_scheduler_pico.cpp 里，主机构建不编译
+uint64_t ecg_sched_clock_pico();
+void ecg_sched_idle_pico(EcgScheduler &sched, uint64_t until_us);
+
+#endif // ECG_SCHEDULER_HPP
@@ -0,0 +1,49 @@
+// ecg_scheduler_pico.cpp
+// 固件上的事件循环时钟和 idle：每个核一个硬件定时器，只用来把 __wfi 叫醒
+
+#include "ecg_scheduler.hpp"
+
+#include <pico/stdlib.h>
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+
+extern "C" {
+#include "DEV_Trace.h"
+}
+
+static int sched_alarm[NUM_CORES] = {-1, -1};
+
+// 中断本身就是目的，回调什么也不做
+static void sched_alarm_fired(uint alarm_num) {
+    (void)alarm_num;
+}
+
+uint64_t ecg_sched_clock_pico() {
+    return time_us_64();
+}
+
+void ecg_sched_idle_pico(EcgScheduler &sched, uint64_t until_us) {
+    uint core = get_core_num();
+    if (sched_alarm[core] < 0) {
+        // 在本核上注册，定时器中断也在本核
+        sched_alarm[core] = hardware_alarm_claim_unused(true);
+        hardware_alarm_set_callback(sched_alarm[core], sched_alarm_fired);
+    }
+
+    // 关中断后再检查事件：检查之后到来的中断会挂起，__wfi 照样醒来，恢复中断后再处理
+    uint32_t save = save_and_disable_interrupts();
+    if (sched.pending.load(std::memory_order_relaxed) == 0) {
+        bool passed = false;
+        if (until_us == ECG_SCHED_NEVER) {
+            hardware_alarm_cancel(sched_alarm[core]);
+        } else {
+            passed = hardware_alarm_set_target(sched_alarm[core], from_us_since_boot(until_us));
+        }
+        if (!passed) {
+            DEV_TRACE_BEGIN("idle");
+            __wfi();
+            DEV_TRACE_END("idle");
+        }
+    }
+    restore_interrupts(save);
+}
@@ -0,0 +1,81 @@
+// ecg_stream.cpp
+// 采样帧的编码和解码
+
+#include "ecg_stream.hpp"
+
+#include <string.h>
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+size_t ecg_stream_encode(const EcgSampleBlock *block, uint8_t *buf, size_t len) {
+    uint32_t samples = ecg_block_samples(block);
+    size_t bytes = ecg_stream_frame_bytes(samples);
+    if (samples > ECG_STREAM_MAX_SAMPLES || bytes > len) {
+        return 0;
+    }
+    buf[0] = ECG_STREAM_SYNC;
+    buf[1] = ECG_STREAM_VERSION;
+    put16(buf + 2, block->sets);
+    put32(buf + 4, block->seq);
+    put32(buf + 8, (uint32_t)block->oldest_us);
+    put32(buf + 12, (uint32_t)(block->oldest_us >> 32));
+    put16(buf + 16, block->channel_mask);
+    put16(buf + 18, block->flags);
+    // 两个平台都是小端，采样按内存字节复制
+    memcpy(buf + ECG_STREAM_HEADER, block->samples, samples * sizeof(uint16_t));
+    size_t body = bytes - ECG_STREAM_TRAILER;
+    put32(buf + body, ~ecg_crc32_update(0xFFFFFFFFu, buf, body));
+    return bytes;
+}
+
+long ecg_stream_decode(const uint8_t *buf, size_t len, EcgStreamFrame &frame, bool *crc_bad) {
+    *crc_bad = false;
+    if (len < 1 || buf[0] != ECG_STREAM_SYNC) {
+        return -1;
+    }
+    if (len < 2) {
+        return 0;
+    }
+    if (buf[1] != ECG_STREAM_VERSION) {
+        return -1;
+    }
+    if (len < ECG_STREAM_HEADER) {
+        return 0;
+    }
+    frame.sets = get16(buf + 2);
+    frame.seq = get32(buf + 4);
+    frame.oldest_us = get32(buf + 8) | ((uint64_t)get32(buf + 12) << 32);
+    frame.channel_mask = get16(buf + 16);
+    frame.flags = get16(buf + 18);
+    uint32_t samples = frame.sets * ecg_stream_leads(frame);
+    if (frame.channel_mask == 0 || frame.sets == 0 || samples > ECG_STREAM_MAX_SAMPLES) {
+        return -1;
+    }
+    size_t bytes = ecg_stream_frame_bytes(samples);
+    if (len < bytes) {
+        return 0;
+    }
+    size_t body = bytes - ECG_STREAM_TRAILER;
+    if (~ecg_crc32_update(0xFFFFFFFFu, buf, body) != get32(buf + body)) {
+        *crc_bad = true;
+        return -1;
+    }
+    frame.samples = buf + ECG_STREAM_HEADER;
+    return (long)bytes;
+}
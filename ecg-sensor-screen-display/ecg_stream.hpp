@@ -0,0 +1,54 @@
+// ecg_stream.hpp
+// USB 上的二进制采样帧：一个采样块一帧，原始 ADC 值，不在设备上格式化
+// 与 printf 的文本、DEV_Log 的记录 (0xA5) 和 DEV_Trace 的事件段 (0xA6) 混在同一个端口上，
+// 同步字节不是 ASCII，接收端 (host/ecg_receiver.hpp) 靠它和帧尾的 CRC 从任意位置重新同步
+// 帧格式 (小端)：
+//   [0]       ECG_STREAM_SYNC
+//   [1]       ECG_STREAM_VERSION
+//   [2..3]    sets，每组按导联交错
+//   [4..7]    seq，块序号，跳号说明中间丢了块
+//   [8..15]   oldest_us，最早一组的采样时刻
+//   [16..17]  channel_mask，每个 ADC 输入一位
+//   [18..19]  flags (ECG_BLOCK_*)
+//   [20..]    sets × 导联数个 uint16 采样
+//   [最后 4]  CRC-32，覆盖前面全部字节
+// 固件和主机共用
+#ifndef ECG_STREAM_HPP
+#define ECG_STREAM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ecg_block_pool.hpp"
+
+#define ECG_STREAM_SYNC         0xA7
+#define ECG_STREAM_VERSION      1
+#define ECG_STREAM_HEADER       20
+#define ECG_STREAM_TRAILER      4
+#define ECG_STREAM_MAX_SAMPLES  1024    // 一帧最多的采样，接收端据此判断头是否可信
+
+struct EcgStreamFrame {
+    uint16_t sets;
+    uint32_t seq;
+    uint64_t oldest_us;
+    uint16_t channel_mask;
+    uint16_t flags;
+    const uint8_t *samples;             // 指向帧里的采样，小端，不一定对齐
+};
+
+inline uint32_t ecg_stream_leads(const EcgStreamFrame &frame) {
+    return (uint32_t)__builtin_popcount(frame.channel_mask);
+}
+
+constexpr size_t ecg_stream_frame_bytes(uint32_t samples) {
+    return ECG_STREAM_HEADER + samples * sizeof(uint16_t) + ECG_STREAM_TRAILER;
+}
+
+// 把一块编成一帧写进 buf，返回帧长；放不下时返回 0
+size_t ecg_stream_encode(const EcgSampleBlock *block, uint8_t *buf, size_t len);
+
+// 解 buf 开头的一帧：返回帧长；还不够一帧返回 0；不是一帧 (头不合理或 CRC 不对) 返回 -1
+// *crc_bad 在头合理而 CRC 不对时置位，其余情况清零
+long ecg_stream_decode(const uint8_t *buf, size_t len, EcgStreamFrame &frame, bool *crc_bad);
+
+#endif // ECG_STREAM_HPP
@@ -0,0 +1,92 @@
+/**
+ * ECG history view
+ * Zoom and pan state for the history window, driven by the board keys.
+ */
+
+#include "ecg_view.hpp"
+#include "lcd_wrapper.hpp"
+
+static const UWORD view_keys[] = {ECG_KEY_ZOOM_IN, ECG_KEY_ZOOM_OUT, ECG_KEY_PAN_BACK, ECG_KEY_PAN_FORWARD};
+#define VIEW_KEY_COUNT (sizeof(view_keys) / sizeof(view_keys[0]))
+
+void ecg_view_init(EcgView &view, uint32_t base_step_q16, uint16_t columns) {
+    view.base_step_q16 = base_step_q16;
+    view.columns = columns;
+    view.zoom = 0;
+    view.live = true;
+    view.end = 0;
+    view.keys = 0;
+}
+
+void ecg_view_keys_init() {
+    for (unsigned i = 0; i < VIEW_KEY_COUNT; i++) {
+        DEV_KEY_Config(view_keys[i]);
+    }
+}
+
+uint32_t ecg_view_step(const EcgView &view) {
+    if (view.zoom >= 0) {
+        return view.base_step_q16 << view.zoom;
+    }
+    uint32_t step = view.base_step_q16 >> -view.zoom;
+    return step > 0 ? step : 1;
+}
+
+uint32_t ecg_view_end(const EcgView &view, const EcgHistory &history) {
+    return view.live ? history.count : view.end;
+}
+
+void ecg_view_zoom(EcgView &view, int delta) {
+    int zoom = view.zoom + delta;
+    zoom = zoom < ECG_VIEW_ZOOM_MIN ? ECG_VIEW_ZOOM_MIN : zoom;
+    zoom = zoom > ECG_VIEW_ZOOM_MAX ? ECG_VIEW_ZOOM_MAX : zoom;
+    view.zoom = (int8_t)zoom;
+}
+
+void ecg_view_pan(EcgView &view, const EcgHistory &history, int halves) {
+    uint32_t window = (uint32_t)(((uint64_t)view.columns * ecg_view_step(view)) >> 16);
+    int64_t end = (int64_t)ecg_view_end(view, history) + (int64_t)halves * (window / 2);
+
+    // 最远只能回到最粗一级仍保留的历史
+    int64_t oldest_end = (int64_t)ecg_history_oldest(history, ECG_HISTORY_LEVELS - 1) + window;
+    if (end < oldest_end) {
+        end = oldest_end;
+    }
+    if (end >= (int64_t)history.count) {
+        view.live = true;
+        return;
+    }
+    view.live = false;
+    view.end = (uint32_t)end;
+}
+
+bool ecg_view_poll_keys(EcgView &view, const EcgHistory &history) {
+    uint8_t keys = 0;
+    for (unsigned i = 0; i < VIEW_KEY_COUNT; i++) {
+        if (DEV_Digital_Read(view_keys[i]) == 0) {
+            keys |= 1 << i;
+        }
+    }
+    uint8_t pressed = keys & ~view.keys;
+    view.keys = keys;
+    if (pressed == 0) {
+        return false;
+    }
+
+    int8_t zoom = view.zoom;
+    bool live = view.live;
+    uint32_t end = view.end;
+    if (pressed & 0x01) {
+        ecg_view_zoom(view, -1);
+    }
+    if (pressed & 0x02) {
+        ecg_view_zoom(view, 1);
+    }
+    if (pressed & 0x04) {
+        ecg_view_pan(view, history, -1);
+    }
+    if (pressed & 0x08) {
+        ecg_view_pan(view, history, 1);
+    }
+    return view.zoom != zoom || view.live != live || view.end != end;
+}
@@ -0,0 +1,42 @@
+// ecg_view.hpp
+// 历史波形的缩放和平移，由板上按键控制
+// 实时模式下窗口末端跟随最新采样；向后平移后窗口固定在历史中，平移回最新处恢复实时
+#ifndef ECG_VIEW_HPP
+#define ECG_VIEW_HPP
+
+#include <stdint.h>
+#include "ecg_history.hpp"
+
+// Pico-LCD-1.14 上的按键，按下为低电平
+#define ECG_KEY_ZOOM_IN      15   // KEY A
+#define ECG_KEY_ZOOM_OUT     17   // KEY B
+#define ECG_KEY_PAN_BACK     2    // 摇杆上
+#define ECG_KEY_PAN_FORWARD  3    // 摇杆按下
+
+#define ECG_VIEW_ZOOM_MIN   -3    // 每列采样数为基准的 1/8
+#define ECG_VIEW_ZOOM_MAX    8    // 每列采样数为基准的 256 倍，1.14" 上约 11 分钟
+
+struct EcgView {
+    uint32_t base_step_q16;   // zoom 为 0 时每列的采样数 (Q16.16)，来自布局
+    uint16_t columns;
+    int8_t zoom;              // 每列采样数 = 基准 * 2^zoom
+    bool live;
+    uint32_t end;             // 非实时模式下窗口末端的绝对序号
+    uint8_t keys;             // 上一次轮询时按下的按键
+};
+
+void ecg_view_init(EcgView &view, uint32_t base_step_q16, uint16_t columns);
+void ecg_view_keys_init();
+
+uint32_t ecg_view_step(const EcgView &view);
+uint32_t ecg_view_end(const EcgView &view, const EcgHistory &history);
+
+// 以窗口右端为中心缩放，delta 为 2 的幂次
+void ecg_view_zoom(EcgView &view, int delta);
+// 平移 halves 个半屏，负数向过去
+void ecg_view_pan(EcgView &view, const EcgHistory &history, int halves);
+
+// 读取按键，每次按下只响应一次；视图有变化时返回 true
+bool ecg_view_poll_keys(EcgView &view, const EcgHistory &history);
+
+#endif // ECG_VIEW_HPP
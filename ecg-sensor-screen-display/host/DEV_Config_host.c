@@ -0,0 +1,382 @@
+/*****************************************************************************
+* | File      	:   DEV_Config_host.c
+* | Function    :   Hardware underlying interface, Linux host build
+* | Info        :
+*   Drop-in replacement for lib/Config/DEV_Config.c. DC/CS edges and SPI
+*   bytes go to the panel model, I2C and PWM are accepted and ignored.
+*   SPI bytes advance the virtual clock at the firmware's bus rate, so
+*   latencies measured on the host include the time on the wire.
+*   Queued transfers run in submission order as soon as they are queued.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "DEV_Config.h"
+#include "Panel_Model.h"
+#include "Debug.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * GPIO
+**/
+int EPD_RST_PIN;
+int EPD_DC_PIN;
+int EPD_CS_PIN;
+int EPD_BL_PIN;
+int EPD_CLK_PIN;
+int EPD_MOSI_PIN;
+int EPD_SCL_PIN;
+int EPD_SDA_PIN;
+
+static UBYTE Pin_Level[32];
+
+/**
+ * GPIO read and write
+**/
+void DEV_Digital_Write(UWORD Pin, UBYTE Value)
+{
+    if(Pin < sizeof(Pin_Level))
+        Pin_Level[Pin] = Value;
+
+    if(Pin == EPD_CS_PIN)
+        Panel_Model_CS(Value);
+    else if(Pin == EPD_DC_PIN)
+        Panel_Model_DC(Value);
+}
+
+UBYTE DEV_Digital_Read(UWORD Pin)
+{
+    // Keys are pulled up, so an untouched input reads 1
+    if(Pin < sizeof(Pin_Level))
+        return Pin_Level[Pin];
+    return 1;
+}
+
+/**
+ * SPI, clocked at the firmware's DEV_SPI_HZ
+**/
+static uint64_t Spi_Bits;
+
+static void DEV_SPI_Wire(uint32_t Len)
+{
+    Spi_Bits += (uint64_t)Len * 8;
+    sleep_us(Spi_Bits * 1000000 / DEV_SPI_HZ);
+    Spi_Bits %= DEV_SPI_HZ / 1000000;
+}
+
+/**
+ * Transaction queue, drained synchronously. A callback that submits more
+ * work only appends it; the outermost DEV_Xfer_Submit runs it.
+**/
+typedef struct {
+    DEV_XFER *Head;
+    DEV_XFER *Tail;
+} DEV_XFER_QUEUE;
+
+static DEV_XFER_QUEUE Xfer_Queue[DEV_BUS_COUNT];
+static UBYTE Xfer_Running;
+
+static DEV_XFER Spi_Dma_Xfer[2];
+static UBYTE Spi_Dma_Next;
+
+static UDOUBLE Xfer_Len(const DEV_XFER *Xfer)
+{
+    if(Xfer->Bus == DEV_BUS_SPI)
+        return Xfer->Tx_Len ? Xfer->Tx_Len : Xfer->Rx_Len;
+    return Xfer->Tx_Len + Xfer->Rx_Len;
+}
+
+static UBYTE Xfer_Check(const DEV_XFER *Xfer, UBYTE Bus)
+{
+    UDOUBLE Len = Xfer_Len(Xfer);
+    if(Xfer->Bus != Bus || Len == 0 || (Xfer->Rx_Len && !Xfer->pRx))
+        return 0;
+    if(Bus == DEV_BUS_SPI) {
+        if(Xfer->Dc == DEV_XFER_DC_TAGGED && (!DEV_LCD_PIO || !Xfer->pTx || Xfer->pRx))
+            return 0;
+        if(DEV_LCD_PIO && Xfer->pRx)
+            return 0;
+        return Xfer->Rx_Len == 0 || Xfer->Rx_Len == Len;
+    }
+    return (Xfer->Tx_Len == 0 || Xfer->pTx) && Len <= DEV_I2C_XFER_MAX;
+}
+
+// Segments as the PIO program sees them: DC from the header, CS high in between
+static void Xfer_Run_Tagged(const UBYTE *pStream, UDOUBLE Len)
+{
+    UBYTE Dc = Pin_Level[EPD_DC_PIN];
+    while(Len > DEV_SPI_TAG_BYTES) {
+        UDOUBLE Bytes = ((((UDOUBLE)(pStream[0] & 0x7F) << 16) | (pStream[1] << 8) | pStream[2]) + 1) / 8;
+        if(Bytes > Len - DEV_SPI_TAG_BYTES)
+            Bytes = Len - DEV_SPI_TAG_BYTES;
+        DEV_Digital_Write(EPD_DC_PIN, pStream[0] >> 7);
+        DEV_Digital_Write(EPD_CS_PIN, 0);
+        Panel_Model_Write(pStream + DEV_SPI_TAG_BYTES, Bytes);
+        DEV_Digital_Write(EPD_CS_PIN, 1);
+        DEV_SPI_Wire(Bytes);
+        pStream += DEV_SPI_TAG_BYTES + Bytes;
+        Len -= DEV_SPI_TAG_BYTES + Bytes;
+    }
+    // The tags do not change the DC used for untagged writes
+    DEV_Digital_Write(EPD_DC_PIN, Dc);
+}
+
+static void Xfer_Run_SPI(DEV_XFER *Xfer)
+{
+    static const UBYTE Zero[64];
+    UDOUBLE Len = Xfer_Len(Xfer);
+    UDOUBLE i;
+
+    if(Xfer->Dc == DEV_XFER_DC_TAGGED) {
+        Xfer_Run_Tagged(Xfer->pTx, Len);
+        return;
+    }
+    if(Xfer->Dc != DEV_XFER_PIN_KEEP)
+        DEV_Digital_Write(EPD_DC_PIN, Xfer->Dc);
+    if(Xfer->Cs != DEV_XFER_PIN_KEEP)
+        DEV_Digital_Write(EPD_CS_PIN, 0);
+    if(Xfer->pTx) {
+        Panel_Model_Write(Xfer->pTx, Len);
+    } else {
+        for(i = 0; i < Len; i += sizeof(Zero))
+            Panel_Model_Write(Zero, Len - i < sizeof(Zero) ? Len - i : sizeof(Zero));
+    }
+    // Nothing drives MISO
+    if(Xfer->pRx)
+        memset(Xfer->pRx, 0, Len);
+    DEV_SPI_Wire(Len);
+    if(Xfer->Cs == DEV_XFER_CS_FRAME)
+        DEV_Digital_Write(EPD_CS_PIN, 1);
+}
+
+static void Xfer_Drain(void)
+{
+    UBYTE Bus;
+    UBYTE More = 1;
+
+    Xfer_Running = 1;
+    while(More) {
+        More = 0;
+        for(Bus = 0; Bus < DEV_BUS_COUNT; Bus++) {
+            DEV_XFER *Xfer = Xfer_Queue[Bus].Head;
+            if(!Xfer)
+                continue;
+            if(Bus == DEV_BUS_SPI)
+                Xfer_Run_SPI(Xfer);
+            else if(Xfer->pRx)
+                memset(Xfer->pRx, 0, Xfer->Rx_Len);
+            Xfer_Queue[Bus].Head = Xfer->Link;
+            if(!Xfer->Link)
+                Xfer_Queue[Bus].Tail = NULL;
+            Xfer->Status = DEV_XFER_DONE;
+            if(Xfer->Callback)
+                Xfer->Callback(Xfer);
+            More = 1;
+        }
+    }
+    Xfer_Running = 0;
+}
+
+UBYTE DEV_Xfer_Submit(DEV_XFER *Xfer)
+{
+    UBYTE Bus = Xfer->Bus;
+    DEV_XFER *Last;
+
+    for(Last = Xfer; Last; Last = Last->Next) {
+        if(Bus >= DEV_BUS_COUNT || !Xfer_Check(Last, Bus)) {
+            Debug("DEV_Xfer_Submit: invalid transfer on bus %d\r\n", Bus);
+            Last->Status = DEV_XFER_ERROR;
+            return 1;
+        }
+    }
+    for(Last = Xfer; ; Last = Last->Next) {
+        Last->Status = DEV_XFER_QUEUED;
+        Last->Link = Last->Next;
+        if(!Last->Next)
+            break;
+    }
+
+    if(Xfer_Queue[Bus].Head)
+        Xfer_Queue[Bus].Tail->Link = Xfer;
+    else
+        Xfer_Queue[Bus].Head = Xfer;
+    Xfer_Queue[Bus].Tail = Last;
+    if(!Xfer_Running)
+        Xfer_Drain();
+    return 0;
+}
+
+// Transfers have completed by the time the outermost submit returns
+void DEV_Xfer_Wait(DEV_XFER *Xfer)
+{
+    (void)Xfer;
+}
+
+UBYTE DEV_Xfer_Busy(UBYTE Bus)
+{
+    return Xfer_Queue[Bus].Head != NULL;
+}
+
+void DEV_Xfer_Flush(UBYTE Bus)
+{
+    (void)Bus;
+}
+
+void DEV_SPI_WriteByte(uint8_t Value)
+{
+    Panel_Model_Write(&Value, 1);
+    DEV_SPI_Wire(1);
+}
+
+void DEV_SPI_Write_nByte(uint8_t pData[], uint32_t Len)
+{
+    Panel_Model_Write(pData, Len);
+    DEV_SPI_Wire(Len);
+}
+
+// Same double-buffered descriptors as the firmware, completed on submit
+void DEV_SPI_Write_nByte_DMA(const uint8_t *pData, uint32_t Len)
+{
+    DEV_XFER *Xfer = &Spi_Dma_Xfer[Spi_Dma_Next];
+
+    Xfer->Bus = DEV_BUS_SPI;
+    Xfer->Cs = DEV_XFER_PIN_KEEP;
+    Xfer->Dc = DEV_XFER_PIN_KEEP;
+    Xfer->pTx = pData;
+    Xfer->Tx_Len = Len;
+    if(Len)
+        DEV_Xfer_Submit(Xfer);
+    Spi_Dma_Next ^= 1;
+}
+
+void DEV_SPI_DMA_Wait(void)
+{
+}
+
+/**
+ * I2C, nothing on the bus answers
+**/
+void DEV_I2C_Write(uint8_t addr, uint8_t reg, uint8_t Value)
+{
+    (void)addr;
+    (void)reg;
+    (void)Value;
+}
+
+void DEV_I2C_Write_nByte(uint8_t addr, uint8_t *pData, uint32_t Len)
+{
+    (void)addr;
+    (void)pData;
+    (void)Len;
+}
+
+uint8_t DEV_I2C_ReadByte(uint8_t addr, uint8_t reg)
+{
+    (void)addr;
+    (void)reg;
+    return 0;
+}
+
+/**
+ * GPIO Mode
+**/
+void DEV_GPIO_Mode(UWORD Pin, UWORD Mode)
+{
+    (void)Mode;
+    if(Pin < sizeof(Pin_Level))
+        Pin_Level[Pin] = 1;
+}
+
+/**
+ * KEY Config
+**/
+void DEV_KEY_Config(UWORD Pin)
+{
+    DEV_GPIO_Mode(Pin, 0);
+}
+
+/**
+ * delay x ms
+**/
+void DEV_Delay_ms(UDOUBLE xms)
+{
+    sleep_ms(xms);
+}
+
+void DEV_Delay_us(UDOUBLE xus)
+{
+    sleep_us(xus);
+}
+
+/******************************************************************************
+function:	Module Initialize, same pin map as the firmware
+parameter:
+Info:
+******************************************************************************/
+UBYTE DEV_Module_Init(void)
+{
+    EPD_RST_PIN     = 12;
+    EPD_DC_PIN      = 8;
+    EPD_BL_PIN    = 13;
+
+    EPD_CS_PIN      = 9;
+    EPD_CLK_PIN     = 10;
+    EPD_MOSI_PIN    = 11;
+
+    EPD_SCL_PIN    = 7;
+    EPD_SDA_PIN    = 6;
+
+    Panel_Model_Reset();
+
+    DEV_Digital_Write(EPD_CS_PIN, 1);
+    DEV_Digital_Write(EPD_DC_PIN, 0);
+    DEV_Digital_Write(EPD_BL_PIN, 1);
+    return 0;
+}
+
+void DEV_SET_PWM(uint8_t Value)
+{
+    if(Value > 100) {
+        printf("DEV_SET_PWM Error \r\n");
+    }
+}
+
+// No clock tree on the host; the transfer model does not depend on it
+UBYTE DEV_Set_Sys_Clock(UDOUBLE Khz)
+{
+    (void)Khz;
+    return 0;
+}
+
+// No bus fabric on the host, nothing is ever contested
+void DEV_Bus_Perf_Start(void)
+{
+}
+
+void DEV_Bus_Perf_Read(UDOUBLE Contested[DEV_BUS_COUNTERS])
+{
+    for(int i = 0; i < DEV_BUS_COUNTERS; i++)
+        Contested[i] = 0;
+}
+
+// Code does not run from flash on the host
+void DEV_XIP_Perf_Read(UDOUBLE *Hit, UDOUBLE *Access)
+{
+    *Hit = 0;
+    *Access = 0;
+}
+
+// Nanoseconds of the real clock; the virtual sleeps do not count
+UDOUBLE DEV_Cycle_Count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UDOUBLE)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+void DEV_Module_Exit(void)
+{
+
+}
@@ -0,0 +1,249 @@
+/*****************************************************************************
+* | File      	:   Panel_Model.c
+* | Function    :   In-memory model of an ST7735/ST7789 style SPI panel
+* | Info        :
+*   Only the commands that move pixels are decoded. Everything else is
+*   counted and its parameters are ignored.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "Panel_Model.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CMD_NONE    0x00
+#define CMD_CASET   0x2A
+#define CMD_RASET   0x2B
+#define CMD_RAMWR   0x2C
+#define CMD_COLMOD  0x3A
+
+static uint16_t Gram[PANEL_MODEL_RAM_SIZE * PANEL_MODEL_RAM_SIZE];
+
+static struct {
+    uint8_t CS;
+    uint8_t DC;
+    uint8_t Cmd;
+    uint8_t Param_Num;
+    uint8_t Params[4];
+    uint8_t Colmod;
+    uint16_t Xs, Xe, Ys, Ye;
+    uint16_t Xcur, Ycur;
+    uint8_t Pixel_Bytes[3];
+    uint8_t Pixel_Num;
+    uint16_t View_X, View_Y, View_W, View_H;
+} Panel;
+
+static PANEL_MODEL_STATS Stats;
+
+/******************************************************************************
+function:	Clear GRAM, decoder state and statistics
+******************************************************************************/
+void Panel_Model_Reset(void)
+{
+    memset(Gram, 0, sizeof(Gram));
+    memset(&Panel, 0, sizeof(Panel));
+    Panel.CS = 1;
+    Panel.Colmod = 0x05;
+    Panel.Xe = PANEL_MODEL_RAM_SIZE - 1;
+    Panel.Ye = PANEL_MODEL_RAM_SIZE - 1;
+    Panel.View_W = PANEL_MODEL_RAM_SIZE;
+    Panel.View_H = PANEL_MODEL_RAM_SIZE;
+    Panel_Model_ResetStats();
+}
+
+/******************************************************************************
+function:	Select the visible part of GRAM
+parameter:
+    Xoffset, Yoffset : Panel glass origin in controller coordinates,
+                       the same offsets the driver adds in SetWindows
+    Width, Height    : Visible size
+******************************************************************************/
+void Panel_Model_SetView(uint16_t Xoffset, uint16_t Yoffset, uint16_t Width, uint16_t Height)
+{
+    Panel.View_X = Xoffset;
+    Panel.View_Y = Yoffset;
+    Panel.View_W = Width;
+    Panel.View_H = Height;
+}
+
+void Panel_Model_CS(uint8_t Level)
+{
+    if(Panel.CS && !Level)
+        Stats.Transactions++;
+    Panel.CS = Level;
+}
+
+void Panel_Model_DC(uint8_t Level)
+{
+    Panel.DC = Level;
+}
+
+static void Panel_Model_StorePixel(uint16_t Color)
+{
+    if(Panel.Xcur < PANEL_MODEL_RAM_SIZE && Panel.Ycur < PANEL_MODEL_RAM_SIZE) {
+        Gram[Panel.Ycur * PANEL_MODEL_RAM_SIZE + Panel.Xcur] = Color;
+        Stats.Pixels++;
+    }
+
+    // Column first, then wrap to the next row of the window
+    if(Panel.Xcur >= Panel.Xe) {
+        Panel.Xcur = Panel.Xs;
+        Panel.Ycur = (Panel.Ycur >= Panel.Ye) ? Panel.Ys : Panel.Ycur + 1;
+    } else {
+        Panel.Xcur++;
+    }
+}
+
+/******************************************************************************
+function:	Widen a 12-bit pixel to RGB565 by repeating the top bits
+******************************************************************************/
+static uint16_t Panel_Model_Expand444(uint16_t Pixel)
+{
+    uint16_t R = (Pixel >> 8) & 0x0F;
+    uint16_t G = (Pixel >> 4) & 0x0F;
+    uint16_t B = Pixel & 0x0F;
+    R = (R << 1) | (R >> 3);
+    G = (G << 2) | (G >> 2);
+    B = (B << 1) | (B >> 3);
+    return (R << 11) | (G << 5) | B;
+}
+
+static void Panel_Model_Command(uint8_t Cmd)
+{
+    Stats.Commands++;
+    Panel.Cmd = Cmd;
+    Panel.Param_Num = 0;
+    Panel.Pixel_Num = 0;
+    if(Cmd == CMD_RAMWR) {
+        Stats.Windows++;
+        Panel.Xcur = Panel.Xs;
+        Panel.Ycur = Panel.Ys;
+    }
+}
+
+static void Panel_Model_Data(uint8_t Data)
+{
+    Stats.Data_Bytes++;
+    switch(Panel.Cmd) {
+    case CMD_CASET:
+    case CMD_RASET:
+        if(Panel.Param_Num < 4)
+            Panel.Params[Panel.Param_Num++] = Data;
+        if(Panel.Param_Num == 4) {
+            uint16_t Start = (Panel.Params[0] << 8) | Panel.Params[1];
+            uint16_t End = (Panel.Params[2] << 8) | Panel.Params[3];
+            if(Panel.Cmd == CMD_CASET) {
+                Panel.Xs = Start;
+                Panel.Xe = End;
+            } else {
+                Panel.Ys = Start;
+                Panel.Ye = End;
+            }
+            Panel.Param_Num++;
+        }
+        break;
+    case CMD_COLMOD:
+        Panel.Colmod = Data;
+        break;
+    case CMD_RAMWR:
+        Panel.Pixel_Bytes[Panel.Pixel_Num++] = Data;
+        if((Panel.Colmod & 0x07) == 0x03) {
+            // 12-bit/pixel, two pixels in three bytes
+            if(Panel.Pixel_Num == 3) {
+                uint16_t P0 = (Panel.Pixel_Bytes[0] << 4) | (Panel.Pixel_Bytes[1] >> 4);
+                uint16_t P1 = ((Panel.Pixel_Bytes[1] & 0x0F) << 8) | Panel.Pixel_Bytes[2];
+                Panel_Model_StorePixel(Panel_Model_Expand444(P0));
+                Panel_Model_StorePixel(Panel_Model_Expand444(P1));
+                Panel.Pixel_Num = 0;
+            }
+        } else if(Panel.Pixel_Num == 2) {
+            // 16-bit/pixel, MSB first
+            Panel_Model_StorePixel((Panel.Pixel_Bytes[0] << 8) | Panel.Pixel_Bytes[1]);
+            Panel.Pixel_Num = 0;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+function:	Clock bytes into the panel
+parameter:
+    pData : bytes in wire order
+    Len   : number of bytes
+info:
+    Bytes sent while CS is high still count towards Bytes but are not
+    decoded, as on the real controller.
+******************************************************************************/
+void Panel_Model_Write(const uint8_t *pData, uint32_t Len)
+{
+    Stats.Bytes += Len;
+    if(Panel.CS)
+        return;
+
+    for(uint32_t i = 0; i < Len; i++) {
+        if(Panel.DC)
+            Panel_Model_Data(pData[i]);
+        else
+            Panel_Model_Command(pData[i]);
+    }
+}
+
+/******************************************************************************
+function:	Read back a visible pixel as RGB565
+******************************************************************************/
+uint16_t Panel_Model_GetPixel(uint16_t X, uint16_t Y)
+{
+    uint32_t Gx = X + Panel.View_X;
+    uint32_t Gy = Y + Panel.View_Y;
+    if(Gx >= PANEL_MODEL_RAM_SIZE || Gy >= PANEL_MODEL_RAM_SIZE)
+        return 0;
+    return Gram[Gy * PANEL_MODEL_RAM_SIZE + Gx];
+}
+
+void Panel_Model_GetStats(PANEL_MODEL_STATS *pStats)
+{
+    *pStats = Stats;
+}
+
+void Panel_Model_ResetStats(void)
+{
+    memset(&Stats, 0, sizeof(Stats));
+}
+
+/******************************************************************************
+function:	Write the visible area as a binary PPM (P6)
+parameter:
+    Path : output file
+return:
+    0 on success, -1 if the file cannot be written
+******************************************************************************/
+int Panel_Model_DumpPPM(const char *Path)
+{
+    FILE *fp = fopen(Path, "wb");
+    if(fp == NULL) {
+        printf("Panel_Model_DumpPPM: cannot open %s\r\n", Path);
+        return -1;
+    }
+
+    fprintf(fp, "P6\n%d %d\n255\n", Panel.View_W, Panel.View_H);
+    for(uint16_t y = 0; y < Panel.View_H; y++) {
+        for(uint16_t x = 0; x < Panel.View_W; x++) {
+            uint16_t Color = Panel_Model_GetPixel(x, y);
+            uint8_t R = (Color >> 11) & 0x1F;
+            uint8_t G = (Color >> 5) & 0x3F;
+            uint8_t B = Color & 0x1F;
+            uint8_t Rgb[3] = {
+                (uint8_t)((R << 3) | (R >> 2)),
+                (uint8_t)((G << 2) | (G >> 4)),
+                (uint8_t)((B << 3) | (B >> 2)),
+            };
+            fwrite(Rgb, 1, 3, fp);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
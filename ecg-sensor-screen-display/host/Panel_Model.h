@@ -0,0 +1,54 @@
+/*****************************************************************************
+* | File      	:   Panel_Model.h
+* | Function    :   In-memory model of an ST7735/ST7789 style SPI panel
+* | Info        :
+*   The host DEV_Config feeds every DC/CS edge and SPI byte into this model.
+*   It decodes CASET/RASET/RAMWR/COLMOD so the real LCD drivers in lib/LCD
+*   run unchanged, and keeps bus statistics for benchmarking.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#ifndef _PANEL_MODEL_H_
+#define _PANEL_MODEL_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Controller address space, large enough for any MADCTL swap of 240x320
+**/
+#define PANEL_MODEL_RAM_SIZE 320
+
+/**
+ * Bus statistics
+**/
+typedef struct {
+    uint64_t Bytes;          // every byte clocked out on MOSI
+    uint64_t Data_Bytes;     // bytes sent with DC high
+    uint64_t Transactions;   // CS falling edges
+    uint64_t Commands;       // bytes sent with DC low
+    uint64_t Windows;        // RAMWR commands, one per window update
+    uint64_t Pixels;         // pixels stored into GRAM
+} PANEL_MODEL_STATS;
+
+void Panel_Model_Reset(void);
+void Panel_Model_SetView(uint16_t Xoffset, uint16_t Yoffset, uint16_t Width, uint16_t Height);
+
+void Panel_Model_CS(uint8_t Level);
+void Panel_Model_DC(uint8_t Level);
+void Panel_Model_Write(const uint8_t *pData, uint32_t Len);
+
+uint16_t Panel_Model_GetPixel(uint16_t X, uint16_t Y);
+void Panel_Model_GetStats(PANEL_MODEL_STATS *pStats);
+void Panel_Model_ResetStats(void);
+int Panel_Model_DumpPPM(const char *Path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/*****************************************************************************
+* | File      	:   dev_log_test.c
+* | Function    :   Deferred binary log round trip
+* | Info        :
+*   Logs every argument kind DEV_Log encodes (ints of each length, chars,
+*   strings, doubles, '*' width and precision, pointers, %%), interleaves
+*   plain text the way printf would on the USB port, and overflows the ring
+*   once so a drop record appears. The drained bytes go to CAPTURE, and what
+*   printf would have printed goes to EXPECTED; log_decode.py run on this
+*   binary and CAPTURE must reproduce EXPECTED byte for byte.
+*   Also checks that DEV_Log_Read only hands out whole records, and that
+*   Debug() from GUI_Paint (built here with DEV_LOG_DEFERRED) is recorded
+*   instead of printed.
+*
+*   dev_log_test CAPTURE EXPECTED
+******************************************************************************/
+#include "DEV_Log.h"
+#include "GUI_Paint.h"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static FILE *Capture;
+static FILE *Expected;
+
+// The same literal goes to the log and to snprintf
+#define LOG_BOTH(Fmt, ...) do { \
+        DEV_LOG(Fmt, ##__VA_ARGS__); \
+        fprintf(Expected, Fmt, ##__VA_ARGS__); \
+    } while(0)
+
+static void Drain(void)
+{
+    uint8_t Buf[256];
+    uint32_t n;
+    while((n = DEV_Log_Read(0, Buf, sizeof(Buf))) > 0)
+        fwrite(Buf, 1, n, Capture);
+}
+
+static void Text(const char *s)
+{
+    fputs(s, Capture);
+    fputs(s, Expected);
+}
+
+static void Log_Kinds(void)
+{
+    long long Big = -1234567890123LL;
+    const char *Name = "lead II";
+    int Local;
+
+    LOG_BOTH("plain record\r\n");
+    LOG_BOTH("int %d, neg %i, unsigned %u, hex %08x/%X, oct %o\r\n", 42, -7, 3000000000u, 0xBEEFu, 0xABCu, 8);
+    LOG_BOTH("short %hd, char-sized %hhu, char '%c'\r\n", (short)-12, (unsigned char)200, 'Q');
+    LOG_BOTH("long %ld, ulong %lu, llong %lld, size %zu\r\n", -100000L, 4000000000UL, Big, sizeof(Local));
+    LOG_BOTH("double %.3f, exp %e, general %g, padded [%8.2f]\r\n", 3.14159, -0.000123, 1e10, 2.5);
+    LOG_BOTH("string [%s] [%-10s] [%.3s]\r\n", Name, "left", "truncate");
+    LOG_BOTH("star width [%*d] precision [%.*f]\r\n", 6, 99, 2, 1.23456);
+    LOG_BOTH("percent 100%% done\r\n");
+    Drain();
+    Text("plain text from printf between records\r\n");
+    LOG_BOTH("after text %d\r\n", 1);
+    Drain();
+}
+
+// A string longer than DEV_LOG_STR_MAX is cut to its first DEV_LOG_STR_MAX characters
+static void Log_Long_String(void)
+{
+    const char *Long = "0123456789abcdefghijklmnopqrstuvwxyzABCDEF";
+    DEV_LOG("long [%s]\r\n", Long);
+    fprintf(Expected, "long [%.*s]\r\n", DEV_LOG_STR_MAX, Long);
+    Drain();
+}
+
+// Fill the ring without draining; the drop is reported before the records that made it
+static void Log_Overflow(void)
+{
+    int Logged = 0;
+    int i;
+    uint32_t Dropped = DEV_Log_Dropped(0);
+    for(i = 0; i < 1000; i++) {
+        DEV_LOG("fill %d\r\n", i);
+        if(DEV_Log_Dropped(0) == Dropped)
+            Logged++;
+    }
+    Dropped = DEV_Log_Dropped(0) - Dropped;
+    CHECK(Dropped == (uint32_t)(1000 - Logged), "dropped %u, logged %d", Dropped, Logged);
+    CHECK(Logged == DEV_LOG_RING_BYTES / (DEV_LOG_HEADER + 4), "logged %d before the ring filled", Logged);
+    fprintf(Expected, "log: %lu records dropped\r\n", (unsigned long)Dropped);
+    for(i = 0; i < Logged; i++)
+        fprintf(Expected, "fill %d\r\n", i);
+
+    // A small buffer gets whole records only
+    {
+        uint8_t Buf[DEV_LOG_HEADER + 8 + 2 * (DEV_LOG_HEADER + 4) + 5];
+        uint32_t n = DEV_Log_Read(0, Buf, sizeof(Buf));
+        CHECK(n == DEV_LOG_HEADER + 8 + 2 * (DEV_LOG_HEADER + 4), "partial read gave %u bytes", n);
+        fwrite(Buf, 1, n, Capture);
+    }
+    Drain();
+    CHECK(DEV_Log_Read(0, (uint8_t[64]){0}, 64) == 0, "ring not empty after draining");
+}
+
+// An out-of-range point reports through Debug(), one record, nothing printed
+static void Log_Paint_Debug(void)
+{
+    PAINT Surface;
+    memset(&Surface, 0, sizeof(Surface));
+    Surface.Width = 10;
+    Surface.Height = 8;
+    Surface_DrawPoint(&Surface, 20, 3, 0, DOT_PIXEL_1X1, DOT_FILL_AROUND);
+    fprintf(Expected, "Debug: Paint_DrawPoint out of range: x=%d w=%d y=%d h=%d\r\n", 20, 10, 3, 8);
+    Drain();
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 3) {
+        printf("usage: %s CAPTURE EXPECTED\n", argv[0]);
+        return 1;
+    }
+    Capture = fopen(argv[1], "wb");
+    Expected = fopen(argv[2], "wb");
+    if(!Capture || !Expected) {
+        printf("cannot open output files\n");
+        return 1;
+    }
+    Log_Kinds();
+    Log_Long_String();
+    Log_Overflow();
+    Log_Paint_Debug();
+    Text("end\r\n");
+    fclose(Capture);
+    fclose(Expected);
+    if(failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("log capture written\n");
+    return 0;
+}
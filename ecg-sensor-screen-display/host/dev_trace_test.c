@@ -0,0 +1,117 @@
+/*****************************************************************************
+* | File      	:   dev_trace_test.c
+* | Function    :   Trace rings and their chunks
+* | Info        :
+*   Records three frames of nested spans, counters, instants and a span on
+*   the SPI track, with log records and text in between as on the USB
+*   port. Then overflows the ring once, and stops with a span still open.
+*   The drained chunks go to CAPTURE. trace_export.py on this binary and
+*   CAPTURE must find 1050 events on 2 tracks, 10 spans and 10 drops.
+*   Also checks the chunk header, that a chunk only carries whole
+*   events, and that nothing is recorded while tracing is off.
+*
+*   dev_trace_test CAPTURE
+******************************************************************************/
+#include "DEV_Trace.h"
+#include "DEV_Log.h"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static FILE *Capture;
+
+static void Drain(void)
+{
+    uint8_t Buf[512];
+    uint32_t n;
+    while((n = DEV_Trace_Read(0, Buf, sizeof(Buf))) > 0)
+        fwrite(Buf, 1, n, Capture);
+    while((n = DEV_Log_Read(0, Buf, sizeof(Buf))) > 0)
+        fwrite(Buf, 1, n, Capture);
+}
+
+static void Trace_Off(void)
+{
+    uint8_t Buf[64];
+    DEV_TRACE_INSTANT("never");
+    CHECK(DEV_Trace_Read(0, Buf, sizeof(Buf)) == 0, "recorded while tracing was off");
+}
+
+// 1 + 3 * 8 events, 9 spans
+static void Trace_Frames(void)
+{
+    int i;
+    DEV_Trace_Enable(1);
+    for(i = 0; i < 3; i++) {
+        DEV_TRACE_BEGIN("frame");
+        DEV_TRACE_BEGIN("filter");
+        DEV_TRACE_COUNTER("pool free", 4 - i);
+        DEV_TRACE_END("filter");
+        DEV_TRACE_INSTANT("beat");
+        DEV_TRACE_BEGIN_ON(DEV_TRACE_TRACK_SPI, "spi xfer");
+        DEV_TRACE_END("frame");
+        DEV_TRACE_END_ON(DEV_TRACE_TRACK_SPI, "spi xfer");
+        DEV_LOG("frame %d\r\n", i);
+        Drain();
+        fputs("text between chunks\r\n", Capture);
+    }
+}
+
+// DEV_TRACE_EVENTS kept, 10 dropped, reported in the first chunk after
+static void Trace_Overflow(void)
+{
+    uint8_t Buf[DEV_TRACE_HEADER + 3 * sizeof(DEV_TRACE_REC) + 5];
+    uint32_t Dropped = DEV_Trace_Dropped(0);
+    uint32_t Count, Lost, n;
+    int i;
+
+    for(i = 0; i < DEV_TRACE_EVENTS + 10; i++)
+        DEV_TRACE_INSTANT("fill");
+    CHECK(DEV_Trace_Dropped(0) - Dropped == 10, "dropped %u", DEV_Trace_Dropped(0) - Dropped);
+
+    n = DEV_Trace_Read(0, Buf, sizeof(Buf));
+    CHECK(n == DEV_TRACE_HEADER + 3 * sizeof(DEV_TRACE_REC), "partial read gave %u bytes", n);
+    Count = Buf[2] | (Buf[3] << 8);
+    memcpy(&Lost, Buf + 4, 4);
+    CHECK(Buf[0] == DEV_TRACE_SYNC && Buf[1] == 0 && Count == 3 && Lost == 10,
+          "chunk header %02x %u %u %u", Buf[0], Buf[1], Count, Lost);
+    fwrite(Buf, 1, n, Capture);
+    Drain();
+
+    n = DEV_Trace_Read(0, Buf, sizeof(Buf));
+    CHECK(n == 0, "ring not empty after draining");
+}
+
+// trace_export.py closes it at the last event
+static void Trace_Stop_Open(void)
+{
+    DEV_TRACE_BEGIN("open at stop");
+    DEV_Trace_Enable(0);
+    Drain();
+    Trace_Off();
+}
+
+int main(int argc, char **argv)
+{
+    if(argc != 2) {
+        printf("usage: %s CAPTURE\n", argv[0]);
+        return 1;
+    }
+    Capture = fopen(argv[1], "wb");
+    if(!Capture) {
+        printf("cannot open %s\n", argv[1]);
+        return 1;
+    }
+    Trace_Off();
+    Trace_Frames();
+    Trace_Overflow();
+    Trace_Stop_Open();
+    fclose(Capture);
+    if(failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("trace capture written\n");
+    return 0;
+}
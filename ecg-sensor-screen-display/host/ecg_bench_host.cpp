@@ -0,0 +1,66 @@
+/**
+ * Host run of the micro-benchmark kernels
+ * Runs the kernels registered in ecg_bench_kernels.cpp, the same ones the
+ * ecg-bench firmware runs, and prints the same lines. Counts are
+ * nanoseconds. SPI kernels talk to the panel model, so they time the
+ * driver, not a bus. Useful for checking that a change helps at all
+ * before measuring cycles on the board, and for comparing runs:
+ *
+ *   ecg_bench_host --output before.txt
+ *   (change, rebuild)
+ *   ecg_bench_host --output after.txt
+ *   python3 lib/Config/bench_compare.py before.txt after.txt
+ *
+ * usage: ecg_bench_host [--runs N] [--filter TEXT] [--output FILE]
+ */
+
+#include "ecg_bench.hpp"
+extern "C" {
+#include "DEV_Config.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nothing interrupts the kernels on the host
+static uint32_t host_quiet_begin() {
+    return 0;
+}
+
+static void host_quiet_end(uint32_t saved) {
+    (void)saved;
+}
+
+int main(int argc, char **argv) {
+    uint32_t runs = 31;
+    const char *filter = NULL;
+    const char *output = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            printf("usage: %s [--runs N] [--filter TEXT] [--output FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (out == NULL) {
+        printf("cannot open %s\n", output);
+        return 1;
+    }
+
+    DEV_Module_Init();
+    EcgBenchEnv env = {DEV_Cycle_Count, host_quiet_begin, host_quiet_end};
+    ecg_bench_print_meta(out, "ns", 0, runs);
+    int ran = ecg_bench_all(out, env, runs, filter);
+    if (output) {
+        fclose(out);
+        printf("%d kernels written to %s\n", ran, output);
+    }
+    return ran > 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * Reference-counted block pool test
+ * Single-threaded checks first: allocation until the pool is empty, the
+ * exhaustion and low-water counters, a block surviving until its last
+ * reference is dropped, and the CRC catching a changed sample.
+ * Then a producer thread stamps blocks and fans each one out to three
+ * consumer threads through SPSC queues, as the DMA interrupt would to the
+ * display, a recorder and the USB streamer. Consumers check sequence,
+ * contents and CRC and drop their reference; every block must come back.
+ * Exits 1 on the first error.
+ *
+ * usage: ecg_block_pool_test [--blocks N]
+ */
+
+#include "ecg_block_pool.hpp"
+#include "ecg_block_queue.hpp"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define POOL_BLOCKS 8
+#define BLOCK_SETS  10
+#define LEADS_MASK  0x3     // 两个导联
+#define CONSUMERS   3
+
+static uint16_t payload[POOL_BLOCKS][BLOCK_SETS * 2];
+static EcgSampleBlock blocks[POOL_BLOCKS];
+static EcgBlockPool pool;
+static EcgBlockQueue<EcgSampleBlock *, POOL_BLOCKS> queues[CONSUMERS];
+
+static void fill(EcgSampleBlock *block, uint32_t seq) {
+    block->sets = BLOCK_SETS;
+    block->seq = seq;
+    block->oldest_us = (uint64_t)seq * 10000;
+    block->channel_mask = LEADS_MASK;
+    for (uint32_t i = 0; i < ecg_block_samples(block); i++) {
+        block->samples[i] = (uint16_t)(seq * 31 + i);
+    }
+    ecg_block_seal(block);
+}
+
+// 分配到池空、计数、引用计数归还和 CRC
+static void check_single() {
+    ecg_block_pool_init(pool, blocks, POOL_BLOCKS, payload[0], BLOCK_SETS * 2);
+    EcgSampleBlock *taken[POOL_BLOCKS];
+    for (int i = 0; i < POOL_BLOCKS; i++) {
+        taken[i] = ecg_block_alloc(pool);
+        CHECK(taken[i] != nullptr && taken[i]->refs.load() == 1, "alloc %d", i);
+    }
+    CHECK(ecg_block_alloc(pool) == nullptr && ecg_block_alloc(pool) == nullptr, "empty pool gave a block");
+    CHECK(pool.exhausted.load() == 2, "exhausted %u, expected 2", pool.exhausted.load());
+    CHECK(pool.low_water.load() == 0, "low water %u, expected 0", pool.low_water.load());
+    for (int i = 0; i < POOL_BLOCKS; i++) {
+        for (int j = 0; j < i; j++) {
+            CHECK(taken[i]->samples != taken[j]->samples, "blocks %d and %d share a payload", i, j);
+        }
+    }
+
+    // 三个引用：放掉两个时块还在用，第三个放掉后回到池里
+    EcgSampleBlock *b = taken[3];
+    fill(b, 7);
+    ecg_block_ref(b, 2);
+    ecg_block_release(b);
+    ecg_block_release(b);
+    CHECK(ecg_block_pool_free(pool) == 0, "block freed with a reference left");
+    CHECK(ecg_block_intact(b), "sealed block fails its CRC");
+    b->samples[5] ^= 0x0100;
+    CHECK(!ecg_block_intact(b), "changed sample passes the CRC");
+    CHECK(~ecg_crc32_update(0xFFFFFFFFu, "123456789", 9) == 0xCBF43926u, "CRC-32 check value");
+    ecg_block_release(b);
+    CHECK(ecg_block_pool_free(pool) == 1, "%u free after last release", ecg_block_pool_free(pool));
+    CHECK(ecg_block_alloc(pool) == b && b->seq == 0 && b->flags == 0, "freed block not reused clean");
+
+    for (int i = 0; i < POOL_BLOCKS; i++) {
+        ecg_block_release(taken[i]);
+    }
+    CHECK(ecg_block_pool_free(pool) == POOL_BLOCKS, "%u free at the end", ecg_block_pool_free(pool));
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = 500000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--blocks") == 0 && i + 1 < argc) {
+            count = (uint32_t)atol(argv[++i]);
+        } else {
+            printf("usage: %s [--blocks N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    check_single();
+    if (failures != 0) {
+        return 1;
+    }
+
+    ecg_block_pool_init(pool, blocks, POOL_BLOCKS, payload[0], BLOCK_SETS * 2);
+
+    // 生产者：池空时计数后重试，和 DMA 中断原地重写不同，这里每块都要送到
+    std::thread producer([count] {
+        for (uint32_t seq = 0; seq < count; seq++) {
+            EcgSampleBlock *block;
+            while ((block = ecg_block_alloc(pool)) == nullptr) {
+                std::this_thread::yield();
+            }
+            fill(block, seq);
+            ecg_block_ref(block, CONSUMERS - 1);
+            for (int c = 0; c < CONSUMERS; c++) {
+                while (!queues[c].push(block)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    // 消费者：检查顺序、内容和 CRC，放掉引用
+    uint32_t errors[CONSUMERS] = {};
+    std::thread consumers[CONSUMERS];
+    for (int c = 0; c < CONSUMERS; c++) {
+        consumers[c] = std::thread([c, count, &errors] {
+            for (uint32_t seq = 0; seq < count; seq++) {
+                EcgSampleBlock *block;
+                while (!queues[c].pop(block)) {
+                    std::this_thread::yield();
+                }
+                bool ok = block->seq == seq && block->oldest_us == (uint64_t)seq * 10000 &&
+                          ecg_block_samples(block) == BLOCK_SETS * 2 && ecg_block_intact(block);
+                for (uint32_t i = 0; ok && i < ecg_block_samples(block); i++) {
+                    ok = block->samples[i] == (uint16_t)(seq * 31 + i);
+                }
+                if (!ok && errors[c]++ == 0) {
+                    printf("FAIL: consumer %d got block %u as %u with bad contents\n", c, seq, block->seq);
+                }
+                ecg_block_release(block);
+            }
+        });
+    }
+    producer.join();
+    for (int c = 0; c < CONSUMERS; c++) {
+        consumers[c].join();
+        CHECK(errors[c] == 0, "consumer %d: %u bad blocks of %u", c, errors[c], count);
+    }
+    CHECK(ecg_block_pool_free(pool) == POOL_BLOCKS, "%u of %d blocks returned", ecg_block_pool_free(pool), POOL_BLOCKS);
+    if (failures != 0) {
+        return 1;
+    }
+    printf("%u blocks to %d consumers, %d buffers, pool empty %u times\n",
+           count, CONSUMERS, POOL_BLOCKS, pool.exhausted.load());
+    return 0;
+}
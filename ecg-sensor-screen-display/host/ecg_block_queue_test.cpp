@@ -0,0 +1,125 @@
+/**
+ * SPSC block queue stress test
+ * A producer thread fills blocks from a fixed pool and publishes them, as
+ * capture does on core 0; a consumer thread takes them, checks every sample
+ * and hands the block back through a second queue, as the render core does.
+ * Blocks must arrive in order, with the contents written before they were
+ * published, and every block must come back. Exits 1 on the first error.
+ *
+ * usage: ecg_block_queue_test [--blocks N]
+ */
+
+#include "ecg_block_queue.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define POOL_BLOCKS 8
+#define BLOCK_SETS  10
+
+// 按值交接的块描述符
+struct TestBlock {
+    uint16_t *samples;
+    uint16_t sets;
+    uint64_t oldest_us;
+};
+
+static uint16_t pool[POOL_BLOCKS][BLOCK_SETS];
+static EcgBlockQueue<TestBlock, POOL_BLOCKS> filled;
+static EcgBlockQueue<TestBlock, POOL_BLOCKS> free_blocks;
+
+// 队列空、满和回绕，单线程
+static bool check_bounds() {
+    EcgBlockQueue<uint32_t, 4> q;
+    uint32_t v = 0;
+    if (!q.empty() || q.pop(v)) {
+        return false;
+    }
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            if (!q.push(round * 4 + i)) {
+                return false;
+            }
+        }
+        if (q.push(99) || q.size() != 4) {
+            return false;
+        }
+        for (uint32_t i = 0; i < 4; i++) {
+            if (!q.pop(v) || v != round * 4 + i) {
+                return false;
+            }
+        }
+    }
+    return q.empty();
+}
+
+int main(int argc, char **argv) {
+    uint32_t blocks = 2000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--blocks") == 0 && i + 1 < argc) {
+            blocks = (uint32_t)atol(argv[++i]);
+        } else {
+            printf("usage: %s [--blocks N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!check_bounds()) {
+        printf("FAIL: empty/full/wrap-around\n");
+        return 1;
+    }
+
+    for (int i = 0; i < POOL_BLOCKS; i++) {
+        free_blocks.push({pool[i], 0, 0});
+    }
+
+    // 生产者：取一块空闲缓冲，按序号写满后发布
+    std::thread producer([blocks] {
+        for (uint32_t seq = 0; seq < blocks; seq++) {
+            TestBlock block;
+            while (!free_blocks.pop(block)) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < BLOCK_SETS; i++) {
+                block.samples[i] = (uint16_t)(seq * BLOCK_SETS + i);
+            }
+            block.sets = BLOCK_SETS;
+            block.oldest_us = seq;
+            while (!filled.push(block)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // 消费者：检查顺序和内容，再把缓冲还回去
+    uint32_t errors = 0;
+    for (uint32_t seq = 0; seq < blocks; seq++) {
+        TestBlock block;
+        while (!filled.pop(block)) {
+            std::this_thread::yield();
+        }
+        bool ok = block.oldest_us == seq && block.sets == BLOCK_SETS &&
+                  block.samples >= pool[0] && block.samples <= pool[POOL_BLOCKS - 1];
+        for (int i = 0; ok && i < BLOCK_SETS; i++) {
+            ok = block.samples[i] == (uint16_t)(seq * BLOCK_SETS + i);
+        }
+        if (!ok && errors++ == 0) {
+            printf("FAIL: block %u arrived as %llu with bad contents\n", seq, (unsigned long long)block.oldest_us);
+        }
+        free_blocks.push(block);
+    }
+    producer.join();
+
+    if (free_blocks.size() != POOL_BLOCKS || !filled.empty()) {
+        printf("FAIL: %u of %d blocks returned\n", free_blocks.size(), POOL_BLOCKS);
+        return 1;
+    }
+    if (errors != 0) {
+        printf("FAIL: %u bad blocks of %u\n", errors, blocks);
+        return 1;
+    }
+    printf("%u blocks handed over, %d buffers\n", blocks, POOL_BLOCKS);
+    return 0;
+}
@@ -0,0 +1,314 @@
+/**
+ * Capture the device's USB output to a CSV file
+ * Reads the serial port in raw mode, in large reads, and decodes sample
+ * frames ('s' on the serial console turns them on) as well as the CSV
+ * lines of examples/adc_dma_capture. The CSV goes to disk through a
+ * writer thread, so a slow disk does not hold up the port. Replaces
+ * data_process/serial-capture.py, whose per-line read and flush could not
+ * keep up with more than a few hundred lines per second.
+ *
+ * The output keeps the old format (a comment line, then
+ * "Time(ms),Voltage(V)"), so data_process/ecg-plot.py reads it unchanged.
+ * Frames with more than one lead get one column per lead. Other text is
+ * echoed to stderr. Log records and trace chunks can be saved raw with
+ * --log for log_decode.py and trace_export.py.
+ *
+ *   ecg_capture --send s --seconds 60
+ *   ecg_capture --input capture.bin --output capture.csv
+ *
+ * usage: ecg_capture [--device TTY] [--input FILE|-] [--output FILE] [--log FILE]
+ *                    [--send TEXT] [--seconds N] [--rate HZ] [--quiet]
+ */
+
+#include "ecg_receiver.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CAPTURE_READ_BYTES  65536
+#define CAPTURE_MV_FULL     3300        // ADC 满量程 3.3 V，12 位
+#define CAPTURE_STATUS_S    5
+
+struct Capture {
+    EcgRxWriter out;
+    EcgRxWriter log;
+    bool logging;
+    bool quiet;
+    uint32_t period_us;
+    bool have_t0;
+    uint64_t t0_us;
+    uint32_t header_leads;              // 表头写的导联数，0 表示还没写
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static double now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static char *put_u64(char *p, uint64_t v) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+// 千分之一为单位的数写成三位小数；每个采样都要写，不用 printf
+static char *put_milli(char *p, uint64_t milli) {
+    p = put_u64(p, milli / 1000);
+    uint32_t frac = (uint32_t)(milli % 1000);
+    p[0] = '.';
+    p[1] = (char)('0' + frac / 100);
+    p[2] = (char)('0' + frac / 10 % 10);
+    p[3] = (char)('0' + frac % 10);
+    return p + 4;
+}
+
+static void write_header(Capture &cap, uint32_t leads) {
+    char line[128];
+    int n = snprintf(line, sizeof(line), "Time(ms),Voltage(V)");
+    for (uint32_t lead = 2; lead <= leads && n < 100; lead++) {
+        n += snprintf(line + n, sizeof(line) - n, ",Lead%u(V)", lead);
+    }
+    line[n++] = '\n';
+    ecg_rx_writer_write(cap.out, line, (size_t)n);
+    cap.header_leads = leads;
+}
+
+static void on_frame(void *ctx, const EcgStreamFrame &frame) {
+    Capture &cap = *(Capture *)ctx;
+    uint32_t leads = ecg_stream_leads(frame);
+    if (cap.header_leads != leads) {
+        write_header(cap, leads);
+    }
+    // 时间从第一帧算起；设备重启后时钟倒退，重新算
+    if (!cap.have_t0 || frame.oldest_us < cap.t0_us) {
+        cap.t0_us = frame.oldest_us;
+        cap.have_t0 = true;
+    }
+    // 一组最多：时间 20 位整数 + 4，每个导联 ",3.300"
+    char *start = ecg_rx_writer_reserve(cap.out, frame.sets * (25 + 6 * leads));
+    char *p = start;
+    const uint8_t *s = frame.samples;
+    uint64_t us = frame.oldest_us - cap.t0_us;
+    for (uint32_t set = 0; set < frame.sets; set++, us += cap.period_us) {
+        p = put_milli(p, us);
+        for (uint32_t lead = 0; lead < leads; lead++, s += 2) {
+            uint32_t raw = (uint32_t)(s[0] | (s[1] << 8)) & 0xFFF;
+            *p++ = ',';
+            p = put_milli(p, (raw * CAPTURE_MV_FULL + 2048) / 4096);
+        }
+        *p++ = '\n';
+    }
+    ecg_rx_writer_commit(cap.out, (size_t)(p - start));
+}
+
+static void on_csv(void *ctx, const char *line, size_t len, double time_ms) {
+    Capture &cap = *(Capture *)ctx;
+    (void)time_ms;
+    if (cap.header_leads == 0) {
+        write_header(cap, 1);
+    }
+    char *p = ecg_rx_writer_reserve(cap.out, len + 1);
+    memcpy(p, line, len);
+    p[len] = '\n';
+    ecg_rx_writer_commit(cap.out, len + 1);
+}
+
+static void on_text(void *ctx, const char *line, size_t len) {
+    Capture &cap = *(Capture *)ctx;
+    if (!cap.quiet) {
+        fprintf(stderr, "%.*s\n", (int)len, line);
+    }
+}
+
+static void on_binary(void *ctx, const uint8_t *data, size_t len) {
+    Capture &cap = *(Capture *)ctx;
+    if (cap.logging) {
+        ecg_rx_writer_write(cap.log, data, len);
+    }
+}
+
+static void print_stats(FILE *out, const EcgRxStats &st, double seconds) {
+    fprintf(out, "capture: %llu sets (%llu frames, %llu csv lines), %llu gaps (%llu sets missing), %llu restarts, "
+            "%llu crc errors, %llu bytes skipped in %llu resyncs, %llu text lines, %llu log records, %llu trace chunks\n",
+            (unsigned long long)st.sets, (unsigned long long)st.frames, (unsigned long long)st.csv_lines,
+            (unsigned long long)st.gaps, (unsigned long long)st.missing, (unsigned long long)st.restarts,
+            (unsigned long long)st.crc_errors, (unsigned long long)st.skipped, (unsigned long long)st.resyncs,
+            (unsigned long long)st.text_lines, (unsigned long long)st.log_records,
+            (unsigned long long)st.trace_chunks);
+    seconds = seconds > 1e-6 ? seconds : 1e-6;
+    fprintf(out, "capture: %.1f MB in %.2f s, %.2f MB/s, %.0f sets/s\n",
+            st.bytes / 1e6, seconds, st.bytes / 1e6 / seconds, st.sets / seconds);
+}
+
+static int open_output(const char *path) {
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+}
+
+int main(int argc, char **argv) {
+    const char *device = "/dev/ttyACM0";
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *log = NULL;
+    const char *send = NULL;
+    double seconds = 0;
+    uint32_t rate = 1000;
+    bool quiet = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            device = argv[++i];
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log = argv[++i];
+        } else if (strcmp(argv[i], "--send") == 0 && i + 1 < argc) {
+            send = argv[++i];
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            printf("usage: %s [--device TTY] [--input FILE|-] [--output FILE] [--log FILE]\n"
+                   "       [--send TEXT] [--seconds N] [--rate HZ] [--quiet]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const char *source = input ? input : device;
+    int fd;
+    if (input) {
+        fd = strcmp(input, "-") == 0 ? STDIN_FILENO : open(input, O_RDONLY | O_CLOEXEC);
+    } else {
+        fd = ecg_rx_open_tty(device, 115200, send != NULL);
+    }
+    if (fd < 0) {
+        printf("cannot open %s: %s\n", source, strerror(errno));
+        return 1;
+    }
+    char name[64];
+    if (output == NULL) {
+        time_t now = time(NULL);
+        strftime(name, sizeof(name), "ecg_capture_%Y%m%d_%H%M%S.csv", localtime(&now));
+        output = name;
+    }
+
+    static Capture cap;
+    cap.quiet = quiet;
+    cap.period_us = rate ? 1000000 / rate : 1000;
+    int out_fd = open_output(output);
+    if (out_fd < 0) {
+        printf("cannot open %s: %s\n", output, strerror(errno));
+        return 1;
+    }
+    ecg_rx_writer_open(cap.out, out_fd);
+    if (log) {
+        int log_fd = open_output(log);
+        if (log_fd < 0) {
+            printf("cannot open %s: %s\n", log, strerror(errno));
+            return 1;
+        }
+        ecg_rx_writer_open(cap.log, log_fd);
+        cap.logging = true;
+    }
+    // ecg-plot.py 跳过第一行
+    char comment[256];
+    time_t started = time(NULL);
+    int n = snprintf(comment, sizeof(comment), "# ecg_capture %s %s", source, ctime(&started));
+    ecg_rx_writer_write(cap.out, comment, (size_t)n);
+
+    static EcgRxDecoder rx;
+    EcgRxSink sink = {&cap, on_frame, on_csv, on_text, on_binary};
+    ecg_rx_init(rx, sink, rate);
+
+    // 不用 SA_RESTART：Ctrl+C 要能打断 poll 和 read
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (send && write(fd, send, strlen(send)) < 0) {
+        printf("cannot write to %s: %s\n", source, strerror(errno));
+    }
+    if (!quiet) {
+        fprintf(stderr, "capturing %s to %s, Ctrl+C to stop\n", source, output);
+    }
+
+    static uint8_t buf[CAPTURE_READ_BYTES];
+    double start = now_s(), status = start + CAPTURE_STATUS_S;
+    int status_code = 0;
+    while (!stop) {
+        double now = now_s();
+        if (seconds > 0 && now - start >= seconds) {
+            break;
+        }
+        if (!quiet && !input && now >= status) {
+            print_stats(stderr, rx.stats, now - start);
+            status = now + CAPTURE_STATUS_S;
+        }
+        if (!input) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 200) <= 0) {
+                continue;
+            }
+        }
+        ssize_t got = read(fd, buf, sizeof(buf));
+        if (got == 0) {
+            break;
+        }
+        if (got < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            printf("read %s: %s\n", source, strerror(errno));
+            status_code = 1;
+            break;
+        }
+        ecg_rx_feed(rx, buf, (size_t)got);
+    }
+    ecg_rx_finish(rx);
+    double elapsed = now_s() - start;
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+
+    uint64_t stalls = cap.out.stalls;
+    int error = ecg_rx_writer_close(cap.out);
+    if (error) {
+        printf("write %s: %s\n", output, strerror(error));
+        status_code = 1;
+    }
+    if (cap.logging && (error = ecg_rx_writer_close(cap.log)) != 0) {
+        printf("write %s: %s\n", log, strerror(error));
+        status_code = 1;
+    }
+    print_stats(stdout, rx.stats, elapsed);
+    printf("capture: %llu sets written to %s, %llu disk stalls\n",
+           (unsigned long long)rx.stats.sets, output, (unsigned long long)stalls);
+    return status_code;
+}
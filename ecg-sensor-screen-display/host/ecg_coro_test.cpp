@@ -0,0 +1,195 @@
+/**
+ * Coroutine runtime check
+ * Runs coroutines on the event loop with a virtual clock: delays, signals
+ * raised by scripted "interrupts", signal timeouts, SPI transfers through
+ * the host bus model, and the frame pool running out and refilling. Then
+ * times the suspend/resume round trip on the host clock.
+ * Exits 1 on the first failure.
+ *
+ * usage: ecg_coro_test
+ */
+
+#include "ecg_coro.hpp"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+static uint64_t clock_us;
+static uint64_t virtual_clock() {
+    return clock_us;
+}
+
+// 脚本化的中断：时钟走到 at_us 时置位信号
+struct HostIrq {
+    uint64_t at_us;
+    EcgSignal *signal;
+};
+static HostIrq irqs[16];
+static int irq_count, irq_next;
+
+static void virtual_idle(EcgScheduler &sched, uint64_t until_us) {
+    if (sched.pending.load() != 0) {
+        return;
+    }
+    uint64_t wake = until_us;
+    if (irq_next < irq_count && irqs[irq_next].at_us < wake) {
+        wake = irqs[irq_next].at_us;
+    }
+    clock_us = wake;
+    while (irq_next < irq_count && irqs[irq_next].at_us <= clock_us) {
+        ecg_signal_raise(*irqs[irq_next++].signal);
+    }
+}
+
+static EcgScheduler sched;
+
+// 协程记录自己恢复的顺序和时刻
+static char order[64];
+static uint64_t times[64];
+static int order_len;
+
+static void mark(char id) {
+    if (order_len < 63) {
+        times[order_len] = clock_us;
+        order[order_len++] = id;
+        order[order_len] = 0;
+    }
+}
+
+static void reset() {
+    clock_us = 1000;
+    irq_count = irq_next = 0;
+    order_len = 0;
+    order[0] = 0;
+}
+
+static EcgCoro ticker(char id, uint32_t period_us, int count) {
+    for (int i = 0; i < count; i++) {
+        co_await ecg_delay_us(period_us);
+        mark(id);
+    }
+}
+
+// 两个定时协程交错运行，时刻准确，结束后帧还给池
+static void test_delay() {
+    reset();
+    CHECK((bool)ticker('a', 3000, 3), "ticker a not created");
+    CHECK((bool)ticker('b', 5000, 2), "ticker b not created");
+    CHECK(ecg_coro_live() == 2, "%d live, expected 2", ecg_coro_live());
+    ecg_sched_run_until(sched, 20000);
+    CHECK(strcmp(order, "abaab") == 0, "order %s, expected abaab", order);
+    CHECK(times[0] == 4000 && times[1] == 6000 && times[4] == 11000, "times %llu %llu %llu",
+          (unsigned long long)times[0], (unsigned long long)times[1], (unsigned long long)times[4]);
+    CHECK(ecg_coro_live() == 0, "%d live after finishing", ecg_coro_live());
+}
+
+static EcgSignal sig_a, sig_b;
+
+static EcgCoro waiter(char id, EcgSignal &signal, uint64_t timeout_us, int count) {
+    for (int i = 0; i < count; i++) {
+        bool signaled = co_await ecg_wait(signal, clock_us + timeout_us);
+        mark(signaled ? id : '-');
+    }
+}
+
+// 中断置位的信号唤醒等待者；超时返回 false；没人等时置位的信号留到下次 co_await
+static void test_signal() {
+    reset();
+    irqs[irq_count++] = {2000, &sig_a};
+    irqs[irq_count++] = {2500, &sig_b};
+    irqs[irq_count++] = {9000, &sig_a};
+    waiter('a', sig_a, 4000, 3);    // 2000 信号，6000 超时，9000 信号
+    waiter('b', sig_b, 100000, 1);
+    ecg_sched_run_until(sched, 20000);
+    CHECK(strcmp(order, "ab-a") == 0, "order %s, expected ab-a", order);
+    CHECK(times[2] == 6000 && times[3] == 9000, "timeout at %llu, signal at %llu",
+          (unsigned long long)times[2], (unsigned long long)times[3]);
+
+    reset();
+    ecg_signal_raise(sig_a);
+    waiter('a', sig_a, 1000, 1);
+    ecg_sched_run_until(sched, 5000);
+    CHECK(strcmp(order, "a") == 0 && times[0] == 1000, "early signal gave %s at %llu",
+          order, (unsigned long long)times[0]);
+}
+
+static UBYTE xfer_bytes[16];
+static UBYTE xfer_status[2];
+
+static EcgCoro sender(DEV_XFER &good, DEV_XFER &bad) {
+    xfer_status[0] = co_await ecg_xfer(good);
+    xfer_status[1] = co_await ecg_xfer(bad);
+    mark('x');
+}
+
+// 主机上传输在提交时同步完成，回调先于挂起；被拒绝的传输不挂起，直接返回错误
+static void test_xfer() {
+    reset();
+    DEV_XFER good = {};
+    good.Bus = DEV_BUS_SPI;
+    good.Cs = DEV_XFER_PIN_KEEP;
+    good.Dc = DEV_XFER_PIN_KEEP;
+    good.pTx = xfer_bytes;
+    good.Tx_Len = sizeof(xfer_bytes);
+    DEV_XFER bad = good;
+    bad.Bus = DEV_BUS_COUNT;
+    sender(good, bad);
+    ecg_sched_run_until(sched, 5000);
+    CHECK(strcmp(order, "x") == 0, "sender did not finish: %s", order);
+    CHECK(xfer_status[0] == DEV_XFER_DONE, "good transfer status %d", xfer_status[0]);
+    CHECK(xfer_status[1] == DEV_XFER_ERROR, "bad transfer status %d", xfer_status[1]);
+}
+
+static EcgSignal sig_release;
+
+static EcgCoro parked() {
+    co_await sig_release;
+    mark('p');
+}
+
+// 池满时协程函数返回空对象；结束的协程把帧还回来
+static void test_pool() {
+    reset();
+    int made = 0;
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        made += (bool)parked();
+    }
+    CHECK(made == ECG_CORO_MAX, "made %d of %d", made, ECG_CORO_MAX);
+    CHECK(!parked(), "pool should be exhausted");
+    ecg_sched_run_until(sched, 2000);
+    ecg_signal_raise(sig_release);
+    ecg_sched_run_until(sched, 3000);
+    CHECK(ecg_coro_live() == ECG_CORO_MAX - 1, "%d live after one release", ecg_coro_live());
+    CHECK((bool)parked(), "freed frame not reused");
+    for (int i = 0; i < ECG_CORO_MAX; i++) {
+        ecg_signal_raise(sig_release);
+        ecg_sched_run_until(sched, 4000 + i);
+    }
+    CHECK(ecg_coro_live() == 0, "%d live after releasing all", ecg_coro_live());
+}
+
+static uint32_t host_ns() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    ecg_sched_init(sched, virtual_clock, virtual_idle);
+    ecg_coro_attach(sched, 1u << 0);
+    test_delay();
+    test_signal();
+    test_xfer();
+    test_pool();
+
+    uint32_t ns = ecg_coro_bench(host_ns, 100000);
+    CHECK(ns != 0 && ecg_coro_live() == 0, "bench gave %u ns, %d live", ns, ecg_coro_live());
+    printf("coroutine switch: %u ns\n", ns);
+    if (failures != 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("coro ok\n");
+    return 0;
+}
@@ -0,0 +1,272 @@
+/**
+ * Host driver for the ECG render path
+ * Feeds a synthetic ECG into the render path on Linux as a 1 kHz ADC would,
+ * with the LCD driver talking to the in-memory panel model. Prints update
+ * timing, bus statistics and sample-to-photon latency and can dump the
+ * last frame as PPM, so the render path can be profiled (perf, valgrind,
+ * ...) without a board.
+ *
+ * usage: ecg_display_host [--panel NAME] [--frames N] [--ppm out.ppm]
+ *                         [--rgb565] [--render framebuffer|list|layers]
+ *                         [--key FRAME:in|out|back|forward ...]
+ *                         [--chunk N] [--max-latency-ms N]
+ *                         [--leads N] [--overlay]
+ *
+ * A frame is CAPTURE_DEPTH samples (2.5 s), the display is updated every
+ * --chunk samples (default ECG_CHUNK_SAMPLES) or as soon as it can when an
+ * update took longer than that.
+ * Stage latency histograms (filter, detect, render, push) are summarised
+ * at the end as the firmware prints them on h.
+ * --rgb565 keeps 16-bit transfers on panels that support 12-bit mode.
+ * --render picks the render path on panels that can take bands; panels
+ * that cannot always use the frame buffer.
+ * --key holds a board key down during frame FRAME, e.g. --key 3:back pans
+ * the history view back half a screen at the start of frame 3.
+ * --max-latency-ms fails the run if any update exceeded that latency.
+ * --leads feeds 2 or 3 leads (scaled, slightly delayed copies of the same
+ * ECG), stacked unless --overlay is given.
+ */
+
+#include "ecg_display.hpp"
+#include "Panel_Model.h"
+
+#include <pico/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+
+static uint16_t capture_buf[CAPTURE_DEPTH * ECG_MAX_LEADS];
+
+#define HOST_MAX_KEYS 32
+
+struct HostKey {
+    int frame;
+    UWORD pin;
+};
+
+static bool parse_key(const char *arg, HostKey &key) {
+    static const struct { const char *name; UWORD pin; } names[] = {
+        {"in", ECG_KEY_ZOOM_IN}, {"out", ECG_KEY_ZOOM_OUT},
+        {"back", ECG_KEY_PAN_BACK}, {"forward", ECG_KEY_PAN_FORWARD},
+    };
+    const char *colon = strchr(arg, ':');
+    if (colon == NULL) {
+        return false;
+    }
+    key.frame = atoi(arg);
+    for (const auto &n : names) {
+        if (strcmp(colon + 1, n.name) == 0) {
+            key.pin = n.pin;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 合成心电信号：P 波、QRS 波群和 T 波的高斯叠加，72 BPM
+static float synthetic_ecg(float t) {
+    const float period = 60.0f / 72.0f;
+    float phase = fmodf(t, period) / period;
+    auto wave = [phase](float centre, float width, float height) {
+        float d = (phase - centre) / width;
+        return height * expf(-d * d);
+    };
+    return 1.5f
+        + wave(0.20f, 0.025f, 0.10f)   // P
+        + wave(0.36f, 0.008f, -0.12f)  // Q
+        + wave(0.38f, 0.010f, 1.10f)   // R
+        + wave(0.40f, 0.008f, -0.20f)  // S
+        + wave(0.65f, 0.050f, 0.25f);  // T
+}
+
+// 从第 first 组采样开始填 count 组 ADC 读数，每组按导联交错
+// 其他导联是导联 0 的缩放和延迟版本，围绕 1.5 V 偏置
+static void fill_capture(uint32_t first, int count, int leads) {
+    static const float gain[ECG_MAX_LEADS] = {1.0f, 0.6f, -0.4f};
+    static const float delay_s[ECG_MAX_LEADS] = {0.0f, 0.008f, 0.016f};
+    uint16_t *out = capture_buf;
+    for (int i = 0; i < count; i++) {
+        for (int lead = 0; lead < leads; lead++) {
+            float t = (first + i) / SAMPLE_RATE - delay_s[lead];
+            float v = 1.5f + (synthetic_ecg(t < 0 ? 0 : t) - 1.5f) * gain[lead];
+            int code = (int)(v / ADC_CONVERSION_FACTOR);
+            *out++ = (uint16_t)(code < 0 ? 0 : (code > 4095 ? 4095 : code));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int frames = 50;
+    const char *ppm_path = NULL;
+    const char *panel_name = ECG_PANEL_DEFAULT;
+    bool rgb444 = ECG_PANEL_RGB444;
+    EcgRenderMode mode = ECG_RENDER_DEFAULT;
+    static const char *const mode_names[] = {"framebuffer", "list", "layers"};
+    HostKey keys[HOST_MAX_KEYS];
+    int key_count = 0;
+    int chunk = ECG_CHUNK_SAMPLES;
+    int max_latency_ms = 0;
+    EcgLeadSetup leads = ECG_LEADS_DEFAULT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ppm") == 0 && i + 1 < argc) {
+            ppm_path = argv[++i];
+        } else if (strcmp(argv[i], "--panel") == 0 && i + 1 < argc) {
+            panel_name = argv[++i];
+        } else if (strcmp(argv[i], "--rgb565") == 0) {
+            rgb444 = false;
+        } else if (strcmp(argv[i], "--render") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            int m = 0;
+            while (m < 3 && strcmp(name, mode_names[m]) != 0) {
+                m++;
+            }
+            if (m == 3) {
+                printf("unknown render mode %s\n", name);
+                return 1;
+            }
+            mode = (EcgRenderMode)m;
+        } else if (strcmp(argv[i], "--key") == 0 && i + 1 < argc && key_count < HOST_MAX_KEYS) {
+            if (!parse_key(argv[++i], keys[key_count++])) {
+                printf("bad key %s, expected FRAME:in|out|back|forward\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunk = atoi(argv[++i]);
+            chunk = chunk < 1 ? 1 : (chunk > CAPTURE_DEPTH ? CAPTURE_DEPTH : chunk);
+        } else if (strcmp(argv[i], "--max-latency-ms") == 0 && i + 1 < argc) {
+            max_latency_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--leads") == 0 && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            leads.count = (uint8_t)(n < 1 ? 1 : (n > ECG_MAX_LEADS ? ECG_MAX_LEADS : n));
+        } else if (strcmp(argv[i], "--overlay") == 0) {
+            leads.arrangement = ECG_LEADS_OVERLAID;
+        } else {
+            printf("usage: %s [--panel NAME] [--frames N] [--ppm out.ppm] [--rgb565]"
+                   " [--render framebuffer|list|layers] [--key FRAME:in|out|back|forward]"
+                   " [--chunk N] [--max-latency-ms N] [--leads N] [--overlay]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const EcgPanel *panel = ecg_panel_find(panel_name);
+    if (panel == NULL) {
+        printf("unknown panel %s, available:", panel_name);
+        for (int i = 0; i < ecg_panel_count; i++) {
+            printf(" %s", ecg_panels[i].name);
+        }
+        printf("\n");
+        return 1;
+    }
+
+    if (!init_display(panel, rgb444, mode, &leads)) {
+        return 1;
+    }
+    Panel_Model_SetView(panel->gram_x, panel->gram_y, *panel->width, *panel->height);
+
+    uint64_t total_us = 0;
+    uint64_t worst_us = 0;
+    int updates = 0;
+    uint32_t total = (uint32_t)frames * CAPTURE_DEPTH;
+    uint32_t fed = 0;
+    uint64_t t0 = time_us_64();
+    Panel_Model_ResetStats();
+    while (fed < total) {
+        // 第 n 个采样在 t0 + (n + 1) ms 转换完成；凑够一块之前等待
+        uint64_t now = time_us_64();
+        uint32_t ready = (uint32_t)((now - t0) * SAMPLE_RATE / 1000000);
+        ready = ready < total ? ready : total;
+        uint32_t want = fed + chunk < total ? fed + chunk : total;
+        if (ready < want) {
+            sleep_us(t0 + (uint64_t)(want * (1000000 / SAMPLE_RATE)) - now);
+            continue;
+        }
+
+        // 按键在这一帧的采样送入时按下，其余时间松开
+        int frame = (ready - 1) / CAPTURE_DEPTH;
+        for (int k = 0; k < key_count; k++) {
+            DEV_Digital_Write(keys[k].pin, keys[k].frame == frame ? 0 : 1);
+        }
+
+        uint64_t start = time_us_64();
+        while (fed < ready) {
+            int count = ready - fed < CAPTURE_DEPTH ? (int)(ready - fed) : CAPTURE_DEPTH;
+            fill_capture(fed, count, leads.count);
+            ecg_display_push(capture_buf, count, t0 + (uint64_t)((fed + 1) * (1000000 / SAMPLE_RATE)));
+            fed += count;
+        }
+        ecg_display_update();
+        uint64_t elapsed = time_us_64() - start;
+
+        updates++;
+        total_us += elapsed;
+        worst_us = elapsed > worst_us ? elapsed : worst_us;
+    }
+
+    // 面板 GRAM 必须与帧缓冲逐像素一致（帧缓冲按大端字节存储）
+    // 显示列表和图层模式没有帧缓冲，由 ctest 与整帧模式的输出比对
+    UWORD width = *panel->width;
+    UWORD height = display_buf != NULL ? *panel->height : 0;
+    uint32_t mismatches = 0;
+    for (UWORD y = 0; y < height; y++) {
+        for (UWORD x = 0; x < width; x++) {
+            const UBYTE *p = (const UBYTE *)&display_buf[y * width + x];
+            if (Panel_Model_GetPixel(x, y) != ((p[0] << 8) | p[1])) {
+                mismatches++;
+            }
+        }
+    }
+
+    PANEL_MODEL_STATS stats;
+    Panel_Model_GetStats(&stats);
+    double n = updates > 0 ? updates : 1;
+    const EcgLatency &lat = display_latency;
+    printf("panel:             %s (%ux%u)\n", panel->name, *panel->width, *panel->height);
+    printf("frames:            %d, %d updates\n", frames, updates);
+    printf("update time:       %.1f us avg, %llu us worst (including SPI)\n",
+           total_us / n, (unsigned long long)worst_us);
+    printf("bytes/update:      %.0f (%.0f data)\n", stats.Bytes / n, stats.Data_Bytes / n);
+    printf("transactions/update:%.0f\n", stats.Transactions / n);
+    printf("commands/update:   %.0f\n", stats.Commands / n);
+    printf("windows/update:    %.0f\n", stats.Windows / n);
+    printf("pixels/update:     %.0f\n", stats.Pixels / n);
+    if (display_buf != NULL) {
+        printf("pixel mismatches:  %u\n", (unsigned)mismatches);
+    } else if (display_compositor.Layers != NULL) {
+        printf("layers:            %.1f rows/update, %.0f pixels/update, %lu of %lu updates skipped\n",
+               display_compositor.Rows / n, display_compositor.Pixels / n,
+               (unsigned long)display_compositor.Skipped, (unsigned long)display_compositor.Frames);
+    } else {
+        printf("display list:      %u commands, %lu bands/update, %lu of %lu updates skipped\n",
+               display_list.Num, (unsigned long)(display_list.Bands / n),
+               (unsigned long)display_list.Skipped, (unsigned long)display_list.Frames);
+    }
+    printf("latency:           %.1f ms avg, %.1f ms worst, target %.0f ms (sample to photon)\n",
+           lat.count ? lat.sum_us / 1000.0 / lat.count : 0.0, lat.max_us / 1000.0,
+           ECG_LATENCY_TARGET_US / 1000.0);
+    // 采集和 USB 两段只在固件上有
+    for (int i = 0; i < ECG_STAGE_COUNT; i++) {
+        if (ecg_hist_count(display_stages[i]) > 0) {
+            char line[128];
+            ecg_hist_summary(display_stages[i], line, sizeof(line));
+            printf("stage (us):        %s", line + 5);
+        }
+    }
+    printf("heart rate:        %.0f BPM\n", heart_rate);
+    printf("history view:      zoom %d, %s, %lu samples kept, %d lead%s\n", display_view.zoom,
+           display_view.live ? "live" : "paused", (unsigned long)display_history[0].count,
+           leads.count, leads.count > 1 ? "s" : "");
+
+    if (ppm_path != NULL && Panel_Model_DumpPPM(ppm_path) != 0) {
+        return 1;
+    }
+
+    if (max_latency_ms > 0 && lat.max_us > (uint32_t)max_latency_ms * 1000u) {
+        printf("latency above %d ms\n", max_latency_ms);
+        return 1;
+    }
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * Clock governor test
+ * Feeds the governor scripted windows: a light load steps it down one
+ * level per ECG_GOV_DOWN_WINDOWS windows, a heavy load jumps straight to
+ * the slowest level that fits, a detection or frame p99 over the guard
+ * goes to the fastest level and holds there, a pinned level is kept
+ * whatever the load, and the energy estimate and report lines add up.
+ * Exits 1 on any error.
+ *
+ * usage: ecg_governor_test
+ */
+
+#include "ecg_governor.hpp"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t TOP = ecg_gov_level_count - 1;
+
+// 两个核忙的千分比
+static EcgGovSample window(uint32_t busy0, uint32_t busy1, uint32_t detect_us = 0, uint32_t frame_us = 0) {
+    EcgGovSample sample;
+    sample.window_us = ECG_GOV_WINDOW_US;
+    sample.busy_us[0] = ECG_GOV_WINDOW_US / 1000 * busy0;
+    sample.busy_us[1] = ECG_GOV_WINDOW_US / 1000 * busy1;
+    sample.detect_p99_us = detect_us;
+    sample.frame_p99_us = frame_us;
+    return sample;
+}
+
+// 跑一个窗口，和固件一样按返回值换档
+static uint8_t step(EcgGovernor &gov, const EcgGovSample &sample) {
+    uint8_t next = ecg_gov_update(gov, sample);
+    ecg_gov_set_level(gov, next);
+    return next;
+}
+
+static void check_down_and_up() {
+    EcgGovernor gov;
+    ecg_gov_init(gov);
+    CHECK(gov.level == TOP && gov.pinned == -1, "starts at level %u", gov.level);
+
+    // 轻负载：每 ECG_GOV_DOWN_WINDOWS 个窗口降一档，到最慢为止
+    for (uint8_t level = TOP; level > 0; level--) {
+        for (int i = 1; i < ECG_GOV_DOWN_WINDOWS; i++) {
+            CHECK(step(gov, window(30, 50)) == level, "left level %u after %d windows", level, i);
+        }
+        CHECK(step(gov, window(30, 50)) == level - 1, "did not step down from %u", level);
+    }
+    for (int i = 0; i < 3 * ECG_GOV_DOWN_WINDOWS; i++) {
+        step(gov, window(30, 50));
+    }
+    CHECK(gov.level == 0 && gov.changes == TOP, "level %u after %u changes", gov.level, gov.changes);
+    CHECK(gov.util[0] == 30 && gov.util[1] == 50, "util %u %u", gov.util[0], gov.util[1]);
+
+    // 最慢一档上 80%：换算到各档，直接跳到放得下的最慢一档
+    uint8_t want = TOP;
+    for (uint8_t i = 0; i < ecg_gov_level_count; i++) {
+        if (800ull * ecg_gov_levels[0].sys_khz / ecg_gov_levels[i].sys_khz <= ECG_GOV_UTIL_HIGH) {
+            want = i;
+            break;
+        }
+    }
+    CHECK(want > 0, "test load fits the slowest level");
+    CHECK(step(gov, window(100, 800)) == want, "heavy load went to %u, expected %u", gov.level, want);
+    // 降档的计数被打断后重新开始
+    step(gov, window(10, 10));
+    step(gov, window(10, 10));
+    step(gov, window(900, 900));
+    for (int i = 1; i < ECG_GOV_DOWN_WINDOWS; i++) {
+        CHECK(step(gov, window(10, 10)) == TOP, "stepped down before %d quiet windows", ECG_GOV_DOWN_WINDOWS);
+    }
+    CHECK(step(gov, window(10, 10)) == TOP - 1, "no step down after the quiet windows");
+}
+
+static void check_guard_and_pin() {
+    EcgGovernor gov;
+    ecg_gov_init(gov);
+    for (int i = 0; i < 3 * ECG_GOV_DOWN_WINDOWS * ecg_gov_level_count; i++) {
+        step(gov, window(5, 5));
+    }
+    CHECK(gov.level == 0, "idle load ended at %u", gov.level);
+
+    // 检测延迟超过保护线：负载再低也到最快一档，保持 ECG_GOV_HOLD_WINDOWS 个窗口
+    CHECK(step(gov, window(5, 5, ECG_GOV_DETECT_GUARD_US + 1)) == TOP, "detect guard ignored");
+    for (int i = 0; i < ECG_GOV_HOLD_WINDOWS; i++) {
+        CHECK(step(gov, window(5, 5)) == TOP, "left the top level %d windows after the guard", i);
+    }
+    for (int i = 0; i < ECG_GOV_DOWN_WINDOWS; i++) {
+        step(gov, window(5, 5));
+    }
+    CHECK(gov.level == TOP - 1, "no step down after the hold: %u", gov.level);
+    CHECK(step(gov, window(5, 5, 0, ECG_GOV_FRAME_GUARD_US + 1)) == TOP, "frame guard ignored");
+    CHECK(gov.guard_trips == 2, "%u guard trips", gov.guard_trips);
+
+    // 固定的档不看负载，但延迟保护照样生效
+    ecg_gov_init(gov);
+    ecg_gov_pin(gov, 0);
+    CHECK(step(gov, window(950, 950)) == 0, "pinned level left under load");
+    CHECK(step(gov, window(5, 5, ECG_GOV_DETECT_GUARD_US + 1)) == TOP, "guard ignored while pinned");
+    for (int i = 0; i <= ECG_GOV_HOLD_WINDOWS; i++) {
+        step(gov, window(5, 5));
+    }
+    CHECK(gov.level == 0, "pinned level not restored after the hold: %u", gov.level);
+    ecg_gov_pin(gov, (int8_t)ecg_gov_level_count);
+    CHECK(gov.pinned == -1, "pin past the last level not back to auto");
+}
+
+static void check_energy_and_report() {
+    EcgGovernor gov;
+    ecg_gov_init(gov);
+    CHECK(ecg_gov_energy_permille(gov) == 1000, "no time counted but energy %u", ecg_gov_energy_permille(gov));
+    // 每档停留相同时间，能耗是各档 V²·f 的平均
+    uint64_t sum = 0, full = 0;
+    for (uint8_t i = 0; i < ecg_gov_level_count; i++) {
+        const EcgGovLevel &level = ecg_gov_levels[i];
+        ecg_gov_set_level(gov, i);
+        for (int w = 0; w < 8; w++) {
+            ecg_gov_update(gov, window(5, 5, 9000 + i, 2000 + i));
+        }
+        sum += (uint64_t)level.vreg_mv * level.vreg_mv / 1000 * level.sys_khz / 1000;
+    }
+    const EcgGovLevel &top = ecg_gov_levels[TOP];
+    full = (uint64_t)top.vreg_mv * top.vreg_mv / 1000 * top.sys_khz / 1000 * ecg_gov_level_count;
+    CHECK(ecg_gov_energy_permille(gov) == sum * 1000 / full, "energy %u, expected %u",
+          ecg_gov_energy_permille(gov), (uint32_t)(sum * 1000 / full));
+    CHECK(ecg_gov_energy_permille(gov) < 1000, "slower levels cost no less than the top one");
+
+    // 一次一行，第一行是总况，之后每档一行
+    char line[128];
+    uint32_t next = 0;
+    int lines = 0;
+    CHECK(ecg_gov_report_line(gov, &next, line, sizeof(line)), "no summary line");
+    CHECK(strncmp(line, "gov: auto at ", 13) == 0, "summary line: %s", line);
+    printf("%s", line);
+    while (ecg_gov_report_line(gov, &next, line, sizeof(line))) {
+        unsigned long mhz = 0, mv = 0, time = 0, detect = 0, frame = 0;
+        CHECK(sscanf(line, "gov-level %lu MHz %lu mV time=%lu%% detect_p99=%lu frame_p99=%lu",
+                     &mhz, &mv, &time, &detect, &frame) == 5, "level line: %s", line);
+        const EcgGovLevel &level = ecg_gov_levels[lines];
+        CHECK(mhz * 1000 == level.sys_khz && mv == level.vreg_mv, "line %d: %lu MHz %lu mV", lines, mhz, mv);
+        CHECK(time == 100 / ecg_gov_level_count, "line %d: %lu%% of the time", lines, time);
+        CHECK(detect == 9000u + lines && frame == 2000u + lines, "line %d: p99 %lu %lu", lines, detect, frame);
+        printf("%s", line);
+        lines++;
+    }
+    CHECK(lines == ecg_gov_level_count, "%d level lines", lines);
+
+    ecg_gov_clear_stats(gov);
+    CHECK(gov.changes == 0 && gov.stats[0].time_us == 0, "stats not cleared");
+}
+
+int main() {
+    check_down_and_up();
+    check_guard_and_pin();
+    check_energy_and_report();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("governor: %u levels, all checks passed\n", ecg_gov_level_count);
+    return 0;
+}
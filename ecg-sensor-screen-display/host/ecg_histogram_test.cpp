@@ -0,0 +1,147 @@
+/**
+ * Latency histogram test
+ * Walks every value up to 2^20 and a sample above that: each lands in a
+ * bucket whose bounds contain it, buckets are contiguous, and no bucket is
+ * wider than 1/16 of its lower bound. Then records known distributions
+ * and checks the quantiles against the exact ones within the bucket
+ * error, the clamping of values past ECG_HIST_MAX_VALUE, a reset request
+ * taking effect at the next record, the bucket lines covering every
+ * record, and quantiles over the records since a snapshot. Exits 1 on
+ * any error.
+ *
+ * usage: ecg_histogram_test
+ */
+
+#include "ecg_histogram.hpp"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static EcgHistogram hist;
+
+static void check_buckets() {
+    uint32_t prev_high = 0;
+    for (uint32_t b = 0; b < ECG_HIST_BUCKETS; b++) {
+        uint32_t low = ecg_hist_bucket_low(b);
+        uint32_t high = ecg_hist_bucket_high(b);
+        CHECK(b == 0 || low == prev_high + 1, "bucket %u starts at %u after %u", b, low, prev_high);
+        CHECK(high >= low, "bucket %u empty range %u..%u", b, low, high);
+        CHECK(low < 16 || (uint64_t)(high - low + 1) * 16 <= low, "bucket %u too wide: %u..%u", b, low, high);
+        CHECK(ecg_hist_bucket(low) == b && ecg_hist_bucket(high) == b, "bucket %u bounds map elsewhere", b);
+        prev_high = high;
+    }
+    CHECK(prev_high == ECG_HIST_MAX_VALUE, "last bucket ends at %u", prev_high);
+    for (uint32_t v = 0; v < (1u << 20); v++) {
+        uint32_t b = ecg_hist_bucket(v);
+        if (b >= ECG_HIST_BUCKETS || v < ecg_hist_bucket_low(b) || v > ecg_hist_bucket_high(b)) {
+            CHECK(false, "value %u in bucket %u", v, b);
+            break;
+        }
+    }
+    CHECK(ecg_hist_bucket(0xFFFFFFFFu) == ECG_HIST_BUCKETS - 1, "large value not clamped");
+}
+
+// 1..10000 us, each once: the exact p-th value is p * 10000
+static void check_quantiles() {
+    ecg_hist_init(hist, "uniform");
+    CHECK(ecg_hist_value_at(hist, 990) == 0, "empty histogram has a p99");
+    for (uint32_t v = 1; v <= 10000; v++) {
+        ecg_hist_record(hist, v);
+    }
+    static const uint32_t permille[] = {1, 100, 500, 900, 990, 999, 1000};
+    for (uint32_t p : permille) {
+        uint32_t exact = p * 10;
+        uint32_t got = ecg_hist_value_at(hist, p);
+        CHECK(got >= exact && got <= exact + exact / 16 + 1, "p%u.%u: %u, exact %u", p / 10, p % 10, got, exact);
+    }
+    CHECK(ecg_hist_value_at(hist, 1000) == 10000, "p100 is not the maximum");
+    CHECK(ecg_hist_count(hist) == 10000 && hist.sum == 50005000ull, "count %u sum %llu",
+          ecg_hist_count(hist), (unsigned long long)hist.sum);
+
+    // 一个离群值决定 p99.9 以上，不影响 p99
+    ecg_hist_init(hist, "tail");
+    for (int i = 0; i < 999; i++) {
+        ecg_hist_record(hist, 200);
+    }
+    ecg_hist_record(hist, 50000);
+    CHECK(ecg_hist_value_at(hist, 990) <= 200 + 200 / 16, "p99 %u pulled up by the outlier", ecg_hist_value_at(hist, 990));
+    CHECK(ecg_hist_value_at(hist, 1000) == 50000, "max %u", ecg_hist_value_at(hist, 1000));
+
+    ecg_hist_record(hist, 0xFFFFFFFFu);
+    CHECK(hist.counts[ECG_HIST_BUCKETS - 1] == 1 && hist.max == 0xFFFFFFFFu, "overflow not in the last bucket");
+}
+
+static void check_reset_and_lines() {
+    ecg_hist_init(hist, "lines");
+    for (uint32_t v = 1; v < 100000; v = v * 3 / 2 + 1) {
+        ecg_hist_record(hist, v);
+    }
+    ecg_hist_reset(hist);
+    CHECK(ecg_hist_count(hist) == 0, "count %u while a reset is pending", ecg_hist_count(hist));
+    char line[128];
+    uint32_t next = 0;
+    CHECK(!ecg_hist_buckets(hist, &next, line, sizeof(line)), "buckets listed while a reset is pending");
+    ecg_hist_record(hist, 7);
+    CHECK(ecg_hist_count(hist) == 1 && hist.max == 7, "reset not done at the next record");
+
+    uint32_t recorded = 1;
+    for (uint32_t v = 1; v < 1000000; v = v * 9 / 8 + 1) {
+        ecg_hist_record(hist, v);
+        recorded++;
+    }
+    // 每行都是完整的 "下界:次数"，加起来等于记录数
+    uint32_t listed = 0, lines = 0;
+    next = 0;
+    while (ecg_hist_buckets(hist, &next, line, sizeof(line))) {
+        lines++;
+        CHECK(strlen(line) < sizeof(line) && line[strlen(line) - 1] == '\n', "line %u not terminated", lines);
+        CHECK(strncmp(line, "hist-buckets lines ", 19) == 0, "line %u: %s", lines, line);
+        for (char *p = strchr(line, ' ') + 1; (p = strchr(p, ' ')) != NULL; p++) {
+            unsigned long low, count;
+            CHECK(sscanf(p, " %lu:%lu", &low, &count) == 2, "bad entry in %s", line);
+            CHECK(hist.counts[ecg_hist_bucket((uint32_t)low)] == count, "entry %lu:%lu", low, count);
+            listed += (uint32_t)count;
+        }
+    }
+    CHECK(lines > 1 && listed == recorded, "%u lines listed %u of %u records", lines, listed, recorded);
+    ecg_hist_summary(hist, line, sizeof(line));
+    printf("%s", line);
+}
+
+// 快照以后的分位数只看新记录；快照以后清零过则看清零以后的全部
+static void check_since() {
+    static EcgHistSnapshot snap;
+    ecg_hist_init(hist, "since");
+    ecg_hist_snapshot(hist, snap);
+    CHECK(ecg_hist_value_since(hist, snap, 990) == 0, "empty window has a p99");
+    for (int i = 0; i < 1000; i++) {
+        ecg_hist_record(hist, 5000);
+    }
+    ecg_hist_snapshot(hist, snap);
+    CHECK(ecg_hist_value_since(hist, snap, 990) == 0, "no new records but p99 %u", ecg_hist_value_since(hist, snap, 990));
+    for (int i = 0; i < 100; i++) {
+        ecg_hist_record(hist, 100);
+    }
+    CHECK(ecg_hist_value_since(hist, snap, 990) <= 100 + 100 / 16, "window p99 %u includes older records",
+          ecg_hist_value_since(hist, snap, 990));
+    CHECK(ecg_hist_value_at(hist, 990) >= 5000, "whole p99 %u", ecg_hist_value_at(hist, 990));
+
+    ecg_hist_reset(hist);
+    ecg_hist_record(hist, 20);
+    CHECK(ecg_hist_value_since(hist, snap, 990) == 20, "after a reset: %u", ecg_hist_value_since(hist, snap, 990));
+}
+
+int main() {
+    check_buckets();
+    check_quantiles();
+    check_reset_and_lines();
+    check_since();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("histogram: %d buckets, all checks passed\n", ECG_HIST_BUCKETS);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * ECG history pyramid check
+ * Pushes a pseudo-random signal and compares every rendered column with a
+ * scan of the raw samples over the buckets the column covers, for random
+ * windows and zoom steps. Exits 1 on the first difference.
+ *
+ * usage: ecg_history_test [--samples N] [--windows N]
+ */
+
+#include "ecg_history.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static EcgHistory history;
+
+// 与渲染相同的列边界，在原始采样上扫描
+static EcgBucket scan(const std::vector<int16_t> &raw, int level, int64_t s, int64_t e) {
+    EcgBucket r = {INT16_MAX, INT16_MIN};
+    if (e <= 0) {
+        return r;
+    }
+    uint32_t first = s > 0 ? (uint32_t)(s >> 16) : 0;
+    uint32_t last = (uint32_t)(e >> 16);
+    last = last > first ? last - 1 : first;
+    uint32_t lo = (first >> level) << level;
+    uint32_t hi = ((last >> level) + 1) << level;
+    uint32_t oldest = ecg_history_oldest(history, level);
+    lo = lo < oldest ? oldest : lo;
+    hi = hi > raw.size() ? (uint32_t)raw.size() : hi;
+    for (uint32_t i = lo; i < hi; i++) {
+        r.min = raw[i] < r.min ? raw[i] : r.min;
+        r.max = raw[i] > r.max ? raw[i] : r.max;
+    }
+    return r;
+}
+
+int main(int argc, char **argv) {
+    uint32_t samples = 3000000;
+    int windows = 400;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--windows") == 0 && i + 1 < argc) {
+            windows = atoi(argv[++i]);
+        } else {
+            printf("usage: %s [--samples N] [--windows N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ecg_history_reset(history);
+    std::vector<int16_t> raw;
+    raw.reserve(samples);
+    uint32_t seed = 12345;
+    int failures = 0;
+    for (uint32_t n = 0; n < samples; n++) {
+        seed = seed * 1664525u + 1013904223u;
+        int16_t v = (int16_t)((seed >> 16) % 4001) - 2000;
+        raw.push_back(v);
+        ecg_history_push(history, v);
+
+        // 在写入过程中也检查几次，覆盖各级桶尚未凑满的情况
+        bool check = (n + 1 == samples) || ((n + 1) % 499979 == 0);
+        for (int w = 0; check && w < windows && failures == 0; w++) {
+            seed = seed * 1664525u + 1013904223u;
+            uint16_t columns = 1 + (seed >> 8) % 320;
+            int zoom = (int)((seed >> 20) % 16) - 3;
+            uint32_t step_q16 = zoom >= 0 ? (682667u << zoom) : (682667u >> -zoom);
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t end = history.count - (seed >> 4) % (history.count + 1);
+
+            EcgBucket out[320];
+            int level = ecg_history_render(history, end, step_q16, columns, out);
+            int64_t start_q16 = ((int64_t)end << 16) - (int64_t)columns * step_q16;
+            for (uint16_t c = 0; c < columns; c++) {
+                int64_t s = start_q16 + (int64_t)c * step_q16;
+                EcgBucket want = scan(raw, level, s, s + step_q16);
+                if (want.min != out[c].min || want.max != out[c].max) {
+                    printf("MISMATCH count %u end %u step %u column %u level %d: got %d..%d, want %d..%d\n",
+                           history.count, end, step_q16, c, level, out[c].min, out[c].max, want.min, want.max);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    printf("%u samples, %s\n", samples, failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
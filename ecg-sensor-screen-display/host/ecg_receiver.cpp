@@ -0,0 +1,448 @@
+// ecg_receiver.cpp
+// 设备输出流的解码、串口设置和写盘线程
+
+#include "ecg_receiver.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+extern "C" {
+#include "DEV_Log.h"
+#include "DEV_Trace.h"
+}
+
+void ecg_rx_init(EcgRxDecoder &rx, const EcgRxSink &sink, uint32_t sample_rate) {
+    memset(&rx, 0, sizeof(rx));
+    rx.sink = sink;
+    rx.period_us = sample_rate ? 1000000 / sample_rate : 1000;
+}
+
+static void rx_skip(EcgRxDecoder &rx, size_t n) {
+    rx.stats.skipped += n;
+    rx.skipping = true;
+    if (!rx.garbage) {
+        rx.stats.resyncs++;
+        rx.garbage = true;
+    }
+}
+
+// 十进制数，可以有符号和小数部分；至少一位数字
+static bool parse_number(const char *&p, const char *end, double &value) {
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    int digits = 0;
+    uint64_t whole = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        whole = whole * 10 + (uint64_t)(*p - '0');
+    }
+    double v = (double)whole;
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            v += (*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    value = negative ? -v : v;
+    return digits > 0;
+}
+
+// 采样行：时间加一列或几列数值，逗号分隔
+static bool parse_csv(const char *line, size_t len, double &time_ms) {
+    const char *p = line, *end = line + len;
+    double value;
+    if (!parse_number(p, end, time_ms) || p == end) {
+        return false;
+    }
+    while (p < end) {
+        if (*p++ != ',' || !parse_number(p, end, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void rx_line(EcgRxDecoder &rx, const char *line, size_t len) {
+    if (len > 0 && line[len - 1] == '\r') {
+        len--;
+    }
+    if (len == 0) {
+        return;
+    }
+    rx.garbage = false;
+    double time_ms;
+    if (!parse_csv(line, len, time_ms)) {
+        rx.stats.text_lines++;
+        if (rx.sink.text) {
+            rx.sink.text(rx.sink.ctx, line, len);
+        }
+        return;
+    }
+    // 相邻两行的时间差超过一个采样间隔就是丢了行；时间倒退是新一轮采集
+    if (rx.have_time && time_ms > rx.last_ms) {
+        uint64_t steps = (uint64_t)((time_ms - rx.last_ms) * 1000.0 / rx.period_us + 0.5);
+        if (steps > 1) {
+            rx.stats.gaps++;
+            rx.stats.missing += steps - 1;
+        }
+    } else if (rx.have_time) {
+        rx.stats.restarts++;
+    }
+    rx.have_time = true;
+    rx.last_ms = time_ms;
+    rx.stats.csv_lines++;
+    rx.stats.sets++;
+    if (rx.sink.csv) {
+        rx.sink.csv(rx.sink.ctx, line, len, time_ms);
+    }
+}
+
+static bool text_byte(uint8_t c) {
+    return (c >= 0x20 && c < 0x7F) || c == '\t' || c == '\r';
+}
+
+// 到换行或第一个非 ASCII 字节为止算一行；返回用掉的字节数，0 表示要等更多数据
+// 设备只输出可打印文本，行里有其他控制字符的是乱码 (通常是损坏的帧剩下的部分)
+static size_t rx_text(EcgRxDecoder &rx, const uint8_t *p, size_t left, bool final) {
+    size_t limit = left < ECG_RX_LINE_MAX ? left : ECG_RX_LINE_MAX;
+    size_t n = 0;
+    while (n < limit && text_byte(p[n])) {
+        n++;
+    }
+    if (n < limit && p[n] < 0x80 && p[n] != '\n') {
+        rx_skip(rx, n + 1);
+        return n + 1;
+    }
+    bool newline = n < left && p[n] == '\n';
+    if (n == limit && !newline) {
+        if (n == ECG_RX_LINE_MAX) {
+            rx_skip(rx, n);
+            return n;
+        }
+        if (!final) {
+            return 0;
+        }
+    }
+    if (rx.skipping) {
+        // 乱码之后不知道一行从哪里开始，等下一个换行
+        rx_skip(rx, n + newline);
+        rx.skipping = !newline;
+        return n + newline;
+    }
+    rx_line(rx, (const char *)p, n);
+    return n + newline;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// 下面几个返回这一项的长度；0 表示还不完整，-1 表示不是这一项
+static long log_record(const uint8_t *p, size_t left) {
+    if (left < DEV_LOG_HEADER) {
+        return 0;
+    }
+    size_t args = p[1] & 0x7F;
+    if (args > DEV_LOG_ARG_BYTES) {
+        return -1;
+    }
+    return left < DEV_LOG_HEADER + args ? 0 : (long)(DEV_LOG_HEADER + args);
+}
+
+static long trace_chunk(const uint8_t *p, size_t left) {
+    if (left < DEV_TRACE_HEADER) {
+        return 0;
+    }
+    uint32_t count = get16(p + 2);
+    if (p[1] >= DEV_TRACE_CORES || count > DEV_TRACE_EVENTS) {
+        return -1;
+    }
+    size_t bytes = DEV_TRACE_HEADER + count * sizeof(DEV_TRACE_REC);
+    if (left < bytes) {
+        return 0;
+    }
+    for (size_t k = DEV_TRACE_HEADER; k < bytes; k += sizeof(DEV_TRACE_REC)) {
+        uint8_t phase = p[k + offsetof(DEV_TRACE_REC, Phase)];
+        if (phase != 'B' && phase != 'E' && phase != 'i' && phase != 'C') {
+            return -1;
+        }
+    }
+    return (long)bytes;
+}
+
+static void rx_frame(EcgRxDecoder &rx, const EcgStreamFrame &frame) {
+    if (rx.have_seq && frame.seq != rx.next_seq) {
+        if ((int32_t)(frame.seq - rx.next_seq) > 0) {
+            rx.stats.gaps++;
+            rx.stats.missing += (uint64_t)(frame.seq - rx.next_seq) * frame.sets;
+        } else {
+            rx.stats.restarts++;
+        }
+    }
+    rx.have_seq = true;
+    rx.next_seq = frame.seq + 1;
+    rx.stats.frames++;
+    rx.stats.sets += frame.sets;
+    if (rx.sink.frame) {
+        rx.sink.frame(rx.sink.ctx, frame);
+    }
+}
+
+static long rx_binary(EcgRxDecoder &rx, const uint8_t *p, size_t left) {
+    long n;
+    if (p[0] == ECG_STREAM_SYNC) {
+        EcgStreamFrame frame;
+        bool crc_bad;
+        n = ecg_stream_decode(p, left, frame, &crc_bad);
+        if (n > 0) {
+            rx_frame(rx, frame);
+        } else if (crc_bad) {
+            rx.stats.crc_errors++;
+        }
+    } else if (p[0] == DEV_LOG_SYNC || p[0] == DEV_TRACE_SYNC) {
+        bool log = p[0] == DEV_LOG_SYNC;
+        n = log ? log_record(p, left) : trace_chunk(p, left);
+        if (n > 0) {
+            (log ? rx.stats.log_records : rx.stats.trace_chunks)++;
+            if (rx.sink.binary) {
+                rx.sink.binary(rx.sink.ctx, p, (size_t)n);
+            }
+        }
+    } else {
+        return -1;
+    }
+    if (n > 0) {
+        rx.skipping = false;
+        rx.garbage = false;
+    }
+    return n;
+}
+
+// 解 buf 里的完整内容，返回用掉的字节数；剩下的是不完整的一项，final 时没有剩下的
+static size_t rx_parse(EcgRxDecoder &rx, const uint8_t *buf, size_t len, bool final) {
+    size_t i = 0;
+    while (i < len) {
+        const uint8_t *p = buf + i;
+        size_t left = len - i;
+        if (p[0] < 0x80) {
+            size_t n = rx_text(rx, p, left, final);
+            if (n == 0) {
+                break;
+            }
+            i += n;
+            continue;
+        }
+        long n = rx_binary(rx, p, left);
+        if (n == 0 && !final) {
+            break;
+        }
+        if (n <= 0) {
+            rx_skip(rx, 1);
+            i++;
+            continue;
+        }
+        i += (size_t)n;
+    }
+    return i;
+}
+
+void ecg_rx_feed(EcgRxDecoder &rx, const uint8_t *data, size_t len) {
+    rx.stats.bytes += len;
+    while (len > 0) {
+        if (rx.carry_len == 0) {
+            // 大部分时候直接在调用者的缓冲上解，只把最后不完整的一项留下
+            size_t used = rx_parse(rx, data, len, false);
+            memcpy(rx.carry, data + used, len - used);
+            rx.carry_len = len - used;
+            return;
+        }
+        size_t take = sizeof(rx.carry) - rx.carry_len;
+        take = take < len ? take : len;
+        memcpy(rx.carry + rx.carry_len, data, take);
+        rx.carry_len += take;
+        data += take;
+        len -= take;
+        size_t used = rx_parse(rx, rx.carry, rx.carry_len, false);
+        if (used == 0 && rx.carry_len == sizeof(rx.carry)) {
+            // 不会发生：不完整的一项都比 carry 小
+            rx_skip(rx, 1);
+            used = 1;
+        }
+        memmove(rx.carry, rx.carry + used, rx.carry_len - used);
+        rx.carry_len -= used;
+    }
+}
+
+void ecg_rx_finish(EcgRxDecoder &rx) {
+    rx_parse(rx, rx.carry, rx.carry_len, true);
+    rx.carry_len = 0;
+}
+
+static speed_t tty_speed(uint32_t baud) {
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B0;
+    }
+}
+
+int ecg_rx_open_tty(const char *path, uint32_t baud, bool writable) {
+    int fd = open(path, (writable ? O_RDWR : O_RDONLY) | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        // 有一个字节就返回，一次读到内核缓冲里已有的全部 (最多调用者给的长度)
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        if (tty_speed(baud) != B0) {
+            cfsetspeed(&tio, tty_speed(baud));
+        }
+        if (tcsetattr(fd, TCSANOW, &tio) == 0) {
+            return fd;
+        }
+    }
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+}
+
+// 写完全部 iov，处理部分写；返回 0 或 errno
+static int write_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+static void writer_run(EcgRxWriter *w) {
+    std::unique_lock<std::mutex> guard(w->lock);
+    for (;;) {
+        w->cond.wait(guard, [w] { return w->queued > 0 || w->closing; });
+        if (w->queued == 0) {
+            return;
+        }
+        // 排队的缓冲不会被改，写的时候不拿锁
+        uint32_t head = w->head, count = w->queued;
+        guard.unlock();
+        struct iovec iov[ECG_RX_WRITE_BUFFERS];
+        uint64_t total = 0;
+        for (uint32_t k = 0; k < count; k++) {
+            uint32_t i = (head + k) % ECG_RX_WRITE_BUFFERS;
+            iov[k].iov_base = w->bufs[i];
+            iov[k].iov_len = w->used[i];
+            total += w->used[i];
+        }
+        int error = write_all(w->fd, iov, (int)count);
+        guard.lock();
+        w->error = w->error ? w->error : error;
+        w->written += total;
+        w->writes++;
+        w->head = (head + count) % ECG_RX_WRITE_BUFFERS;
+        w->queued -= count;
+        w->cond.notify_all();
+    }
+}
+
+bool ecg_rx_writer_open(EcgRxWriter &w, int fd) {
+    w.fd = fd;
+    for (int i = 0; i < ECG_RX_WRITE_BUFFERS; i++) {
+        w.bufs[i] = new uint8_t[ECG_RX_WRITE_BYTES];
+        w.used[i] = 0;
+    }
+    w.fill = 0;
+    w.head = 0;
+    w.queued = 0;
+    w.closing = false;
+    w.error = 0;
+    w.written = w.writes = w.stalls = 0;
+    w.thread = std::thread(writer_run, &w);
+    return true;
+}
+
+// 当前缓冲排队，换下一个；全部在排队时等写盘线程还回一个
+static void writer_next(EcgRxWriter &w) {
+    std::unique_lock<std::mutex> guard(w.lock);
+    w.queued++;
+    w.cond.notify_all();
+    if (w.queued == ECG_RX_WRITE_BUFFERS) {
+        w.stalls++;
+        w.cond.wait(guard, [&w] { return w.queued < ECG_RX_WRITE_BUFFERS; });
+    }
+    w.fill = (w.head + w.queued) % ECG_RX_WRITE_BUFFERS;
+    w.used[w.fill] = 0;
+}
+
+char *ecg_rx_writer_reserve(EcgRxWriter &w, size_t bytes) {
+    if (w.used[w.fill] + bytes > ECG_RX_WRITE_BYTES) {
+        writer_next(w);
+    }
+    return (char *)w.bufs[w.fill] + w.used[w.fill];
+}
+
+void ecg_rx_writer_write(EcgRxWriter &w, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0) {
+        size_t room = ECG_RX_WRITE_BYTES - w.used[w.fill];
+        if (room == 0) {
+            writer_next(w);
+            continue;
+        }
+        size_t n = len < room ? len : room;
+        memcpy(w.bufs[w.fill] + w.used[w.fill], p, n);
+        w.used[w.fill] += n;
+        p += n;
+        len -= n;
+    }
+}
+
+int ecg_rx_writer_close(EcgRxWriter &w) {
+    {
+        std::lock_guard<std::mutex> guard(w.lock);
+        if (w.used[w.fill] > 0) {
+            w.queued++;
+        }
+        w.closing = true;
+        w.cond.notify_all();
+    }
+    w.thread.join();
+    for (int i = 0; i < ECG_RX_WRITE_BUFFERS; i++) {
+        delete[] w.bufs[i];
+        w.bufs[i] = nullptr;
+    }
+    if (close(w.fd) != 0 && w.error == 0) {
+        w.error = errno;
+    }
+    return w.error;
+}
@@ -0,0 +1,100 @@
+// ecg_receiver.hpp
+// 主机端接收设备的 USB 输出：原始模式读串口、解码、按大块写盘，取代逐行读、逐行 flush 的 data_process/serial-capture.py
+// 解码器认下面几种内容，它们在同一个流里可以任意交错，数据可以在任意位置切开分几次送进来：
+//   文本行：采样行 "<时间 ms>,<电压 V>" (adc_dma_capture 的 CSV) 和其他文本 (报告等)
+//   采样帧 (ECG_STREAM_SYNC，ecg_stream.hpp)
+//   日志记录 (DEV_LOG_SYNC) 和追踪事件段 (DEV_TRACE_SYNC)：不解开，原样交出去，可以另存给 log_decode.py / trace_export.py
+// 认不出的字节、带控制字符的文本和 CRC 不对的帧逐字节跳过，直到下一处能解开的地方 (重新同步)；乱码之后的文本从下一个换行之后才算
+// 丢块按帧序号统计，CSV 按相邻两行的时间差统计
+#ifndef ECG_RECEIVER_HPP
+#define ECG_RECEIVER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "ecg_stream.hpp"
+
+#define ECG_RX_LINE_MAX     256         // 超过这么长还没有换行的文本当作乱码
+#define ECG_RX_CARRY        32768       // 跨两次送入的不完整内容，最大的是满的追踪事件段 (16 KB)
+
+struct EcgRxStats {
+    uint64_t bytes;
+    uint64_t frames;                    // 采样帧
+    uint64_t csv_lines;                 // CSV 采样行
+    uint64_t sets;                      // 收到的采样组，两种来源合计
+    uint64_t text_lines;
+    uint64_t log_records;
+    uint64_t trace_chunks;
+    uint64_t gaps;                      // 帧序号跳号或 CSV 时间跳变的次数
+    uint64_t missing;                   // 估计丢掉的采样组
+    uint64_t restarts;                  // 序号或时间倒退：设备重启或新一轮采集，不算丢
+    uint64_t crc_errors;
+    uint64_t resyncs;                   // 遇到乱码的次数
+    uint64_t skipped;                   // 跳过的字节
+};
+
+// 回调都可以为 NULL；指针只在回调期间有效
+struct EcgRxSink {
+    void *ctx;
+    void (*frame)(void *ctx, const EcgStreamFrame &frame);
+    void (*csv)(void *ctx, const char *line, size_t len, double time_ms);   // 不含换行
+    void (*text)(void *ctx, const char *line, size_t len);
+    void (*binary)(void *ctx, const uint8_t *data, size_t len);             // 一条日志记录或一个追踪事件段
+};
+
+struct EcgRxDecoder {
+    EcgRxSink sink;
+    uint32_t period_us;                 // CSV 的采样间隔
+    EcgRxStats stats;
+    bool have_seq;
+    uint32_t next_seq;
+    bool have_time;
+    double last_ms;
+    bool skipping;                      // 正在跳过乱码，文本等下一个换行
+    bool garbage;                       // 上一次认出内容之后遇到过乱码，一段乱码只算一次重新同步
+    size_t carry_len;
+    uint8_t carry[ECG_RX_CARRY];
+};
+
+void ecg_rx_init(EcgRxDecoder &rx, const EcgRxSink &sink, uint32_t sample_rate);
+void ecg_rx_feed(EcgRxDecoder &rx, const uint8_t *data, size_t len);
+// 流结束：最后一行没有换行也算一行，剩下不完整的二进制内容算乱码
+void ecg_rx_finish(EcgRxDecoder &rx);
+
+// 打开串口，原始模式 (不做行处理、不回显、8N1)；返回 fd，失败返回 -1 并设 errno
+// USB CDC 不看波特率，真串口才用得上
+int ecg_rx_open_tty(const char *path, uint32_t baud, bool writable);
+
+// 写盘：调用者往当前缓冲里写，写满的缓冲排队交给写盘线程，线程一次 writev 把排队的全部写出去
+// 读串口的一方只在所有缓冲都在排队时才等磁盘，等的次数计入 stalls
+#define ECG_RX_WRITE_BUFFERS    8
+#define ECG_RX_WRITE_BYTES      (1u << 20)
+
+struct EcgRxWriter {
+    int fd;
+    uint8_t *bufs[ECG_RX_WRITE_BUFFERS];
+    size_t used[ECG_RX_WRITE_BUFFERS];
+    uint32_t fill;                      // 正在写的缓冲，总是排队的后一个
+    std::mutex lock;
+    std::condition_variable cond;
+    uint32_t head, queued;              // 排队的缓冲：从 head 起 queued 个，环形
+    bool closing;
+    int error;                          // 写盘线程遇到的第一个错误 (errno)
+    std::thread thread;
+    uint64_t written, writes, stalls;
+};
+
+bool ecg_rx_writer_open(EcgRxWriter &w, int fd);
+// 在当前缓冲里留出 bytes 字节 (不超过 ECG_RX_WRITE_BYTES)，写完用 commit 说明实际写了多少
+char *ecg_rx_writer_reserve(EcgRxWriter &w, size_t bytes);
+inline void ecg_rx_writer_commit(EcgRxWriter &w, size_t bytes) {
+    w.used[w.fill] += bytes;
+}
+void ecg_rx_writer_write(EcgRxWriter &w, const void *data, size_t len);
+// 写出剩下的、等线程结束、关闭 fd；返回 0 或第一个错误的 errno
+int ecg_rx_writer_close(EcgRxWriter &w);
+
+#endif // ECG_RECEIVER_HPP
@@ -0,0 +1,323 @@
+/**
+ * Stream receiver test
+ * Builds a capture the way the device would send it: text, CSV sample
+ * lines with a missing stretch and a restart, log records, a trace chunk,
+ * and sample frames with dropped blocks, one corrupted frame, a lead
+ * change and a run of garbage. Decodes it whole, one byte at a time and
+ * in random pieces; the counts must be exact and the same every time, and
+ * every decoded frame must carry the samples it was built from.
+ * Then the writer: pieces of every size through the writer thread must
+ * come back from the file unchanged. Last, decodes a long run of frames
+ * and of CSV lines and prints the rate against one device (1000 sample
+ * sets per second); below 100 devices' worth is an error.
+ * Exits 1 on any error.
+ *
+ * usage: ecg_receiver_test [CAPTURE_FILE]
+ *   CAPTURE_FILE receives the test capture, for the ecg_capture test
+ */
+
+#include "ecg_receiver.hpp"
+#include "test_check.h"
+extern "C" {
+#include "DEV_Log.h"
+#include "DEV_Trace.h"
+}
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define BLOCK_SETS  10
+#define FRAMES      120
+#define DEVICE_SETS 1000        // 一台设备每秒的采样组
+
+static std::vector<uint8_t> capture;
+
+static double now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void put_text(std::vector<uint8_t> &out, const char *text) {
+    out.insert(out.end(), text, text + strlen(text));
+}
+
+// 采样的低字节在 0x10..0x4F，高字节 0x07：不是换行也不是同步字节，损坏的帧不会被当成别的内容
+static uint16_t sample_value(uint32_t seq, uint32_t i) {
+    return (uint16_t)(0x0710 + (seq * 7 + i) % 0x40);
+}
+
+static void put_frame(std::vector<uint8_t> &out, uint32_t seq, uint16_t mask, bool corrupt = false) {
+    static uint16_t payload[ECG_STREAM_MAX_SAMPLES];
+    static EcgSampleBlock block;
+    block.samples = payload;
+    block.capacity = ECG_STREAM_MAX_SAMPLES;
+    block.sets = BLOCK_SETS;
+    block.seq = seq;
+    block.oldest_us = 1000000 + (uint64_t)seq * BLOCK_SETS * 1000;
+    block.channel_mask = mask;
+    block.flags = 0;
+    for (uint32_t i = 0; i < ecg_block_samples(&block); i++) {
+        payload[i] = sample_value(seq, i);
+    }
+    uint8_t frame[ecg_stream_frame_bytes(ECG_STREAM_MAX_SAMPLES)];
+    size_t n = ecg_stream_encode(&block, frame, sizeof(frame));
+    CHECK(n == ecg_stream_frame_bytes(ecg_block_samples(&block)), "frame %u encoded to %zu bytes", seq, n);
+    if (corrupt) {
+        frame[ECG_STREAM_HEADER + 3] ^= 0x01;
+    }
+    out.insert(out.end(), frame, frame + n);
+}
+
+static void put_csv(std::vector<uint8_t> &out, uint32_t t_ms) {
+    char line[32];
+    snprintf(line, sizeof(line), "%u.0,%.3f\n", t_ms, 1.0 + (t_ms % 10) * 0.01);
+    put_text(out, line);
+}
+
+static void build_capture() {
+    put_text(capture, "ecg: stream test\r\n");
+    put_text(capture, "Time(ms),Voltage(V)\n");
+    // 100..104 ms 丢了，之后重新开始一轮
+    for (uint32_t t = 0; t < 500; t++) {
+        if (t < 100 || t > 104) {
+            put_csv(capture, t);
+        }
+    }
+    put_text(capture, "Capture complete\n\n");
+    for (uint32_t t = 0; t < 100; t++) {
+        put_csv(capture, t);
+    }
+
+    // 核 0 四字节参数、核 1 八字节参数的两条日志
+    const uint8_t log0[] = {DEV_LOG_SYNC, 4, 0x10, 0x00, 1, 2, 3, 4, 42, 0, 0, 0};
+    const uint8_t log1[] = {DEV_LOG_SYNC, 0x80 | 8, 0x20, 0x00, 5, 6, 7, 8, 1, 0, 0, 0, 2, 0, 0, 0};
+    capture.insert(capture.end(), log0, log0 + sizeof(log0));
+    capture.insert(capture.end(), log1, log1 + sizeof(log1));
+    uint8_t chunk[DEV_TRACE_HEADER + 2 * sizeof(DEV_TRACE_REC)] = {DEV_TRACE_SYNC, 1, 2, 0, 0, 0, 0, 0};
+    DEV_TRACE_REC recs[2] = {{1000, 4, 'B', 1, 0}, {1500, 4, 'E', 1, 0}};
+    memcpy(chunk + DEV_TRACE_HEADER, recs, sizeof(recs));
+    capture.insert(capture.end(), chunk, chunk + sizeof(chunk));
+
+    // 50..52 丢了，80 损坏，100 起三个导联；每 25 块一行报告
+    for (uint32_t seq = 0; seq < FRAMES; seq++) {
+        if (seq % 25 == 0) {
+            put_text(capture, "latency: p99 123 us\n");
+        }
+        if (seq >= 50 && seq <= 52) {
+            continue;
+        }
+        put_frame(capture, seq, seq >= 100 ? 0x7 : 0x1, seq == 80);
+    }
+
+    // 乱码，之后到换行为止的文本不算
+    const uint8_t junk[] = {0x80, 0xFF, 0x99, 0xC3};
+    capture.insert(capture.end(), junk, junk + sizeof(junk));
+    put_text(capture, "junk after garbage\n");
+    put_text(capture, "after junk\n");
+    put_text(capture, "last line");
+}
+
+struct Seen {
+    uint32_t frames;
+    uint32_t bad_samples;
+    uint32_t binary_bytes;
+    uint32_t lead3_frames;
+};
+
+static void seen_frame(void *ctx, const EcgStreamFrame &frame) {
+    Seen &seen = *(Seen *)ctx;
+    seen.frames++;
+    seen.lead3_frames += ecg_stream_leads(frame) == 3;
+    for (uint32_t i = 0; i < frame.sets * ecg_stream_leads(frame); i++) {
+        uint16_t v = (uint16_t)(frame.samples[2 * i] | (frame.samples[2 * i + 1] << 8));
+        seen.bad_samples += v != sample_value(frame.seq, i);
+    }
+    if (frame.oldest_us != 1000000 + (uint64_t)frame.seq * BLOCK_SETS * 1000) {
+        seen.bad_samples++;
+    }
+}
+
+static void seen_binary(void *ctx, const uint8_t *data, size_t len) {
+    (void)data;
+    ((Seen *)ctx)->binary_bytes += (uint32_t)len;
+}
+
+// 按 piece(i) 给出的长度分几次送入，返回统计
+static EcgRxStats decode(size_t (*piece)(size_t), Seen &seen) {
+    static EcgRxDecoder rx;
+    memset(&seen, 0, sizeof(seen));
+    EcgRxSink sink = {&seen, seen_frame, NULL, NULL, seen_binary};
+    ecg_rx_init(rx, sink, 1000);
+    for (size_t i = 0, k = 0; i < capture.size(); k++) {
+        size_t n = piece(k);
+        n = n < capture.size() - i ? n : capture.size() - i;
+        ecg_rx_feed(rx, capture.data() + i, n);
+        i += n;
+    }
+    ecg_rx_finish(rx);
+    return rx.stats;
+}
+
+static size_t whole(size_t) {
+    return capture.size();
+}
+
+static size_t one_byte(size_t) {
+    return 1;
+}
+
+static size_t random_piece(size_t) {
+    return 1 + (size_t)rand() % 3000;
+}
+
+static void check_decode() {
+    Seen seen;
+    EcgRxStats st = decode(whole, seen);
+    uint64_t frames = FRAMES - 3 - 1;
+    CHECK(st.bytes == capture.size(), "%llu bytes of %zu", (unsigned long long)st.bytes, capture.size());
+    CHECK(st.frames == frames && seen.frames == frames, "%llu frames", (unsigned long long)st.frames);
+    CHECK(seen.lead3_frames == FRAMES - 100, "%u three-lead frames", seen.lead3_frames);
+    CHECK(seen.bad_samples == 0, "%u samples differ", seen.bad_samples);
+    CHECK(st.csv_lines == 595, "%llu csv lines", (unsigned long long)st.csv_lines);
+    CHECK(st.sets == 595 + frames * BLOCK_SETS, "%llu sets", (unsigned long long)st.sets);
+    CHECK(st.gaps == 3 && st.missing == 5 + 3 * BLOCK_SETS + BLOCK_SETS, "%llu gaps, %llu missing",
+          (unsigned long long)st.gaps, (unsigned long long)st.missing);
+    CHECK(st.restarts == 1, "%llu restarts", (unsigned long long)st.restarts);
+    CHECK(st.crc_errors == 1, "%llu crc errors", (unsigned long long)st.crc_errors);
+    CHECK(st.log_records == 2 && st.trace_chunks == 1, "%llu log records, %llu trace chunks",
+          (unsigned long long)st.log_records, (unsigned long long)st.trace_chunks);
+    CHECK(seen.binary_bytes == 12 + 16 + DEV_TRACE_HEADER + 2 * sizeof(DEV_TRACE_REC), "%u binary bytes",
+          seen.binary_bytes);
+    // 3 行开头、5 行报告、乱码之后的 2 行
+    CHECK(st.text_lines == 10, "%llu text lines", (unsigned long long)st.text_lines);
+    CHECK(st.resyncs == 2, "%llu resyncs", (unsigned long long)st.resyncs);
+    CHECK(st.skipped >= sizeof("junk after garbage") + 4, "%llu bytes skipped", (unsigned long long)st.skipped);
+
+    // 怎么切开送进去都一样
+    srand(1);
+    size_t (*pieces[])(size_t) = {one_byte, random_piece, random_piece};
+    for (auto piece : pieces) {
+        Seen again;
+        EcgRxStats other = decode(piece, again);
+        CHECK(memcmp(&st, &other, sizeof(st)) == 0, "stats differ when fed in pieces: %llu frames, %llu csv lines, "
+              "%llu text lines, %llu skipped", (unsigned long long)other.frames, (unsigned long long)other.csv_lines,
+              (unsigned long long)other.text_lines, (unsigned long long)other.skipped);
+        CHECK(again.bad_samples == 0, "%u samples differ when fed in pieces", again.bad_samples);
+    }
+    printf("decode: %zu bytes, %llu frames, %llu csv lines, %llu text lines, %llu skipped\n", capture.size(),
+           (unsigned long long)st.frames, (unsigned long long)st.csv_lines, (unsigned long long)st.text_lines,
+           (unsigned long long)st.skipped);
+}
+
+static void check_writer() {
+    const char *path = "receiver_writer.bin";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0, "cannot open %s", path);
+    if (fd < 0) {
+        return;
+    }
+    static EcgRxWriter w;
+    ecg_rx_writer_open(w, fd);
+    std::vector<uint8_t> expect;
+    srand(2);
+    // 小块预留加整段写，合计超过全部缓冲，写盘线程要转好几圈
+    while (expect.size() < 3 * ECG_RX_WRITE_BUFFERS * ECG_RX_WRITE_BYTES / 2) {
+        if (rand() % 4) {
+            size_t n = 1 + (size_t)rand() % 4000;
+            char *p = ecg_rx_writer_reserve(w, n + 100);
+            for (size_t i = 0; i < n; i++) {
+                p[i] = (char)(expect.size() + i);
+            }
+            ecg_rx_writer_commit(w, n);
+            for (size_t i = 0; i < n; i++) {
+                expect.push_back((uint8_t)p[i]);
+            }
+        } else {
+            std::vector<uint8_t> piece(1 + (size_t)rand() % 300000);
+            for (size_t i = 0; i < piece.size(); i++) {
+                piece[i] = (uint8_t)(rand() >> 4);
+            }
+            ecg_rx_writer_write(w, piece.data(), piece.size());
+            expect.insert(expect.end(), piece.begin(), piece.end());
+        }
+    }
+    uint64_t writes = w.writes;
+    CHECK(ecg_rx_writer_close(w) == 0, "writer failed");
+    CHECK(w.written == expect.size(), "wrote %llu of %zu bytes", (unsigned long long)w.written, expect.size());
+
+    std::vector<uint8_t> got(expect.size() + 1);
+    FILE *in = fopen(path, "rb");
+    size_t n = in ? fread(got.data(), 1, got.size(), in) : 0;
+    if (in) {
+        fclose(in);
+    }
+    CHECK(n == expect.size() && memcmp(got.data(), expect.data(), n) == 0, "file differs: %zu of %zu bytes", n,
+          expect.size());
+    printf("writer: %zu bytes in %llu writes, %llu stalls\n", expect.size(), (unsigned long long)w.writes,
+           (unsigned long long)w.stalls);
+    CHECK(writes > 0, "no write before close");
+    unlink(path);
+}
+
+// 解 data 若干遍取最快一遍，返回每秒的采样组
+static double rate(const std::vector<uint8_t> &data, double &mb_s) {
+    static EcgRxDecoder rx;
+    EcgRxSink sink = {};
+    double best = 1e9;
+    uint64_t sets = 0;
+    for (int run = 0; run < 5; run++) {
+        ecg_rx_init(rx, sink, 1000);
+        double start = now_s();
+        for (size_t i = 0; i < data.size(); i += 65536) {
+            ecg_rx_feed(rx, data.data() + i, data.size() - i < 65536 ? data.size() - i : 65536);
+        }
+        ecg_rx_finish(rx);
+        double t = now_s() - start;
+        best = t < best ? t : best;
+        sets = rx.stats.sets;
+    }
+    mb_s = data.size() / 1e6 / best;
+    return sets / best;
+}
+
+static void check_rate() {
+    std::vector<uint8_t> frames, csv;
+    for (uint32_t seq = 0; seq < 50000; seq++) {
+        put_frame(frames, seq, 0x1);
+    }
+    for (uint32_t t = 0; t < 500000; t++) {
+        put_csv(csv, t);
+    }
+    double frame_mb, csv_mb;
+    double frame_sets = rate(frames, frame_mb);
+    double csv_sets = rate(csv, csv_mb);
+    printf("rate: frames %.0f MB/s, %.0f sets/s (%.0f devices); csv %.0f MB/s, %.0f sets/s (%.0f devices)\n",
+           frame_mb, frame_sets, frame_sets / DEVICE_SETS, csv_mb, csv_sets, csv_sets / DEVICE_SETS);
+    CHECK(frame_sets >= 100 * DEVICE_SETS && csv_sets >= 100 * DEVICE_SETS, "decoder keeps up with fewer than 100 devices");
+}
+
+int main(int argc, char **argv) {
+    build_capture();
+    check_decode();
+    check_writer();
+    check_rate();
+    if (argc > 1) {
+        FILE *out = fopen(argv[1], "wb");
+        CHECK(out && fwrite(capture.data(), 1, capture.size(), out) == capture.size(), "cannot write %s", argv[1]);
+        if (out) {
+            fclose(out);
+        }
+    }
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("receiver: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * Event-loop scheduler check
+ * Runs the scheduler on a virtual clock: tasks advance the clock by their
+ * run time, and idle jumps to the wake time, raising scripted "interrupts"
+ * on the way. Every case is deterministic; exits 1 on the first failure.
+ *
+ * usage: ecg_scheduler_test
+ */
+
+#include "ecg_scheduler.hpp"
+#include "test_check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint64_t clock_us;
+static uint64_t virtual_clock() {
+    return clock_us;
+}
+
+// 脚本化的中断：时钟走到 at_us 时置位 events
+struct HostIrq {
+    uint64_t at_us;
+    uint32_t events;
+};
+static HostIrq irqs[16];
+static int irq_count, irq_next;
+static int idle_calls;
+
+static void raise_due(EcgScheduler &sched) {
+    while (irq_next < irq_count && irqs[irq_next].at_us <= clock_us) {
+        ecg_sched_post(sched, irqs[irq_next++].events);
+    }
+}
+
+// 睡到 until_us 或下一个中断，先到者为准
+static void virtual_idle(EcgScheduler &sched, uint64_t until_us) {
+    idle_calls++;
+    if (sched.pending.load() != 0) {
+        return;
+    }
+    uint64_t wake = until_us;
+    if (irq_next < irq_count && irqs[irq_next].at_us < wake) {
+        wake = irqs[irq_next].at_us;
+    }
+    clock_us = wake;
+    raise_due(sched);
+}
+
+static void reset(EcgScheduler &sched) {
+    clock_us = 1000;
+    irq_count = irq_next = idle_calls = 0;
+    ecg_sched_init(sched, virtual_clock, virtual_idle);
+}
+
+// 任务记录运行顺序和时刻，再按 cost 推进时钟
+struct Probe {
+    char id;
+    uint32_t cost_us;
+    EcgScheduler *sched;
+    uint32_t post_events;   // 运行中置位的事件，模拟任务运行时来的中断
+};
+static char order[64];
+static uint64_t times[64];
+static int order_len;
+
+static void probe_task(void *arg) {
+    Probe *p = (Probe *)arg;
+    if (order_len < 63) {
+        times[order_len] = clock_us;
+        order[order_len++] = p->id;
+        order[order_len] = 0;
+    }
+    clock_us += p->cost_us;
+    if (p->post_events != 0) {
+        ecg_sched_post(*p->sched, p->post_events);
+        p->post_events = 0;
+    }
+}
+
+static EcgScheduler sched;
+
+// 周期任务按周期递推，不漂移；运行时间记入统计，其余时间在 idle
+static void test_periodic() {
+    reset(sched);
+    order_len = 0;
+    Probe a = {'a', 100, &sched, 0};
+    Probe b = {'b', 300, &sched, 0};
+    ecg_sched_add(sched, "a", probe_task, &a, 0, 10000, 0);
+    ecg_sched_add(sched, "b", probe_task, &b, 0, 25000, 0);
+    ecg_sched_run_until(sched, 1000 + 101000);
+    CHECK(sched.tasks[0].runs == 10, "periodic a ran %u times, expected 10", sched.tasks[0].runs);
+    CHECK(sched.tasks[1].runs == 4, "periodic b ran %u times, expected 4", sched.tasks[1].runs);
+    CHECK(times[0] == 11000, "first run at %llu, expected 11000", (unsigned long long)times[0]);
+    CHECK(sched.tasks[0].busy_us == 1000 && sched.tasks[1].busy_us == 1200, "busy %llu/%llu",
+          (unsigned long long)sched.tasks[0].busy_us, (unsigned long long)sched.tasks[1].busy_us);
+    CHECK(sched.idle_us == 101000 - 2200, "idle %llu us, expected 98800", (unsigned long long)sched.idle_us);
+    CHECK(sched.idle_clock_us.load() == 101000 - 2200, "idle clock %u us", sched.idle_clock_us.load());
+    // 50 ms 时两个任务同时到期，没有截止时间时按添加顺序
+    bool found = false;
+    for (int i = 0; i + 1 < order_len; i++) {
+        if (times[i] == 51000) {
+            CHECK(order[i] == 'a' && order[i + 1] == 'b', "tie at 50 ms ran %c%c", order[i], order[i + 1]);
+            CHECK(times[i + 1] == 51100, "b started at %llu", (unsigned long long)times[i + 1]);
+            found = true;
+        }
+    }
+    CHECK(found, "no run at 50 ms");
+
+    // 取出统计：副本留着这段的数，调度器从零开始
+    static EcgSchedStats stats;
+    ecg_sched_take_stats(sched, stats);
+    CHECK(stats.elapsed_us == 101000 && stats.idle_us == 101000 - 2200, "stats %llu us, idle %llu us",
+          (unsigned long long)stats.elapsed_us, (unsigned long long)stats.idle_us);
+    CHECK(stats.count == 2 && stats.tasks[0].runs == 10 && stats.tasks[1].busy_us == 1200, "stats runs %u busy %llu",
+          stats.tasks[0].runs, (unsigned long long)stats.tasks[1].busy_us);
+    CHECK(sched.tasks[0].runs == 0 && sched.tasks[1].busy_us == 0 && sched.idle_us == 0, "stats not cleared");
+    CHECK(sched.tasks[0].period_us == 10000, "period cleared with the stats");
+    char line[128];
+    uint32_t next = 0;
+    int lines = 0;
+    while (ecg_sched_report_line(stats, &next, line, sizeof(line))) {
+        CHECK(lines > 0 || strcmp(line, "sched: 101 ms, idle 97%\n") == 0, "summary line: %s", line);
+        lines++;
+    }
+    CHECK(lines == 3, "%d report lines, expected 3", lines);
+}
+
+// 同时就绪时截止时间早的先运行
+static void test_deadlines() {
+    reset(sched);
+    order_len = 0;
+    Probe slow = {'s', 4000, &sched, 0};
+    Probe urgent = {'u', 500, &sched, 0};
+    ecg_sched_add(sched, "slow", probe_task, &slow, 1u << 0, 0, 20000);
+    ecg_sched_add(sched, "urgent", probe_task, &urgent, 1u << 1, 0, 3000);
+    irqs[irq_count++] = {5000, (1u << 0) | (1u << 1)};
+    irqs[irq_count++] = {20000, 1u << 1};
+    ecg_sched_run_until(sched, 30000);
+    CHECK(strcmp(order, "usu") == 0, "order %s, expected usu", order);
+    CHECK(sched.tasks[1].misses == 0 && sched.tasks[0].misses == 0, "misses %u/%u",
+          sched.tasks[0].misses, sched.tasks[1].misses);
+    CHECK(sched.tasks[0].max_wait_us == 500, "slow waited %u us, expected 500", sched.tasks[0].max_wait_us);
+
+    // 长任务运行中到来的事件在它结束后取走，紧急任务随即运行
+    reset(sched);
+    order_len = 0;
+    slow.cost_us = 4000;
+    ecg_sched_add(sched, "slow", probe_task, &slow, 1u << 0, 0, 0);
+    ecg_sched_add(sched, "urgent", probe_task, &urgent, 1u << 1, 0, 3000);
+    slow.post_events = 1u << 1;     // slow 运行时 urgent 的中断到来
+    irqs[irq_count++] = {2000, 1u << 0};
+    ecg_sched_run_until(sched, 20000);
+    CHECK(strcmp(order, "su") == 0, "order %s, expected su", order);
+    CHECK(sched.tasks[1].misses == 0, "urgent released at the end of slow should not miss");
+    CHECK(times[1] == 6000, "urgent started at %llu, expected 6000", (unsigned long long)times[1]);
+    slow.post_events = 0;
+}
+
+// 运行中又来的事件让任务再运行一次；未运行前重复到来的事件合并
+static void test_coalesce() {
+    reset(sched);
+    order_len = 0;
+    Probe p = {'p', 200, &sched, 1u << 0};
+    ecg_sched_add(sched, "p", probe_task, &p, 1u << 0, 0, 1000);
+    irqs[irq_count++] = {3000, 1u << 0};
+    irqs[irq_count++] = {3000, 1u << 0};
+    irqs[irq_count++] = {3000, 1u << 0};
+    ecg_sched_run_until(sched, 10000);
+    CHECK(strcmp(order, "pp") == 0, "order %s, expected pp", order);
+    CHECK(times[1] == 3200, "second run at %llu, expected 3200", (unsigned long long)times[1]);
+}
+
+// 一次性唤醒、没有事件时 idle 睡到 until、超过一个周期的延误跳过错过的几次
+static void test_wake_and_overrun() {
+    reset(sched);
+    order_len = 0;
+    Probe once = {'o', 10, &sched, 0};
+    int id = ecg_sched_add(sched, "once", probe_task, &once, 0, 0, 0);
+    ecg_sched_wake_at(sched, id, 7000);
+    ecg_sched_run_until(sched, 50000);
+    CHECK(strcmp(order, "o") == 0 && times[0] == 7000, "one-shot ran %s at %llu", order, (unsigned long long)times[0]);
+    CHECK(idle_calls == 2, "idle called %d times, expected 2", idle_calls);
+
+    reset(sched);
+    order_len = 0;
+    Probe hog = {'h', 35000, &sched, 0};
+    ecg_sched_add(sched, "hog", probe_task, &hog, 0, 10000, 10000);
+    ecg_sched_run_until(sched, 1000 + 60000);
+    // 11 ms 运行到 46 ms；21 ms 那次马上补上，31/41 ms 跳过，下一次是 56 ms
+    CHECK(order_len == 2 && times[1] == 46000, "overrun runs %d, second at %llu",
+          order_len, (unsigned long long)times[1]);
+    CHECK(sched.tasks[0].next_us == 56000, "next run at %llu, expected 56000",
+          (unsigned long long)sched.tasks[0].next_us);
+    CHECK(sched.tasks[0].misses == 2, "overrun misses %u, expected 2", sched.tasks[0].misses);
+    CHECK(sched.tasks[0].max_us == 35000, "max run %u us", sched.tasks[0].max_us);
+}
+
+int main() {
+    test_periodic();
+    test_deadlines();
+    test_coalesce();
+    test_wake_and_overrun();
+    if (failures != 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("scheduler ok\n");
+    return 0;
+}
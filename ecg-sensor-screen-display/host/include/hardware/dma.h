@@ -0,0 +1,10 @@
+/*****************************************************************************
+* | File      	:   hardware/dma.h (host)
+* | Function    :   Empty stand-in, the host DEV_Config has no dma peripheral
+******************************************************************************/
+#ifndef _HOST_HARDWARE_DMA_H_
+#define _HOST_HARDWARE_DMA_H_
+
+#include "pico/stdlib.h"
+
+#endif
@@ -0,0 +1,10 @@
+/*****************************************************************************
+* | File      	:   hardware/i2c.h (host)
+* | Function    :   Empty stand-in, the host DEV_Config has no i2c peripheral
+******************************************************************************/
+#ifndef _HOST_HARDWARE_I2C_H_
+#define _HOST_HARDWARE_I2C_H_
+
+#include "pico/stdlib.h"
+
+#endif
@@ -0,0 +1,10 @@
+/*****************************************************************************
+* | File      	:   hardware/pwm.h (host)
+* | Function    :   Empty stand-in, the host DEV_Config has no pwm peripheral
+******************************************************************************/
+#ifndef _HOST_HARDWARE_PWM_H_
+#define _HOST_HARDWARE_PWM_H_
+
+#include "pico/stdlib.h"
+
+#endif
@@ -0,0 +1,10 @@
+/*****************************************************************************
+* | File      	:   hardware/spi.h (host)
+* | Function    :   Empty stand-in, the host DEV_Config has no spi peripheral
+******************************************************************************/
+#ifndef _HOST_HARDWARE_SPI_H_
+#define _HOST_HARDWARE_SPI_H_
+
+#include "pico/stdlib.h"
+
+#endif
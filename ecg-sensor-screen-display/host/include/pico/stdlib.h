@@ -0,0 +1,24 @@
+/*****************************************************************************
+* | File      	:   pico/stdlib.h (host)
+* | Function    :   Minimal stand-in for the pico SDK header on Linux
+* | Info        :
+*   Only the types and time helpers used by lib/ and the ECG render path.
+******************************************************************************/
+#ifndef _HOST_PICO_STDLIB_H_
+#define _HOST_PICO_STDLIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// One thread stands in for core 0
+static inline uint get_core_num(void)
+{
+    return 0;
+}
+
+#include "pico/time.h"
+
+#endif
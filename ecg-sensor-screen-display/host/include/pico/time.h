@@ -0,0 +1,44 @@
+/*****************************************************************************
+* | File      	:   pico/time.h (host)
+* | Function    :   Virtual clock for the host build
+* | Info        :
+*   Time is CLOCK_MONOTONIC plus every sleep_ms()/sleep_us() requested so
+*   far. Sleeps return immediately, so LCD reset delays cost nothing while
+*   time-based code (heart rate) still sees them elapse.
+******************************************************************************/
+#ifndef _HOST_PICO_TIME_H_
+#define _HOST_PICO_TIME_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+
+static inline uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return (uint32_t)(t / 1000);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
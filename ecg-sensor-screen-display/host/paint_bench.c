@@ -0,0 +1,378 @@
+/*****************************************************************************
+* | File      	:   paint_bench.c
+* | Function    :   GUI_Paint benchmark and golden-image regression suite
+* | Info        :
+*   Runs every scenario (clear, grid, waveform, column-span traces, strings
+*   in Font8..Font24, right-aligned GB2312 strings in Font12CN/Font24CN,
+*   filled rectangle, filled circle) in every rotation x mirror x scale mode
+*   on a 240x135 image cache. For each case it reports pixels written and
+*   ns per pixel, and hashes the resulting image cache (FNV-1a 64).
+*
+*   paint_bench [--iterations N] [--filter TEXT] [--deferred]
+*               [--check FILE | --update FILE] [--dump DIR]
+*
+*   --check  compares every hash with FILE and fails on any difference,
+*            so fast paths cannot change pixels unnoticed.
+*   --update rewrites FILE from the current implementation.
+*   --dump   writes the image cache of each mismatching case to DIR.
+*   --deferred records each scene into a display list and rasterises it
+*            band by band (GUI_DisplayList), timing record + flush. Only the
+*            s65-r0-mnone cases run, and they must match the same hashes as
+*            the immediate mode. A second flush of an unchanged list must
+*            be skipped.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "GUI_Paint.h"
+#include "GUI_DisplayList.h"
+#include "GUI_Waveform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#define BENCH_WIDTH         240
+#define BENCH_HEIGHT        135
+#define BENCH_MAX_CASES     1024
+#define BENCH_NAME_LEN      48
+#define BENCH_LIST_CMDS     65535
+
+static UBYTE Image[BENCH_WIDTH * BENCH_HEIGHT * 2];
+static PAINT_CMD List_Cmds[BENCH_LIST_CMDS];
+static PAINT_LIST List;
+
+typedef struct {
+    UWORD Rotate;
+    UBYTE Mirror;
+    UBYTE Scale;
+} BENCH_MODE;
+
+typedef struct {
+    const char *Name;
+    void (*Draw)(void);
+} BENCH_SCENARIO;
+
+typedef struct {
+    char Name[BENCH_NAME_LEN];
+    uint64_t Hash;
+} BENCH_GOLDEN;
+
+static BENCH_GOLDEN Golden[BENCH_MAX_CASES];
+static int Golden_Num;
+
+/******************************************************************************
+function:	Scenarios, all coordinates follow Paint.Width/Height so the same
+            drawing fits every rotation
+******************************************************************************/
+static void Scene_Clear(void)
+{
+    Paint_Clear(BLACK);
+}
+
+static void Scene_Grid(void)
+{
+    for (UWORD x = 0; x < Paint.Width; x += 20)
+        Paint_DrawLine(x, 0, x, Paint.Height - 1, GRAY, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    for (UWORD y = 0; y < Paint.Height; y += 20)
+        Paint_DrawLine(0, y, Paint.Width - 1, y, GRAY, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+}
+
+static void Scene_Waveform(void)
+{
+    UWORD Mid = Paint.Height / 2;
+    UWORD Amp = Paint.Height / 3;
+    UWORD Prev_Y = Mid;
+    for (UWORD x = 1; x < Paint.Width; x++) {
+        // Sharp spike every 60 columns on top of a slow sine, like an ECG
+        double Phase = (x % 60) / 60.0;
+        double V = 0.3 * sin(x * 0.05) + (Phase > 0.45 && Phase < 0.5 ? 1.0 : 0.0);
+        UWORD Y = Mid - (int)(V * Amp);
+        Paint_DrawLine(x - 1, Prev_Y, x, Y, BLUE, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+        Prev_Y = Y;
+    }
+}
+
+// Polyline and min/max envelope of the same signal, drawn twice so the
+// second draw erases the first in place
+static void Scene_Trace(void)
+{
+    static UWORD Line[2][BENCH_WIDTH], Top[2][BENCH_WIDTH], Bottom[2][BENCH_WIDTH];
+    static UWORD Prev[2][2 * BENCH_WIDTH];
+    UWORD Mid = Paint.Height / 2;
+    UWORD Amp = Paint.Height / 3;
+    UWORD Columns = Paint.Width < BENCH_WIDTH ? Paint.Width : BENCH_WIDTH;
+    PAINT_TRACE Traces[2];
+
+    for (int f = 0; f < 2; f++) {
+        for (UWORD x = 0; x < Columns; x++) {
+            double Phase = ((x + f * 17) % 60) / 60.0;
+            double V = 0.3 * sin((x + f * 17) * 0.05) + (Phase > 0.45 && Phase < 0.5 ? 1.0 : 0.0);
+            Line[f][x] = Mid - (int)(V * Amp);
+            Top[f][x] = Line[f][x] - 4 - x % 3;
+            Bottom[f][x] = Line[f][x] + 6;
+        }
+    }
+    Paint_TraceInit(&Traces[0], 0, Columns, 0, Paint.Height - 1, BLUE);
+    Paint_TraceInit(&Traces[1], 0, Columns, 0, Paint.Height - 1, RED);
+    Paint_TraceSetErase(&Traces[0], Prev[0], BLACK);
+    Paint_TraceSetErase(&Traces[1], Prev[1], BLACK);
+    for (int f = 0; f < 2; f++) {
+        Paint_TraceSetData(&Traces[0], Line[f], NULL);
+        Paint_TraceSetData(&Traces[1], Top[f], Bottom[f]);
+        Paint_DrawTraces(Traces, 2);
+    }
+}
+
+static void Scene_String(sFONT *Font)
+{
+    Paint_DrawString_EN(2, 2, "HR: 72 BPM ecg~!", Font, BLACK, GREEN);
+}
+
+static void Scene_Font8(void)  { Scene_String(&Font8); }
+static void Scene_Font12(void) { Scene_String(&Font12); }
+static void Scene_Font16(void) { Scene_String(&Font16); }
+static void Scene_Font20(void) { Scene_String(&Font20); }
+static void Scene_Font24(void) { Scene_String(&Font24); }
+
+// "你好 ECG" right-aligned with Paint_GetStringWidth_CN
+static void Scene_String_CN(cFONT *Font)
+{
+    const char *Text = "\xC4\xE3\xBA\xC3 abc";
+    UWORD Width = Paint_GetStringWidth_CN(Text, Font);
+    UWORD X = Width + 2 < Paint.Width ? Paint.Width - Width - 2 : 0;
+    Paint_DrawString_CN(X, 2, Text, Font, GREEN, BLACK);
+}
+
+static void Scene_Font12CN(void) { Scene_String_CN(&Font12CN); }
+static void Scene_Font24CN(void) { Scene_String_CN(&Font24CN); }
+
+static void Scene_Rect(void)
+{
+    Paint_DrawRectangle(10, 10, Paint.Width - 10, Paint.Height - 10, RED, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+}
+
+static void Scene_Circle(void)
+{
+    UWORD R = (Paint.Width < Paint.Height ? Paint.Width : Paint.Height) / 2 - 4;
+    Paint_DrawCircle(Paint.Width / 2, Paint.Height / 2, R, GREEN, DOT_PIXEL_1X1, DRAW_FILL_FULL);
+}
+
+static const BENCH_SCENARIO Scenarios[] = {
+    {"clear",    Scene_Clear},
+    {"grid",     Scene_Grid},
+    {"waveform", Scene_Waveform},
+    {"trace",    Scene_Trace},
+    {"font8",    Scene_Font8},
+    {"font12",   Scene_Font12},
+    {"font16",   Scene_Font16},
+    {"font20",   Scene_Font20},
+    {"font24",   Scene_Font24},
+    {"font12cn", Scene_Font12CN},
+    {"font24cn", Scene_Font24CN},
+    {"rect",     Scene_Rect},
+    {"circle",   Scene_Circle},
+};
+
+static const UWORD Rotates[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+static const UBYTE Mirrors[] = {MIRROR_NONE, MIRROR_HORIZONTAL, MIRROR_VERTICAL, MIRROR_ORIGIN};
+static const UBYTE Scales[] = {2, 4, 16, 65};
+static const char *Mirror_Names[] = {"none", "h", "v", "hv"};
+
+/******************************************************************************
+function:	Helpers
+******************************************************************************/
+static uint64_t Bench_Now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static uint64_t Bench_Hash(const UBYTE *pData, UDOUBLE Len)
+{
+    uint64_t Hash = 0xcbf29ce484222325ull;
+    for (UDOUBLE i = 0; i < Len; i++) {
+        Hash ^= pData[i];
+        Hash *= 0x100000001b3ull;
+    }
+    return Hash;
+}
+
+static void Bench_Setup(const BENCH_MODE *Mode, int Deferred)
+{
+    memset(Image, 0, sizeof(Image));
+    Paint_NewImage(Image, BENCH_WIDTH, BENCH_HEIGHT, Mode->Rotate, WHITE);
+    Paint_SetScale(Mode->Scale);
+    Paint_SetMirroring(Mode->Mirror);
+    if (Deferred) {
+        // The zeroed image cache is BLACK, so is a fresh list
+        Paint_ListInit(&List, List_Cmds, BENCH_LIST_CMDS, BLACK);
+        Paint_SetList(&List);
+    }
+}
+
+// Band sink, copies the rows into the image cache so they can be hashed
+static void Bench_Sink(UWORD Ystart, UWORD Yend, UWORD *Band)
+{
+    memcpy(&Image[Ystart * BENCH_WIDTH * 2], Band, (Yend - Ystart) * BENCH_WIDTH * 2);
+}
+
+static UDOUBLE Bench_ImageSize(void)
+{
+    return (UDOUBLE)Paint.WidthByte * Paint.HeightByte;
+}
+
+static int Golden_Load(const char *Path)
+{
+    FILE *fp = fopen(Path, "r");
+    if (fp == NULL) {
+        printf("cannot open golden file %s\r\n", Path);
+        return -1;
+    }
+    char Name[BENCH_NAME_LEN];
+    unsigned long long Hash;
+    while (Golden_Num < BENCH_MAX_CASES && fscanf(fp, "%47s %llx", Name, &Hash) == 2) {
+        strcpy(Golden[Golden_Num].Name, Name);
+        Golden[Golden_Num].Hash = Hash;
+        Golden_Num++;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static const BENCH_GOLDEN *Golden_Find(const char *Name)
+{
+    for (int i = 0; i < Golden_Num; i++) {
+        if (strcmp(Golden[i].Name, Name) == 0)
+            return &Golden[i];
+    }
+    return NULL;
+}
+
+static void Bench_Dump(const char *Dir, const char *Name)
+{
+    char Path[256];
+    snprintf(Path, sizeof(Path), "%s/%s.bin", Dir, Name);
+    FILE *fp = fopen(Path, "wb");
+    if (fp == NULL) {
+        printf("cannot write %s\r\n", Path);
+        return;
+    }
+    fwrite(Image, 1, Bench_ImageSize(), fp);
+    fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
+    int Iterations = 20;
+    const char *Filter = NULL;
+    const char *Check_Path = NULL;
+    const char *Update_Path = NULL;
+    const char *Dump_Dir = NULL;
+    int Deferred = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            Iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            Filter = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            Check_Path = argv[++i];
+        } else if (strcmp(argv[i], "--update") == 0 && i + 1 < argc) {
+            Update_Path = argv[++i];
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            Dump_Dir = argv[++i];
+        } else if (strcmp(argv[i], "--deferred") == 0) {
+            Deferred = 1;
+        } else {
+            printf("usage: %s [--iterations N] [--filter TEXT] [--deferred] "
+                   "[--check FILE | --update FILE] [--dump DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (Iterations < 1)
+        Iterations = 1;
+    if (Check_Path != NULL && Golden_Load(Check_Path) != 0)
+        return 1;
+
+    FILE *Update_fp = NULL;
+    if (Update_Path != NULL && (Update_fp = fopen(Update_Path, "w")) == NULL) {
+        printf("cannot write golden file %s\r\n", Update_Path);
+        return 1;
+    }
+
+    int Cases = 0, Failures = 0;
+    printf("%-32s %10s %12s %10s\n", "case", "pixels", "ns/op", "ns/pixel");
+
+    for (size_t s = 0; s < sizeof(Scenarios) / sizeof(Scenarios[0]); s++) {
+        for (size_t sc = 0; sc < sizeof(Scales); sc++) {
+            for (size_t r = 0; r < sizeof(Rotates) / sizeof(Rotates[0]); r++) {
+                for (size_t m = 0; m < sizeof(Mirrors); m++) {
+                    BENCH_MODE Mode = {Rotates[r], Mirrors[m], Scales[sc]};
+                    char Name[BENCH_NAME_LEN];
+                    snprintf(Name, sizeof(Name), "%s-s%d-r%d-m%s", Scenarios[s].Name,
+                             Mode.Scale, Mode.Rotate, Mirror_Names[m]);
+                    if (Filter != NULL && strstr(Name, Filter) == NULL)
+                        continue;
+                    if (Deferred && (Mode.Scale != 65 || Mode.Rotate != ROTATE_0 || Mode.Mirror != MIRROR_NONE))
+                        continue;
+
+                    // Timed runs start from a fresh image cache every time
+                    uint64_t Best_ns = UINT64_MAX;
+                    UDOUBLE Pixels = 0;
+                    for (int it = 0; it < Iterations; it++) {
+                        Bench_Setup(&Mode, Deferred);
+                        Paint_PixelCount = 0;
+                        uint64_t Start = Bench_Now_ns();
+                        Scenarios[s].Draw();
+                        if (Deferred)
+                            Paint_ListFlush(&List, Bench_Sink);
+                        uint64_t Elapsed = Bench_Now_ns() - Start;
+                        Best_ns = Elapsed < Best_ns ? Elapsed : Best_ns;
+                        Pixels = Paint_PixelCount;
+                    }
+
+                    if (Deferred) {
+                        if (List.Overflow || Paint_ListFlush(&List, Bench_Sink) != 0) {
+                            printf("DEFERRED %s: %s\n", Name,
+                                   List.Overflow ? "command list full" : "unchanged frame was sent again");
+                            Failures++;
+                        }
+                        Paint_SetList(NULL);
+                    }
+
+                    uint64_t Hash = Bench_Hash(Image, Bench_ImageSize());
+                    printf("%-32s %10lu %12llu %10.2f\n", Name, (unsigned long)Pixels,
+                           (unsigned long long)Best_ns, Pixels ? (double)Best_ns / Pixels : 0.0);
+                    Cases++;
+
+                    if (Update_fp != NULL)
+                        fprintf(Update_fp, "%s %016llx\n", Name, (unsigned long long)Hash);
+
+                    if (Check_Path != NULL) {
+                        const BENCH_GOLDEN *pGolden = Golden_Find(Name);
+                        if (pGolden == NULL || pGolden->Hash != Hash) {
+                            printf("MISMATCH %s: got %016llx, golden %s\n", Name,
+                                   (unsigned long long)Hash, pGolden ? "differs" : "missing");
+                            Failures++;
+                            if (Dump_Dir != NULL)
+                                Bench_Dump(Dump_Dir, Name);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (Update_fp != NULL)
+        fclose(Update_fp);
+
+    printf("%d cases", Cases);
+    if (Check_Path != NULL)
+        printf(", %d golden mismatches", Failures);
+    printf("\n");
+    return Failures ? 1 : 0;
+}
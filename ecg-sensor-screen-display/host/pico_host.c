@@ -0,0 +1,31 @@
+/*****************************************************************************
+* | File      	:   pico_host.c
+* | Function    :   Virtual clock behind the host pico/time.h
+******************************************************************************/
+#include "pico/time.h"
+
+#include <time.h>
+
+static uint64_t Slept_us;
+
+uint64_t time_us_64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000u + Slept_us;
+}
+
+absolute_time_t get_absolute_time(void)
+{
+    return time_us_64();
+}
+
+void sleep_ms(uint32_t ms)
+{
+    Slept_us += (uint64_t)ms * 1000u;
+}
+
+void sleep_us(uint64_t us)
+{
+    Slept_us += us;
+}
@@ -0,0 +1,21 @@
+/*****************************************************************************
+* | File      	:   test_check.h
+* | Function    :   Failure counting shared by the host tests
+* | Info        :
+*   CHECK prints "FAIL: " and the message when the condition is false and
+*   counts the failure; the test keeps going and main() returns 1 when
+*   failures is not zero. Included by both the C and the C++ tests.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#ifndef _TEST_CHECK_H_
+#define _TEST_CHECK_H_
+
+#include <stdio.h>
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { printf("FAIL: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+#endif
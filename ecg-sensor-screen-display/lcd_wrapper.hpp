@@ -7,9 +7,20 @@ extern "C" {
 #endif
 
 #include "DEV_Config.h"
+#include "DEV_Log.h"
+#include "DEV_Trace.h"
+#include "LCD_0in96.h"
 #include "LCD_1in14.h"
+#include "LCD_1in3.h"
+#include "LCD_1in44.h"
+#include "LCD_1in54.h"
+#include "LCD_1in8.h"
+#include "LCD_2in.h"
 #include "EPD_Test.h"
 #include "GUI_Paint.h"  // 如果这个头文件存在的话
+#include "GUI_DisplayList.h"
+#include "GUI_Compositor.h"
+#include "GUI_Waveform.h"
 
 #ifdef __cplusplus
 }
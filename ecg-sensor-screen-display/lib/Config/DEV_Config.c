@@ -27,9 +27,26 @@
 # THE SOFTWARE.
 ******************************************************************************/
 #include "DEV_Config.h"
+#include "Debug.h"
+#include "DEV_Trace.h"
+#include "hardware/irq.h"
+#include "hardware/structs/busctrl.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "pico/critical_section.h"
+#if !PICO_RISCV
+#include "hardware/structs/m33.h"
+#endif
+#include "hardware/clocks.h"
+#if DEV_LCD_PIO
+#include "hardware/pio.h"
+#include "lcd_spi.pio.h"
+#endif
 
 #define SPI_PORT spi1
-#define I2C_PORT spi1
+#define I2C_PORT i2c1
+#define DEV_I2C_HZ      300000
+#define DEV_PWM_TICK_HZ 3000000     // backlight counter clock, clk_sys / 50 at 150 MHz
+#define I2C_IRQ  I2C1_IRQ
 
 /**
  * GPIO
@@ -45,11 +62,73 @@ int EPD_SDA_PIN;
 
 
 uint slice_num;
+
+/**
+ * Transaction queues, one per bus. Head is on the bus, Link runs to Tail.
+**/
+typedef struct {
+    DEV_XFER *volatile Head;
+    DEV_XFER *Tail;
+} DEV_XFER_QUEUE;
+
+static DEV_XFER_QUEUE Xfer_Queue[DEV_BUS_COUNT];
+static critical_section_t Xfer_Lock;
+// Set by DEV_Set_Sys_Clock: transfers still queue, but none starts
+static volatile UBYTE Xfer_Hold;
+static volatile UBYTE Xfer_Stalled[DEV_BUS_COUNT];  // Head is queued but not started
+
+static int spi_tx_chan = -1;
+static int spi_rx_chan = -1;     // RX, or the segment header with DEV_LCD_PIO
+static int spi_irq_chan = -1;    // the channel that finishes last
+static int i2c_tx_chan = -1;
+static int i2c_rx_chan = -1;
+
+static UBYTE Spi_Zero;
+static UBYTE Spi_Discard;
+static uint32_t I2c_Cmd[DEV_I2C_XFER_MAX];
+
+// Double-buffered writes behind DEV_SPI_Write_nByte_DMA
+static DEV_XFER Spi_Dma_Xfer[2];
+static UBYTE Spi_Dma_Next;
+
+#if DEV_LCD_PIO
+static PIO lcd_pio;
+static uint lcd_sm;
+static uint lcd_offset;
+static UBYTE Lcd_Dc;             // DC for untagged writes, set through DEV_Digital_Write
+static UBYTE Lcd_Header[DEV_SPI_TAG_BYTES];
+#endif
+
+#if DEV_MEMORY_PLAN
+/**
+ * DEV_RAM_FRAME is NOLOAD, so it holds whatever the SRAM powered up with.
+ * Clear it like .bss, ahead of the C++ constructors.
+**/
+extern UBYTE __sram_frame_start__[];
+extern UBYTE __sram_frame_end__[];
+
+static void __attribute__((constructor(101))) DEV_Memory_Init(void)
+{
+    UBYTE *p;
+    for(p = __sram_frame_start__; p < __sram_frame_end__; p++)
+        *p = 0;
+}
+#endif
+
 /**
  * GPIO read and write
 **/
 void DEV_Digital_Write(UWORD Pin, UBYTE Value)
 {
+#if DEV_LCD_PIO
+    // DC and CS belong to the PIO program, DC goes out with the next write
+    if(Pin == EPD_DC_PIN) {
+        Lcd_Dc = Value;
+        return;
+    }
+    if(Pin == EPD_CS_PIN)
+        return;
+#endif
     gpio_put(Pin, Value);
 }
 
@@ -58,41 +137,425 @@ UBYTE DEV_Digital_Read(UWORD Pin)
     return gpio_get(Pin);
 }
 
+/**
+ * Transaction queue
+**/
+static UDOUBLE Xfer_Len(const DEV_XFER *Xfer)
+{
+    if(Xfer->Bus == DEV_BUS_SPI)
+        return Xfer->Tx_Len ? Xfer->Tx_Len : Xfer->Rx_Len;
+    return Xfer->Tx_Len + Xfer->Rx_Len;
+}
+
+static UBYTE Xfer_Check(const DEV_XFER *Xfer, UBYTE Bus)
+{
+    UDOUBLE Len = Xfer_Len(Xfer);
+    if(Xfer->Bus != Bus || Len == 0 || (Xfer->Rx_Len && !Xfer->pRx))
+        return 0;
+    if(Bus == DEV_BUS_SPI) {
+        if(Xfer->Dc == DEV_XFER_DC_TAGGED && (!DEV_LCD_PIO || !Xfer->pTx || Xfer->pRx))
+            return 0;
+        // The PIO program only writes
+        if(DEV_LCD_PIO && Xfer->pRx)
+            return 0;
+        // SPI is full duplex, both directions clock the same bytes
+        return Xfer->Rx_Len == 0 || Xfer->Rx_Len == Len;
+    }
+    return (Xfer->Tx_Len == 0 || Xfer->pTx) && Len <= DEV_I2C_XFER_MAX;
+}
+
+#if DEV_LCD_PIO
+static void Xfer_Start_SPI(DEV_XFER *Xfer)
+{
+    UDOUBLE Len = Xfer_Len(Xfer);
+    volatile void *Txf = &lcd_pio->txf[lcd_sm];
+    dma_channel_config cfg;
+
+    cfg = dma_channel_get_default_config(spi_tx_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, Xfer->pTx != NULL);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(lcd_pio, lcd_sm, true));
+    dma_channel_configure(spi_tx_chan, &cfg, Txf, Xfer->pTx ? Xfer->pTx : &Spi_Zero, Len, false);
+    if(Xfer->Dc == DEV_XFER_DC_TAGGED) {
+        dma_channel_start(spi_tx_chan);
+        return;
+    }
+
+    // Tag the bytes as one segment; the header channel then starts the data
+    DEV_SPI_Tag(Lcd_Header, Xfer->Dc == DEV_XFER_PIN_KEEP ? Lcd_Dc : Xfer->Dc, NULL, Len);
+    cfg = dma_channel_get_default_config(spi_rx_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(lcd_pio, lcd_sm, true));
+    channel_config_set_chain_to(&cfg, spi_tx_chan);
+    dma_channel_configure(spi_rx_chan, &cfg, Txf, Lcd_Header, DEV_SPI_TAG_BYTES, true);
+}
+#else
+static void Xfer_Start_SPI(DEV_XFER *Xfer)
+{
+    UDOUBLE Len = Xfer_Len(Xfer);
+    dma_channel_config cfg;
+
+    if(Xfer->Dc != DEV_XFER_PIN_KEEP)
+        gpio_put(EPD_DC_PIN, Xfer->Dc);
+    if(Xfer->Cs != DEV_XFER_PIN_KEEP)
+        gpio_put(EPD_CS_PIN, 0);
+    spi_get_hw(SPI_PORT)->icr = SPI_SSPICR_RORIC_BITS;
+
+    // RX finishes only once the last byte has left the shift register,
+    // so its interrupt marks the end of the transfer
+    cfg = dma_channel_get_default_config(spi_rx_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, Xfer->pRx != NULL);
+    channel_config_set_dreq(&cfg, spi_get_dreq(SPI_PORT, false));
+    channel_config_set_high_priority(&cfg, true);
+    dma_channel_configure(spi_rx_chan, &cfg, Xfer->pRx ? Xfer->pRx : &Spi_Discard,
+                          &spi_get_hw(SPI_PORT)->dr, Len, false);
+
+    cfg = dma_channel_get_default_config(spi_tx_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, Xfer->pTx != NULL);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, spi_get_dreq(SPI_PORT, true));
+    dma_channel_configure(spi_tx_chan, &cfg, &spi_get_hw(SPI_PORT)->dr,
+                          Xfer->pTx ? Xfer->pTx : &Spi_Zero, Len, false);
+
+    dma_start_channel_mask((1u << spi_tx_chan) | (1u << spi_rx_chan));
+}
+#endif
+
+static void Xfer_Start_I2C(DEV_XFER *Xfer)
+{
+    i2c_hw_t *hw = i2c_get_hw(I2C_PORT);
+    UDOUBLE Len = Xfer_Len(Xfer);
+    UDOUBLE i;
+    dma_channel_config cfg;
+
+    // One command word per byte: data to write, or a read request
+    for(i = 0; i < Xfer->Tx_Len; i++)
+        I2c_Cmd[i] = Xfer->pTx[i];
+    for(; i < Len; i++)
+        I2c_Cmd[i] = I2C_IC_DATA_CMD_CMD_BITS;
+    if(Xfer->Tx_Len && Xfer->Rx_Len)
+        I2c_Cmd[Xfer->Tx_Len] |= I2C_IC_DATA_CMD_RESTART_BITS;
+    I2c_Cmd[Len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    hw->enable = 0;
+    hw->tar = Xfer->Addr;
+    hw->enable = 1;
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+    if(Xfer->Rx_Len) {
+        cfg = dma_channel_get_default_config(i2c_rx_chan);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_dreq(&cfg, i2c_get_dreq(I2C_PORT, false));
+        dma_channel_configure(i2c_rx_chan, &cfg, Xfer->pRx, &hw->data_cmd, Xfer->Rx_Len, true);
+    }
+
+    cfg = dma_channel_get_default_config(i2c_tx_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(I2C_PORT, true));
+    dma_channel_configure(i2c_tx_chan, &cfg, &hw->data_cmd, I2c_Cmd, Len, true);
+}
+
+static void Xfer_Start(UBYTE Bus, DEV_XFER *Xfer)
+{
+    if(Bus == DEV_BUS_SPI) {
+        // Ends in Xfer_Complete, on its own track: the CPU moves on meanwhile
+        DEV_TRACE_BEGIN_ON(DEV_TRACE_TRACK_SPI, "spi xfer");
+        Xfer_Start_SPI(Xfer);
+    } else
+        Xfer_Start_I2C(Xfer);
+}
+
+/******************************************************************************
+function:	Retire the transfer at the head of a bus queue, start the next one
+parameter:
+    Bus    : DEV_BUS_SPI or DEV_BUS_I2C
+    Status : DEV_XFER_DONE or DEV_XFER_ERROR
+info:
+    Runs in interrupt context. A failed transfer takes the rest of its
+    chain with it. The next transfer is started before any callback runs,
+    so the bus does not idle while callbacks work.
+******************************************************************************/
+static void Xfer_Complete(UBYTE Bus, UBYTE Status)
+{
+    DEV_XFER_QUEUE *Queue = &Xfer_Queue[Bus];
+    DEV_XFER *Xfer = Queue->Head;
+    DEV_XFER *Last = Xfer;
+
+    if(!DEV_LCD_PIO && Bus == DEV_BUS_SPI && Xfer->Cs == DEV_XFER_CS_FRAME)
+        gpio_put(EPD_CS_PIN, 1);
+    if(Bus == DEV_BUS_SPI)
+        DEV_TRACE_END_ON(DEV_TRACE_TRACK_SPI, "spi xfer");
+
+    critical_section_enter_blocking(&Xfer_Lock);
+    if(Status != DEV_XFER_DONE) {
+        while(Last->Next)
+            Last = Last->Next;
+    }
+    Queue->Head = Last->Link;
+    if(!Queue->Head)
+        Queue->Tail = NULL;
+    else if(Xfer_Hold)
+        Xfer_Stalled[Bus] = 1;
+    else
+        Xfer_Start(Bus, Queue->Head);
+    critical_section_exit(&Xfer_Lock);
+
+    for(;;) {
+        DEV_XFER *Next = Xfer->Next;
+        Xfer->Status = Status;
+        if(Xfer->Callback)
+            Xfer->Callback(Xfer);
+        if(Xfer == Last)
+            break;
+        Xfer = Next;
+    }
+}
+
+static void DEV_SPI_DMA_IRQ(void)
+{
+    if(!dma_irqn_get_channel_status(0, spi_irq_chan))
+        return;
+    dma_irqn_acknowledge_channel(0, spi_irq_chan);
+    DEV_TRACE_BEGIN("spi dma irq");
+    Xfer_Complete(DEV_BUS_SPI, DEV_XFER_DONE);
+    DEV_TRACE_END("spi dma irq");
+}
+
+static void DEV_I2C_IRQ(void)
+{
+    i2c_hw_t *hw = i2c_get_hw(I2C_PORT);
+    uint32_t Stat = hw->intr_stat;
+    UBYTE Status = DEV_XFER_DONE;
+
+    if(Xfer_Queue[DEV_BUS_I2C].Head == NULL) {
+        hw->intr_mask = 0;
+        return;
+    }
+    if(Stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK or lost arbitration, the controller has flushed its FIFO
+        (void)hw->clr_tx_abrt;
+        dma_channel_abort(i2c_tx_chan);
+        dma_channel_abort(i2c_rx_chan);
+        Status = DEV_XFER_ERROR;
+    } else if(Stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        // The last byte read is in the FIFO, DMA picks it up right away
+        if(Xfer_Queue[DEV_BUS_I2C].Head->Rx_Len)
+            dma_channel_wait_for_finish_blocking(i2c_rx_chan);
+    } else {
+        return;
+    }
+    (void)hw->clr_stop_det;
+    hw->intr_mask = 0;
+    Xfer_Complete(DEV_BUS_I2C, Status);
+}
+
+/******************************************************************************
+function:	Queue a transfer, or a chain of them linked through Next
+parameter:
+    Xfer : descriptor and buffers must stay untouched until Status leaves
+           DEV_XFER_QUEUED
+return:
+    0 when queued, 1 when a descriptor is invalid; nothing is queued then
+info:
+    A chain runs back to back on its bus, with no other transfer between
+    its members. The SPI and I2C queues run independently of each other.
+    Callbacks run in interrupt context and may submit further transfers.
+******************************************************************************/
+UBYTE DEV_Xfer_Submit(DEV_XFER *Xfer)
+{
+    UBYTE Bus = Xfer->Bus;
+    DEV_XFER *Last;
+    DEV_XFER_QUEUE *Queue;
+
+    for(Last = Xfer; Last; Last = Last->Next) {
+        if(Bus >= DEV_BUS_COUNT || !Xfer_Check(Last, Bus)) {
+            Debug("DEV_Xfer_Submit: invalid transfer on bus %d\r\n", Bus);
+            Last->Status = DEV_XFER_ERROR;
+            return 1;
+        }
+    }
+    for(Last = Xfer; ; Last = Last->Next) {
+        Last->Status = DEV_XFER_QUEUED;
+        Last->Link = Last->Next;
+        if(!Last->Next)
+            break;
+    }
+
+    Queue = &Xfer_Queue[Bus];
+    critical_section_enter_blocking(&Xfer_Lock);
+    if(Queue->Head) {
+        Queue->Tail->Link = Xfer;
+        Queue->Tail = Last;
+    } else {
+        Queue->Head = Xfer;
+        Queue->Tail = Last;
+        if(Xfer_Hold)
+            Xfer_Stalled[Bus] = 1;
+        else
+            Xfer_Start(Bus, Xfer);
+    }
+    critical_section_exit(&Xfer_Lock);
+    return 0;
+}
+
+void DEV_Xfer_Wait(DEV_XFER *Xfer)
+{
+    while(Xfer->Status == DEV_XFER_QUEUED)
+        tight_loop_contents();
+}
+
+UBYTE DEV_Xfer_Busy(UBYTE Bus)
+{
+    return Xfer_Queue[Bus].Head != NULL;
+}
+
+void DEV_Xfer_Flush(UBYTE Bus)
+{
+    while(DEV_Xfer_Busy(Bus))
+        tight_loop_contents();
+}
+
 /**
  * SPI
 **/
+#if DEV_LCD_PIO
+// One segment straight into the FIFO, tagged with the DC last written
+static void DEV_SPI_Put(const uint8_t *pData, uint32_t Len)
+{
+    UBYTE Header[DEV_SPI_TAG_BYTES];
+    uint32_t i;
+
+    DEV_Xfer_Flush(DEV_BUS_SPI);
+    DEV_SPI_Tag(Header, Lcd_Dc, NULL, Len);
+    for(i = 0; i < DEV_SPI_TAG_BYTES; i++)
+        pio_sm_put_blocking(lcd_pio, lcd_sm, (uint32_t)Header[i] << 24);
+    for(i = 0; i < Len; i++)
+        pio_sm_put_blocking(lcd_pio, lcd_sm, (uint32_t)pData[i] << 24);
+}
+
+void DEV_SPI_WriteByte(uint8_t Value)
+{
+    DEV_SPI_Put(&Value, 1);
+}
+
+void DEV_SPI_Write_nByte(uint8_t pData[], uint32_t Len)
+{
+    if(Len)
+        DEV_SPI_Put(pData, Len);
+}
+#else
+// Through the queue rather than spi_write_blocking, so a clock change
+// holds these writes too and never moves the divider under them
 void DEV_SPI_WriteByte(uint8_t Value)
 {
-    spi_write_blocking(SPI_PORT, &Value, 1);
+    DEV_SPI_Write_nByte(&Value, 1);
 }
 
 void DEV_SPI_Write_nByte(uint8_t pData[], uint32_t Len)
 {
-    spi_write_blocking(SPI_PORT, pData, Len);
+    DEV_XFER Xfer = {0};
+    Xfer.Bus = DEV_BUS_SPI;
+    Xfer.Cs = DEV_XFER_PIN_KEEP;
+    Xfer.Dc = DEV_XFER_PIN_KEEP;
+    Xfer.pTx = pData;
+    Xfer.Tx_Len = Len;
+    if(Len && DEV_Xfer_Submit(&Xfer) == 0)
+        DEV_Xfer_Wait(&Xfer);
+}
+#endif
+
+/******************************************************************************
+function:	Queue a DMA write to the SPI bus and return once it is on its way
+parameter:
+    pData : must stay valid until the next DEV_SPI_Write_nByte_DMA or
+            DEV_SPI_DMA_Wait call
+    Len   : bytes
+info:
+    Waits for the previous write to finish first, so the caller can fill
+    one buffer while the other is on the bus. CS and DC are left to the
+    caller; with DEV_LCD_PIO the bytes are tagged with the DC last written.
+******************************************************************************/
+void DEV_SPI_Write_nByte_DMA(const uint8_t *pData, uint32_t Len)
+{
+    DEV_XFER *Xfer = &Spi_Dma_Xfer[Spi_Dma_Next];
+
+    DEV_Xfer_Wait(Xfer);
+    Xfer->Bus = DEV_BUS_SPI;
+    Xfer->Cs = DEV_XFER_PIN_KEEP;
+    Xfer->Dc = DEV_XFER_PIN_KEEP;
+    Xfer->pTx = pData;
+    Xfer->Tx_Len = Len;
+    if(Len)
+        DEV_Xfer_Submit(Xfer);
+
+    Spi_Dma_Next ^= 1;
+    DEV_Xfer_Wait(&Spi_Dma_Xfer[Spi_Dma_Next]);
+}
+
+/******************************************************************************
+function:	Wait until every queued SPI transfer has left the shift register
+info:
+    Must be called before CS goes high. With DEV_LCD_PIO this also waits
+    for the PIO FIFO to drain and the program to wait for a header.
+******************************************************************************/
+void DEV_SPI_DMA_Wait(void)
+{
+    DEV_Xfer_Flush(DEV_BUS_SPI);
+#if DEV_LCD_PIO
+    while(!pio_sm_is_tx_fifo_empty(lcd_pio, lcd_sm) ||
+          pio_sm_get_pc(lcd_pio, lcd_sm) != lcd_offset + lcd_spi_offset_start)
+        tight_loop_contents();
+#endif
 }
 
 
 
 /**
- * I2C
+ * I2C, queued behind any asynchronous transfers on the bus
 **/
+static UBYTE DEV_I2C_Transfer(uint8_t addr, const uint8_t *pTx, uint32_t Tx_Len,
+                              uint8_t *pRx, uint32_t Rx_Len)
+{
+    DEV_XFER Xfer = {0};
+    Xfer.Bus = DEV_BUS_I2C;
+    Xfer.Addr = addr;
+    Xfer.pTx = pTx;
+    Xfer.Tx_Len = Tx_Len;
+    Xfer.pRx = pRx;
+    Xfer.Rx_Len = Rx_Len;
+    if(DEV_Xfer_Submit(&Xfer) != 0)
+        return DEV_XFER_ERROR;
+    DEV_Xfer_Wait(&Xfer);
+    return Xfer.Status;
+}
 
 void DEV_I2C_Write(uint8_t addr, uint8_t reg, uint8_t Value)
 {
     uint8_t data[2] = {reg, Value};
-    i2c_write_blocking(i2c1, addr, data, 2, false);
+    DEV_I2C_Transfer(addr, data, 2, NULL, 0);
 }
 
 void DEV_I2C_Write_nByte(uint8_t addr, uint8_t *pData, uint32_t Len)
 {
-    i2c_write_blocking(i2c1, addr, pData, Len, false);
+    DEV_I2C_Transfer(addr, pData, Len, NULL, 0);
 }
 
 uint8_t DEV_I2C_ReadByte(uint8_t addr, uint8_t reg)
 {
-    uint8_t buf;
-    i2c_write_blocking(i2c1,addr,&reg,1,true);
-    i2c_read_blocking(i2c1,addr,&buf,1,false);
+    uint8_t buf = 0;
+    DEV_I2C_Transfer(addr, &reg, 1, &buf, 1);
     return buf;
 }
 
@@ -149,6 +612,45 @@ void DEV_GPIO_Init(void)
     DEV_Digital_Write(EPD_DC_PIN, 0);
     DEV_Digital_Write(EPD_BL_PIN, 1);
 }
+/******************************************************************************
+function:	Set up the LCD bus and its DMA channels
+info:
+    With DEV_LCD_PIO, DC, CS and SCK are the program's side-set pins and
+    must be consecutive.
+******************************************************************************/
+static UBYTE DEV_SPI_Init(void)
+{
+    if(spi_tx_chan >= 0)
+        return 0;
+#if DEV_LCD_PIO
+    if(EPD_CS_PIN != EPD_DC_PIN + 1 || EPD_CLK_PIN != EPD_DC_PIN + 2) {
+        printf("DEV_SPI_Init: DC, CS and SCK must be consecutive pins \r\n");
+        return 1;
+    }
+    if(!pio_claim_free_sm_and_add_program_for_gpio_range(&lcd_spi_program, &lcd_pio, &lcd_sm, &lcd_offset,
+                                                         EPD_DC_PIN, EPD_MOSI_PIN - EPD_DC_PIN + 1, true)) {
+        printf("DEV_SPI_Init: no free PIO state machine \r\n");
+        return 1;
+    }
+    // Two instructions per bit
+    lcd_spi_program_init(lcd_pio, lcd_sm, lcd_offset, EPD_DC_PIN, EPD_MOSI_PIN,
+                         (float)clock_get_hz(clk_sys) / (2.0f * DEV_SPI_HZ));
+#else
+    spi_init(SPI_PORT, DEV_SPI_HZ);
+    gpio_set_function(EPD_CLK_PIN, GPIO_FUNC_SPI);
+    gpio_set_function(EPD_MOSI_PIN, GPIO_FUNC_SPI);
+#endif
+
+    critical_section_init(&Xfer_Lock);
+    spi_tx_chan = dma_claim_unused_channel(true);
+    spi_rx_chan = dma_claim_unused_channel(true);
+    spi_irq_chan = DEV_LCD_PIO ? spi_tx_chan : spi_rx_chan;
+    dma_irqn_set_channel_enabled(0, spi_irq_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, DEV_SPI_DMA_IRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    return 0;
+}
+
 /******************************************************************************
 function:	Module Initialize, the library and initialize the pins, SPI protocol
 parameter:
@@ -170,30 +672,37 @@ UBYTE DEV_Module_Init(void)
     EPD_SCL_PIN    = 7;
     EPD_SDA_PIN    = 6;
     
-    // SPI Config
-    spi_init(SPI_PORT, 10000 * 1000);
-    gpio_set_function(EPD_CLK_PIN, GPIO_FUNC_SPI);
-    gpio_set_function(EPD_MOSI_PIN, GPIO_FUNC_SPI);
-    
     // GPIO Config
     DEV_GPIO_Init();
     
+    // SPI Config, after the GPIO so the PIO can take over DC and CS
+    if(DEV_SPI_Init() != 0)
+        return 1;
+    
     
     // PWM Config
     gpio_set_function(EPD_BL_PIN, GPIO_FUNC_PWM);
     slice_num = pwm_gpio_to_slice_num(EPD_BL_PIN);
     pwm_set_wrap(slice_num, 100);
     pwm_set_chan_level(slice_num, PWM_CHAN_B, 1);
-    pwm_set_clkdiv(slice_num,50);
+    pwm_set_clkdiv(slice_num, (float)clock_get_hz(clk_sys) / DEV_PWM_TICK_HZ);
     pwm_set_enabled(slice_num, true);
     
     
     //I2C Config
-    i2c_init(i2c1,300*1000);
+    i2c_init(I2C_PORT, DEV_I2C_HZ);
     gpio_set_function(EPD_SDA_PIN,GPIO_FUNC_I2C);
     gpio_set_function(EPD_SCL_PIN,GPIO_FUNC_I2C);
     gpio_pull_up(EPD_SDA_PIN);
     gpio_pull_up(EPD_SCL_PIN);
+    // Only STOP and abort interrupt, and only while a transfer is queued
+    i2c_get_hw(I2C_PORT)->intr_mask = 0;
+    if(i2c_tx_chan < 0) {
+        i2c_tx_chan = dma_claim_unused_channel(true);
+        i2c_rx_chan = dma_claim_unused_channel(true);
+        irq_set_exclusive_handler(I2C_IRQ, DEV_I2C_IRQ);
+        irq_set_enabled(I2C_IRQ, true);
+    }
     
     printf("DEV_Module_Init OK \r\n");
     return 0;
@@ -208,6 +717,145 @@ void DEV_SET_PWM(uint8_t Value){
         
     
     
+}
+
+// End the hold of DEV_Set_Sys_Clock and start what queued meanwhile
+static void Xfer_Release(void)
+{
+    UBYTE Bus;
+    critical_section_enter_blocking(&Xfer_Lock);
+    Xfer_Hold = 0;
+    for(Bus = 0; Bus < DEV_BUS_COUNT; Bus++) {
+        if(Xfer_Stalled[Bus]) {
+            Xfer_Stalled[Bus] = 0;
+            Xfer_Start(Bus, Xfer_Queue[Bus].Head);
+        }
+    }
+    critical_section_exit(&Xfer_Lock);
+}
+
+/******************************************************************************
+function:	Change clk_sys and keep the bus and backlight rates
+parameter:
+    Khz :   new system clock, must be reachable from the crystal
+info:
+    The transfer queues are held while the clock moves: transfers still
+    queue on either core, but none starts until the new dividers are in.
+    Without DEV_LCD_PIO the blocking SPI writes are queued too, so they
+    wait for the hold like any other transfer.
+    The lock is only taken to set and clear the hold, so interrupts stay
+    on through the PLL relock. clk_peri is set to clk_sys again, whatever
+    the SDK does with it, and the LCD bus, I2C and backlight dividers are
+    set for the new clock. With DEV_LCD_PIO the divider goes in before a
+    speed-up and after a slow-down, so SCK never runs above DEV_SPI_HZ
+    and a transfer already on the bus carries on at the slower rate.
+    The ADC and USB clocks come from PLL_USB and do not move. Raise the
+    core voltage before going faster. Returns 1 when the clock cannot be
+    made or an I2C transfer is queued.
+******************************************************************************/
+UBYTE DEV_Set_Sys_Clock(UDOUBLE Khz)
+{
+    uint Vco, Post_Div1, Post_Div2;
+    if(spi_tx_chan < 0 || !check_sys_clock_khz(Khz, &Vco, &Post_Div1, &Post_Div2))
+        return 1;
+    UDOUBLE Hz = Vco / (Post_Div1 * Post_Div2);
+#if DEV_LCD_PIO
+    UBYTE Faster = Hz > clock_get_hz(clk_sys);
+#endif
+
+    // An idle I2C bus stays idle under the hold, so its rate can be reset
+    critical_section_enter_blocking(&Xfer_Lock);
+    if(DEV_Xfer_Busy(DEV_BUS_I2C)) {
+        critical_section_exit(&Xfer_Lock);
+        return 1;
+    }
+    Xfer_Hold = 1;
+    critical_section_exit(&Xfer_Lock);
+
+#if DEV_LCD_PIO
+    if(Faster)
+        pio_sm_set_clkdiv(lcd_pio, lcd_sm, (float)Hz / (2.0f * DEV_SPI_HZ));
+#else
+    // The SPI block's divider must not change under a transfer: let the one
+    // on the bus finish, the hold keeps the next from starting
+    while(DEV_Xfer_Busy(DEV_BUS_SPI) && !Xfer_Stalled[DEV_BUS_SPI])
+        tight_loop_contents();
+#endif
+    set_sys_clock_pll(Vco, Post_Div1, Post_Div2);
+    // Whether set_sys_clock_pll moves clk_peri depends on the SDK
+    // configuration; SPI and I2C take their dividers from it
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS, Hz, Hz);
+#if DEV_LCD_PIO
+    if(!Faster)
+        pio_sm_set_clkdiv(lcd_pio, lcd_sm, (float)Hz / (2.0f * DEV_SPI_HZ));
+#else
+    // SCK from clk_peri, set above, so DEV_SPI_HZ again
+    spi_set_baudrate(SPI_PORT, DEV_SPI_HZ);
+#endif
+    i2c_set_baudrate(I2C_PORT, DEV_I2C_HZ);
+    pwm_set_clkdiv(slice_num, (float)Hz / DEV_PWM_TICK_HZ);
+    Xfer_Release();
+    return 0;
+}
+
+/******************************************************************************
+function:	Count contested accesses to SRAM0, SRAM4, scratch X and scratch Y
+info:
+    An access is contested when another master is using the same bank in
+    that cycle. Each striped half spreads its traffic evenly over its four
+    banks, so one bank stands for the half. Counters saturate.
+******************************************************************************/
+void DEV_Bus_Perf_Start(void)
+{
+    static const bus_ctrl_perf_event_t Events[DEV_BUS_COUNTERS] = {
+        arbiter_sram0_perf_event_access_contested,
+        arbiter_sram4_perf_event_access_contested,
+        arbiter_sram8_perf_event_access_contested,
+        arbiter_sram9_perf_event_access_contested,
+    };
+    for(int i = 0; i < DEV_BUS_COUNTERS; i++) {
+        bus_ctrl_hw->counter[i].sel = Events[i];
+        bus_ctrl_hw->counter[i].value = 0;
+    }
+}
+
+// Counts since the last call, or since DEV_Bus_Perf_Start
+void DEV_Bus_Perf_Read(UDOUBLE Contested[DEV_BUS_COUNTERS])
+{
+    for(int i = 0; i < DEV_BUS_COUNTERS; i++) {
+        Contested[i] = bus_ctrl_hw->counter[i].value;
+        bus_ctrl_hw->counter[i].value = 0;
+    }
+}
+
+// XIP cache hits and accesses since the last call; a write clears them
+void DEV_XIP_Perf_Read(UDOUBLE *Hit, UDOUBLE *Access)
+{
+    *Hit = xip_ctrl_hw->ctr_hit;
+    *Access = xip_ctrl_hw->ctr_acc;
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+}
+
+/******************************************************************************
+function:	CPU cycles, from the DWT cycle counter of the calling core
+info:
+    The first call turns the counter on. It wraps after 2^32 cycles (28 s
+    at 150 MHz); differences stay right across one wrap. Hazard3 builds
+    fall back to microseconds.
+******************************************************************************/
+UDOUBLE DEV_Cycle_Count(void)
+{
+#if !PICO_RISCV
+    if(!(m33_hw->dwt_ctrl & M33_DWT_CTRL_CYCCNTENA_BITS)) {
+        m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+        m33_hw->dwt_cyccnt = 0;
+        m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+    }
+    return m33_hw->dwt_cyccnt;
+#else
+    return time_us_32();
+#endif
 }
 
 /******************************************************************************
@@ -34,6 +34,7 @@
 #include "stdio.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
+#include "hardware/dma.h"
 
 /**
  * data
@@ -54,6 +55,108 @@ extern int EPD_MOSI_PIN;
 extern int EPD_SCL_PIN;
 extern int EPD_SDA_PIN;
 
+/**
+ * Memory plan (RP2350 SRAM). SRAM0-3 and SRAM4-7 are two word-striped
+ * 256 KB halves, SRAM8/9 the 4 KB scratch X/Y banks. .data, .bss and the
+ * heap stay in SRAM0-3, the core 1 and core 0 stacks at the top of scratch
+ * X and Y, as the SDK puts them. Buffers that a DMA channel streams through
+ * get banks of their own, so the DMA and the CPU stop queueing for the same
+ * bank:
+ *   DEV_RAM_DMA   : scratch Y, the ADC capture blocks written by DMA; core 0
+ *                   only takes interrupts, so its stack there is quiet
+ *   DEV_RAM_DSP   : scratch X, per-sample filter state, next to the stack of
+ *                   core 1 that runs the filters
+ *   DEV_RAM_FRAME : SRAM4-7, frame buffers, layer caches and the line and
+ *                   band buffers the LCD DMA reads (memmap_banks.ld)
+ * DEV_RAM_FRAME is not loaded; DEV_Config clears it before main(). Without
+ * DEV_MEMORY_PLAN, e.g. on the host, these are ordinary variables.
+**/
+#ifndef DEV_MEMORY_PLAN
+#define DEV_MEMORY_PLAN     0
+#endif
+#if DEV_MEMORY_PLAN
+#define DEV_RAM_DMA         __scratch_y("dev_dma")
+#define DEV_RAM_DSP         __scratch_x("dev_dsp")
+#define DEV_RAM_FRAME       __attribute__((section(".sram_frame")))
+#else
+#define DEV_RAM_DMA
+#define DEV_RAM_DSP
+#define DEV_RAM_FRAME
+#endif
+
+/**
+ * Bus fabric counters, contested accesses to one bank of each SRAM group
+**/
+#define DEV_BUS_SRAM0_3     0       // SRAM0, stands for the striped lower half
+#define DEV_BUS_SRAM4_7     1       // SRAM4, stands for the striped upper half
+#define DEV_BUS_SCRATCH_X   2
+#define DEV_BUS_SCRATCH_Y   3
+#define DEV_BUS_COUNTERS    4
+
+/**
+ * Hot code in RAM. Functions declared as DEV_RAM_FUNC(Name) go to
+ * .time_critical like the SDK's __not_in_flash_func and are copied to RAM
+ * at boot, so the per-sample and per-pixel loops never wait on the XIP
+ * cache, e.g. after a font or image table in flash has evicted them. Build
+ * with DEV_RAM_CODE=0 to leave them in flash and compare the XIP counters.
+**/
+#ifndef DEV_RAM_CODE
+#define DEV_RAM_CODE        1
+#endif
+#if DEV_RAM_CODE && defined(__not_in_flash_func)
+#define DEV_RAM_FUNC(Name)  __not_in_flash_func(Name)
+#else
+#define DEV_RAM_FUNC(Name)  Name
+#endif
+
+/**
+ * LCD SPI. With DEV_LCD_PIO the LCD bus is a PIO program that drives DC
+ * and CS itself from a tagged byte stream (lcd_spi.pio), otherwise it is
+ * the SPI peripheral with DC and CS on GPIO.
+**/
+#ifndef DEV_LCD_PIO
+#define DEV_LCD_PIO         1
+#endif
+#define DEV_SPI_HZ          10000000
+#define DEV_SPI_TAG_BYTES   3       // header in front of every tagged segment
+
+/**
+ * Asynchronous bus transactions
+**/
+#define DEV_BUS_SPI         0
+#define DEV_BUS_I2C         1
+#define DEV_BUS_COUNT       2
+
+#define DEV_XFER_DONE       0       // zero, so a fresh descriptor counts as finished
+#define DEV_XFER_QUEUED     1
+#define DEV_XFER_ERROR      2       // I2C NACK or abort, or a rejected descriptor
+
+#define DEV_XFER_CS_FRAME   0       // CS low for the transfer, high again after it
+#define DEV_XFER_CS_HOLD    1       // CS low, left low for the next transfer
+#define DEV_XFER_PIN_KEEP   0xFF    // leave the pin as it is
+#define DEV_XFER_DC_TAGGED  0xFE    // SPI: pTx is a tagged stream, see DEV_SPI_Tag
+
+#define DEV_I2C_XFER_MAX    64      // write + read bytes of one I2C transaction
+
+typedef struct DEV_XFER DEV_XFER;
+typedef void (*DEV_XFER_CALLBACK)(DEV_XFER *Xfer);
+
+struct DEV_XFER {
+    UBYTE Bus;                  // DEV_BUS_SPI or DEV_BUS_I2C
+    UBYTE Cs;                   // SPI: DEV_XFER_CS_FRAME, DEV_XFER_CS_HOLD or DEV_XFER_PIN_KEEP
+    UBYTE Dc;                   // SPI: DC level, DEV_XFER_PIN_KEEP or DEV_XFER_DC_TAGGED
+    UBYTE Addr;                 // I2C: 7-bit address
+    const UBYTE *pTx;           // SPI: NULL clocks out zeros
+    UDOUBLE Tx_Len;
+    UBYTE *pRx;                 // SPI: NULL discards MISO, must be NULL with DEV_LCD_PIO
+    UDOUBLE Rx_Len;             // SPI: 0 or Tx_Len; I2C: read after a repeated start
+    DEV_XFER_CALLBACK Callback; // runs in interrupt context, must not block
+    void *Arg;
+    DEV_XFER *Next;             // chained transfer, queued with this one
+    DEV_XFER *Link;             // owned by the queue
+    volatile UBYTE Status;
+};
+
 /*------------------------------------------------------------------------------------------------------*/
 void DEV_Digital_Write(UWORD Pin, UBYTE Value);
 UBYTE DEV_Digital_Read(UWORD Pin);
@@ -65,6 +168,41 @@ UBYTE DEV_Digital_Read(UWORD Pin);
 
 void DEV_SPI_WriteByte(UBYTE Value);
 void DEV_SPI_Write_nByte(uint8_t *pData, uint32_t Len);
+void DEV_SPI_Write_nByte_DMA(const uint8_t *pData, uint32_t Len);
+void DEV_SPI_DMA_Wait(void);
+
+/******************************************************************************
+function:	Append one segment of a tagged SPI stream
+parameter:
+    pStream : output, DEV_SPI_TAG_BYTES + Len bytes
+    Dc      : DC level for the segment
+    pData   : segment bytes, NULL to write the header only
+    Len     : bytes in the segment, 1 .. 1 MiB
+return:
+    bytes written to pStream
+info:
+    A stream of segments sent with DEV_XFER_DC_TAGGED switches DC and CS
+    in between segments without the CPU, so a command with its parameters
+    is one transfer.
+******************************************************************************/
+static inline UDOUBLE DEV_SPI_Tag(UBYTE *pStream, UBYTE Dc, const UBYTE *pData, UDOUBLE Len)
+{
+    UDOUBLE Bits = Len * 8 - 1;
+    UDOUBLE i;
+    pStream[0] = (Dc ? 0x80 : 0x00) | ((Bits >> 16) & 0x7F);
+    pStream[1] = (Bits >> 8) & 0xFF;
+    pStream[2] = Bits & 0xFF;
+    if(!pData)
+        return DEV_SPI_TAG_BYTES;
+    for(i = 0; i < Len; i++)
+        pStream[DEV_SPI_TAG_BYTES + i] = pData[i];
+    return DEV_SPI_TAG_BYTES + Len;
+}
+
+UBYTE DEV_Xfer_Submit(DEV_XFER *Xfer);
+void DEV_Xfer_Wait(DEV_XFER *Xfer);
+UBYTE DEV_Xfer_Busy(UBYTE Bus);
+void DEV_Xfer_Flush(UBYTE Bus);
 
 void DEV_Delay_ms(UDOUBLE xms);
 void DEV_Delay_us(UDOUBLE xus);
@@ -75,6 +213,12 @@ void DEV_I2C_Write_nByte(uint8_t addr, uint8_t *pData, uint32_t Len);
 uint8_t DEV_I2C_ReadByte(uint8_t addr, uint8_t reg);
 
 void DEV_SET_PWM(uint8_t Value);
+UBYTE DEV_Set_Sys_Clock(UDOUBLE Khz);
+
+void DEV_Bus_Perf_Start(void);
+void DEV_Bus_Perf_Read(UDOUBLE Contested[DEV_BUS_COUNTERS]);
+void DEV_XIP_Perf_Read(UDOUBLE *Hit, UDOUBLE *Access);
+UDOUBLE DEV_Cycle_Count(void);
 
 UBYTE DEV_Module_Init(void);
 void DEV_Module_Exit(void);
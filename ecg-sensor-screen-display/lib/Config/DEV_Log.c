@@ -0,0 +1,236 @@
+/*****************************************************************************
+* | File      	:   DEV_Log.c
+* | Function    :   Deferred binary logging
+* | Info        :
+*   One ring per core. Only its own core writes a ring, with interrupts
+*   off for the copy, so task code and interrupt handlers on that core
+*   can both log. One reader, usually a task on core 0, drains both.
+*   Head and Tail only grow; their difference is the fill.
+******************************************************************************/
+#include "DEV_Log.h"
+#include "DEV_Config.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#define LOG_MASK (DEV_LOG_RING_BYTES - 1)
+
+typedef struct {
+    uint8_t Data[DEV_LOG_RING_BYTES];
+    uint32_t Head;          // written by the ring's core
+    uint32_t Tail;          // written by the reader
+    uint32_t Dropped;       // written by the ring's core
+    uint32_t Reported;      // drops already reported, reader only
+} DEV_LOG_RING;
+
+static DEV_LOG_RING Log_Ring[DEV_LOG_CORES];
+
+// Start of the format section, provided by the linker
+extern const char __start_dev_log_fmt[];
+
+// Also keeps the section in every image that links DEV_Log.c
+static const char Log_Drop_Fmt[] __attribute__((section("dev_log_fmt"))) = "log: %lu records dropped\r\n";
+
+enum { LEN_INT, LEN_LONG, LEN_LLONG, LEN_MAX, LEN_SIZE, LEN_PTRDIFF, LEN_DOUBLE };
+
+static uint32_t Log_Put64(uint8_t *pArgs, uint32_t n, uint64_t Value)
+{
+    if(n + 8 > DEV_LOG_ARG_BYTES)
+        return n;
+    memcpy(pArgs + n, &Value, 8);
+    return n + 8;
+}
+
+static uint32_t Log_Put32(uint8_t *pArgs, uint32_t n, uint32_t Value)
+{
+    if(n + 4 > DEV_LOG_ARG_BYTES)
+        return n;
+    memcpy(pArgs + n, &Value, 4);
+    return n + 4;
+}
+
+/******************************************************************************
+function:	Copy the arguments of Fmt, in the record layout
+parameter:
+    pArgs : output, DEV_LOG_ARG_BYTES
+return:
+    bytes used; an argument that does not fit ends the record
+info:
+    Only the conversion specifiers are walked, the text between them is
+    skipped with strchr. Nothing is formatted.
+******************************************************************************/
+static uint32_t DEV_RAM_FUNC(Log_Encode)(uint8_t *pArgs, const char *Fmt, va_list Ap)
+{
+    uint32_t n = 0;
+    const char *p = Fmt;
+
+    while((p = strchr(p, '%')) != NULL) {
+        uint32_t Before = n;
+        int Len = LEN_INT;
+        p++;
+        if(*p == '%') {
+            p++;
+            continue;
+        }
+        while(*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+            p++;
+        if(*p == '*') {
+            n = Log_Put32(pArgs, n, (uint32_t)va_arg(Ap, int));
+            p++;
+        }
+        while(*p >= '0' && *p <= '9')
+            p++;
+        if(*p == '.') {
+            p++;
+            if(*p == '*') {
+                n = Log_Put32(pArgs, n, (uint32_t)va_arg(Ap, int));
+                p++;
+            }
+            while(*p >= '0' && *p <= '9')
+                p++;
+        }
+
+        switch(*p) {
+        case 'h':
+            p += p[1] == 'h' ? 2 : 1;
+            break;
+        case 'l':
+            Len = p[1] == 'l' ? LEN_LLONG : LEN_LONG;
+            p += p[1] == 'l' ? 2 : 1;
+            break;
+        case 'j': Len = LEN_MAX; p++; break;
+        case 'z': Len = LEN_SIZE; p++; break;
+        case 't': Len = LEN_PTRDIFF; p++; break;
+        case 'L': Len = LEN_DOUBLE; p++; break;
+        }
+
+        switch(*p++) {
+        case 'd': case 'i':
+            switch(Len) {
+            case LEN_LONG:    n = Log_Put64(pArgs, n, (uint64_t)(int64_t)va_arg(Ap, long)); break;
+            case LEN_LLONG:   n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, long long)); break;
+            case LEN_MAX:     n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, intmax_t)); break;
+            case LEN_SIZE:    n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, size_t)); break;
+            case LEN_PTRDIFF: n = Log_Put64(pArgs, n, (uint64_t)(int64_t)va_arg(Ap, ptrdiff_t)); break;
+            default:          n = Log_Put32(pArgs, n, (uint32_t)va_arg(Ap, int)); break;
+            }
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            switch(Len) {
+            case LEN_LONG:    n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, unsigned long)); break;
+            case LEN_LLONG:   n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, unsigned long long)); break;
+            case LEN_MAX:     n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, uintmax_t)); break;
+            case LEN_SIZE:    n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, size_t)); break;
+            case LEN_PTRDIFF: n = Log_Put64(pArgs, n, (uint64_t)va_arg(Ap, ptrdiff_t)); break;
+            default:          n = Log_Put32(pArgs, n, va_arg(Ap, unsigned int)); break;
+            }
+            break;
+        case 'c':
+            n = Log_Put32(pArgs, n, (uint32_t)va_arg(Ap, int));
+            break;
+        case 'p':
+            n = Log_Put64(pArgs, n, (uint64_t)(uintptr_t)va_arg(Ap, void *));
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+            double Value = Len == LEN_DOUBLE ? (double)va_arg(Ap, long double) : va_arg(Ap, double);
+            uint64_t Bits;
+            memcpy(&Bits, &Value, 8);
+            n = Log_Put64(pArgs, n, Bits);
+            break;
+        }
+        case 's': {
+            const char *s = va_arg(Ap, const char *);
+            uint32_t Chars = 0;
+            while(s && Chars < DEV_LOG_STR_MAX && s[Chars])
+                Chars++;
+            if(n + 1 + Chars > DEV_LOG_ARG_BYTES)
+                return n;
+            pArgs[n] = (uint8_t)Chars;
+            memcpy(pArgs + n + 1, s, Chars);
+            n += 1 + Chars;
+            break;
+        }
+        case 'n':
+            (void)va_arg(Ap, void *);
+            break;
+        default:
+            return n;
+        }
+        if(n == Before && p[-1] != 'n')
+            return n;       // argument did not fit
+    }
+    return n;
+}
+
+static void Log_Header(uint8_t *pRec, uint8_t Core, const char *Fmt, uint32_t Args)
+{
+    uint32_t Id = (uint32_t)(Fmt - __start_dev_log_fmt);
+    uint32_t Now = time_us_32();
+    pRec[0] = DEV_LOG_SYNC;
+    pRec[1] = (uint8_t)(Args | (Core << 7));
+    pRec[2] = Id & 0xFF;
+    pRec[3] = (Id >> 8) & 0xFF;
+    memcpy(pRec + 4, &Now, 4);
+}
+
+void DEV_RAM_FUNC(DEV_Log_Write)(const char *Fmt, ...)
+{
+    uint8_t Rec[DEV_LOG_HEADER + DEV_LOG_ARG_BYTES];
+    uint8_t Core = (uint8_t)get_core_num();
+    DEV_LOG_RING *Ring = &Log_Ring[Core];
+    uint32_t Args, Len, Head, Save, i;
+    va_list Ap;
+
+    va_start(Ap, Fmt);
+    Args = Log_Encode(Rec + DEV_LOG_HEADER, Fmt, Ap);
+    va_end(Ap);
+    Log_Header(Rec, Core, Fmt, Args);
+    Len = DEV_LOG_HEADER + Args;
+
+    Save = save_and_disable_interrupts();
+    Head = Ring->Head;
+    if(DEV_LOG_RING_BYTES - (Head - __atomic_load_n(&Ring->Tail, __ATOMIC_ACQUIRE)) < Len) {
+        Ring->Dropped++;
+    } else {
+        for(i = 0; i < Len; i++)
+            Ring->Data[(Head + i) & LOG_MASK] = Rec[i];
+        __atomic_store_n(&Ring->Head, Head + Len, __ATOMIC_RELEASE);
+    }
+    restore_interrupts(Save);
+}
+
+uint32_t DEV_Log_Read(uint8_t Core, uint8_t *pBuf, uint32_t Len)
+{
+    DEV_LOG_RING *Ring = &Log_Ring[Core];
+    uint32_t Out = 0;
+    uint32_t Dropped = __atomic_load_n(&Ring->Dropped, __ATOMIC_RELAXED);
+    uint32_t Tail = Ring->Tail;
+    uint32_t Head = __atomic_load_n(&Ring->Head, __ATOMIC_ACQUIRE);
+
+    if(Dropped != Ring->Reported && Len >= DEV_LOG_HEADER + 8) {
+        Log_Header(pBuf, Core, Log_Drop_Fmt, 8);
+        Log_Put64(pBuf + DEV_LOG_HEADER, 0, Dropped - Ring->Reported);
+        Ring->Reported = Dropped;
+        Out = DEV_LOG_HEADER + 8;
+    }
+
+    while(Head - Tail >= DEV_LOG_HEADER) {
+        uint32_t Rec = DEV_LOG_HEADER + (Ring->Data[(Tail + 1) & LOG_MASK] & 0x7F);
+        uint32_t i;
+        if(Out + Rec > Len)
+            break;
+        for(i = 0; i < Rec; i++)
+            pBuf[Out + i] = Ring->Data[(Tail + i) & LOG_MASK];
+        Tail += Rec;
+        Out += Rec;
+    }
+    __atomic_store_n(&Ring->Tail, Tail, __ATOMIC_RELEASE);
+    return Out;
+}
+
+uint32_t DEV_Log_Dropped(uint8_t Core)
+{
+    return __atomic_load_n(&Log_Ring[Core].Dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,53 @@
+/*****************************************************************************
+* | File      	:   DEV_Log.h
+* | Function    :   Deferred binary logging
+* | Info        :
+*   DEV_LOG("fmt", args...) does not format anything. The format string
+*   goes into the dev_log_fmt section, and its offset there is the
+*   record ID. The call stores the ID, a timestamp and the raw arguments
+*   in a per-core ring buffer. Later, a task outside the hot path moves
+*   whole records to the USB port with DEV_Log_Read(), and
+*   lib/Config/log_decode.py expands them on the host. It takes the format
+*   strings from the ELF.
+*
+*   Record layout (little endian):
+*     [0]     DEV_LOG_SYNC
+*     [1]     argument bytes, bit 7 = core
+*     [2..3]  format ID
+*     [4..7]  time_us_32()
+*     [8.. ]  arguments, in format order:
+*             int, char, %hh/%h        4 bytes
+*             %l, %ll, %j, %z, %t, %p  8 bytes
+*             %e %f %g %a              8 bytes (double)
+*             %s                       1 length byte + up to DEV_LOG_STR_MAX bytes
+*             '*' width or precision   4 bytes
+*   Records that do not fit in the ring are dropped and counted.
+*   Text printed with printf may sit between records on the same port;
+*   it is plain ASCII, and DEV_LOG_SYNC is not.
+******************************************************************************/
+#ifndef _DEV_LOG_H_
+#define _DEV_LOG_H_
+
+#include <stdint.h>
+
+#define DEV_LOG_RING_BYTES  2048    // per core, power of two
+#define DEV_LOG_ARG_BYTES   64      // arguments of one record, the rest is cut
+#define DEV_LOG_STR_MAX     32      // characters kept of a %s argument
+#define DEV_LOG_HEADER      8
+#define DEV_LOG_SYNC        0xA5
+#define DEV_LOG_CORES       2
+
+// Fmt must be a string literal; it is placed, never read, on the device
+#define DEV_LOG(Fmt, ...) do { \
+        static const char DEV_Log_Fmt[] __attribute__((section("dev_log_fmt"))) = Fmt; \
+        DEV_Log_Write(DEV_Log_Fmt, ##__VA_ARGS__); \
+    } while(0)
+
+void DEV_Log_Write(const char *Fmt, ...);
+
+// Move whole records of one core's ring into pBuf, at most Len bytes.
+// A drop since the last read is reported first, as a record of its own.
+uint32_t DEV_Log_Read(uint8_t Core, uint8_t *pBuf, uint32_t Len);
+uint32_t DEV_Log_Dropped(uint8_t Core);
+
+#endif
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* | File      	:   DEV_Trace.c
+* | Function    :   Per-core event tracing
+* | Info        :
+*   Same ring discipline as DEV_Log.c: only its own core writes a ring,
+*   with interrupts off for the store, and one reader drains both. Events
+*   are fixed size, so the rings count events, not bytes.
+******************************************************************************/
+#include "DEV_Trace.h"
+#include "DEV_Config.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include <string.h>
+
+#define TRACE_MASK (DEV_TRACE_EVENTS - 1)
+
+// trace_export.py reads events as <QHBBi
+_Static_assert(sizeof(DEV_TRACE_REC) == 16, "trace event layout");
+
+typedef struct {
+    DEV_TRACE_REC Events[DEV_TRACE_EVENTS];
+    uint32_t Head;          // written by the ring's core
+    uint32_t Tail;          // written by the reader
+    uint32_t Dropped;       // written by the ring's core
+    uint32_t Reported;      // drops already sent, reader only
+} DEV_TRACE_RING;
+
+static DEV_TRACE_RING Trace_Ring[DEV_TRACE_CORES];
+
+volatile uint8_t DEV_Trace_On = 0;
+
+// Start of the name section, provided by the linker
+extern const char __start_dev_trace_name[];
+
+// Marks the start of a capture; also keeps the section in every image
+static const char Trace_Start_Name[] __attribute__((section("dev_trace_name"))) = "trace on";
+
+void DEV_RAM_FUNC(DEV_Trace_Record)(uint8_t Track, const char *Name, char Phase, int32_t Value)
+{
+    uint8_t Core = (uint8_t)get_core_num();
+    DEV_TRACE_RING *Ring = &Trace_Ring[Core];
+    uint32_t Head, Save;
+
+    Save = save_and_disable_interrupts();
+    Head = Ring->Head;
+    if(Head - __atomic_load_n(&Ring->Tail, __ATOMIC_ACQUIRE) >= DEV_TRACE_EVENTS) {
+        Ring->Dropped++;
+    } else {
+        DEV_TRACE_REC *Rec = &Ring->Events[Head & TRACE_MASK];
+        Rec->Time_us = time_us_64();
+        Rec->Name = (uint16_t)(Name - __start_dev_trace_name);
+        Rec->Phase = (uint8_t)Phase;
+        Rec->Track = Track == DEV_TRACE_TRACK_CORE ? Core : Track;
+        Rec->Value = Value;
+        __atomic_store_n(&Ring->Head, Head + 1, __ATOMIC_RELEASE);
+    }
+    restore_interrupts(Save);
+}
+
+/******************************************************************************
+function:	Start or stop tracing
+info:
+    Starting drops what is left in the rings, so the capture does not open
+    with the end of an old one. Call it from the reader's core while the
+    reader is not in DEV_Trace_Read(). A span that is open when tracing
+    stops keeps its 'B' without an 'E'; trace_export.py closes it.
+******************************************************************************/
+void DEV_Trace_Enable(uint8_t On)
+{
+    uint8_t i;
+    if(On && !DEV_Trace_On) {
+        for(i = 0; i < DEV_TRACE_CORES; i++) {
+            DEV_TRACE_RING *Ring = &Trace_Ring[i];
+            __atomic_store_n(&Ring->Tail, __atomic_load_n(&Ring->Head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            Ring->Reported = __atomic_load_n(&Ring->Dropped, __ATOMIC_RELAXED);
+        }
+        DEV_Trace_On = 1;
+        DEV_Trace_Record(DEV_TRACE_TRACK_CORE, Trace_Start_Name, 'i', 0);
+    } else if(!On) {
+        DEV_Trace_On = 0;
+    }
+}
+
+uint32_t DEV_Trace_Read(uint8_t Core, uint8_t *pBuf, uint32_t Len)
+{
+    DEV_TRACE_RING *Ring = &Trace_Ring[Core];
+    uint32_t Tail = Ring->Tail;
+    uint32_t Head = __atomic_load_n(&Ring->Head, __ATOMIC_ACQUIRE);
+    uint32_t Dropped = __atomic_load_n(&Ring->Dropped, __ATOMIC_RELAXED) - Ring->Reported;
+    uint32_t Count = Head - Tail;
+    uint32_t i;
+
+    if(Len < DEV_TRACE_HEADER || (Count == 0 && Dropped == 0))
+        return 0;
+    if(Count > (Len - DEV_TRACE_HEADER) / sizeof(DEV_TRACE_REC))
+        Count = (Len - DEV_TRACE_HEADER) / sizeof(DEV_TRACE_REC);
+    if(Count > 0xFFFF)
+        Count = 0xFFFF;
+
+    pBuf[0] = DEV_TRACE_SYNC;
+    pBuf[1] = Core;
+    pBuf[2] = Count & 0xFF;
+    pBuf[3] = (Count >> 8) & 0xFF;
+    memcpy(pBuf + 4, &Dropped, 4);
+    Ring->Reported += Dropped;
+    for(i = 0; i < Count; i++)
+        memcpy(pBuf + DEV_TRACE_HEADER + i * sizeof(DEV_TRACE_REC), &Ring->Events[(Tail + i) & TRACE_MASK], sizeof(DEV_TRACE_REC));
+    __atomic_store_n(&Ring->Tail, Tail + Count, __ATOMIC_RELEASE);
+    return DEV_TRACE_HEADER + Count * sizeof(DEV_TRACE_REC);
+}
+
+uint32_t DEV_Trace_Dropped(uint8_t Core)
+{
+    return __atomic_load_n(&Trace_Ring[Core].Dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,83 @@
+/*****************************************************************************
+* | File      	:   DEV_Trace.h
+* | Function    :   Per-core event tracing
+* | Info        :
+*   DEV_TRACE_BEGIN/END("name") bracket a span. DEV_TRACE_INSTANT marks a
+*   point in time, and DEV_TRACE_COUNTER records a value. Each event is 16
+*   bytes: the 64-bit microsecond timer, a name ID, the phase, the track
+*   and a value. It goes into the ring of the calling core. As in
+*   DEV_Log.h, the name is a string literal in the dev_trace_name section,
+*   and its offset there is the ID.
+*
+*   Tracing is off until DEV_Trace_Enable(1). While it is off, a trace
+*   point costs one load. A reader drains the rings with DEV_Trace_Read(),
+*   which emits chunks:
+*     [0]     DEV_TRACE_SYNC
+*     [1]     core
+*     [2..3]  event count
+*     [4..7]  events dropped on that core since the previous chunk
+*     [8.. ]  events, DEV_TRACE_REC
+*   lib/Config/trace_export.py turns a capture holding such chunks into
+*   Chrome trace JSON (chrome://tracing, ui.perfetto.dev). Each track
+*   becomes a thread.
+*
+*   Spans on one track must nest. Work that outlives the code that started
+*   it, such as a DMA transfer, goes on its own track (DEV_TRACE_TRACK_SPI).
+*   Build with DEV_TRACE=0 to compile every trace point out.
+******************************************************************************/
+#ifndef _DEV_TRACE_H_
+#define _DEV_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef DEV_TRACE
+#define DEV_TRACE           1
+#endif
+
+#define DEV_TRACE_EVENTS    1024    // per core, power of two
+#define DEV_TRACE_SYNC      0xA6
+#define DEV_TRACE_HEADER    8
+#define DEV_TRACE_CORES     2
+
+// Tracks: one per core, then the asynchronous ones
+#define DEV_TRACE_TRACK_CORE    0xFF    // the calling core
+#define DEV_TRACE_TRACK_SPI     2
+
+typedef struct {
+    uint64_t Time_us;
+    uint16_t Name;          // offset in dev_trace_name
+    uint8_t Phase;          // 'B', 'E', 'i' or 'C'
+    uint8_t Track;
+    int32_t Value;          // counters only
+} DEV_TRACE_REC;
+
+extern volatile uint8_t DEV_Trace_On;
+
+#if DEV_TRACE
+#define DEV_TRACE_POINT(Track, Name, Phase, Value) do { \
+        if(DEV_Trace_On) { \
+            static const char DEV_Trace_Name[] __attribute__((section("dev_trace_name"))) = Name; \
+            DEV_Trace_Record(Track, DEV_Trace_Name, Phase, Value); \
+        } \
+    } while(0)
+#else
+#define DEV_TRACE_POINT(Track, Name, Phase, Value) do { } while(0)
+#endif
+
+#define DEV_TRACE_BEGIN(Name)           DEV_TRACE_POINT(DEV_TRACE_TRACK_CORE, Name, 'B', 0)
+#define DEV_TRACE_END(Name)             DEV_TRACE_POINT(DEV_TRACE_TRACK_CORE, Name, 'E', 0)
+#define DEV_TRACE_INSTANT(Name)         DEV_TRACE_POINT(DEV_TRACE_TRACK_CORE, Name, 'i', 0)
+#define DEV_TRACE_COUNTER(Name, Value)  DEV_TRACE_POINT(DEV_TRACE_TRACK_CORE, Name, 'C', Value)
+#define DEV_TRACE_BEGIN_ON(Track, Name) DEV_TRACE_POINT(Track, Name, 'B', 0)
+#define DEV_TRACE_END_ON(Track, Name)   DEV_TRACE_POINT(Track, Name, 'E', 0)
+
+void DEV_Trace_Record(uint8_t Track, const char *Name, char Phase, int32_t Value);
+
+// Turning tracing on empties the rings, so a capture starts clean
+void DEV_Trace_Enable(uint8_t On);
+
+// One chunk of the core's ring, at most Len bytes; 0 when there is nothing to send
+uint32_t DEV_Trace_Read(uint8_t Core, uint8_t *pBuf, uint32_t Len);
+uint32_t DEV_Trace_Dropped(uint8_t Core);
+
+#endif
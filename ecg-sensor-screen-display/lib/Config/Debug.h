@@ -39,6 +39,10 @@
 
 #if DEBUG
 	#define Debug(__info,...) printf("Debug: " __info,##__VA_ARGS__)
+#elif DEV_LOG_DEFERRED
+	// Recorded in the binary log, expanded on the host by log_decode.py
+	#include "DEV_Log.h"
+	#define Debug(__info,...) DEV_LOG("Debug: " __info,##__VA_ARGS__)
 #else
 	#define Debug(__info,...)  
 #endif
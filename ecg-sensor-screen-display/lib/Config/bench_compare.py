@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Compare two micro-benchmark runs (ecg_bench.hpp output).
+
+Each file is a capture of the ecg-bench firmware's USB output, or of
+ecg_bench_host. Only the bench-meta and bench lines are read; other text is
+skipped. If a kernel appears more than once, the lowest median is kept,
+because that is the run with the least interference. For each kernel the
+script prints the medians, the change in percent and the count per unit.
+A change beyond --threshold is marked. With --fail, such a regression, or
+a kernel missing from CURRENT, makes the exit status 1. With only
+BASELINE, the script prints that run.
+
+usage: bench_compare.py [--threshold PCT] [--fail] BASELINE [CURRENT]
+"""
+
+import argparse
+import sys
+
+
+def load(path):
+    """({kernel: (unit, items, min, median, max)}, meta) of one capture."""
+    kernels = {}
+    meta = {}
+    with open(path, encoding="latin-1") as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("bench-meta "):
+                meta = dict(item.split("=", 1) for item in line.split()[1:] if "=" in item)
+            elif line.startswith("bench,"):
+                fields = line.split(",")
+                if len(fields) != 8:
+                    continue
+                try:
+                    unit, items, low, median, high = fields[2], int(fields[3]), int(fields[4]), int(fields[5]), int(fields[6])
+                except ValueError:
+                    continue
+                old = kernels.get(fields[1])
+                if old is None or median < old[3]:
+                    kernels[fields[1]] = (unit, items, low, median, high)
+    return kernels, meta
+
+
+def per_unit(entry):
+    return entry[3] / entry[1] if entry[1] else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current", nargs="?")
+    parser.add_argument("--threshold", type=float, default=5.0, help="percent change to mark, default 5")
+    parser.add_argument("--fail", action="store_true", help="exit 1 on a marked regression or a missing kernel")
+    args = parser.parse_args()
+
+    base, base_meta = load(args.baseline)
+    if not base:
+        print("no bench lines in %s" % args.baseline, file=sys.stderr)
+        sys.exit(1)
+    counter = base_meta.get("counter", "count")
+
+    if args.current is None:
+        print("%-12s %-7s %8s %10s %10s %10s %10s" % ("kernel", "unit", "items", "min", "median", "max",
+                                                     counter + "/unit"))
+        for name, e in base.items():
+            print("%-12s %-7s %8d %10d %10d %10d %10.2f" % (name, e[0], e[1], e[2], e[3], e[4], per_unit(e)))
+        return
+
+    cur, cur_meta = load(args.current)
+    for key in ("counter", "hz", "ram_code", "memory_plan"):
+        if base_meta.get(key) != cur_meta.get(key):
+            print("warning: %s differs: %s vs %s" % (key, base_meta.get(key), cur_meta.get(key)), file=sys.stderr)
+
+    bad = 0
+    print("%-12s %-7s %10s %10s %8s %10s %10s" % ("kernel", "unit", "baseline", "current", "change",
+                                                 "base/unit", "cur/unit"))
+    for name, b in base.items():
+        c = cur.get(name)
+        if c is None:
+            print("%-12s %-7s %10d %10s" % (name, b[0], b[3], "missing"))
+            bad += 1
+            continue
+        if c[1] != b[1]:
+            print("warning: %s: items changed from %d to %d, comparing per unit" % (name, b[1], c[1]),
+                  file=sys.stderr)
+        change = (per_unit(c) / per_unit(b) - 1.0) * 100.0 if per_unit(b) else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  slower"
+            bad += 1
+        elif change < -args.threshold:
+            mark = "  faster"
+        print("%-12s %-7s %10d %10d %+7.1f%% %10.2f %10.2f%s" % (name, b[0], b[3], c[3], change,
+                                                               per_unit(b), per_unit(c), mark))
+    for name in cur:
+        if name not in base:
+            print("%-12s %-7s %10s %10d  new" % (name, cur[name][0], "-", cur[name][3]))
+    if args.fail and bad:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
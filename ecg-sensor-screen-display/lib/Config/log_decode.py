@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+"""Expand the deferred binary log (DEV_Log.h) of a USB capture back into text.
+
+Reads the format strings from the dev_log_fmt section of the ELF that
+produced the capture, then copies the capture to stdout. Plain text passes
+through unchanged. Each record (DEV_LOG_SYNC, length/core, format ID,
+timestamp, raw arguments) is replaced by its format string expanded with
+its arguments, as printf would have printed it. Trace chunks (DEV_Trace.h)
+on the same port are left out; trace_export.py turns them into a trace.
+So are sample frames (ecg_stream.hpp); host/ecg_capture stores those.
+Works on a file or live:
+
+    cat /dev/ttyACM0 | log_decode.py --objcopy arm-none-eabi-objcopy firmware.elf
+
+usage: log_decode.py [--objcopy objcopy] [--time] [--output file] firmware.elf [capture]
+"""
+
+import argparse
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+SYNC = 0xA5
+HEADER = 8
+ARG_BYTES = 64
+
+TRACE_SYNC = 0xA6
+TRACE_HEADER = 8
+TRACE_EVENTS = 1024
+TRACE_CORES = 2
+TRACE_EVENT = struct.Struct("<QHBBi")
+TRACE_PHASES = b"BEiC"
+
+STREAM_SYNC = 0xA7
+STREAM_VERSION = 1
+STREAM_HEADER = struct.Struct("<BBHIQHH")
+STREAM_MAX_SAMPLES = 1024
+
+SYNC_RE = re.compile(bytes([ord("["), SYNC, TRACE_SYNC, STREAM_SYNC, ord("]")]))
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcpeEfFgGaAsn%])")
+WIDE = ("l", "ll", "j", "z", "t")
+
+
+def load_formats(elf, objcopy, section="dev_log_fmt"):
+    """Raw bytes of a string section; a record's ID is an offset into it.
+
+    Empty when the ELF does not have the section.
+    """
+    with tempfile.TemporaryDirectory() as tmp:
+        out = os.path.join(tmp, "fmt.bin")
+        subprocess.run([objcopy, "-O", "binary", "--only-section=" + section, elf, out], check=True)
+        with open(out, "rb") as f:
+            return f.read()
+
+
+def format_at(table, offset):
+    if offset >= len(table) or (offset > 0 and table[offset - 1] != 0):
+        return None
+    end = table.find(b"\0", offset)
+    return table[offset:end if end >= 0 else len(table)].decode("latin-1")
+
+
+class Args:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, fmt, size):
+        if self.pos + size > len(self.data):
+            raise IndexError
+        value = struct.unpack_from(fmt, self.data, self.pos)[0]
+        self.pos += size
+        return value
+
+    def string(self):
+        n = self.take("<B", 1)
+        if self.pos + n > len(self.data):
+            raise IndexError
+        s = self.data[self.pos:self.pos + n].decode("latin-1")
+        self.pos += n
+        return s
+
+
+def expand(fmt, data):
+    """fmt with its arguments from data, in the layout DEV_Log_Write stores them."""
+    args = Args(data)
+    out = []
+    pos = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, precision, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            if width == "*":
+                width = str(args.take("<i", 4))
+            if precision == "*":
+                precision = str(args.take("<i", 4))
+            spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+            wide = length in WIDE
+            if conv in "di":
+                out.append((spec + "d") % args.take("<q" if wide else "<i", 8 if wide else 4))
+            elif conv in "uoxX":
+                value = args.take("<Q" if wide else "<I", 8 if wide else 4)
+                out.append((spec + ("d" if conv == "u" else conv)) % value)
+            elif conv == "c":
+                out.append((spec + "c") % chr(args.take("<I", 4) & 0xFF))
+            elif conv == "p":
+                out.append((spec + "s") % ("0x%x" % args.take("<Q", 8)))
+            elif conv in "eEfFgG":
+                out.append((spec + conv) % args.take("<d", 8))
+            elif conv in "aA":
+                text = args.take("<d", 8).hex()
+                out.append((spec + "s") % (text.upper() if conv == "A" else text))
+            elif conv == "s":
+                out.append((spec + "s") % args.string())
+        except IndexError:
+            out.append("<?>")       # cut at DEV_LOG_ARG_BYTES
+            break
+    else:
+        out.append(fmt[pos:])
+    return "".join(out)
+
+
+def trace_chunk(buf, j, names):
+    """Length of the trace chunk at buf[j], 0 if it is not one, None if it is cut."""
+    if j + TRACE_HEADER > len(buf):
+        return None
+    core = buf[j + 1]
+    count = struct.unpack_from("<H", buf, j + 2)[0]
+    if core >= TRACE_CORES or count > TRACE_EVENTS:
+        return 0
+    end = j + TRACE_HEADER + count * TRACE_EVENT.size
+    if end > len(buf):
+        return None
+    for k in range(j + TRACE_HEADER, end, TRACE_EVENT.size):
+        _, name, phase, _, _ = TRACE_EVENT.unpack_from(buf, k)
+        if phase not in TRACE_PHASES or (names and format_at(names, name) is None):
+            return 0
+    return end - j
+
+
+def stream_frame(buf, j):
+    """Length of the sample frame at buf[j], 0 if it is not one, None if it is cut."""
+    if j + STREAM_HEADER.size > len(buf):
+        return None
+    _, version, sets, _, _, mask, _ = STREAM_HEADER.unpack_from(buf, j)
+    samples = sets * bin(mask).count("1")
+    if version != STREAM_VERSION or samples == 0 or samples > STREAM_MAX_SAMPLES:
+        return 0
+    body = STREAM_HEADER.size + 2 * samples
+    if j + body + 4 > len(buf):
+        return None
+    if zlib.crc32(buf[j:j + body]) != struct.unpack_from("<I", buf, j + body)[0]:
+        return 0
+    return body + 4
+
+
+class Decoder:
+    """Splits a byte stream into text, records, trace chunks and sample frames; feed() may cut anywhere.
+
+    on_trace(core, dropped, events) gets the body of every trace chunk;
+    without it the chunks are dropped. trace_names, the dev_trace_name
+    section, makes telling chunks from text stricter.
+    """
+
+    def __init__(self, table, timestamps=False, on_trace=None, trace_names=b""):
+        self.table = table
+        self.timestamps = timestamps
+        self.on_trace = on_trace
+        self.trace_names = trace_names
+        self.pending = b""
+
+    def feed(self, data, final=False):
+        buf = self.pending + data
+        out = []
+        i = 0
+        while i < len(buf):
+            m = SYNC_RE.search(buf, i)
+            if m is None:
+                out.append(buf[i:].decode("latin-1"))
+                i = len(buf)
+                break
+            j = m.start()
+            out.append(buf[i:j].decode("latin-1"))
+            if buf[j] == STREAM_SYNC:
+                length = stream_frame(buf, j)
+                if length is None and not final:
+                    i = j
+                    break
+                if not length:
+                    out.append(buf[j:j + 1].decode("latin-1"))
+                    i = j + 1
+                    continue
+                i = j + length
+                continue
+            if buf[j] == TRACE_SYNC:
+                length = trace_chunk(buf, j, self.trace_names)
+                if length is None and not final:
+                    i = j
+                    break
+                if not length:
+                    out.append(buf[j:j + 1].decode("latin-1"))
+                    i = j + 1
+                    continue
+                if self.on_trace:
+                    dropped = struct.unpack_from("<I", buf, j + 4)[0]
+                    self.on_trace(buf[j + 1], dropped, buf[j + TRACE_HEADER:j + length])
+                i = j + length
+                continue
+            if j + HEADER > len(buf):
+                i = j
+                break
+            length = buf[j + 1] & 0x7F
+            core = buf[j + 1] >> 7
+            fmt_id, stamp = struct.unpack_from("<HI", buf, j + 2)
+            fmt = format_at(self.table, fmt_id) if length <= ARG_BYTES else None
+            if fmt is None:
+                # not a record: the byte was text after all
+                out.append(buf[j:j + 1].decode("latin-1"))
+                i = j + 1
+                continue
+            if j + HEADER + length > len(buf):
+                i = j
+                break
+            if self.timestamps:
+                out.append("[%11.6f c%d] " % (stamp / 1e6, core))
+            out.append(expand(fmt, buf[j + HEADER:j + HEADER + length]))
+            i = j + HEADER + length
+        self.pending = buf[i:]
+        if final and self.pending:
+            out.append(self.pending.decode("latin-1"))
+            self.pending = b""
+        return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("capture", nargs="?", help="raw capture, default stdin")
+    parser.add_argument("--objcopy", default="objcopy")
+    parser.add_argument("--time", action="store_true", help="prefix records with device time and core")
+    parser.add_argument("--output", help="write the text here instead of stdout")
+    args = parser.parse_args()
+
+    decoder = Decoder(load_formats(args.elf, args.objcopy), args.time,
+                      trace_names=load_formats(args.elf, args.objcopy, "dev_trace_name"))
+    src = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    # newline="" keeps the device's \r\n as they came
+    out = open(args.output, "w", encoding="latin-1", newline="") if args.output else sys.stdout
+    with src:
+        while True:
+            data = src.read1(4096) if hasattr(src, "read1") else src.read(4096)
+            if not data:
+                break
+            out.write(decoder.feed(data))
+            out.flush()
+    out.write(decoder.feed(b"", final=True))
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Print where the large RAM buffers of a firmware ELF ended up.
+
+Reads the symbol table (`objdump -t`) and lists every RAM object of at least
+--min-size bytes, and every object in a section of the memory plan
+(DEV_RAM_DMA/DSP/FRAME in DEV_Config.h) whatever its size, with its address,
+size, section and SRAM bank, then the bytes used in each bank. Run after
+every firmware link, so a buffer that drifts out of its bank shows up in the
+build log.
+
+usage: memory_report.py [--objdump arm-none-eabi-objdump] [--platform rp2350] firmware.elf
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+# (name, start, end) of each bank group, lowest address first
+BANKS = {
+    "rp2350": [
+        ("SRAM0-3", 0x20000000, 0x20040000),
+        ("SRAM4-7", 0x20040000, 0x20080000),
+        ("scratch X", 0x20080000, 0x20081000),
+        ("scratch Y", 0x20081000, 0x20082000),
+    ],
+    "rp2040": [
+        ("SRAM0-3", 0x20000000, 0x20040000),
+        ("scratch X", 0x20040000, 0x20041000),
+        ("scratch Y", 0x20041000, 0x20042000),
+    ],
+}
+
+PLANNED = (".scratch_x", ".scratch_y", ".sram_frame")
+
+# 20000400 l     O .bss	00000800 capture_ring
+SYMBOL_RE = re.compile(r"^([0-9a-fA-F]+) (.{7}) (\S+)\s+([0-9a-fA-F]+)\s+(.*)$")
+
+
+def parse_symbols(text):
+    """objdump -t text -> [(address, size, section, name)] of sized objects."""
+    symbols = []
+    for line in text.splitlines():
+        m = SYMBOL_RE.match(line)
+        if not m or m.group(2)[6] != "O":
+            continue
+        size = int(m.group(4), 16)
+        if size:
+            symbols.append((int(m.group(1), 16), size, m.group(3), m.group(5).strip()))
+    return symbols
+
+
+def bank_of(banks, address):
+    for name, start, end in banks:
+        if start <= address < end:
+            return name
+    return None
+
+
+def report(symbols, banks, min_size, out=sys.stdout):
+    used = {name: 0 for name, _, _ in banks}
+    rows = []
+    for address, size, section, name in sorted(symbols):
+        bank = bank_of(banks, address)
+        if bank is None:
+            continue
+        used[bank] += size
+        if size >= min_size or section.startswith(PLANNED):
+            rows.append((address, size, section, bank, name))
+
+    out.write("%-10s %8s  %-22s %-10s %s\n" % ("address", "size", "section", "bank", "object"))
+    for address, size, section, bank, name in rows:
+        out.write("0x%08x %8d  %-22s %-10s %s\n" % (address, size, section, bank, name))
+    for name, start, end in banks:
+        out.write("%-10s %7d of %7d bytes in objects\n" % (name, used[name], end - start))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--platform", default="rp2350", help="PICO_PLATFORM, e.g. rp2350-arm-s")
+    parser.add_argument("--min-size", type=int, default=256)
+    args = parser.parse_args()
+
+    text = subprocess.run([args.objdump, "-t", args.elf], check=True,
+                          stdout=subprocess.PIPE, universal_newlines=True).stdout
+    report(parse_symbols(text), BANKS[args.platform.split("-")[0]], args.min_size)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Turn the trace chunks (DEV_Trace.h) of a USB capture into Chrome trace JSON.
+
+Takes the event names from the dev_trace_name section of the ELF that
+produced the capture. Log records and text on the same port are skipped.
+Open the output in chrome://tracing or ui.perfetto.dev: core 0, core 1
+and the SPI transfers show as threads of one process. A summary of the
+spans per track goes to stdout.
+
+    cat /dev/ttyACM0 > capture.bin      # after sending 't' to start tracing
+    trace_export.py --objcopy arm-none-eabi-objcopy firmware.elf capture.bin
+
+usage: trace_export.py [--objcopy objcopy] [--output trace.json] firmware.elf [capture]
+"""
+
+import argparse
+import json
+import sys
+
+import log_decode
+
+TRACKS = {0: "core 0", 1: "core 1", 2: "spi"}
+
+
+class Trace:
+    def __init__(self, names):
+        self.names = names
+        self.events = []        # (time_us, order, track, phase, name, value)
+        self.dropped = {}
+        self.marks = 0          # events added here, not recorded on the device
+        self.last_us = {}
+
+    def chunk(self, core, dropped, data):
+        if dropped:
+            # the drops happened before the first event of this chunk
+            self.dropped[core] = self.dropped.get(core, 0) + dropped
+            if len(data) >= log_decode.TRACE_EVENT.size:
+                stamp = log_decode.TRACE_EVENT.unpack_from(data, 0)[0]
+            else:
+                stamp = self.last_us.get(core, 0)
+            self.add(stamp, core, "i", "dropped %d events" % dropped, 0)
+            self.marks += 1
+        for k in range(0, len(data), log_decode.TRACE_EVENT.size):
+            stamp, name, phase, track, value = log_decode.TRACE_EVENT.unpack_from(data, k)
+            self.add(stamp, track, chr(phase), log_decode.format_at(self.names, name) or "#%d" % name, value)
+            self.last_us[core] = stamp
+
+    def add(self, stamp, track, phase, name, value):
+        self.events.append((stamp, len(self.events), track, phase, name, value))
+
+    def export(self):
+        """Chrome trace events, with every span closed, and the span statistics."""
+        out = []
+        stacks = {}
+        stats = {}
+        self.events.sort()
+        base = self.events[0][0] if self.events else 0
+        for stamp, _, track, phase, name, value in self.events:
+            ts = stamp - base
+            ev = {"name": name, "ph": phase, "ts": ts, "pid": 0, "tid": track}
+            stack = stacks.setdefault(track, [])
+            if phase == "B":
+                stack.append((name, ts))
+            elif phase == "E":
+                if not stack or stack[-1][0] != name:
+                    print("warning: %s: end of '%s' without its begin, skipped" % (track_name(track), name),
+                          file=sys.stderr)
+                    continue
+                span(stats, track, name, ts - stack.pop()[1])
+            elif phase == "i":
+                ev["s"] = "t"
+            elif phase == "C":
+                ev["args"] = {name: value}
+            out.append(ev)
+        end = self.events[-1][0] - base if self.events else 0
+        for track, stack in stacks.items():
+            while stack:
+                name, ts = stack.pop()
+                print("warning: %s: '%s' still open at the end, closed there" % (track_name(track), name),
+                      file=sys.stderr)
+                out.append({"name": name, "ph": "E", "ts": end, "pid": 0, "tid": track})
+                span(stats, track, name, end - ts)
+        for track in sorted(stacks):
+            out.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": track,
+                        "args": {"name": track_name(track)}})
+        out.append({"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "ecg firmware"}})
+        return out, stats, end
+
+
+def track_name(track):
+    return TRACKS.get(track, "track %d" % track)
+
+
+def span(stats, track, name, us):
+    s = stats.setdefault((track, name), [0, 0, 0])
+    s[0] += 1
+    s[1] += us
+    s[2] = max(s[2], us)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("capture", nargs="?", help="raw capture, default stdin")
+    parser.add_argument("--objcopy", default="objcopy")
+    parser.add_argument("--output", default="trace.json")
+    args = parser.parse_args()
+
+    names = log_decode.load_formats(args.elf, args.objcopy, "dev_trace_name")
+    trace = Trace(names)
+    decoder = log_decode.Decoder(log_decode.load_formats(args.elf, args.objcopy), on_trace=trace.chunk,
+                                 trace_names=names)
+    src = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    with src:
+        while True:
+            data = src.read1(4096) if hasattr(src, "read1") else src.read(4096)
+            if not data:
+                break
+            decoder.feed(data)
+    decoder.feed(b"", final=True)
+    if not trace.events:
+        print("no trace events in the capture", file=sys.stderr)
+        sys.exit(1)
+
+    events, stats, end = trace.export()
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+
+    print("%-8s %-16s %7s %10s %8s %8s %6s" % ("track", "span", "count", "total us", "mean us", "max us", "share"))
+    for (track, name), (count, total, longest) in sorted(stats.items()):
+        print("%-8s %-16s %7d %10d %8.1f %8d %5.1f%%" % (track_name(track), name, count, total, total / count,
+                                                        longest, 100.0 * total / end if end else 0))
+    tracks = {ev[2] for ev in trace.events}
+    print("trace: %d events on %d tracks, %d spans, %d dropped, %.3f s"
+          % (len(trace.events) - trace.marks,
+             len(tracks), sum(s[0] for s in stats.values()), sum(trace.dropped.values()), end / 1e6))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,15 @@
+# 在构建时由 cn_index.py 生成中文字库 (cFONT) 的排序索引 font_cn_index.c
+# 固件和主机构建共用，用法：cn_font_index(变量名)，生成文件路径写入该变量
+set(CN_INDEX_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(cn_font_index OUT_VAR)
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+    file(GLOB CN_FONT_SRCS ${CN_INDEX_DIR}/font*CN.c)
+    set(CN_INDEX_OUT ${CMAKE_CURRENT_BINARY_DIR}/font_cn_index.c)
+    add_custom_command(
+        OUTPUT ${CN_INDEX_OUT}
+        COMMAND ${Python3_EXECUTABLE} ${CN_INDEX_DIR}/cn_index.py -o ${CN_INDEX_OUT} ${CN_FONT_SRCS}
+        DEPENDS ${CN_INDEX_DIR}/cn_index.py ${CN_FONT_SRCS}
+        COMMENT "Generating CN glyph index")
+    set(${OUT_VAR} ${CN_INDEX_OUT} PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Generate sorted glyph indexes for the GB2312 (cFONT) tables.
+
+Reads every `const CH_CN <Name>_Table[]` in the given font sources and writes
+one `const CN_INDEX <Name>_Index` per table: the glyph codes sorted ascending,
+each with its position in the table, so Paint_DrawString_CN can binary-search
+instead of scanning the table for every character.
+
+Codes are the two index bytes as a big-endian uint16_t. ASCII glyphs only
+match on their first byte, so they are keyed as (byte << 8). When a code
+appears twice the first entry wins, as with the old linear scan.
+
+usage: cn_index.py -o font_cn_index.c font12CN.c font24CN.c ...
+"""
+
+import argparse
+import os
+import re
+import sys
+
+TABLE_RE = re.compile(rb"const\s+CH_CN\s+(\w+)_Table\s*\[\s*\]\s*=\s*\{(.*?)\n\}\s*;", re.S)
+ENTRY_RE = re.compile(rb'\{\{"((?:[^"\\]|\\.)*)"\}\s*,')
+
+
+def unescape(raw):
+    """C string literal bytes -> bytes, enough for the escapes fonts use."""
+    out = bytearray()
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        if c == 0x5C and i + 1 < len(raw):  # backslash
+            n = raw[i + 1]
+            if n in b"xX":
+                m = re.match(rb"[0-9a-fA-F]{1,2}", raw[i + 2:])
+                out.append(int(m.group(0), 16))
+                i += 2 + len(m.group(0))
+                continue
+            out.append({ord("n"): 10, ord("t"): 9, ord("0"): 0}.get(n, n))
+            i += 2
+            continue
+        out.append(c)
+        i += 1
+    return bytes(out)
+
+
+def glyph_code(index):
+    first = index[0] if len(index) > 0 else 0
+    if first <= 0x7F:
+        return first << 8
+    second = index[1] if len(index) > 1 else 0
+    return (first << 8) | second
+
+
+def parse(path):
+    with open(path, "rb") as f:
+        text = f.read()
+    # Comments hold GB2312 text that may contain quotes, drop them first
+    text = re.sub(rb"/\*.*?\*/", b"", text, flags=re.S)
+    text = re.sub(rb"//[^\n]*", b"", text)
+    tables = []
+    for m in TABLE_RE.finditer(text):
+        name = m.group(1).decode()
+        codes = {}
+        for pos, e in enumerate(ENTRY_RE.finditer(m.group(2))):
+            code = glyph_code(unescape(e.group(1)))
+            codes.setdefault(code, pos)
+        tables.append((name, sorted(codes.items())))
+    return tables
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-o", "--output", required=True)
+    ap.add_argument("sources", nargs="+")
+    args = ap.parse_args()
+
+    lines = [
+        "/* Generated by cn_index.py from %s, do not edit */"
+        % " ".join(os.path.basename(s) for s in args.sources),
+        '#include "fonts.h"',
+        "",
+    ]
+    for src in args.sources:
+        for name, entries in parse(src):
+            if len(entries) > 0xFFFF:
+                sys.exit("%s: too many glyphs" % name)
+            lines.append("static const CN_INDEX_ENTRY %s_Index_Entries[] = {" % name)
+            for code, pos in entries:
+                lines.append("  {0x%04X, %d}," % (code, pos))
+            lines.append("};")
+            lines.append("const CN_INDEX %s_Index = {%s_Index_Entries, %d};"
+                         % (name, name, len(entries)))
+            lines.append("")
+
+    data = "\n".join(lines)
+    # Only touch the output when it changes, so the font library is not rebuilt
+    try:
+        with open(args.output) as f:
+            if f.read() == data:
+                return
+    except OSError:
+        pass
+    with open(args.output, "w") as f:
+        f.write(data)
+
+
+if __name__ == "__main__":
+    main()
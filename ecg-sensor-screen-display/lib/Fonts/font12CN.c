@@ -147,6 +147,7 @@ cFONT Font12CN = {
   11, /* ASCII Width */
   16, /* Width */
   21, /* Height */
+  &Font12CN_Index, /* Sorted index */
 };
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
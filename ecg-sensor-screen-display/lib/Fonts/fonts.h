@@ -69,6 +69,19 @@ typedef struct                                          // 
 }CH_CN;
 
 
+//Sorted glyph index, generated at build time by cn_index.py
+typedef struct
+{
+  uint16_t Code;                                      // index bytes, big-endian; ASCII is (char << 8)
+  uint16_t Glyph;                                     // position in table
+}CN_INDEX_ENTRY;
+
+typedef struct
+{
+  const CN_INDEX_ENTRY *Entries;                      // ascending Code
+  uint16_t Size;
+}CN_INDEX;
+
 typedef struct
 {    
   const CH_CN *table;
@@ -76,6 +89,7 @@ typedef struct
   uint16_t ASCII_Width;
   uint16_t Width;
   uint16_t Height;
+  const CN_INDEX *Index;                              // NULL: linear search of table
   
 }cFONT;
 
@@ -87,6 +101,9 @@ extern sFONT Font8;
 
 extern cFONT Font12CN;
 extern cFONT Font24CN;
+
+extern const CN_INDEX Font12CN_Index;
+extern const CN_INDEX Font24CN_Index;
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,240 @@
+/*****************************************************************************
+* | File      	:   GUI_Compositor.c
+* | Function    :   Layer compositor for GUI_Paint surfaces
+* | Info        :
+*   Rows are built bottom-up: layer 0 fills the row, every layer above
+*   writes its non-transparent pixels over it.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "GUI_Compositor.h"
+#include "Debug.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+function:	Set up a compositor
+parameter:
+    Comp          : Compositor
+    Layers        : Layer stack, bottom first, kept by the caller
+    Num           : Number of layers
+    Width, Height : Memory size of the output, every layer must match it
+return:
+    0 on success, 1 if a layer does not fit
+******************************************************************************/
+UBYTE Paint_CompositorInit(PAINT_COMPOSITOR *Comp, PAINT_LAYER *Layers, UBYTE Num,
+                           UWORD Width, UWORD Height)
+{
+    memset(Comp, 0, offsetof(PAINT_COMPOSITOR, Band));
+    if(Num == 0 || Num > PAINT_COMPOSITOR_MAX_LAYERS || Width > PAINT_COMPOSITOR_MAX_WIDTH) {
+        Debug("Paint_CompositorInit: no layers, too many or too wide\r\n");
+        return 1;
+    }
+    for(UBYTE i = 0; i < Num; i++) {
+        const PAINT *Surface = Layers[i].Surface;
+        if(Surface->WidthMemory != Width || Surface->HeightMemory != Height ||
+           (Surface->Scale != 65 && Layers[i].Palette == NULL) || Surface->Scale == 2) {
+            Debug("Paint_CompositorInit: layer %d does not match\r\n", i);
+            return 1;
+        }
+    }
+    Comp->Layers = Layers;
+    Comp->Num = Num;
+    Comp->Width = Width;
+    Comp->Height = Height;
+    Comp->Force = 1;
+    return 0;
+}
+
+/******************************************************************************
+function:	Compose and send every row on the next flush, e.g. after the
+            panel was cleared or a layer was shown or hidden
+******************************************************************************/
+void Paint_CompositorInvalidate(PAINT_COMPOSITOR *Comp)
+{
+    Comp->Force = 1;
+}
+
+/******************************************************************************
+function:	Write one layer row over the band row
+parameter:
+    Layer      : Layer to read
+    Y          : Memory row
+    Xstart     : First memory column
+    pRow       : Band row from Xstart on, image cache byte order
+    Width      : Number of columns
+    Opaque     : Also write the Key pixels (bottom layer)
+******************************************************************************/
+static void DEV_RAM_FUNC(Compositor_Row)(const PAINT_LAYER *Layer, UWORD Y, UWORD Xstart, UBYTE *pRow, UWORD Width, UBYTE Opaque)
+{
+    const PAINT *Surface = Layer->Surface;
+    const UBYTE *pSrc = &Surface->Image[(UDOUBLE)Y * Surface->WidthByte];
+    UWORD X, Xend = Xstart + Width;
+
+    pRow -= 2 * Xstart;
+    if(Surface->Scale == 65) {
+        for(X = Xstart; X < Xend; X++) {
+            UWORD Color = (pSrc[2 * X] << 8) | pSrc[2 * X + 1];
+            if(Opaque || Color != Layer->Key) {
+                pRow[2 * X] = pSrc[2 * X];
+                pRow[2 * X + 1] = pSrc[2 * X + 1];
+            }
+        }
+    } else if(Surface->Scale == 4) {
+        for(X = Xstart; X < Xend; X++) {
+            UBYTE Index = (pSrc[X / 4] >> (6 - (X % 4) * 2)) & 0x03;
+            if(Opaque || Index != Layer->Key) {
+                UWORD Color = Layer->Palette[Index];
+                pRow[2 * X] = Color >> 8;
+                pRow[2 * X + 1] = Color & 0xff;
+            }
+        }
+    } else {
+        for(X = Xstart; X < Xend; X++) {
+            UBYTE Index = (pSrc[X / 2] >> (4 - (X % 2) * 4)) & 0x0f;
+            if(Opaque || Index != Layer->Key) {
+                UWORD Color = Layer->Palette[Index];
+                pRow[2 * X] = Color >> 8;
+                pRow[2 * X + 1] = Color & 0xff;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+function:	Compose rows Y0..Y1-1, columns Xstart..Xend-1 into the band
+******************************************************************************/
+static void DEV_RAM_FUNC(Compositor_Band)(PAINT_COMPOSITOR *Comp, UWORD Xstart, UWORD Xend, UWORD Y0, UWORD Y1)
+{
+    UWORD Width = Xend - Xstart;
+    for(UWORD Y = Y0; Y < Y1; Y++) {
+        UBYTE *pRow = (UBYTE *)&Comp->Band[(Y - Y0) * Width];
+        for(UBYTE i = 0; i < Comp->Num; i++) {
+            if(i == 0 || Comp->Layers[i].Visible)
+                Compositor_Row(&Comp->Layers[i], Y, Xstart, pRow, Width, i == 0);
+        }
+    }
+    PAINT_COUNT_PIXELS((UDOUBLE)(Y1 - Y0) * Width);
+    Comp->Pixels += (UDOUBLE)(Y1 - Y0) * Width;
+}
+
+/******************************************************************************
+function:	Compose the rows changed on any visible layer and send them
+parameter:
+    Comp : Compositor
+    Sink : Called once per band with full-width rows
+return:
+    Number of rows sent, 0 if no layer changed
+******************************************************************************/
+int Paint_CompositorFlush(PAINT_COMPOSITOR *Comp, PAINT_BAND_SINK Sink)
+{
+    UWORD Ystart = 0xFFFF, Yend = 0;
+    Comp->Frames++;
+
+    // Union of the dirty rows of all layers
+    for(UBYTE i = 0; i < Comp->Num; i++) {
+        UWORD Ys, Ye;
+        PAINT *Surface = Comp->Layers[i].Surface;
+        if(Surface_GetDirty(Surface, &Ys, &Ye) && Comp->Layers[i].Visible) {
+            Ystart = Ys < Ystart ? Ys : Ystart;
+            Yend = Ye > Yend ? Ye : Yend;
+        }
+        Surface_ClearDirty(Surface);
+    }
+    if(Comp->Force) {
+        Ystart = 0;
+        Yend = Comp->Height - 1;
+        Comp->Force = 0;
+    }
+    if(Ystart > Yend) {
+        Comp->Skipped++;
+        return 0;
+    }
+
+    for(UWORD Y0 = Ystart; Y0 <= Yend; Y0 += PAINT_COMPOSITOR_BAND_HEIGHT) {
+        UWORD Y1 = Y0 + PAINT_COMPOSITOR_BAND_HEIGHT;
+        if(Y1 > Yend + 1)
+            Y1 = Yend + 1;
+        Compositor_Band(Comp, 0, Comp->Width, Y0, Y1);
+        Sink(Y0, Y1, Comp->Band);
+    }
+
+    Comp->Rows += Yend - Ystart + 1;
+    return Yend - Ystart + 1;
+}
+
+/******************************************************************************
+function:	Compose the changed rectangle of each visible layer and send it
+parameter:
+    Comp : Compositor
+    Sink : Called once per band, a band is as many rows of the rectangle
+           as fit in the work area
+return:
+    Number of pixels sent, 0 if no layer changed
+info:
+    Rectangles of different layers that overlap are merged first, the
+    others go out as separate windows.
+******************************************************************************/
+UDOUBLE Paint_CompositorFlushRect(PAINT_COMPOSITOR *Comp, PAINT_RECT_SINK Sink)
+{
+    UWORD Rect[PAINT_COMPOSITOR_MAX_LAYERS][4];
+    UBYTE Num = 0, i, j;
+    UDOUBLE Pixels = 0;
+    Comp->Frames++;
+
+    for(i = 0; i < Comp->Num; i++) {
+        PAINT *Surface = Comp->Layers[i].Surface;
+        UWORD *r = Rect[Num];
+        if(Surface_GetDirtyRect(Surface, &r[0], &r[1], &r[2], &r[3]) && Comp->Layers[i].Visible && !Comp->Force)
+            Num++;
+        Surface_ClearDirty(Surface);
+    }
+    if(Comp->Force) {
+        Rect[0][0] = 0;
+        Rect[0][1] = 0;
+        Rect[0][2] = Comp->Width - 1;
+        Rect[0][3] = Comp->Height - 1;
+        Num = 1;
+        Comp->Force = 0;
+    }
+    if(Num == 0) {
+        Comp->Skipped++;
+        return 0;
+    }
+
+    // Merge overlapping rectangles until none overlap
+    UBYTE Merged = 1;
+    while(Merged) {
+        Merged = 0;
+        for(i = 0; i < Num && !Merged; i++) {
+            for(j = i + 1; j < Num && !Merged; j++) {
+                UWORD *a = Rect[i], *b = Rect[j];
+                if(a[0] > b[2] || b[0] > a[2] || a[1] > b[3] || b[1] > a[3])
+                    continue;
+                a[0] = b[0] < a[0] ? b[0] : a[0];
+                a[1] = b[1] < a[1] ? b[1] : a[1];
+                a[2] = b[2] > a[2] ? b[2] : a[2];
+                a[3] = b[3] > a[3] ? b[3] : a[3];
+                memcpy(b, Rect[--Num], sizeof(Rect[0]));
+                Merged = 1;
+            }
+        }
+    }
+
+    for(i = 0; i < Num; i++) {
+        UWORD Xstart = Rect[i][0], Xend = Rect[i][2] + 1;
+        UWORD Rows = (UWORD)(PAINT_COMPOSITOR_BAND_HEIGHT * PAINT_COMPOSITOR_MAX_WIDTH / (Xend - Xstart));
+        for(UWORD Y0 = Rect[i][1]; Y0 <= Rect[i][3]; Y0 += Rows) {
+            UWORD Y1 = Y0 + Rows;
+            if(Y1 > Rect[i][3] + 1)
+                Y1 = Rect[i][3] + 1;
+            Compositor_Band(Comp, Xstart, Xend, Y0, Y1);
+            Sink(Xstart, Y0, Xend, Y1, Comp->Band);
+        }
+        Comp->Rows += Rect[i][3] - Rect[i][1] + 1;
+        Pixels += (UDOUBLE)(Xend - Xstart) * (Rect[i][3] - Rect[i][1] + 1);
+    }
+    return Pixels;
+}
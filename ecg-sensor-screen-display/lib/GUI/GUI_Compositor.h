@@ -0,0 +1,64 @@
+/*****************************************************************************
+* | File      	:   GUI_Compositor.h
+* | Function    :   Layer compositor for GUI_Paint surfaces
+* | Info        :
+*   Merges a stack of surfaces (e.g. static background, waveform, HUD) into
+*   bands for the panel. Each surface tracks the rows drawn on it, so only
+*   rows that changed on some layer are composed and sent; a frame where no
+*   layer changed costs nothing.
+*
+*   All layers share the compositor's memory size. Layers with a palette
+*   (scale 4 or 16) store colour indices, scale 65 layers store RGB565.
+*   Layer 0 is the bottom and is always opaque; on the others the Key
+*   index (or colour, for scale 65) is transparent.
+*
+*   Panels that accept arbitrary windows can take Paint_CompositorFlushRect()
+*   instead, which sends only the changed rectangle of each layer. A trace
+*   that changes a few columns per update then costs a few columns on the
+*   bus instead of full-width rows.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#ifndef __GUI_COMPOSITOR_H
+#define __GUI_COMPOSITOR_H
+
+#include "GUI_Paint.h"
+#include "GUI_DisplayList.h"
+
+#define PAINT_COMPOSITOR_BAND_HEIGHT  8
+#define PAINT_COMPOSITOR_MAX_WIDTH    320
+#define PAINT_COMPOSITOR_MAX_LAYERS   8
+
+// Window Xstart..Xend-1, Ystart..Yend-1, Band holds (Xend - Xstart) pixels per row
+typedef void (*PAINT_RECT_SINK)(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Band);
+
+typedef struct {
+    PAINT *Surface;
+    const UWORD *Palette;   // RGB565 for each index, NULL for scale 65
+    UWORD Key;              // transparent index or colour
+    UBYTE Visible;
+} PAINT_LAYER;
+
+typedef struct {
+    PAINT_LAYER *Layers;
+    UBYTE Num;
+    UWORD Width;
+    UWORD Height;
+    UBYTE Force;            // compose every row on the next flush
+    // Statistics
+    UDOUBLE Frames;
+    UDOUBLE Skipped;
+    UDOUBLE Rows;
+    UDOUBLE Pixels;
+    // Flush work area
+    UWORD Band[PAINT_COMPOSITOR_BAND_HEIGHT * PAINT_COMPOSITOR_MAX_WIDTH];
+} PAINT_COMPOSITOR;
+
+UBYTE Paint_CompositorInit(PAINT_COMPOSITOR *Comp, PAINT_LAYER *Layers, UBYTE Num,
+                           UWORD Width, UWORD Height);
+void Paint_CompositorInvalidate(PAINT_COMPOSITOR *Comp);
+int Paint_CompositorFlush(PAINT_COMPOSITOR *Comp, PAINT_BAND_SINK Sink);
+UDOUBLE Paint_CompositorFlushRect(PAINT_COMPOSITOR *Comp, PAINT_RECT_SINK Sink);
+
+#endif
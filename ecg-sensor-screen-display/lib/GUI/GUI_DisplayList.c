@@ -0,0 +1,498 @@
+/*****************************************************************************
+* | File      	:   GUI_DisplayList.c
+* | Function    :   Deferred (display list) mode for GUI_Paint
+* | Info        :
+*   Every rasteriser below reproduces the pixels of the matching Paint_*
+*   function in the immediate mode, including its quirks (the 1x1 pen of
+*   Paint_DrawLine lands one pixel up and left, dotted lines use BLACK or
+*   WHITE for every third point, a WHITE character background is
+*   transparent), so both modes stay byte-identical.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "GUI_DisplayList.h"
+#include "Debug.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+function:	Prepare a display list
+parameter:
+    List       : List to set up
+    Cmds       : Command storage
+    Capacity   : Number of commands Cmds can hold
+    Background : What the frame holds before the first Paint_Clear()
+******************************************************************************/
+void Paint_ListInit(PAINT_LIST *List, PAINT_CMD *Cmds, UWORD Capacity, UWORD Background)
+{
+    memset(List, 0, offsetof(PAINT_LIST, Band));
+    List->Cmds = Cmds;
+    List->Capacity = Capacity;
+    List->Background = Background;
+}
+
+/******************************************************************************
+function:	Select the list the drawing calls on a surface record into
+parameter:
+    Surface : Surface whose geometry the list takes
+    List    : Display list, or NULL to draw into the image cache again
+return:
+    0 on success, 1 if the surface layout cannot be deferred
+******************************************************************************/
+UBYTE Surface_SetList(PAINT *Surface, PAINT_LIST *List)
+{
+    if(List == NULL) {
+        Surface->List = NULL;
+        return 0;
+    }
+    if(Surface->Scale != 65 || Surface->Rotate != ROTATE_0 || Surface->Mirror != MIRROR_NONE ||
+       Surface->Width > PAINT_LIST_MAX_WIDTH || Surface->Height > PAINT_LIST_MAX_HEIGHT) {
+        Debug("Surface_SetList: needs scale 65, ROTATE_0, MIRROR_NONE\r\n");
+        return 1;
+    }
+    if(List->Width != Surface->Width || List->Height != Surface->Height) {
+        List->Width = Surface->Width;
+        List->Height = Surface->Height;
+        List->Sent = 0;
+    }
+    Surface->List = List;
+    return 0;
+}
+
+UBYTE Paint_SetList(PAINT_LIST *List)
+{
+    return Surface_SetList(&Paint, List);
+}
+
+/******************************************************************************
+function:	Force the next flush to be sent, e.g. after the panel was cleared
+******************************************************************************/
+void Paint_ListInvalidate(PAINT_LIST *List)
+{
+    List->Sent = 0;
+}
+
+/******************************************************************************
+function:	Recording
+******************************************************************************/
+static PAINT_CMD *List_Add(PAINT_LIST *List, UBYTE Type, UWORD Ytop, UWORD Ybottom)
+{
+    if(List->Num >= List->Capacity) {
+        if(!List->Overflow) {
+            Debug("Paint_List: command list full\r\n");
+        }
+        List->Overflow = 1;
+        return NULL;
+    }
+    PAINT_CMD *Cmd = &List->Cmds[List->Num++];
+    memset(Cmd, 0, sizeof(PAINT_CMD));
+    Cmd->Type = Type;
+    Cmd->Ytop = Ytop;
+    Cmd->Ybottom = Ybottom < List->Height ? Ybottom : List->Height - 1;
+    return Cmd;
+}
+
+void Paint_ListClear(PAINT_LIST *List, UWORD Color)
+{
+    // Everything recorded so far is covered, drop it
+    List->Num = 0;
+    List->Overflow = 0;
+    List->Background = Color;
+}
+
+void Paint_ListSpan(PAINT_LIST *List, UWORD Xpoint, UWORD Ypoint, UWORD Len, UWORD Color)
+{
+    if(Xpoint >= List->Width || Ypoint >= List->Height || Len == 0)
+        return;
+    if(Len > List->Width - Xpoint)
+        Len = List->Width - Xpoint;
+
+    // Runs of Paint_SetPixel() along a row become one span
+    if(List->Num > 0) {
+        PAINT_CMD *Last = &List->Cmds[List->Num - 1];
+        if(Last->Type == PAINT_CMD_SPAN && Last->Y0 == Ypoint && Last->Color == Color &&
+           Last->X0 + Last->X1 == Xpoint) {
+            Last->X1 += Len;
+            return;
+        }
+    }
+
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_SPAN, Ypoint, Ypoint);
+    if(Cmd == NULL)
+        return;
+    Cmd->Color = Color;
+    Cmd->X0 = Xpoint;
+    Cmd->Y0 = Ypoint;
+    Cmd->X1 = Len;
+}
+
+void Paint_ListVSpan(PAINT_LIST *List, UWORD Xpoint, UWORD Ystart, UWORD Yend, UWORD Color)
+{
+    if(Xpoint >= List->Width || Ystart > Yend || Ystart >= List->Height)
+        return;
+
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_VSPAN, Ystart, Yend);
+    if(Cmd == NULL)
+        return;
+    Cmd->Color = Color;
+    Cmd->X0 = Xpoint;
+    Cmd->Y0 = Ystart;
+    Cmd->Y1 = Cmd->Ybottom;
+}
+
+void Paint_ListLine(PAINT_LIST *List, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, LINE_STYLE Line_Style)
+{
+    // The pen puts each point at (x - 1, y - 1), row 0 of the line is never drawn
+    UWORD Ymin = Ystart < Yend ? Ystart : Yend;
+    UWORD Ymax = Ystart < Yend ? Yend : Ystart;
+    if(Ymax == 0 || Ymin > List->Height)
+        return;
+
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_LINE, Ymin ? Ymin - 1 : 0, Ymax - 1);
+    if(Cmd == NULL)
+        return;
+    Cmd->Arg = Line_Style;
+    Cmd->Color = Color;
+    Cmd->X0 = Xstart;
+    Cmd->Y0 = Ystart;
+    Cmd->X1 = Xend;
+    Cmd->Y1 = Yend;
+}
+
+void Paint_ListChar(PAINT_LIST *List, UWORD Xpoint, UWORD Ypoint, const char Acsii_Char, sFONT* Font,
+                    UWORD Color_Foreground, UWORD Color_Background)
+{
+    if(Ypoint >= List->Height || Font->Height == 0)
+        return;
+
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_CHAR, Ypoint, Ypoint + Font->Height - 1);
+    if(Cmd == NULL)
+        return;
+    Cmd->Arg = (UBYTE)Acsii_Char;
+    Cmd->Color = Color_Foreground;
+    Cmd->Color_Background = Color_Background;
+    Cmd->X0 = Xpoint;
+    Cmd->Y0 = Ypoint;
+    Cmd->pData = Font;
+}
+
+void Paint_ListImage(PAINT_LIST *List, const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image)
+{
+    if(yStart >= List->Height || W_Image == 0 || H_Image == 0)
+        return;
+
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_IMAGE, yStart, yStart + H_Image - 1);
+    if(Cmd == NULL)
+        return;
+    Cmd->X0 = xStart;
+    Cmd->Y0 = yStart;
+    Cmd->X1 = W_Image;
+    Cmd->Y1 = H_Image;
+    Cmd->pData = image;
+}
+
+void Paint_ListBitMap(PAINT_LIST *List, const unsigned char *image_buffer)
+{
+    PAINT_CMD *Cmd = List_Add(List, PAINT_CMD_BITMAP, 0, List->Height - 1);
+    if(Cmd == NULL)
+        return;
+    Cmd->pData = image_buffer;
+}
+
+/******************************************************************************
+function:	Rasterisers, each draws the part of one command that falls in
+            rows Ystart..Yend-1 of the band
+******************************************************************************/
+static void DEV_RAM_FUNC(List_Put)(PAINT_LIST *List, UWORD Ystart, UWORD X, UWORD Y, UWORD Color)
+{
+    UBYTE *p = (UBYTE *)&List->Band[(Y - Ystart) * List->Width + X];
+    p[0] = Color >> 8;
+    p[1] = Color & 0xff;
+    PAINT_COUNT_PIXELS(1);
+}
+
+static void DEV_RAM_FUNC(List_RasterSpan)(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart)
+{
+    UBYTE Pixel[2] = {Cmd->Color >> 8, Cmd->Color & 0xff};
+    UWORD Value;
+    memcpy(&Value, Pixel, 2);
+    UWORD *p = &List->Band[(Cmd->Y0 - Ystart) * List->Width + Cmd->X0];
+    for(UWORD i = 0; i < Cmd->X1; i++)
+        p[i] = Value;
+    PAINT_COUNT_PIXELS(Cmd->X1);
+}
+
+static void DEV_RAM_FUNC(List_RasterVSpan)(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    UWORD Y = Cmd->Y0 > Ystart ? Cmd->Y0 : Ystart;
+    for(; Y <= Cmd->Y1 && Y < Yend; Y++)
+        List_Put(List, Ystart, Cmd->X0, Y, Cmd->Color);
+}
+
+static void DEV_RAM_FUNC(List_LinePoint)(PAINT_LIST *List, UWORD Ystart, UWORD Yend,
+                           UWORD Xpoint, UWORD Ypoint, UWORD Color)
+{
+    if(Xpoint == 0 || Ypoint == 0)
+        return;
+    UWORD X = Xpoint - 1, Y = Ypoint - 1;
+    if(X < List->Width && Y < List->Height && Y >= Ystart && Y < Yend)
+        List_Put(List, Ystart, X, Y, Color);
+}
+
+static void DEV_RAM_FUNC(List_RasterLine)(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    UWORD Xstart = Cmd->X0, Ystart_Line = Cmd->Y0;
+    UWORD Xend = Cmd->X1, Yend_Line = Cmd->Y1;
+    UWORD Color = Cmd->Color;
+    UWORD Gap_Color = Color ? BLACK : WHITE;
+    UBYTE Dotted = (Cmd->Arg == LINE_STYLE_DOTTED);
+
+    if(Xstart == Xend) {
+        // Vertical: jump straight to the first point inside the band
+        int Dir = Ystart_Line <= Yend_Line ? 1 : -1;
+        int Len = Dir > 0 ? Yend_Line - Ystart_Line : Ystart_Line - Yend_Line;
+        int k = 0;
+        if(Dir > 0 && Ystart_Line < Ystart + 1)
+            k = Ystart + 1 - Ystart_Line;
+        else if(Dir < 0 && Ystart_Line > Yend)
+            k = Ystart_Line - Yend;
+        for(; k <= Len; k++) {
+            int Ypoint = Ystart_Line + Dir * k;
+            if((Dir > 0 && Ypoint - 1 >= Yend) || (Dir < 0 && Ypoint - 1 < (int)Ystart))
+                break;
+            List_LinePoint(List, Ystart, Yend, Xstart, Ypoint,
+                           (Dotted && (k + 1) % 3 == 0) ? Gap_Color : Color);
+        }
+        return;
+    }
+
+    // Same walk as Paint_DrawLine()
+    UWORD Xpoint = Xstart;
+    UWORD Ypoint = Ystart_Line;
+    int dx = (int)Xend - (int)Xstart >= 0 ? Xend - Xstart : Xstart - Xend;
+    int dy = (int)Yend_Line - (int)Ystart_Line <= 0 ? Yend_Line - Ystart_Line : Ystart_Line - Yend_Line;
+    int XAddway = Xstart < Xend ? 1 : -1;
+    int YAddway = Ystart_Line < Yend_Line ? 1 : -1;
+    int Esp = dx + dy;
+    char Dotted_Len = 0;
+
+    for (;;) {
+        if(YAddway > 0 && (int)Ypoint - 1 >= Yend)
+            break;
+        Dotted_Len++;
+        if (Dotted && Dotted_Len % 3 == 0) {
+            List_LinePoint(List, Ystart, Yend, Xpoint, Ypoint, Gap_Color);
+            Dotted_Len = 0;
+        } else {
+            List_LinePoint(List, Ystart, Yend, Xpoint, Ypoint, Color);
+        }
+        if (2 * Esp >= dy) {
+            if (Xpoint == Xend)
+                break;
+            Esp += dy;
+            Xpoint += XAddway;
+        }
+        if (2 * Esp <= dx) {
+            if (Ypoint == Yend_Line)
+                break;
+            Esp += dx;
+            Ypoint += YAddway;
+            if(YAddway < 0 && (int)Ypoint - 1 < (int)Ystart)
+                break;
+        }
+    }
+}
+
+static void List_RasterChar(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    const sFONT *Font = (const sFONT *)Cmd->pData;
+    UWORD Row_Bytes = Font->Width / 8 + (Font->Width % 8 ? 1 : 0);
+    uint32_t Char_Offset = ((char)Cmd->Arg - ' ') * Font->Height * Row_Bytes;
+    UWORD Page = Cmd->Y0 < Ystart ? Ystart - Cmd->Y0 : 0;
+    UBYTE Opaque = (FONT_BACKGROUND != Cmd->Color_Background);
+
+    for (; Page < Font->Height && Cmd->Y0 + Page < Yend; Page++) {
+        UWORD Y = Cmd->Y0 + Page;
+        if(Y >= List->Height)
+            break;
+        const unsigned char *ptr = &Font->table[Char_Offset + Page * Row_Bytes];
+        for (UWORD Column = 0; Column < Font->Width; Column++) {
+            UWORD X = Cmd->X0 + Column;
+            if(X >= List->Width)
+                break;
+            if (ptr[Column / 8] & (0x80 >> (Column % 8)))
+                List_Put(List, Ystart, X, Y, Cmd->Color);
+            else if (Opaque)
+                List_Put(List, Ystart, X, Y, Cmd->Color_Background);
+        }
+    }
+}
+
+static void List_RasterImage(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    const unsigned char *image = (const unsigned char *)Cmd->pData;
+    UWORD W_Image = Cmd->X1;
+    UWORD j = Cmd->Y0 < Ystart ? Ystart - Cmd->Y0 : 0;
+
+    for (; j < Cmd->Y1 && Cmd->Y0 + j < Yend; j++) {
+        UWORD Y = Cmd->Y0 + j;
+        if(Y >= List->Height)
+            break;
+        for (UWORD i = 0; i < W_Image && Cmd->X0 + i < List->Width; i++) {
+            const unsigned char *p = image + j * W_Image * 2 + i * 2;
+            List_Put(List, Ystart, Cmd->X0 + i, Y, (p[1] << 8) | p[0]);
+        }
+    }
+}
+
+static void List_RasterBitMap(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    const unsigned char *image_buffer = (const unsigned char *)Cmd->pData;
+    UDOUBLE Row_Bytes = List->Width * 2;
+    memcpy(List->Band, image_buffer + Ystart * Row_Bytes, (Yend - Ystart) * Row_Bytes);
+    PAINT_COUNT_PIXELS((Yend - Ystart) * List->Width);
+}
+
+static void DEV_RAM_FUNC(List_Raster)(PAINT_LIST *List, const PAINT_CMD *Cmd, UWORD Ystart, UWORD Yend)
+{
+    switch(Cmd->Type) {
+    case PAINT_CMD_SPAN:
+        List_RasterSpan(List, Cmd, Ystart);
+        break;
+    case PAINT_CMD_LINE:
+        List_RasterLine(List, Cmd, Ystart, Yend);
+        break;
+    case PAINT_CMD_CHAR:
+        List_RasterChar(List, Cmd, Ystart, Yend);
+        break;
+    case PAINT_CMD_IMAGE:
+        List_RasterImage(List, Cmd, Ystart, Yend);
+        break;
+    case PAINT_CMD_BITMAP:
+        List_RasterBitMap(List, Cmd, Ystart, Yend);
+        break;
+    case PAINT_CMD_VSPAN:
+        List_RasterVSpan(List, Cmd, Ystart, Yend);
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+function:	FNV-1a over everything that decides the pixels of a frame
+******************************************************************************/
+static UDOUBLE List_Hash(UDOUBLE Hash, const void *pData, UDOUBLE Len)
+{
+    const UBYTE *p = (const UBYTE *)pData;
+    for(UDOUBLE i = 0; i < Len; i++) {
+        Hash ^= p[i];
+        Hash *= 16777619u;
+    }
+    return Hash;
+}
+
+static UDOUBLE List_HashFrame(PAINT_LIST *List)
+{
+    UDOUBLE Hash = 2166136261u;
+    Hash = List_Hash(Hash, &List->Background, sizeof(List->Background));
+    Hash = List_Hash(Hash, &List->Num, sizeof(List->Num));
+    for(UWORD i = 0; i < List->Num; i++) {
+        const PAINT_CMD *Cmd = &List->Cmds[i];
+        // Field by field, padding bytes are not part of the frame
+        Hash = List_Hash(Hash, &Cmd->Type, sizeof(Cmd->Type));
+        Hash = List_Hash(Hash, &Cmd->Arg, sizeof(Cmd->Arg));
+        Hash = List_Hash(Hash, &Cmd->Color, sizeof(Cmd->Color));
+        Hash = List_Hash(Hash, &Cmd->Color_Background, sizeof(Cmd->Color_Background));
+        Hash = List_Hash(Hash, &Cmd->X0, 4 * sizeof(UWORD));
+        if(Cmd->Type == PAINT_CMD_IMAGE)
+            Hash = List_Hash(Hash, Cmd->pData, (UDOUBLE)Cmd->X1 * Cmd->Y1 * 2);
+        else if(Cmd->Type == PAINT_CMD_BITMAP)
+            Hash = List_Hash(Hash, Cmd->pData, (UDOUBLE)List->Width * List->Height * 2);
+        else
+            Hash = List_Hash(Hash, &Cmd->pData, sizeof(Cmd->pData));
+    }
+    return Hash;
+}
+
+/******************************************************************************
+function:	Bin the commands per band, rasterise each band and send it
+parameter:
+    List : Display list
+    Sink : Called once per band with the finished rows
+return:
+    Number of bands sent, 0 if the frame equals the last one sent,
+    -1 if commands were dropped because the list was full
+******************************************************************************/
+int Paint_ListFlush(PAINT_LIST *List, PAINT_BAND_SINK Sink)
+{
+    List->Frames++;
+    UDOUBLE Hash = List_HashFrame(List);
+    if(List->Sent && !List->Overflow && Hash == List->Hash_Last) {
+        List->Skipped++;
+        return 0;
+    }
+
+    UWORD Bands = (List->Height + PAINT_LIST_BAND_HEIGHT - 1) / PAINT_LIST_BAND_HEIGHT;
+
+    // Counting sort of command indices by band, keeps drawing order per band
+    UDOUBLE Entries = 0;
+    memset(List->Bin_Start, 0, sizeof(List->Bin_Start));
+    for(UWORD i = 0; i < List->Num; i++) {
+        const PAINT_CMD *Cmd = &List->Cmds[i];
+        UWORD b0 = Cmd->Ytop / PAINT_LIST_BAND_HEIGHT, b1 = Cmd->Ybottom / PAINT_LIST_BAND_HEIGHT;
+        for(UWORD b = b0; b <= b1; b++)
+            List->Bin_Start[b + 1]++;
+        Entries += b1 - b0 + 1;
+    }
+    UBYTE Binned = (Entries <= PAINT_LIST_BIN_ENTRIES);
+    if(Binned) {
+        UWORD Fill[PAINT_LIST_MAX_BANDS];
+        for(UWORD b = 0; b < Bands; b++) {
+            List->Bin_Start[b + 1] += List->Bin_Start[b];
+            Fill[b] = List->Bin_Start[b];
+        }
+        for(UWORD i = 0; i < List->Num; i++) {
+            const PAINT_CMD *Cmd = &List->Cmds[i];
+            UWORD b0 = Cmd->Ytop / PAINT_LIST_BAND_HEIGHT, b1 = Cmd->Ybottom / PAINT_LIST_BAND_HEIGHT;
+            for(UWORD b = b0; b <= b1; b++)
+                List->Bin[Fill[b]++] = i;
+        }
+    }
+
+    UBYTE Pixel[2] = {List->Background >> 8, List->Background & 0xff};
+    UWORD Background;
+    memcpy(&Background, Pixel, 2);
+
+    for(UWORD b = 0; b < Bands; b++) {
+        UWORD Ystart = b * PAINT_LIST_BAND_HEIGHT;
+        UWORD Yend = Ystart + PAINT_LIST_BAND_HEIGHT;
+        if(Yend > List->Height)
+            Yend = List->Height;
+
+        UDOUBLE Pixels = (UDOUBLE)(Yend - Ystart) * List->Width;
+        for(UDOUBLE i = 0; i < Pixels; i++)
+            List->Band[i] = Background;
+        PAINT_COUNT_PIXELS(Pixels);
+
+        if(Binned) {
+            for(UWORD e = List->Bin_Start[b]; e < List->Bin_Start[b + 1]; e++)
+                List_Raster(List, &List->Cmds[List->Bin[e]], Ystart, Yend);
+        } else {
+            for(UWORD i = 0; i < List->Num; i++) {
+                const PAINT_CMD *Cmd = &List->Cmds[i];
+                if(Cmd->Ybottom >= Ystart && Cmd->Ytop < Yend)
+                    List_Raster(List, Cmd, Ystart, Yend);
+            }
+        }
+        Sink(Ystart, Yend, List->Band);
+    }
+
+    List->Bands += Bands;
+    List->Hash_Last = Hash;
+    List->Sent = !List->Overflow;
+    return List->Overflow ? -1 : Bands;
+}
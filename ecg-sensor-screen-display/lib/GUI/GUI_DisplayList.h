@@ -0,0 +1,108 @@
+/*****************************************************************************
+* | File      	:   GUI_DisplayList.h
+* | Function    :   Deferred (display list) mode for GUI_Paint
+* | Info        :
+*   While a list is selected with Surface_SetList(), the drawing calls on
+*   that surface record commands instead of writing the image cache.
+*   Paint_ListFlush() bins the commands per horizontal band, rasterises each
+*   band into a small line buffer and hands it to the panel.
+*
+*   What this saves is memory and bus time, not drawing: no full frame
+*   buffer is needed, and a frame whose command list hashes the same as the
+*   last one sent is not pushed again. Every command that touches a band is
+*   still rasterised in full, overdraw included, each time the band is
+*   flushed.
+*
+*   The list is retained between flushes like the image cache would be;
+*   Paint_Clear() starts a new frame.
+*
+*   Only the RGB565 cache layout (scale 65, ROTATE_0, MIRROR_NONE) is
+*   supported. The pixels match the immediate mode (paint_golden_deferred
+*   checks this).
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#ifndef __GUI_DISPLAYLIST_H
+#define __GUI_DISPLAYLIST_H
+
+#include "GUI_Paint.h"
+
+#define PAINT_LIST_BAND_HEIGHT  8       // rows per band
+#define PAINT_LIST_MAX_WIDTH    320     // widest supported image
+#define PAINT_LIST_MAX_HEIGHT   320
+#define PAINT_LIST_BIN_ENTRIES  2048    // band bins, larger lists fall back to a scan
+#define PAINT_LIST_MAX_BANDS    ((PAINT_LIST_MAX_HEIGHT + PAINT_LIST_BAND_HEIGHT - 1) / PAINT_LIST_BAND_HEIGHT)
+
+/**
+ * Recorded command
+**/
+typedef enum {
+    PAINT_CMD_SPAN = 0,     // X0,Y0 + length X1
+    PAINT_CMD_LINE,         // Paint_DrawLine with a 1 pixel pen, Arg = LINE_STYLE
+    PAINT_CMD_CHAR,         // Paint_DrawChar, Arg = character, pData = sFONT
+    PAINT_CMD_IMAGE,        // Paint_DrawImage, X0,Y0 + size X1,Y1, pData = pixels (LSB first)
+    PAINT_CMD_BITMAP,       // Paint_DrawBitMap, pData = image cache bytes
+    PAINT_CMD_VSPAN,        // column X0, rows Y0..Y1, see GUI_Waveform.h
+} PAINT_CMD_TYPE;
+
+typedef struct {
+    UBYTE Type;
+    UBYTE Arg;
+    UWORD Color;
+    UWORD Color_Background;
+    UWORD X0, Y0, X1, Y1;
+    UWORD Ytop, Ybottom;    // rows touched, for binning
+    const void *pData;
+} PAINT_CMD;
+
+/**
+ * Display list, the command storage is provided by the caller. The band
+ * buffer and bins live in the list, so lists on different cores can be
+ * flushed at the same time.
+**/
+typedef struct PAINT_LIST {
+    PAINT_CMD *Cmds;
+    UWORD Capacity;
+    UWORD Num;
+    UBYTE Overflow;
+    UWORD Background;
+    UWORD Width;
+    UWORD Height;
+    UDOUBLE Hash_Last;
+    UBYTE Sent;             // Hash_Last is valid
+    // Statistics
+    UDOUBLE Frames;
+    UDOUBLE Skipped;
+    UDOUBLE Bands;
+    // Flush work area
+    UWORD Band[PAINT_LIST_BAND_HEIGHT * PAINT_LIST_MAX_WIDTH];
+    UWORD Bin[PAINT_LIST_BIN_ENTRIES];
+    UWORD Bin_Start[PAINT_LIST_MAX_BANDS + 1];
+} PAINT_LIST;
+
+/**
+ * Receives one rasterised band, rows Ystart..Yend-1, Width pixels each,
+ * in the same byte order as the image cache
+**/
+typedef void (*PAINT_BAND_SINK)(UWORD Ystart, UWORD Yend, UWORD *Band);
+
+void Paint_ListInit(PAINT_LIST *List, PAINT_CMD *Cmds, UWORD Capacity, UWORD Background);
+UBYTE Surface_SetList(PAINT *Surface, PAINT_LIST *List);
+UBYTE Paint_SetList(PAINT_LIST *List);
+void Paint_ListInvalidate(PAINT_LIST *List);
+int Paint_ListFlush(PAINT_LIST *List, PAINT_BAND_SINK Sink);
+
+// Recording, called by GUI_Paint.c while a list is selected
+void Paint_ListClear(PAINT_LIST *List, UWORD Color);
+void Paint_ListSpan(PAINT_LIST *List, UWORD Xpoint, UWORD Ypoint, UWORD Len, UWORD Color);
+void Paint_ListVSpan(PAINT_LIST *List, UWORD Xpoint, UWORD Ystart, UWORD Yend, UWORD Color);
+void Paint_ListLine(PAINT_LIST *List, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
+                    UWORD Color, LINE_STYLE Line_Style);
+void Paint_ListChar(PAINT_LIST *List, UWORD Xpoint, UWORD Ypoint, const char Acsii_Char, sFONT* Font,
+                    UWORD Color_Foreground, UWORD Color_Background);
+void Paint_ListImage(PAINT_LIST *List, const unsigned char *image, UWORD xStart, UWORD yStart,
+                     UWORD W_Image, UWORD H_Image);
+void Paint_ListBitMap(PAINT_LIST *List, const unsigned char *image_buffer);
+
+#endif
@@ -1,4 +1,5 @@
 #include "GUI_Paint.h"
+#include "GUI_DisplayList.h"
 #include "DEV_Config.h"
 #include "Debug.h"
 #include <stdint.h>
@@ -7,6 +8,101 @@
 #include <math.h>
 
 PAINT Paint;
+#ifdef PAINT_PIXEL_COUNT
+UDOUBLE Paint_PixelCount;
+#endif
+
+/******************************************************************************
+function: Dirty rectangles
+info:
+    Every surface keeps the memory rectangle changed since the compositor
+    last took it (Dirty) and the rectangle drawn since the last clear
+    (Content). Clearing to the same colour as last time only dirties
+    Content, so a layer that is cleared and redrawn every frame costs only
+    the area it actually uses.
+******************************************************************************/
+static void DEV_RAM_FUNC(Surface_Touch)(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
+{
+    if(Xstart < Surface->Dirty_Xs)
+        Surface->Dirty_Xs = Xstart;
+    if(Xend > Surface->Dirty_Xe)
+        Surface->Dirty_Xe = Xend;
+    if(Ystart < Surface->Dirty_Ys)
+        Surface->Dirty_Ys = Ystart;
+    if(Yend > Surface->Dirty_Ye)
+        Surface->Dirty_Ye = Yend;
+    if(Xstart < Surface->Content_Xs)
+        Surface->Content_Xs = Xstart;
+    if(Xend > Surface->Content_Xe)
+        Surface->Content_Xe = Xend;
+    if(Ystart < Surface->Content_Ys)
+        Surface->Content_Ys = Ystart;
+    if(Yend > Surface->Content_Ye)
+        Surface->Content_Ye = Yend;
+}
+
+/******************************************************************************
+function: Mark an area as changed, for code that writes Surface->Image itself
+parameter:
+    Xstart, Ystart : First memory column and row
+    Xend, Yend     : Last memory column and row
+******************************************************************************/
+void Surface_MarkDirtyRect(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
+{
+    if(Xstart > Xend || Ystart > Yend || Xstart >= Surface->WidthMemory || Ystart >= Surface->HeightMemory)
+        return;
+    if(Xend >= Surface->WidthMemory)
+        Xend = Surface->WidthMemory - 1;
+    if(Yend >= Surface->HeightMemory)
+        Yend = Surface->HeightMemory - 1;
+    Surface_Touch(Surface, Xstart, Ystart, Xend, Yend);
+}
+
+void Surface_MarkDirty(PAINT *Surface, UWORD Ystart, UWORD Yend)
+{
+    Surface_MarkDirtyRect(Surface, 0, Ystart, Surface->WidthMemory - 1, Yend);
+}
+
+/******************************************************************************
+function: Area changed since the last Surface_ClearDirty()
+parameter:
+    Xstart, Ystart : First dirty memory column and row
+    Xend, Yend     : Last dirty memory column and row
+return:
+    1 if anything changed, 0 if the surface is clean
+******************************************************************************/
+UBYTE Surface_GetDirtyRect(PAINT *Surface, UWORD *Xstart, UWORD *Ystart, UWORD *Xend, UWORD *Yend)
+{
+    if(Surface->Dirty_Ys > Surface->Dirty_Ye)
+        return 0;
+    *Xstart = Surface->Dirty_Xs;
+    *Ystart = Surface->Dirty_Ys;
+    *Xend = Surface->Dirty_Xe;
+    *Yend = Surface->Dirty_Ye;
+    return 1;
+}
+
+UBYTE Surface_GetDirty(PAINT *Surface, UWORD *Ystart, UWORD *Yend)
+{
+    UWORD Xstart, Xend;
+    return Surface_GetDirtyRect(Surface, &Xstart, Ystart, &Xend, Yend);
+}
+
+void Surface_ClearDirty(PAINT *Surface)
+{
+    Surface->Dirty_Xs = 0xFFFF;
+    Surface->Dirty_Ys = 0xFFFF;
+    Surface->Dirty_Xe = 0;
+    Surface->Dirty_Ye = 0;
+}
+
+static void Surface_ClearContent(PAINT *Surface)
+{
+    Surface->Content_Xs = 0xFFFF;
+    Surface->Content_Ys = 0xFFFF;
+    Surface->Content_Xe = 0;
+    Surface->Content_Ye = 0;
+}
 
 /******************************************************************************
 function: Create Image
@@ -16,30 +112,37 @@ parameter:
     Height  :   The height of the picture
     Color   :   Whether the picture is inverted
 ******************************************************************************/
-void Paint_NewImage(UBYTE *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD Color)
+void Surface_NewImage(PAINT *Surface, UBYTE *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD Color)
 {
-    Paint.Image = NULL;
-    Paint.Image = image;
+    Surface->Image = NULL;
+    Surface->Image = image;
 
-    Paint.WidthMemory = Width;
-    Paint.HeightMemory = Height;
-    Paint.Color = Color;    
-	Paint.Scale = 2;
+    Surface->WidthMemory = Width;
+    Surface->HeightMemory = Height;
+    Surface->Color = Color;    
+	Surface->Scale = 2;
 		
-    Paint.WidthByte = (Width % 8 == 0)? (Width / 8 ): (Width / 8 + 1);
-    Paint.HeightByte = Height;    
-//    printf("WidthByte = %d, HeightByte = %d\r\n", Paint.WidthByte, Paint.HeightByte);
+    Surface->WidthByte = (Width % 8 == 0)? (Width / 8 ): (Width / 8 + 1);
+    Surface->HeightByte = Height;    
+//    printf("WidthByte = %d, HeightByte = %d\r\n", Surface->WidthByte, Surface->HeightByte);
 //    printf(" EPD_WIDTH / 8 = %d\r\n",  122 / 8);
    
-    Paint.Rotate = Rotate;
-    Paint.Mirror = MIRROR_NONE;
+    Surface->Rotate = Rotate;
+    Surface->Mirror = MIRROR_NONE;
+    Surface->List = NULL;
+
+    // Contents of a new image cache are unknown
+    Surface->Clear_Color = Color;
+    Surface_ClearDirty(Surface);
+    Surface_ClearContent(Surface);
+    Surface_MarkDirty(Surface, 0, Height - 1);
     
     if(Rotate == ROTATE_0 || Rotate == ROTATE_180) {
-        Paint.Width = Width;
-        Paint.Height = Height;
+        Surface->Width = Width;
+        Surface->Height = Height;
     } else {
-        Paint.Width = Height;
-        Paint.Height = Width;
+        Surface->Width = Height;
+        Surface->Height = Width;
     }
 }
 
@@ -48,9 +151,10 @@ function: Select Image
 parameter:
     image : Pointer to the image cache
 ******************************************************************************/
-void Paint_SelectImage(UBYTE *image)
+void Surface_SelectImage(PAINT *Surface, UBYTE *image)
 {
-    Paint.Image = image;
+    Surface->Image = image;
+    Surface_MarkDirty(Surface, 0, Surface->HeightMemory - 1);
 }
 
 /******************************************************************************
@@ -58,30 +162,30 @@ function: Select Image Rotate
 parameter:
     Rotate : 0,90,180,270
 ******************************************************************************/
-void Paint_SetRotate(UWORD Rotate)
+void Surface_SetRotate(PAINT *Surface, UWORD Rotate)
 {
     if(Rotate == ROTATE_0 || Rotate == ROTATE_90 || Rotate == ROTATE_180 || Rotate == ROTATE_270) {
         Debug("Set image Rotate %d\r\n", Rotate);
-        Paint.Rotate = Rotate;
+        Surface->Rotate = Rotate;
     } else {
         Debug("rotate = 0, 90, 180, 270\r\n");
     }
 }
 
-void Paint_SetScale(UBYTE scale)
+void Surface_SetScale(PAINT *Surface, UBYTE scale)
 {
     if(scale == 2){
-        Paint.Scale = scale;
-        Paint.WidthByte = (Paint.WidthMemory % 8 == 0)? (Paint.WidthMemory / 8 ): (Paint.WidthMemory / 8 + 1);
+        Surface->Scale = scale;
+        Surface->WidthByte = (Surface->WidthMemory % 8 == 0)? (Surface->WidthMemory / 8 ): (Surface->WidthMemory / 8 + 1);
     }else if(scale == 4){
-        Paint.Scale = scale;
-        Paint.WidthByte = (Paint.WidthMemory % 4 == 0)? (Paint.WidthMemory / 4 ): (Paint.WidthMemory / 4 + 1);
+        Surface->Scale = scale;
+        Surface->WidthByte = (Surface->WidthMemory % 4 == 0)? (Surface->WidthMemory / 4 ): (Surface->WidthMemory / 4 + 1);
     }else if(scale ==16) {
-        Paint.Scale = scale;
-        Paint.WidthByte = (Paint.WidthMemory%2==0) ? (Paint.WidthMemory/2) : (Paint.WidthMemory/2+1); 
+        Surface->Scale = scale;
+        Surface->WidthByte = (Surface->WidthMemory%2==0) ? (Surface->WidthMemory/2) : (Surface->WidthMemory/2+1); 
     }else if(scale ==65) {
-        Paint.Scale = scale;
-        Paint.WidthByte = Paint.WidthMemory*2; 
+        Surface->Scale = scale;
+        Surface->WidthByte = Surface->WidthMemory*2; 
     }else{
         Debug("Set Scale Input parameter error\r\n");
         Debug("Scale Only support: 2 4 16 65\r\n");
@@ -92,12 +196,12 @@ function:	Select Image mirror
 parameter:
     mirror   :Not mirror,Horizontal mirror,Vertical mirror,Origin mirror
 ******************************************************************************/
-void Paint_SetMirroring(UBYTE mirror)
+void Surface_SetMirroring(PAINT *Surface, UBYTE mirror)
 {
     if(mirror == MIRROR_NONE || mirror == MIRROR_HORIZONTAL || 
         mirror == MIRROR_VERTICAL || mirror == MIRROR_ORIGIN) {
         Debug("mirror image x:%s, y:%s\r\n",(mirror & 0x01)? "mirror":"none", ((mirror >> 1) & 0x01)? "mirror":"none");
-        Paint.Mirror = mirror;
+        Surface->Mirror = mirror;
     } else {
         Debug("mirror should be MIRROR_NONE, MIRROR_HORIZONTAL, \
         MIRROR_VERTICAL or MIRROR_ORIGIN\r\n");
@@ -111,81 +215,87 @@ parameter:
     Ypoint : At point Y
     Color  : Painted colors
 ******************************************************************************/
-void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
+void DEV_RAM_FUNC(Surface_SetPixel)(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, UWORD Color)
 {
-    if(Xpoint > Paint.Width || Ypoint > Paint.Height){
+    if(Xpoint >= Surface->Width || Ypoint >= Surface->Height){
         Debug("Exceeding display boundaries\r\n");
         return;
     }      
+    if(Surface->List != NULL) {
+        Paint_ListSpan(Surface->List, Xpoint, Ypoint, 1, Color);
+        return;
+    }
     UWORD X, Y;
 
-    switch(Paint.Rotate) {
+    switch(Surface->Rotate) {
     case 0:
         X = Xpoint;
         Y = Ypoint;  
         break;
     case 90:
-        X = Paint.WidthMemory - Ypoint - 1;
+        X = Surface->WidthMemory - Ypoint - 1;
         Y = Xpoint;
         break;
     case 180:
-        X = Paint.WidthMemory - Xpoint - 1;
-        Y = Paint.HeightMemory - Ypoint - 1;
+        X = Surface->WidthMemory - Xpoint - 1;
+        Y = Surface->HeightMemory - Ypoint - 1;
         break;
     case 270:
         X = Ypoint;
-        Y = Paint.HeightMemory - Xpoint - 1;
+        Y = Surface->HeightMemory - Xpoint - 1;
         break;
     default:
         return;
     }
     
-    switch(Paint.Mirror) {
+    switch(Surface->Mirror) {
     case MIRROR_NONE:
         break;
     case MIRROR_HORIZONTAL:
-        X = Paint.WidthMemory - X - 1;
+        X = Surface->WidthMemory - X - 1;
         break;
     case MIRROR_VERTICAL:
-        Y = Paint.HeightMemory - Y - 1;
+        Y = Surface->HeightMemory - Y - 1;
         break;
     case MIRROR_ORIGIN:
-        X = Paint.WidthMemory - X - 1;
-        Y = Paint.HeightMemory - Y - 1;
+        X = Surface->WidthMemory - X - 1;
+        Y = Surface->HeightMemory - Y - 1;
         break;
     default:
         return;
     }
 
-    if(X > Paint.WidthMemory || Y > Paint.HeightMemory){
+    if(X >= Surface->WidthMemory || Y >= Surface->HeightMemory){
         Debug("Exceeding display boundaries\r\n");
         return;
     }
+    PAINT_COUNT_PIXELS(1);
+    Surface_Touch(Surface, X, Y, X, Y);
     
-    if(Paint.Scale == 2){
-        UDOUBLE Addr = X / 8 + Y * Paint.WidthByte;
-        UBYTE Rdata = Paint.Image[Addr];
+    if(Surface->Scale == 2){
+        UDOUBLE Addr = X / 8 + Y * Surface->WidthByte;
+        UBYTE Rdata = Surface->Image[Addr];
         if(Color&0xff == BLACK)
-            Paint.Image[Addr] = Rdata & ~(0x80 >> (X % 8));
+            Surface->Image[Addr] = Rdata & ~(0x80 >> (X % 8));
         else
-            Paint.Image[Addr] = Rdata | (0x80 >> (X % 8));
-    }else if(Paint.Scale == 4){
-        UDOUBLE Addr = X / 4 + Y * Paint.WidthByte;
+            Surface->Image[Addr] = Rdata | (0x80 >> (X % 8));
+    }else if(Surface->Scale == 4){
+        UDOUBLE Addr = X / 4 + Y * Surface->WidthByte;
         Color = Color % 4;//Guaranteed color scale is 4  --- 0~3
-        UBYTE Rdata = Paint.Image[Addr];
+        UBYTE Rdata = Surface->Image[Addr];
         
         Rdata = Rdata & (~(0xC0 >> ((X % 4)*2)));
-        Paint.Image[Addr] = Rdata | ((Color << 6) >> ((X % 4)*2));
-    }else if(Paint.Scale == 16) {
-        UDOUBLE Addr = X / 2 + Y * Paint.WidthByte;
-        UBYTE Rdata = Paint.Image[Addr];
+        Surface->Image[Addr] = Rdata | ((Color << 6) >> ((X % 4)*2));
+    }else if(Surface->Scale == 16) {
+        UDOUBLE Addr = X / 2 + Y * Surface->WidthByte;
+        UBYTE Rdata = Surface->Image[Addr];
         Color = Color % 16;
         Rdata = Rdata & (~(0xf0 >> ((X % 2)*4)));
-        Paint.Image[Addr] = Rdata | ((Color << 4) >> ((X % 2)*4));
-    }else if(Paint.Scale == 65) {
-        UDOUBLE Addr = X*2 + Y*Paint.WidthByte;
-        Paint.Image[Addr] = 0xff & (Color>>8);
-        Paint.Image[Addr+1] = 0xff & Color;
+        Surface->Image[Addr] = Rdata | ((Color << 4) >> ((X % 2)*4));
+    }else if(Surface->Scale == 65) {
+        UDOUBLE Addr = X*2 + Y*Surface->WidthByte;
+        Surface->Image[Addr] = 0xff & (Color>>8);
+        Surface->Image[Addr+1] = 0xff & Color;
     }
 
 }
@@ -195,29 +305,42 @@ function: Clear the color of the picture
 parameter:
     Color : Painted colors
 ******************************************************************************/
-void Paint_Clear(UWORD Color)
+void Surface_Clear(PAINT *Surface, UWORD Color)
 {
-    if(Paint.Scale == 2 || Paint.Scale == 4) {
-        for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
-            for (UWORD X = 0; X < Paint.WidthByte; X++ ) {//8 pixel =  1 byte
-                UDOUBLE Addr = X + Y*Paint.WidthByte;
-                Paint.Image[Addr] = Color;
+    if(Surface->List != NULL) {
+        Paint_ListClear(Surface->List, Color);
+        return;
+    }
+    PAINT_COUNT_PIXELS(Surface->WidthMemory * Surface->HeightMemory);
+    if(Color != Surface->Clear_Color) {
+        Surface_MarkDirty(Surface, 0, Surface->HeightMemory - 1);
+        Surface->Clear_Color = Color;
+    } else if(Surface->Content_Ys <= Surface->Content_Ye) {
+        Surface_MarkDirtyRect(Surface, Surface->Content_Xs, Surface->Content_Ys,
+                              Surface->Content_Xe, Surface->Content_Ye);
+    }
+    Surface_ClearContent(Surface);
+    if(Surface->Scale == 2 || Surface->Scale == 4) {
+        for (UWORD Y = 0; Y < Surface->HeightByte; Y++) {
+            for (UWORD X = 0; X < Surface->WidthByte; X++ ) {//8 pixel =  1 byte
+                UDOUBLE Addr = X + Y*Surface->WidthByte;
+                Surface->Image[Addr] = Color;
             }
         }
-    }else if(Paint.Scale == 16) {
-        for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
-            for (UWORD X = 0; X < Paint.WidthByte; X++ ) {//8 pixel =  1 byte
-                UDOUBLE Addr = X + Y*Paint.WidthByte;
+    }else if(Surface->Scale == 16) {
+        for (UWORD Y = 0; Y < Surface->HeightByte; Y++) {
+            for (UWORD X = 0; X < Surface->WidthByte; X++ ) {//8 pixel =  1 byte
+                UDOUBLE Addr = X + Y*Surface->WidthByte;
                 Color = Color & 0x0f;
-                Paint.Image[Addr] = (Color<<4) | Color;
+                Surface->Image[Addr] = (Color<<4) | Color;
             }
         }
-    }else if(Paint.Scale == 65) {
-        for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
-            for (UWORD X = 0; X < Paint.WidthByte; X++ ) {//8 pixel =  1 byte
-                UDOUBLE Addr = X*2 + Y*Paint.WidthByte;
-                Paint.Image[Addr] = 0xff & (Color>>8);
-                Paint.Image[Addr+1] = 0xff & Color;
+    }else if(Surface->Scale == 65) {
+        for (UWORD Y = 0; Y < Surface->HeightByte; Y++) {
+            for (UWORD X = 0; X < Surface->WidthMemory; X++ ) {//1 pixel = 2 bytes
+                UDOUBLE Addr = X*2 + Y*Surface->WidthByte;
+                Surface->Image[Addr] = 0xff & (Color>>8);
+                Surface->Image[Addr+1] = 0xff & Color;
             }
         }
     }
@@ -232,12 +355,12 @@ parameter:
     Yend   : y end point
     Color  : Painted colors
 ******************************************************************************/
-void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
+void Surface_ClearWindows(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
 {
     UWORD X, Y;
     for (Y = Ystart; Y < Yend; Y++) {
         for (X = Xstart; X < Xend; X++) {//8 pixel =  1 byte
-            Paint_SetPixel(X, Y, Color);
+            Surface_SetPixel(Surface, X, Y, Color);
         }
     }
 }
@@ -251,13 +374,12 @@ parameter:
     Dot_Pixel	: point size
     Dot_Style	: point Style
 ******************************************************************************/
-void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color,
+void DEV_RAM_FUNC(Surface_DrawPoint)(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, UWORD Color,
                      DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_Style)
 {
-    if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
-        Debug("Paint_DrawPoint Input exceeds the normal display range\r\n");
-        printf("Xpoint = %d , Paint.Width = %d  \r\n ",Xpoint,Paint.Width);
-        printf("Ypoint = %d , Paint.Height = %d  \r\n ",Ypoint,Paint.Height);
+    if (Xpoint > Surface->Width || Ypoint > Surface->Height) {
+        Debug("Paint_DrawPoint out of range: x=%d w=%d y=%d h=%d\r\n",
+              Xpoint, Surface->Width, Ypoint, Surface->Height);
         return;
     }
 
@@ -268,13 +390,13 @@ void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color,
                 if(Xpoint + XDir_Num - Dot_Pixel < 0 || Ypoint + YDir_Num - Dot_Pixel < 0)
                     break;
                 // printf("x = %d, y = %d\r\n", Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel);
-                Paint_SetPixel(Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel, Color);
+                Surface_SetPixel(Surface, Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel, Color);
             }
         }
     } else {
         for (XDir_Num = 0; XDir_Num <  Dot_Pixel; XDir_Num++) {
             for (YDir_Num = 0; YDir_Num <  Dot_Pixel; YDir_Num++) {
-                Paint_SetPixel(Xpoint + XDir_Num - 1, Ypoint + YDir_Num - 1, Color);
+                Surface_SetPixel(Surface, Xpoint + XDir_Num - 1, Ypoint + YDir_Num - 1, Color);
             }
         }
     }
@@ -291,14 +413,18 @@ parameter:
     Line_width : Line width
     Line_Style: Solid and dotted lines
 ******************************************************************************/
-void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
+void DEV_RAM_FUNC(Surface_DrawLine)(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
                     UWORD Color, DOT_PIXEL Line_width, LINE_STYLE Line_Style)
 {
-    if (Xstart > Paint.Width || Ystart > Paint.Height ||
-        Xend > Paint.Width || Yend > Paint.Height) {
+    if (Xstart > Surface->Width || Ystart > Surface->Height ||
+        Xend > Surface->Width || Yend > Surface->Height) {
         Debug("Paint_DrawLine Input exceeds the normal display range\r\n");
         return;
     }
+    if (Surface->List != NULL && Line_width == DOT_PIXEL_1X1) {
+        Paint_ListLine(Surface->List, Xstart, Ystart, Xend, Yend, Color, Line_Style);
+        return;
+    }
 
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
@@ -319,12 +445,12 @@ void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
         if (Line_Style == LINE_STYLE_DOTTED && Dotted_Len % 3 == 0) {
             //Debug("LINE_DOTTED\r\n");
 						if(Color)
-							Paint_DrawPoint(Xpoint, Ypoint, BLACK, Line_width, DOT_STYLE_DFT);
+							Surface_DrawPoint(Surface, Xpoint, Ypoint, BLACK, Line_width, DOT_STYLE_DFT);
             else
-							Paint_DrawPoint(Xpoint, Ypoint, WHITE, Line_width, DOT_STYLE_DFT);
+							Surface_DrawPoint(Surface, Xpoint, Ypoint, WHITE, Line_width, DOT_STYLE_DFT);
             Dotted_Len = 0;
         } else {
-            Paint_DrawPoint(Xpoint, Ypoint, Color, Line_width, DOT_STYLE_DFT);
+            Surface_DrawPoint(Surface, Xpoint, Ypoint, Color, Line_width, DOT_STYLE_DFT);
         }
         if (2 * Esp >= dy) {
             if (Xpoint == Xend)
@@ -352,11 +478,11 @@ parameter:
     Line_width: Line width
     Draw_Fill : Whether to fill the inside of the rectangle
 ******************************************************************************/
-void Paint_DrawRectangle(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
+void Surface_DrawRectangle(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
                          UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill)
 {
-    if (Xstart > Paint.Width || Ystart > Paint.Height ||
-        Xend > Paint.Width || Yend > Paint.Height) {
+    if (Xstart > Surface->Width || Ystart > Surface->Height ||
+        Xend > Surface->Width || Yend > Surface->Height) {
         Debug("Input exceeds the normal display range\r\n");
         return;
     }
@@ -364,13 +490,13 @@ void Paint_DrawRectangle(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
     if (Draw_Fill) {
         UWORD Ypoint;
         for(Ypoint = Ystart; Ypoint < Yend; Ypoint++) {
-            Paint_DrawLine(Xstart, Ypoint, Xend, Ypoint, Color , Line_width, LINE_STYLE_SOLID);
+            Surface_DrawLine(Surface, Xstart, Ypoint, Xend, Ypoint, Color , Line_width, LINE_STYLE_SOLID);
         }
     } else {
-        Paint_DrawLine(Xstart, Ystart, Xend, Ystart, Color, Line_width, LINE_STYLE_SOLID);
-        Paint_DrawLine(Xstart, Ystart, Xstart, Yend, Color, Line_width, LINE_STYLE_SOLID);
-        Paint_DrawLine(Xend, Yend, Xend, Ystart, Color, Line_width, LINE_STYLE_SOLID);
-        Paint_DrawLine(Xend, Yend, Xstart, Yend, Color, Line_width, LINE_STYLE_SOLID);
+        Surface_DrawLine(Surface, Xstart, Ystart, Xend, Ystart, Color, Line_width, LINE_STYLE_SOLID);
+        Surface_DrawLine(Surface, Xstart, Ystart, Xstart, Yend, Color, Line_width, LINE_STYLE_SOLID);
+        Surface_DrawLine(Surface, Xend, Yend, Xend, Ystart, Color, Line_width, LINE_STYLE_SOLID);
+        Surface_DrawLine(Surface, Xend, Yend, Xstart, Yend, Color, Line_width, LINE_STYLE_SOLID);
     }
 }
 
@@ -385,10 +511,10 @@ parameter:
     Line_width: Line width
     Draw_Fill : Whether to fill the inside of the Circle
 ******************************************************************************/
-void Paint_DrawCircle(UWORD X_Center, UWORD Y_Center, UWORD Radius,
+void Surface_DrawCircle(PAINT *Surface, UWORD X_Center, UWORD Y_Center, UWORD Radius,
                       UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill)
 {
-    if (X_Center > Paint.Width || Y_Center >= Paint.Height) {
+    if (X_Center > Surface->Width || Y_Center >= Surface->Height) {
         Debug("Paint_DrawCircle Input exceeds the normal display range\r\n");
         return;
     }
@@ -405,14 +531,14 @@ void Paint_DrawCircle(UWORD X_Center, UWORD Y_Center, UWORD Radius,
     if (Draw_Fill == DRAW_FILL_FULL) {
         while (XCurrent <= YCurrent ) { //Realistic circles
             for (sCountY = XCurrent; sCountY <= YCurrent; sCountY ++ ) {
-                Paint_DrawPoint(X_Center + XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//1
-                Paint_DrawPoint(X_Center - XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//2
-                Paint_DrawPoint(X_Center - sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//3
-                Paint_DrawPoint(X_Center - sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//4
-                Paint_DrawPoint(X_Center - XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//5
-                Paint_DrawPoint(X_Center + XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//6
-                Paint_DrawPoint(X_Center + sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//7
-                Paint_DrawPoint(X_Center + sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);
+                Surface_DrawPoint(Surface, X_Center + XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//1
+                Surface_DrawPoint(Surface, X_Center - XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//2
+                Surface_DrawPoint(Surface, X_Center - sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//3
+                Surface_DrawPoint(Surface, X_Center - sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//4
+                Surface_DrawPoint(Surface, X_Center - XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//5
+                Surface_DrawPoint(Surface, X_Center + XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//6
+                Surface_DrawPoint(Surface, X_Center + sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);//7
+                Surface_DrawPoint(Surface, X_Center + sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT);
             }
             if (Esp < 0 )
                 Esp += 4 * XCurrent + 6;
@@ -424,14 +550,14 @@ void Paint_DrawCircle(UWORD X_Center, UWORD Y_Center, UWORD Radius,
         }
     } else { //Draw a hollow circle
         while (XCurrent <= YCurrent ) {
-            Paint_DrawPoint(X_Center + XCurrent, Y_Center + YCurrent, Color, Line_width, DOT_STYLE_DFT);//1
-            Paint_DrawPoint(X_Center - XCurrent, Y_Center + YCurrent, Color, Line_width, DOT_STYLE_DFT);//2
-            Paint_DrawPoint(X_Center - YCurrent, Y_Center + XCurrent, Color, Line_width, DOT_STYLE_DFT);//3
-            Paint_DrawPoint(X_Center - YCurrent, Y_Center - XCurrent, Color, Line_width, DOT_STYLE_DFT);//4
-            Paint_DrawPoint(X_Center - XCurrent, Y_Center - YCurrent, Color, Line_width, DOT_STYLE_DFT);//5
-            Paint_DrawPoint(X_Center + XCurrent, Y_Center - YCurrent, Color, Line_width, DOT_STYLE_DFT);//6
-            Paint_DrawPoint(X_Center + YCurrent, Y_Center - XCurrent, Color, Line_width, DOT_STYLE_DFT);//7
-            Paint_DrawPoint(X_Center + YCurrent, Y_Center + XCurrent, Color, Line_width, DOT_STYLE_DFT);//0
+            Surface_DrawPoint(Surface, X_Center + XCurrent, Y_Center + YCurrent, Color, Line_width, DOT_STYLE_DFT);//1
+            Surface_DrawPoint(Surface, X_Center - XCurrent, Y_Center + YCurrent, Color, Line_width, DOT_STYLE_DFT);//2
+            Surface_DrawPoint(Surface, X_Center - YCurrent, Y_Center + XCurrent, Color, Line_width, DOT_STYLE_DFT);//3
+            Surface_DrawPoint(Surface, X_Center - YCurrent, Y_Center - XCurrent, Color, Line_width, DOT_STYLE_DFT);//4
+            Surface_DrawPoint(Surface, X_Center - XCurrent, Y_Center - YCurrent, Color, Line_width, DOT_STYLE_DFT);//5
+            Surface_DrawPoint(Surface, X_Center + XCurrent, Y_Center - YCurrent, Color, Line_width, DOT_STYLE_DFT);//6
+            Surface_DrawPoint(Surface, X_Center + YCurrent, Y_Center - XCurrent, Color, Line_width, DOT_STYLE_DFT);//7
+            Surface_DrawPoint(Surface, X_Center + YCurrent, Y_Center + XCurrent, Color, Line_width, DOT_STYLE_DFT);//0
 
             if (Esp < 0 )
                 Esp += 4 * XCurrent + 6;
@@ -454,15 +580,19 @@ parameter:
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
 ******************************************************************************/
-void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
+void Surface_DrawChar(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
                     sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
 {
     UWORD Page, Column;
 
-    if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
+    if (Xpoint > Surface->Width || Ypoint > Surface->Height) {
         Debug("Paint_DrawChar Input exceeds the normal display range\r\n");
         return;
     }
+    if (Surface->List != NULL) {
+        Paint_ListChar(Surface->List, Xpoint, Ypoint, Acsii_Char, Font, Color_Foreground, Color_Background);
+        return;
+    }
 
     uint32_t Char_Offset = (Acsii_Char - ' ') * Font->Height * (Font->Width / 8 + (Font->Width % 8 ? 1 : 0));
     const unsigned char *ptr = &Font->table[Char_Offset];
@@ -473,15 +603,15 @@ void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
             //To determine whether the font background color and screen background color is consistent
             if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
                 if (*ptr & (0x80 >> (Column % 8)))
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
-                    // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
+                    Surface_SetPixel(Surface, Xpoint + Column, Ypoint + Page, Color_Foreground);
+                    // Surface_DrawPoint(Surface, Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
             } else {
                 if (*ptr & (0x80 >> (Column % 8))) {
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
-                    // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
+                    Surface_SetPixel(Surface, Xpoint + Column, Ypoint + Page, Color_Foreground);
+                    // Surface_DrawPoint(Surface, Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
                 } else {
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Background);
-                    // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
+                    Surface_SetPixel(Surface, Xpoint + Column, Ypoint + Page, Color_Background);
+                    // Surface_DrawPoint(Surface, Xpoint + Column, Ypoint + Page, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
                 }
             }
             //One pixel is 8 bits
@@ -503,30 +633,30 @@ parameter:
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
 ******************************************************************************/
-void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
+void Surface_DrawString_EN(PAINT *Surface, UWORD Xstart, UWORD Ystart, const char * pString,
                          sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
 {
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
 
-    if (Xstart > Paint.Width || Ystart > Paint.Height) {
+    if (Xstart > Surface->Width || Ystart > Surface->Height) {
         Debug("Paint_DrawString_EN Input exceeds the normal display range\r\n");
         return;
     }
 
     while (* pString != '\0') {
         //if X direction filled , reposition to(Xstart,Ypoint),Ypoint is Y direction plus the Height of the character
-        if ((Xpoint + Font->Width ) > Paint.Width ) {
+        if ((Xpoint + Font->Width ) > Surface->Width ) {
             Xpoint = Xstart;
             Ypoint += Font->Height;
         }
 
         // If the Y direction is full, reposition to(Xstart, Ystart)
-        if ((Ypoint  + Font->Height ) > Paint.Height ) {
+        if ((Ypoint  + Font->Height ) > Surface->Height ) {
             Xpoint = Xstart;
             Ypoint = Ystart;
         }
-        Paint_DrawChar(Xpoint, Ypoint, * pString, Font, Color_Background, Color_Foreground);
+        Surface_DrawChar(Surface, Xpoint, Ypoint, * pString, Font, Color_Background, Color_Foreground);
 
         //The next character of the address
         pString ++;
@@ -537,6 +667,77 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
 }
 
 
+/******************************************************************************
+function: Find the glyph of the character at p_text
+parameter:
+    font   ：GB2312 font
+    p_text ：One ASCII byte or the two bytes of a GB2312 character
+return:
+    The table entry, or NULL if the font does not have the character
+info:
+    Fonts with a generated index (cn_index.py) are binary searched,
+    other tables are scanned.
+******************************************************************************/
+static const CH_CN *Paint_FindGlyph_CN(const cFONT *font, const char *p_text)
+{
+    UBYTE First = (UBYTE)p_text[0];
+    UWORD Code = First <= 0x7F ? First << 8 : (First << 8) | (UBYTE)p_text[1];
+
+    if (font->Index != NULL) {
+        const CN_INDEX_ENTRY *Entries = font->Index->Entries;
+        int Low = 0, High = font->Index->Size - 1;
+        while (Low <= High) {
+            int Mid = (Low + High) / 2;
+            if (Entries[Mid].Code == Code)
+                return &font->table[Entries[Mid].Glyph];
+            if (Entries[Mid].Code < Code)
+                Low = Mid + 1;
+            else
+                High = Mid - 1;
+        }
+        return NULL;
+    }
+
+    for (int Num = 0; Num < font->size; Num++) {
+        const char *index = font->table[Num].index;
+        if ((UBYTE)index[0] == First && (First <= 0x7F || index[1] == p_text[1]))
+            return &font->table[Num];
+    }
+    return NULL;
+}
+
+/******************************************************************************
+function: Draw one glyph of a GB2312 font
+******************************************************************************/
+static void Surface_DrawGlyph_CN(PAINT *Surface, int x, int y, const CH_CN *Glyph, UWORD Width, const cFONT *font,
+                               UWORD Color_Foreground, UWORD Color_Background)
+{
+    const char* ptr = &Glyph->matrix[0];
+    int i, j;
+
+    for (j = 0; j < font->Height; j++) {
+        for (i = 0; i < Width; i++) {
+            if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
+                if (*ptr & (0x80 >> (i % 8))) {
+                    Surface_SetPixel(Surface, x + i, y + j, Color_Foreground);
+                }
+            } else {
+                if (*ptr & (0x80 >> (i % 8))) {
+                    Surface_SetPixel(Surface, x + i, y + j, Color_Foreground);
+                } else {
+                    Surface_SetPixel(Surface, x + i, y + j, Color_Background);
+                }
+            }
+            if (i % 8 == 7) {
+                ptr++;
+            }
+        }
+        if (Width % 8 != 0) {
+            ptr++;
+        }
+    }
+}
+
 /******************************************************************************
 function: Display the string
 parameter:
@@ -547,90 +748,70 @@ parameter:
     Font    ：A structure pointer that displays a character size
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
+info:
+    ASCII glyphs are drawn font->Width wide but advance by font->ASCII_Width,
+    characters missing from the font leave a gap of the same size.
 ******************************************************************************/
-void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT* font,
+void Surface_DrawString_CN(PAINT *Surface, UWORD Xstart, UWORD Ystart, const char * pString, cFONT* font,
                         UWORD Color_Foreground, UWORD Color_Background)
 {
     const char* p_text = pString;
     int x = Xstart, y = Ystart;
-    int i, j,Num;
 
     /* Send the string character by character on EPD */
     while (*p_text != 0) {
-        if(*p_text <= 0x7F) {  //ASCII < 126
-            for(Num = 0; Num < font->size; Num++) {
-                if(*p_text== font->table[Num].index[0]) {
-                    const char* ptr = &font->table[Num].matrix[0];
-
-                    for (j = 0; j < font->Height; j++) {
-                        for (i = 0; i < font->Width; i++) {
-                            if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
-                                if (*ptr & (0x80 >> (i % 8))) {
-                                    Paint_SetPixel(x + i, y + j, Color_Foreground);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                }
-                            } else {
-                                if (*ptr & (0x80 >> (i % 8))) {
-                                    Paint_SetPixel(x + i, y + j, Color_Foreground);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                } else {
-                                    Paint_SetPixel(x + i, y + j, Color_Background);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                }
-                            }
-                            if (i % 8 == 7) {
-                                ptr++;
-                            }
-                        }
-                        if (font->Width % 8 != 0) {
-                            ptr++;
-                        }
-                    }
-                    break;
-                }
-            }
-            /* Point on the next character */
-            p_text += 1;
-            /* Decrement the column position by 16 */
-            x += font->ASCII_Width;
-        } else {        //Chinese
-            for(Num = 0; Num < font->size; Num++) {
-                if((*p_text== font->table[Num].index[0]) && (*(p_text+1) == font->table[Num].index[1])) {
-                    const char* ptr = &font->table[Num].matrix[0];
-
-                    for (j = 0; j < font->Height; j++) {
-                        for (i = 0; i < font->Width; i++) {
-                            if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
-                                if (*ptr & (0x80 >> (i % 8))) {
-                                    Paint_SetPixel(x + i, y + j, Color_Foreground);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                }
-                            } else {
-                                if (*ptr & (0x80 >> (i % 8))) {
-                                    Paint_SetPixel(x + i, y + j, Color_Foreground);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                } else {
-                                    Paint_SetPixel(x + i, y + j, Color_Background);
-                                    // Paint_DrawPoint(x + i, y + j, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                                }
-                            }
-                            if (i % 8 == 7) {
-                                ptr++;
-                            }
-                        }
-                        if (font->Width % 8 != 0) {
-                            ptr++;
-                        }
-                    }
-                    break;
-                }
-            }
-            /* Point on the next character */
+        UBYTE Wide = (UBYTE)*p_text > 0x7F;   // GB2312 takes two bytes
+        if (Wide && p_text[1] == 0)
+            break;
+        const CH_CN *Glyph = Paint_FindGlyph_CN(font, p_text);
+        if (Glyph != NULL)
+            Surface_DrawGlyph_CN(Surface, x, y, Glyph, font->Width, font, Color_Foreground, Color_Background);
+
+        /* Point on the next character */
+        p_text += Wide ? 2 : 1;
+        x += Wide ? font->Width : font->ASCII_Width;
+    }
+}
+
+/******************************************************************************
+function: Width of a string on one line, without the wrapping of
+          Paint_DrawString_EN
+parameter:
+    pString ：String to measure
+    Font    ：Font it is drawn with
+return:
+    Width in pixels, the height is Font->Height
+******************************************************************************/
+UWORD Paint_GetStringWidth_EN(const char * pString, sFONT* Font)
+{
+    return (UWORD)(strlen(pString) * Font->Width);
+}
+
+/******************************************************************************
+function: Width of a mixed ASCII / GB2312 string drawn by Paint_DrawString_CN
+parameter:
+    pString ：String to measure
+    font    ：Font it is drawn with
+return:
+    Width in pixels, the height is font->Height
+******************************************************************************/
+UWORD Paint_GetStringWidth_CN(const char * pString, cFONT* font)
+{
+    const char* p_text = pString;
+    UWORD Width = 0;
+
+    while (*p_text != 0) {
+        if ((UBYTE)*p_text > 0x7F) {
+            if (p_text[1] == 0)
+                break;
+            Width += font->Width;
             p_text += 2;
-            /* Decrement the column position by 16 */
-            x += font->Width;
+        } else {
+            Width += font->ASCII_Width;
+            p_text += 1;
         }
     }
+    return Width;
 }
 
 /******************************************************************************
@@ -645,7 +826,7 @@ parameter:
     Color_Background : Select the background color
 ******************************************************************************/
 #define  ARRAY_LEN 255
-void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber,
+void Surface_DrawNum(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, double Nummber,
                    sFONT* Font, UWORD Digit,UWORD Color_Foreground, UWORD Color_Background)
 {
     int16_t Num_Bit = 0, Str_Bit = 0;
@@ -654,7 +835,7 @@ void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber,
 	int temp = Nummber;
 	float decimals;
 	uint8_t i;
-    if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
+    if (Xpoint > Surface->Width || Ypoint > Surface->Height) {
         Debug("Paint_DisNum Input exceeds the normal display range\r\n");
         return;
     }
@@ -691,7 +872,7 @@ void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber,
     }
 
     //show
-    Paint_DrawString_EN(Xpoint, Ypoint, (const char*)pStr, Font, Color_Background, Color_Foreground);
+    Surface_DrawString_EN(Surface, Xpoint, Ypoint, (const char*)pStr, Font, Color_Background, Color_Foreground);
 }
 
 /******************************************************************************
@@ -704,7 +885,7 @@ parameter:
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
 ******************************************************************************/
-void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font,
+void Surface_DrawTime(PAINT *Surface, UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font,
                     UWORD Color_Foreground, UWORD Color_Background)
 {
     uint8_t value[10] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
@@ -712,25 +893,29 @@ void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font,
     UWORD Dx = Font->Width;
 
     //Write data into the cache
-    Paint_DrawChar(Xstart                           , Ystart, value[pTime->Hour / 10], Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx                      , Ystart, value[pTime->Hour % 10], Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx  + Dx / 4 + Dx / 2   , Ystart, ':'                    , Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx * 2 + Dx / 2         , Ystart, value[pTime->Min / 10] , Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx * 3 + Dx / 2         , Ystart, value[pTime->Min % 10] , Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx * 4 + Dx / 2 - Dx / 4, Ystart, ':'                    , Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx * 5                  , Ystart, value[pTime->Sec / 10] , Font, Color_Background, Color_Foreground);
-    Paint_DrawChar(Xstart + Dx * 6                  , Ystart, value[pTime->Sec % 10] , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart                           , Ystart, value[pTime->Hour / 10], Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx                      , Ystart, value[pTime->Hour % 10], Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx  + Dx / 4 + Dx / 2   , Ystart, ':'                    , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx * 2 + Dx / 2         , Ystart, value[pTime->Min / 10] , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx * 3 + Dx / 2         , Ystart, value[pTime->Min % 10] , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx * 4 + Dx / 2 - Dx / 4, Ystart, ':'                    , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx * 5                  , Ystart, value[pTime->Sec / 10] , Font, Color_Background, Color_Foreground);
+    Surface_DrawChar(Surface, Xstart + Dx * 6                  , Ystart, value[pTime->Sec % 10] , Font, Color_Background, Color_Foreground);
     
 }
 
 
-void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image) 
+void Surface_DrawImage(PAINT *Surface, const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image) 
 {
+    if (Surface->List != NULL) {
+        Paint_ListImage(Surface->List, image, xStart, yStart, W_Image, H_Image);
+        return;
+    }
     int i,j; 
 		for(j = 0; j < H_Image; j++){
 			for(i = 0; i < W_Image; i++){
-				if(xStart+i < Paint.WidthMemory  &&  yStart+j < Paint.HeightMemory)//Exceeded part does not display
-					Paint_SetPixel(xStart + i, yStart + j, (*(image + j*W_Image*2 + i*2+1))<<8 | (*(image + j*W_Image*2 + i*2)));
+				if(xStart+i < Surface->WidthMemory  &&  yStart+j < Surface->HeightMemory)//Exceeded part does not display
+					Surface_SetPixel(Surface, xStart + i, yStart + j, (*(image + j*W_Image*2 + i*2+1))<<8 | (*(image + j*W_Image*2 + i*2)));
 				//Using arrays is a property of sequential storage, accessing the original array by algorithm
 				//j*W_Image*2 			   Y offset
 				//i*2              	   X offset
@@ -738,13 +923,13 @@ void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWO
 		} 
 }
 
-void Paint_DrawImage1(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image) 
+void Surface_DrawImage1(PAINT *Surface, const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image) 
 {
     int i,j; 
 		for(j = 0; j < H_Image; j++){
 			for(i = 0; i < W_Image; i++){
-				if(xStart+i < Paint.HeightMemory  &&  yStart+j < Paint.WidthMemory)//Exceeded part does not display
-					Paint_SetPixel(xStart + i, yStart + j, (*(image + j*W_Image*2 + i*2+1))<<8 | (*(image + j*W_Image*2 + i*2)));
+				if(xStart+i < Surface->HeightMemory  &&  yStart+j < Surface->WidthMemory)//Exceeded part does not display
+					Surface_SetPixel(Surface, xStart + i, yStart + j, (*(image + j*W_Image*2 + i*2+1))<<8 | (*(image + j*W_Image*2 + i*2)));
 				//Using arrays is a property of sequential storage, accessing the original array by algorithm
 				//j*W_Image*2 			   Y offset
 				//i*2              	   X offset
@@ -760,45 +945,167 @@ info:
     Use a computer to convert the image into a corresponding array,
     and then embed the array directly into Imagedata.cpp as a .c file.
 ******************************************************************************/
-void Paint_DrawBitMap(const unsigned char* image_buffer)
+void Surface_DrawBitMap(PAINT *Surface, const unsigned char* image_buffer)
 {
     UWORD x, y;
     UDOUBLE Addr = 0;
 
-    for (y = 0; y < Paint.HeightByte; y++) {
-        for (x = 0; x < Paint.WidthByte; x++) {//8 pixel =  1 byte
-            Addr = x + y * Paint.WidthByte;
-            Paint.Image[Addr] = (unsigned char)image_buffer[Addr];
+    if (Surface->List != NULL) {
+        Paint_ListBitMap(Surface->List, image_buffer);
+        return;
+    }
+    Surface_MarkDirty(Surface, 0, Surface->HeightMemory - 1);
+    for (y = 0; y < Surface->HeightByte; y++) {
+        for (x = 0; x < Surface->WidthByte; x++) {//8 pixel =  1 byte
+            Addr = x + y * Surface->WidthByte;
+            Surface->Image[Addr] = (unsigned char)image_buffer[Addr];
         }
     }
 }
 
-void Paint_DrawBitMap_Block(const unsigned char* image_buffer, UBYTE Region)
+void Surface_DrawBitMap_Block(PAINT *Surface, const unsigned char* image_buffer, UBYTE Region)
 {
     UWORD x, y;
     UDOUBLE Addr = 0;
-		for (y = 0; y < Paint.HeightByte; y++) {
-				for (x = 0; x < Paint.WidthByte; x++) {//8 pixel =  1 byte
-						Addr = x + y * Paint.WidthByte ;
-						Paint.Image[Addr] = \
-						(unsigned char)image_buffer[Addr+ (Paint.HeightByte)*Paint.WidthByte*(Region - 1)];
+    if (Surface->List != NULL) {
+        Paint_ListBitMap(Surface->List, image_buffer + (Surface->HeightByte) * Surface->WidthByte * (Region - 1));
+        return;
+    }
+    Surface_MarkDirty(Surface, 0, Surface->HeightMemory - 1);
+		for (y = 0; y < Surface->HeightByte; y++) {
+				for (x = 0; x < Surface->WidthByte; x++) {//8 pixel =  1 byte
+						Addr = x + y * Surface->WidthByte ;
+						Surface->Image[Addr] = \
+						(unsigned char)image_buffer[Addr+ (Surface->HeightByte)*Surface->WidthByte*(Region - 1)];
 				}
 		}
 }
 
 
 
- void Paint_BmpWindows(unsigned char x,unsigned char y,const unsigned char *pBmp,
+void Surface_BmpWindows(PAINT *Surface, unsigned char x,unsigned char y,const unsigned char *pBmp,
 					unsigned char chWidth,unsigned char chHeight)
 {
 	uint16_t i, j, byteWidth = (chWidth + 7)/8;
     for(j = 0; j < chHeight; j ++){
         for(i = 0; i < chWidth; i ++ ) {
             if(*(pBmp + j * byteWidth + i / 8) & (128 >> (i & 7))) {
-                Paint_SetPixel(x+i, y+j, 0xffff);
+                Surface_SetPixel(Surface, x+i, y+j, 0xffff);
             }
         }
     }
 }
          
 
+/******************************************************************************
+function:	The Paint_* API, drawing on the default surface Paint
+******************************************************************************/
+void Paint_NewImage(UBYTE *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD Color)
+{
+    Surface_NewImage(&Paint, image, Width, Height, Rotate, Color);
+}
+
+void Paint_SelectImage(UBYTE *image)
+{
+    Surface_SelectImage(&Paint, image);
+}
+
+void Paint_SetRotate(UWORD Rotate)
+{
+    Surface_SetRotate(&Paint, Rotate);
+}
+
+void Paint_SetMirroring(UBYTE mirror)
+{
+    Surface_SetMirroring(&Paint, mirror);
+}
+
+void DEV_RAM_FUNC(Paint_SetPixel)(UWORD Xpoint, UWORD Ypoint, UWORD Color)
+{
+    Surface_SetPixel(&Paint, Xpoint, Ypoint, Color);
+}
+
+void Paint_SetScale(UBYTE scale)
+{
+    Surface_SetScale(&Paint, scale);
+}
+
+void Paint_Clear(UWORD Color)
+{
+    Surface_Clear(&Paint, Color);
+}
+
+void Paint_ClearWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
+{
+    Surface_ClearWindows(&Paint, Xstart, Ystart, Xend, Yend, Color);
+}
+
+void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color, DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_FillWay)
+{
+    Surface_DrawPoint(&Paint, Xpoint, Ypoint, Color, Dot_Pixel, Dot_FillWay);
+}
+
+void DEV_RAM_FUNC(Paint_DrawLine)(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, DOT_PIXEL Line_width, LINE_STYLE Line_Style)
+{
+    Surface_DrawLine(&Paint, Xstart, Ystart, Xend, Yend, Color, Line_width, Line_Style);
+}
+
+void Paint_DrawRectangle(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill)
+{
+    Surface_DrawRectangle(&Paint, Xstart, Ystart, Xend, Yend, Color, Line_width, Draw_Fill);
+}
+
+void Paint_DrawCircle(UWORD X_Center, UWORD Y_Center, UWORD Radius, UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill)
+{
+    Surface_DrawCircle(&Paint, X_Center, Y_Center, Radius, Color, Line_width, Draw_Fill);
+}
+
+void Paint_DrawChar(UWORD Xstart, UWORD Ystart, const char Acsii_Char, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
+{
+    Surface_DrawChar(&Paint, Xstart, Ystart, Acsii_Char, Font, Color_Foreground, Color_Background);
+}
+
+void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
+{
+    Surface_DrawString_EN(&Paint, Xstart, Ystart, pString, Font, Color_Foreground, Color_Background);
+}
+
+void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT* font, UWORD Color_Foreground, UWORD Color_Background)
+{
+    Surface_DrawString_CN(&Paint, Xstart, Ystart, pString, font, Color_Foreground, Color_Background);
+}
+
+void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber, sFONT* Font, UWORD Digit, UWORD Color_Foreground, UWORD Color_Background)
+{
+    Surface_DrawNum(&Paint, Xpoint, Ypoint, Nummber, Font, Digit, Color_Foreground, Color_Background);
+}
+
+void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
+{
+    Surface_DrawTime(&Paint, Xstart, Ystart, pTime, Font, Color_Foreground, Color_Background);
+}
+
+void Paint_DrawBitMap(const unsigned char* image_buffer)
+{
+    Surface_DrawBitMap(&Paint, image_buffer);
+}
+
+void Paint_DrawBitMap_Block(const unsigned char* image_buffer, UBYTE Region)
+{
+    Surface_DrawBitMap_Block(&Paint, image_buffer, Region);
+}
+
+void Paint_DrawImage(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image)
+{
+    Surface_DrawImage(&Paint, image, xStart, yStart, W_Image, H_Image);
+}
+
+void Paint_DrawImage1(const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image)
+{
+    Surface_DrawImage1(&Paint, image, xStart, yStart, W_Image, H_Image);
+}
+
+void Paint_BmpWindows(unsigned char x, unsigned char y, const unsigned char *pBmp, unsigned char chWidth, unsigned char chHeight)
+{
+    Surface_BmpWindows(&Paint, x, y, pBmp, chWidth, chHeight);
+}
@@ -4,8 +4,13 @@
 #include "DEV_Config.h"
 #include "../Fonts/fonts.h"
 
+struct PAINT_LIST;
+
 /**
- * Image attributes
+ * Image attributes. Each PAINT is a surface with its own image cache,
+ * geometry and format; the Surface_* functions draw on the one they are
+ * given and share no state, so surfaces can be drawn on from either core.
+ * The Paint_* functions draw on the default surface Paint.
 **/
 typedef struct {
     UBYTE *Image;
@@ -19,9 +24,26 @@ typedef struct {
     UWORD WidthByte;
     UWORD HeightByte;
     UWORD Scale;
+    struct PAINT_LIST *List;    // display list being recorded, see GUI_DisplayList.h
+    UWORD Dirty_Xs, Dirty_Ys;   // memory rectangle changed since Surface_ClearDirty()
+    UWORD Dirty_Xe, Dirty_Ye;
+    UWORD Content_Xs, Content_Ys; // memory rectangle drawn since the last clear
+    UWORD Content_Xe, Content_Ye;
+    UWORD Clear_Color;
 } PAINT;
 extern PAINT Paint;
 
+/**
+ * Pixel write counter, only compiled in when PAINT_PIXEL_COUNT is defined
+ * (host build). Counts every pixel stored into the image cache.
+**/
+#ifdef PAINT_PIXEL_COUNT
+extern UDOUBLE Paint_PixelCount;
+#define PAINT_COUNT_PIXELS(n) (Paint_PixelCount += (n))
+#else
+#define PAINT_COUNT_PIXELS(n)
+#endif
+
 /**
  * Display rotate
 **/
@@ -140,6 +162,10 @@ void Paint_DrawString_CN(UWORD Xstart, UWORD Ystart, const char * pString, cFONT
 void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber, sFONT* Font, UWORD Digit,UWORD Color_Foreground, UWORD Color_Background);
 void Paint_DrawTime(UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background);
 
+//Text measurement
+UWORD Paint_GetStringWidth_EN(const char * pString, sFONT* Font);
+UWORD Paint_GetStringWidth_CN(const char * pString, cFONT* font);
+
 //pic
 void Paint_DrawBitMap(const unsigned char* image_buffer);
 void Paint_DrawBitMap_Block(const unsigned char* image_buffer, UBYTE Region);
@@ -150,6 +176,47 @@ void Paint_DrawImage1(const unsigned char *image, UWORD xStart, UWORD yStart, UW
 					unsigned char chWidth,unsigned char chHeight);
 
 
+//Surfaces
+void Surface_MarkDirty(PAINT *Surface, UWORD Ystart, UWORD Yend);
+void Surface_MarkDirtyRect(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend);
+UBYTE Surface_GetDirty(PAINT *Surface, UWORD *Ystart, UWORD *Yend);
+UBYTE Surface_GetDirtyRect(PAINT *Surface, UWORD *Xstart, UWORD *Ystart, UWORD *Xend, UWORD *Yend);
+void Surface_ClearDirty(PAINT *Surface);
+
+//init and Clear
+void Surface_NewImage(PAINT *Surface, UBYTE *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD Color);
+void Surface_SelectImage(PAINT *Surface, UBYTE *image);
+void Surface_SetRotate(PAINT *Surface, UWORD Rotate);
+void Surface_SetMirroring(PAINT *Surface, UBYTE mirror);
+void Surface_SetPixel(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, UWORD Color);
+void Surface_SetScale(PAINT *Surface, UBYTE scale);
+
+void Surface_Clear(PAINT *Surface, UWORD Color);
+void Surface_ClearWindows(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color);
+
+//Drawing
+void Surface_DrawPoint(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, UWORD Color, DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_FillWay);
+void Surface_DrawLine(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, DOT_PIXEL Line_width, LINE_STYLE Line_Style);
+void Surface_DrawRectangle(PAINT *Surface, UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill);
+void Surface_DrawCircle(PAINT *Surface, UWORD X_Center, UWORD Y_Center, UWORD Radius, UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill);
+
+//Display string
+void Surface_DrawChar(PAINT *Surface, UWORD Xstart, UWORD Ystart, const char Acsii_Char, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background);
+void Surface_DrawString_EN(PAINT *Surface, UWORD Xstart, UWORD Ystart, const char * pString, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background);
+void Surface_DrawString_CN(PAINT *Surface, UWORD Xstart, UWORD Ystart, const char * pString, cFONT* font, UWORD Color_Foreground, UWORD Color_Background);
+void Surface_DrawNum(PAINT *Surface, UWORD Xpoint, UWORD Ypoint, double Nummber, sFONT* Font, UWORD Digit,UWORD Color_Foreground, UWORD Color_Background);
+void Surface_DrawTime(PAINT *Surface, UWORD Xstart, UWORD Ystart, PAINT_TIME *pTime, sFONT* Font, UWORD Color_Foreground, UWORD Color_Background);
+
+//pic
+void Surface_DrawBitMap(PAINT *Surface, const unsigned char* image_buffer);
+void Surface_DrawBitMap_Block(PAINT *Surface, const unsigned char* image_buffer, UBYTE Region);
+
+void Surface_DrawImage(PAINT *Surface, const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image) ;
+void Surface_DrawImage1(PAINT *Surface, const unsigned char *image, UWORD xStart, UWORD yStart, UWORD W_Image, UWORD H_Image);
+void Surface_BmpWindows(PAINT *Surface, unsigned char x,unsigned char y,const unsigned char *pBmp,\
+					unsigned char chWidth,unsigned char chHeight);
+
+
 #endif
 
 
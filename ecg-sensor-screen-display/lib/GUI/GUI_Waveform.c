@@ -0,0 +1,295 @@
+/*****************************************************************************
+* | File      	:   GUI_Waveform.c
+* | Function    :   Column-span waveform renderer for GUI_Paint surfaces
+* | Info        :
+*   Spans go straight into the image cache for RGB565 and 2-bit surfaces
+*   in ROTATE_0 / MIRROR_NONE, through the display list while one is
+*   selected, and through Surface_SetPixel() for everything else.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#include "GUI_Waveform.h"
+#include "GUI_DisplayList.h"
+#include "Debug.h"
+
+/******************************************************************************
+function:	Set up a trace
+parameter:
+    Xstart        : Surface column of the first value
+    Columns       : Number of values
+    Ytop, Ybottom : Rows the trace is clipped to, inclusive
+    Color         : Trace color
+******************************************************************************/
+void Paint_TraceInit(PAINT_TRACE *Trace, UWORD Xstart, UWORD Columns, UWORD Ytop, UWORD Ybottom, UWORD Color)
+{
+    Trace->Xstart = Xstart;
+    Trace->Columns = Columns;
+    Trace->Ytop = Ytop < Ybottom ? Ytop : Ybottom;
+    Trace->Ybottom = Ytop < Ybottom ? Ybottom : Ytop;
+    Trace->Color = Color;
+    Trace->Ymin = NULL;
+    Trace->Ymax = NULL;
+    Trace->Connect = 1;
+    Trace->Prev = NULL;
+    Trace->Color_Erase = 0;
+    Trace->Prev_Valid = 0;
+}
+
+/******************************************************************************
+function:	Values for the next draw, kept by the caller
+parameter:
+    Ymin : Row per column (polyline), or top row of each column's span
+    Ymax : Bottom row of each column's span, NULL for a polyline
+******************************************************************************/
+void Paint_TraceSetData(PAINT_TRACE *Trace, const UWORD *Ymin, const UWORD *Ymax)
+{
+    Trace->Ymin = Ymin;
+    Trace->Ymax = Ymax;
+}
+
+/******************************************************************************
+function:	Erase the spans of the previous draw before drawing
+parameter:
+    Prev        : Storage for 2 * Columns rows, NULL to stop erasing
+    Color_Erase : Background the old spans are painted with
+******************************************************************************/
+void Paint_TraceSetErase(PAINT_TRACE *Trace, UWORD *Prev, UWORD Color_Erase)
+{
+    Trace->Prev = Prev;
+    Trace->Color_Erase = Color_Erase;
+    Trace->Prev_Valid = 0;
+}
+
+/******************************************************************************
+function:	Forget the previous spans, e.g. after the surface was cleared
+******************************************************************************/
+void Paint_TraceInvalidate(PAINT_TRACE *Trace)
+{
+    Trace->Prev_Valid = 0;
+}
+
+/******************************************************************************
+function:	Span of column i after connecting and clipping
+******************************************************************************/
+static UWORD DEV_RAM_FUNC(Trace_Clip)(const PAINT_TRACE *Trace, UWORD Y)
+{
+    return Y < Trace->Ytop ? Trace->Ytop : (Y > Trace->Ybottom ? Trace->Ybottom : Y);
+}
+
+static void DEV_RAM_FUNC(Trace_Raw)(const PAINT_TRACE *Trace, UWORD i, UWORD *Ys, UWORD *Ye)
+{
+    UWORD Lo = Trace->Ymin[i];
+    UWORD Hi = Trace->Ymax != NULL && Lo != PAINT_TRACE_GAP ? Trace->Ymax[i] : Lo;
+    *Ys = Lo < Hi ? Lo : Hi;
+    *Ye = Lo < Hi ? Hi : Lo;
+}
+
+static void DEV_RAM_FUNC(Trace_Span)(const PAINT_TRACE *Trace, UWORD i, UWORD *Ys, UWORD *Ye)
+{
+    Trace_Raw(Trace, i, Ys, Ye);
+    if(*Ys == PAINT_TRACE_GAP)
+        return;
+    if(Trace->Connect && i > 0) {
+        // Stretch towards the previous column until the two spans touch
+        UWORD Prev_Ys, Prev_Ye;
+        Trace_Raw(Trace, i - 1, &Prev_Ys, &Prev_Ye);
+        if(Prev_Ys != PAINT_TRACE_GAP) {
+            if(*Ys > Prev_Ye + 1)
+                *Ys = Prev_Ye + 1;
+            if(Prev_Ys > 0 && *Ye < Prev_Ys - 1)
+                *Ye = Prev_Ys - 1;
+        }
+    }
+    *Ys = Trace_Clip(Trace, *Ys);
+    *Ye = Trace_Clip(Trace, *Ye);
+}
+
+static UWORD Trace_Columns(const PAINT *Surface, const PAINT_TRACE *Trace)
+{
+    if(Trace->Xstart >= Surface->Width || Trace->Ytop > Trace->Ybottom)
+        return 0;
+    if(Trace->Columns > Surface->Width - Trace->Xstart)
+        return Surface->Width - Trace->Xstart;
+    return Trace->Columns;
+}
+
+/******************************************************************************
+function:	Write one vertical span, rows Ys..Ye of column X, already clipped
+******************************************************************************/
+static void DEV_RAM_FUNC(Trace_Fill)(PAINT *Surface, UWORD X, UWORD Ys, UWORD Ye, UWORD Color)
+{
+    UWORD Y;
+
+    if(Surface->List != NULL) {
+        Paint_ListVSpan(Surface->List, X, Ys, Ye, Color);
+        return;
+    }
+    if(Surface->Rotate != ROTATE_0 || Surface->Mirror != MIRROR_NONE ||
+       (Surface->Scale != 65 && Surface->Scale != 4)) {
+        for(Y = Ys; Y <= Ye; Y++)
+            Surface_SetPixel(Surface, X, Y, Color);
+        return;
+    }
+
+    UBYTE *p = &Surface->Image[(UDOUBLE)Ys * Surface->WidthByte];
+    if(Surface->Scale == 65) {
+        UBYTE Hi = Color >> 8, Lo = Color & 0xff;
+        p += 2 * X;
+        for(Y = Ys; Y <= Ye; Y++, p += Surface->WidthByte) {
+            p[0] = Hi;
+            p[1] = Lo;
+        }
+    } else {
+        UBYTE Shift = 6 - (X % 4) * 2;
+        UBYTE Mask = ~(0x03 << Shift);
+        UBYTE Bits = (Color % 4) << Shift;
+        p += X / 4;
+        for(Y = Ys; Y <= Ye; Y++, p += Surface->WidthByte)
+            *p = (*p & Mask) | Bits;
+    }
+    PAINT_COUNT_PIXELS(Ye - Ys + 1);
+    Surface_MarkDirtyRect(Surface, X, Ys, X, Ye);
+}
+
+/******************************************************************************
+function:	Columns First..Last-1 of a trace a ranged draw may skip to
+info:
+    Without valid previous spans, or without data to draw, every column
+    has to be visited.
+******************************************************************************/
+static void DEV_RAM_FUNC(Trace_Range)(const PAINT_TRACE *Trace, UWORD Columns, UWORD First, UWORD Count,
+                        UWORD *pFirst, UWORD *pLast)
+{
+    if(Trace->Prev == NULL || !Trace->Prev_Valid || Trace->Ymin == NULL) {
+        *pFirst = 0;
+        *pLast = Columns;
+        return;
+    }
+    *pFirst = First < Columns ? First : Columns;
+    *pLast = Count < Columns - *pFirst ? *pFirst + Count : Columns;
+}
+
+/******************************************************************************
+function:	Erase the part of the previous span of column i not covered by Ys..Ye
+return:
+    1 if the span changed
+******************************************************************************/
+static UBYTE DEV_RAM_FUNC(Trace_Erase)(PAINT *Surface, const PAINT_TRACE *Trace, UWORD i, UWORD Ys, UWORD Ye)
+{
+    UWORD Prev_Ys = Trace->Prev[2 * i], Prev_Ye = Trace->Prev[2 * i + 1];
+    UWORD X = Trace->Xstart + i;
+
+    if(Ys == Prev_Ys && Ye == Prev_Ye)
+        return 0;
+    if(Prev_Ys == PAINT_TRACE_GAP)
+        return 1;
+    if(Ys > Prev_Ye || Ye < Prev_Ys) {
+        Trace_Fill(Surface, X, Prev_Ys, Prev_Ye, Trace->Color_Erase);
+        return 1;
+    }
+    if(Prev_Ys < Ys)
+        Trace_Fill(Surface, X, Prev_Ys, Ys - 1, Trace->Color_Erase);
+    if(Prev_Ye > Ye)
+        Trace_Fill(Surface, X, Ye + 1, Prev_Ye, Trace->Color_Erase);
+    return 1;
+}
+
+/******************************************************************************
+function:	Draw traces, one vertical span per column
+parameter:
+    Surface : Surface to draw on
+    Traces  : Traces with data set by Paint_TraceSetData()
+    Num     : Number of traces, at most PAINT_TRACE_MAX_TRACES
+******************************************************************************/
+void Surface_DrawTraces(PAINT *Surface, PAINT_TRACE *Traces, UBYTE Num)
+{
+    Surface_DrawTracesRange(Surface, Traces, Num, 0, 0xFFFF);
+}
+
+/******************************************************************************
+function:	Draw only columns First..First+Count-1 of each trace
+parameter:
+    Surface : Surface to draw on
+    Traces  : Traces with data set by Paint_TraceSetData()
+    Num     : Number of traces, at most PAINT_TRACE_MAX_TRACES
+    First   : First column, counted from each trace's Xstart
+    Count   : Number of columns
+info:
+    The other columns are left as they were, so their values must not have
+    changed since the last draw. A column's span also depends on the
+    column before it while Connect is set. Traces without valid previous
+    spans are drawn whole.
+******************************************************************************/
+void DEV_RAM_FUNC(Surface_DrawTracesRange)(PAINT *Surface, PAINT_TRACE *Traces, UBYTE Num, UWORD First, UWORD Count)
+{
+    UBYTE t;
+    UWORD X, Xs = 0xFFFF, Xe = 0, Ys, Ye;
+    UWORD Start[PAINT_TRACE_MAX_TRACES], End[PAINT_TRACE_MAX_TRACES];
+    UBYTE Erase[PAINT_TRACE_MAX_TRACES], Kept[PAINT_TRACE_MAX_TRACES];
+
+    if(Num > PAINT_TRACE_MAX_TRACES) {
+        Debug("Surface_DrawTraces: too many traces\r\n");
+        Num = PAINT_TRACE_MAX_TRACES;
+    }
+
+    // Clip once: rows to the surface, columns in Trace_Columns(); collect
+    // the surface columns any trace has to visit
+    for(t = 0; t < Num; t++) {
+        PAINT_TRACE *Trace = &Traces[t];
+        UWORD i, Last;
+        if(Trace->Ybottom >= Surface->Height)
+            Trace->Ybottom = Surface->Height - 1;
+        Trace_Range(Trace, Trace_Columns(Surface, Trace), First, Count, &i, &Last);
+        Start[t] = Trace->Xstart + i;
+        End[t] = Trace->Xstart + Last;
+        if(Start[t] < End[t]) {
+            Xs = Start[t] < Xs ? Start[t] : Xs;
+            Xe = End[t] > Xe ? End[t] : Xe;
+        }
+        Erase[t] = Trace->Prev != NULL && Trace->Prev_Valid;
+        // A span still in place is only redrawn if something was erased in its column
+        Kept[t] = Erase[t] && Surface->List == NULL;
+    }
+
+    // One pass over the columns: in each, every trace is erased before any
+    // is drawn, so traces that cross do not cut holes in each other
+    for(X = Xs; X < Xe; X++) {
+        UBYTE Erased = 0;
+        for(t = 0; t < Num; t++) {
+            const PAINT_TRACE *Trace = &Traces[t];
+            if(!Erase[t] || X < Start[t] || X >= End[t])
+                continue;
+            if(Trace->Ymin != NULL) {
+                Trace_Span(Trace, X - Trace->Xstart, &Ys, &Ye);
+            } else {
+                Ys = PAINT_TRACE_GAP;
+                Ye = PAINT_TRACE_GAP;
+            }
+            Erased |= Trace_Erase(Surface, Trace, X - Trace->Xstart, Ys, Ye);
+        }
+        for(t = 0; t < Num; t++) {
+            PAINT_TRACE *Trace = &Traces[t];
+            UWORD i = X - Trace->Xstart;
+            if(Trace->Ymin == NULL || X < Start[t] || X >= End[t])
+                continue;
+            Trace_Span(Trace, i, &Ys, &Ye);
+            if(Ys == PAINT_TRACE_GAP) {
+                // Nothing to draw
+            } else if(!Kept[t] || Erased || Ys != Trace->Prev[2 * i] || Ye != Trace->Prev[2 * i + 1])
+                Trace_Fill(Surface, X, Ys, Ye, Trace->Color);
+            if(Trace->Prev != NULL) {
+                Trace->Prev[2 * i] = Ys;
+                Trace->Prev[2 * i + 1] = Ye;
+            }
+        }
+    }
+
+    for(t = 0; t < Num; t++)
+        Traces[t].Prev_Valid = Traces[t].Prev != NULL && Traces[t].Ymin != NULL;
+}
+
+void Paint_DrawTraces(PAINT_TRACE *Traces, UBYTE Num)
+{
+    Surface_DrawTraces(&Paint, Traces, Num);
+}
@@ -0,0 +1,57 @@
+/*****************************************************************************
+* | File      	:   GUI_Waveform.h
+* | Function    :   Column-span waveform renderer for GUI_Paint surfaces
+* | Info        :
+*   A trace with one value (or one min/max pair) per column is drawn as one
+*   vertical span per column instead of a Paint_DrawLine per segment. The
+*   clip rectangle is applied once per call, not per pixel.
+*
+*   A trace given storage for its previous spans erases them in place
+*   before drawing, so a waveform on its own layer needs no Paint_Clear().
+*   Columns whose span did not move are not touched at all, so an
+*   unchanged trace leaves no dirty rows for the compositor.
+*   Surface_DrawTraces() draws all traces in one pass over the columns:
+*   in each column every trace is erased before any is drawn, so traces
+*   that cross do not cut holes in each other, and each column is touched
+*   once however many traces there are.
+*
+*   A column whose Ymin is PAINT_TRACE_GAP draws nothing and breaks the
+*   trace there, e.g. the blank columns ahead of a sweep cursor.
+*   Surface_DrawTracesRange() only looks at some columns, for callers that
+*   know which values changed and want each changed area flushed on its own.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+******************************************************************************/
+#ifndef __GUI_WAVEFORM_H
+#define __GUI_WAVEFORM_H
+
+#include "GUI_Paint.h"
+
+#define PAINT_TRACE_MAX_TRACES  8
+#define PAINT_TRACE_GAP         0xFFFF  // Ymin value of a column without data
+
+typedef struct {
+    UWORD Xstart;           // surface column of value 0
+    UWORD Columns;
+    UWORD Ytop, Ybottom;    // clip rows, inclusive
+    UWORD Color;
+    const UWORD *Ymin;      // top row per column
+    const UWORD *Ymax;      // bottom row per column, NULL: Ymin is a polyline
+    UBYTE Connect;          // stretch each span to touch the previous column
+    // Erasing in place
+    UWORD *Prev;            // 2 * Columns rows, spans drawn last time
+    UWORD Color_Erase;
+    UBYTE Prev_Valid;
+} PAINT_TRACE;
+
+void Paint_TraceInit(PAINT_TRACE *Trace, UWORD Xstart, UWORD Columns, UWORD Ytop, UWORD Ybottom, UWORD Color);
+void Paint_TraceSetData(PAINT_TRACE *Trace, const UWORD *Ymin, const UWORD *Ymax);
+void Paint_TraceSetErase(PAINT_TRACE *Trace, UWORD *Prev, UWORD Color_Erase);
+void Paint_TraceInvalidate(PAINT_TRACE *Trace);
+
+void Surface_DrawTraces(PAINT *Surface, PAINT_TRACE *Traces, UBYTE Num);
+void Surface_DrawTracesRange(PAINT *Surface, PAINT_TRACE *Traces, UBYTE Num, UWORD First, UWORD Count);
+void Paint_DrawTraces(PAINT_TRACE *Traces, UBYTE Num);
+
+#endif
@@ -6,6 +6,22 @@
 
 LCD_1IN14_ATTRIBUTES LCD_1IN14;
 
+/**
+ * RGB444 line buffers, one is packed while the other is sent by DMA.
+ * A line holds up to 240 pixels plus one carried over from the previous line.
+**/
+#define LCD_1IN14_LINE_BYTES ((LCD_1IN14_HEIGHT + 1) * 3 / 2 + 1)
+static UBYTE LCD_1IN14_Line[2][LCD_1IN14_LINE_BYTES] DEV_RAM_FRAME;
+
+#if DEV_LCD_PIO
+/**
+ * Window commands as one tagged stream: 2A, 2B and 2C with their
+ * parameters, five segments.
+**/
+static UBYTE LCD_1IN14_Window[5 * DEV_SPI_TAG_BYTES + 11];
+static DEV_XFER LCD_1IN14_Window_Xfer;
+#endif
+
 
 /******************************************************************************
 function :	Hardware reset
@@ -68,7 +84,7 @@ parameter:
 static void LCD_1IN14_InitReg(void)
 {
     LCD_1IN14_SendCommand(0x3A);
-    LCD_1IN14_SendData_8Bit(0x05);
+    LCD_1IN14_SendData_8Bit(LCD_1IN14.COLOR_MODE);
 
     LCD_1IN14_SendCommand(0xB2);
     LCD_1IN14_SendData_8Bit(0x0C);
@@ -179,10 +195,35 @@ void LCD_1IN14_Init(UBYTE Scan_dir)
     //Set the resolution and scanning method of the screen
     LCD_1IN14_SetAttributes(Scan_dir);
     
+    //Keep a mode chosen before Init, default to 16-bit
+    if(LCD_1IN14.COLOR_MODE != LCD_1IN14_COLOR_RGB444)
+        LCD_1IN14.COLOR_MODE = LCD_1IN14_COLOR_RGB565;
+
     //Set the initialization register
     LCD_1IN14_InitReg();
 }
 
+/********************************************************************************
+function :	Select the interface pixel format
+parameter:
+    Mode : LCD_1IN14_COLOR_RGB565 or LCD_1IN14_COLOR_RGB444
+info:
+    Image buffers stay RGB565 in both modes. In RGB444 mode every transfer
+    drops the low bits of each channel while packing, which cuts the bytes
+    on the bus by 25%. Colours whose RGB565 low bits repeat the high bits
+    (BLACK, WHITE, BLUE, GREEN, RED, ...) come out unchanged.
+********************************************************************************/
+void LCD_1IN14_SetColorMode(UBYTE Mode)
+{
+    if(Mode != LCD_1IN14_COLOR_RGB565 && Mode != LCD_1IN14_COLOR_RGB444) {
+        printf("LCD_1IN14_SetColorMode: unsupported mode 0x%02x\r\n", Mode);
+        return;
+    }
+    LCD_1IN14.COLOR_MODE = Mode;
+    LCD_1IN14_SendCommand(0x3A);
+    LCD_1IN14_SendData_8Bit(Mode);
+}
+
 /********************************************************************************
 function:	Sets the start position and size of the display area
 parameter:
@@ -190,12 +231,42 @@ parameter:
 		Ystart  :   Y direction Start coordinates
 		Xend    :   X direction end coordinates
 		Yend    :   Y direction end coordinates
+info:
+    With DEV_LCD_PIO the three commands and their parameters are one
+    queued transfer, DC and CS switch in the PIO program.
 ********************************************************************************/
 void LCD_1IN14_SetWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
 {
     UBYTE x,y;
     if(LCD_1IN14.SCAN_DIR == HORIZONTAL){x=40;y=53;}
     else{ x=52; y=40; }
+#if DEV_LCD_PIO
+    UWORD Col[2] = {Xstart + x, Xend - 1 + x};
+    UWORD Row[2] = {Ystart + y, Yend - 1 + y};
+    UBYTE Param[4];
+    UBYTE Cmd;
+    UDOUBLE Len = 0;
+    DEV_XFER *Xfer = &LCD_1IN14_Window_Xfer;
+
+    DEV_Xfer_Wait(Xfer);
+    Cmd = 0x2A;
+    Len += DEV_SPI_Tag(&LCD_1IN14_Window[Len], 0, &Cmd, 1);
+    Param[0] = Col[0] >> 8; Param[1] = Col[0] & 0xFF; Param[2] = Col[1] >> 8; Param[3] = Col[1] & 0xFF;
+    Len += DEV_SPI_Tag(&LCD_1IN14_Window[Len], 1, Param, 4);
+    Cmd = 0x2B;
+    Len += DEV_SPI_Tag(&LCD_1IN14_Window[Len], 0, &Cmd, 1);
+    Param[0] = Row[0] >> 8; Param[1] = Row[0] & 0xFF; Param[2] = Row[1] >> 8; Param[3] = Row[1] & 0xFF;
+    Len += DEV_SPI_Tag(&LCD_1IN14_Window[Len], 1, Param, 4);
+    Cmd = 0X2C;
+    Len += DEV_SPI_Tag(&LCD_1IN14_Window[Len], 0, &Cmd, 1);
+
+    Xfer->Bus = DEV_BUS_SPI;
+    Xfer->Cs = DEV_XFER_CS_FRAME;
+    Xfer->Dc = DEV_XFER_DC_TAGGED;
+    Xfer->pTx = LCD_1IN14_Window;
+    Xfer->Tx_Len = Len;
+    DEV_Xfer_Submit(Xfer);
+#else
     //set the X coordinates
     LCD_1IN14_SendCommand(0x2A);
     
@@ -209,6 +280,81 @@ void LCD_1IN14_SetWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
 
     LCD_1IN14_SendCommand(0X2C);
     // printf("%d %d\r\n",x,y);
+#endif
+}
+
+/******************************************************************************
+function :	Pack RGB565 pixels into the RGB444 wire format
+parameter:
+    pSrc   : pixels in image buffer byte order (high byte first)
+    Pixels : number of pixels
+    pDst   : output, 3 bytes per 2 pixels
+    pCarry : the odd pixel left over from the previous call, 0xFFFF if none
+return:
+    number of bytes written to pDst
+******************************************************************************/
+static UWORD DEV_RAM_FUNC(LCD_1IN14_Pack444)(const UBYTE *pSrc, UWORD Pixels, UBYTE *pDst, UWORD *pCarry)
+{
+    UWORD Bytes = 0;
+    UWORD Carry = *pCarry;
+    for(UWORD i = 0; i < Pixels; i++, pSrc += 2) {
+        UWORD Color = (pSrc[0] << 8) | pSrc[1];
+        UWORD Pixel = ((Color >> 4) & 0xF00) | ((Color >> 3) & 0x0F0) | ((Color >> 1) & 0x00F);
+        if(Carry == 0xFFFF) {
+            Carry = Pixel;
+        } else {
+            pDst[Bytes++] = Carry >> 4;
+            pDst[Bytes++] = ((Carry & 0x0F) << 4) | (Pixel >> 8);
+            pDst[Bytes++] = Pixel & 0xFF;
+            Carry = 0xFFFF;
+        }
+    }
+    *pCarry = Carry;
+    return Bytes;
+}
+
+/******************************************************************************
+function :	Send a window of an image buffer to the panel
+parameter:
+    Xstart, Ystart, Xend, Yend : window, end exclusive
+    Image  : top-left pixel of the window
+    Stride : pixels per row of Image
+info:
+    Rows go out through the SPI transfer queue. In RGB444 mode the next
+    line is packed while DMA sends the previous one.
+    An odd pixel count is padded with the window's first pixel: the
+    controller wraps to the window start, so the pad rewrites that pixel
+    with its own value.
+******************************************************************************/
+static void LCD_1IN14_SendWindow(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
+                                 const UWORD *Image, UWORD Stride)
+{
+    UWORD j;
+    UWORD Width = Xend - Xstart;
+    LCD_1IN14_SetWindows(Xstart, Ystart, Xend, Yend);
+    DEV_Digital_Write(EPD_DC_PIN, 1);
+    DEV_Digital_Write(EPD_CS_PIN, 0);
+    if(LCD_1IN14.COLOR_MODE == LCD_1IN14_COLOR_RGB444) {
+        UWORD Carry = 0xFFFF;
+        UBYTE Buf = 0;
+        for(j = 0; j < Yend - Ystart; j++) {
+            UWORD Len = LCD_1IN14_Pack444((const UBYTE *)&Image[j * Stride], Width,
+                                          LCD_1IN14_Line[Buf], &Carry);
+            DEV_SPI_Write_nByte_DMA(LCD_1IN14_Line[Buf], Len);
+            Buf ^= 1;
+        }
+        if(Carry != 0xFFFF) {
+            UWORD Len = LCD_1IN14_Pack444((const UBYTE *)Image, 1, LCD_1IN14_Line[Buf], &Carry);
+            DEV_SPI_Write_nByte_DMA(LCD_1IN14_Line[Buf], Len);
+        }
+        DEV_SPI_DMA_Wait();
+    } else {
+        for(j = 0; j < Yend - Ystart; j++) {
+            DEV_SPI_Write_nByte_DMA((const uint8_t *)&Image[j * Stride], Width * 2);
+        }
+        DEV_SPI_DMA_Wait();
+    }
+    DEV_Digital_Write(EPD_CS_PIN, 1);
 }
 
 /******************************************************************************
@@ -217,23 +363,17 @@ parameter:
 ******************************************************************************/
 void LCD_1IN14_Clear(UWORD Color)
 {
-    UWORD j,i;
-    UWORD Image[LCD_1IN14.WIDTH*LCD_1IN14.HEIGHT];
+    UWORD j;
+    UWORD Line[LCD_1IN14_HEIGHT];
     
     Color = ((Color<<8)&0xff00)|(Color>>8);
    
-    for (j = 0; j < LCD_1IN14.HEIGHT*LCD_1IN14.WIDTH; j++) {
-        Image[j] = Color;
+    for (j = 0; j < LCD_1IN14.WIDTH; j++) {
+        Line[j] = Color;
     }
     
-    LCD_1IN14_SetWindows(0, 0, LCD_1IN14.WIDTH, LCD_1IN14.HEIGHT);
-    DEV_Digital_Write(EPD_DC_PIN, 1);
-    DEV_Digital_Write(EPD_CS_PIN, 0);
-    // printf("HEIGHT %d, WIDTH %d\r\n",LCD_1IN14.HEIGHT,LCD_1IN14.WIDTH);
-    for(j = 0; j < LCD_1IN14.HEIGHT; j++){
-        DEV_SPI_Write_nByte((uint8_t *)&Image[j*LCD_1IN14.WIDTH], LCD_1IN14.WIDTH*2);
-    }
-    DEV_Digital_Write(EPD_CS_PIN, 1);
+    // Every row reads the same line
+    LCD_1IN14_SendWindow(0, 0, LCD_1IN14.WIDTH, LCD_1IN14.HEIGHT, Line, 0);
 }
 
 /******************************************************************************
@@ -242,37 +382,49 @@ parameter:
 ******************************************************************************/
 void LCD_1IN14_Display(UWORD *Image)
 {
-    UWORD j;
-    LCD_1IN14_SetWindows(0, 0, LCD_1IN14.WIDTH, LCD_1IN14.HEIGHT);
-    DEV_Digital_Write(EPD_DC_PIN, 1);
-    DEV_Digital_Write(EPD_CS_PIN, 0);
-    for (j = 0; j < LCD_1IN14.HEIGHT; j++) {
-        DEV_SPI_Write_nByte((uint8_t *)&Image[j*LCD_1IN14.WIDTH], LCD_1IN14.WIDTH*2);
-    }
-    DEV_Digital_Write(EPD_CS_PIN, 1);
+    LCD_1IN14_SendWindow(0, 0, LCD_1IN14.WIDTH, LCD_1IN14.HEIGHT, Image, LCD_1IN14.WIDTH);
     LCD_1IN14_SendCommand(0x29);
 }
 
 void LCD_1IN14_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image)
 {
     // display
-    UDOUBLE Addr = 0;
+    UDOUBLE Addr = Xstart + Ystart * LCD_1IN14.WIDTH;
+    LCD_1IN14_SendWindow(Xstart, Ystart, Xend, Yend, &Image[Addr], LCD_1IN14.WIDTH);
+}
 
-    UWORD j;
-    LCD_1IN14_SetWindows(Xstart, Ystart, Xend , Yend);
-    DEV_Digital_Write(EPD_DC_PIN, 1);
-    DEV_Digital_Write(EPD_CS_PIN, 0);
-    for (j = Ystart; j < Yend - 1; j++) {
-        Addr = Xstart + j * LCD_1IN14.WIDTH ;
-        DEV_SPI_Write_nByte((uint8_t *)&Image[Addr], (Xend-Xstart)*2);
-    }
-    DEV_Digital_Write(EPD_CS_PIN, 1);
+/******************************************************************************
+function :	Sends full-width rows Ystart..Yend-1, e.g. one band of a display list
+parameter:
+    Band : rows of the band only, LCD_1IN14.WIDTH pixels each
+******************************************************************************/
+void LCD_1IN14_DisplayBand(UWORD Ystart, UWORD Yend, UWORD *Band)
+{
+    LCD_1IN14_SendWindow(0, Ystart, LCD_1IN14.WIDTH, Yend, Band, LCD_1IN14.WIDTH);
+}
+
+/******************************************************************************
+function :	Sends the window Xstart..Xend-1, Ystart..Yend-1
+parameter:
+    Rect : pixels of the window only, Xend - Xstart per row
+******************************************************************************/
+void LCD_1IN14_DisplayRect(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Rect)
+{
+    LCD_1IN14_SendWindow(Xstart, Ystart, Xend, Yend, Rect, Xend - Xstart);
 }
 
 void LCD_1IN14_DisplayPoint(UWORD X, UWORD Y, UWORD Color)
 {
     LCD_1IN14_SetWindows(X,Y,X,Y);
-    LCD_1IN14_SendData_16Bit(Color);
+    if(LCD_1IN14.COLOR_MODE == LCD_1IN14_COLOR_RGB444) {
+        // Two copies of the same pixel, the second wraps onto the first
+        UWORD Pixel = ((Color >> 4) & 0xF00) | ((Color >> 3) & 0x0F0) | ((Color >> 1) & 0x00F);
+        LCD_1IN14_SendData_8Bit(Pixel >> 4);
+        LCD_1IN14_SendData_8Bit(((Pixel & 0x0F) << 4) | (Pixel >> 8));
+        LCD_1IN14_SendData_8Bit(Pixel & 0xFF);
+    } else {
+        LCD_1IN14_SendData_16Bit(Color);
+    }
 }
 
 void  Handler_1IN14_LCD(int signo)
@@ -17,11 +17,18 @@
 
 #define LCD_1IN14_SetBacklight(Value) ; 
 
+/**
+ * Interface pixel format (COLMOD 0x3A)
+**/
+#define LCD_1IN14_COLOR_RGB565  0x05    // 16-bit/pixel, 2 bytes per pixel
+#define LCD_1IN14_COLOR_RGB444  0x03    // 12-bit/pixel, 3 bytes per 2 pixels
+
 
 typedef struct{
     UWORD WIDTH;
     UWORD HEIGHT;
     UBYTE SCAN_DIR;
+    UBYTE COLOR_MODE;
 }LCD_1IN14_ATTRIBUTES;
 extern LCD_1IN14_ATTRIBUTES LCD_1IN14;
 
@@ -30,9 +37,12 @@ function:
 			Macro definition variable name
 ********************************************************************************/
 void LCD_1IN14_Init(UBYTE Scan_dir);
+void LCD_1IN14_SetColorMode(UBYTE Mode);
 void LCD_1IN14_Clear(UWORD Color);
 void LCD_1IN14_Display(UWORD *Image);
 void LCD_1IN14_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image);
+void LCD_1IN14_DisplayBand(UWORD Ystart, UWORD Yend, UWORD *Band);
+void LCD_1IN14_DisplayRect(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Rect);
 void LCD_1IN14_DisplayPoint(UWORD X, UWORD Y, UWORD Color);
 
 void Handler_1IN14_LCD(int signo);